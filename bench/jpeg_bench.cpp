@@ -0,0 +1,688 @@
+/**
+ * @file jpeg_bench.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Measures the throughput of each stage of the codec and of whole-image encode/decode.
+ *
+ * Every figure is printed as one record (JSON array or CSV), so that runs on
+ * successive commits can be compared by a script. The inputs are generated
+ * deterministically: the same build on the same machine measures the same work.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/cCompression.h"
+#include "core/cCompressionCouleur.h"
+#include "core/cContexteCodec.h"
+#include "core/cEncodeurPipeline.h"
+#include "core/cHuffman.h"
+#include "core/cImage.h"
+#include "core/cTablesHuffman.h"
+#include "couleur/couleur.h"
+#include "dct/dct.h"
+#include "dct/dct_kernels.h"
+#include "quantification/quantification.h"
+
+namespace {
+
+/** @brief Number of blocks in the batch of every per-stage measurement. */
+constexpr size_t kNbBlocs = 1024;
+
+/**
+ * @struct sMesure
+ * @brief One measured figure.
+ */
+struct sMesure {
+    std::string categorie;        ///< "stage" or "image".
+    std::string nom;              ///< What was measured.
+    std::string variante;         ///< Kernel set, subsampling or filter.
+    unsigned int largeur = 0;     ///< Image width (0 for a stage).
+    unsigned int hauteur = 0;     ///< Image height.
+    unsigned int qualite = 0;     ///< Quality (0 if irrelevant).
+    uint64_t iterations = 0;      ///< Calls timed.
+    uint64_t blocs = 0;           ///< 8x8 blocks (or 64-pixel groups) per call.
+    uint64_t octets = 0;          ///< Input bytes per call (output pixels for a decoder).
+    uint64_t octetsSortie = 0;    ///< Compressed size for a whole-image encoder.
+    double secondes = 0.0;        ///< Time of the best repetition.
+
+    double nsParBloc() const { return (blocs && iterations) ? secondes * 1e9 / static_cast<double>(blocs * iterations) : 0.0; }
+    double moParSeconde() const { return (secondes > 0.0) ? static_cast<double>(octets * iterations) / 1e6 / secondes : 0.0; }
+};
+
+/** @brief Settings from the command line. */
+struct sOptions {
+    double tempsMin = 0.2;  ///< Minimum duration of a repetition, in seconds.
+    unsigned int repetitions = 3;
+    bool csv = false;
+    bool rapide = false;    ///< Smallest image size only.
+    std::string filtre;     ///< Only the records whose name contains it.
+    std::string sortie;     ///< Output file (stdout if empty).
+};
+
+/** @brief Keeps results alive so that the compiler cannot drop the work. */
+volatile uint64_t g_puits = 0;
+
+/** @brief Deterministic pseudo-random generator (xorshift). */
+struct sAleatoire {
+    uint32_t etat = 2463534242u;
+    uint32_t suivant()
+    {
+        etat ^= etat << 13;
+        etat ^= etat >> 17;
+        etat ^= etat << 5;
+        return etat;
+    }
+};
+
+/**
+ * @brief Fills a plane with something image-like: gradients, edges and some noise.
+ * @param c The component (0-2); the patterns are shifted between components.
+ */
+void synthetiser(unsigned char *pixels, unsigned int w, unsigned int h, size_t pas, size_t saut, unsigned int c, sAleatoire &rng)
+{
+    for (unsigned int y = 0; y < h; ++y) {
+        for (unsigned int x = 0; x < w; ++x) {
+            double v = 96.0 + 64.0 * std::sin((x + 37.0 * c) * 0.021) * std::cos((y + 11.0 * c) * 0.017);
+            if (((x / 48 + y / 40 + c) & 3) == 0) v += 60.0;            // flat tiles with sharp edges
+            v += 24.0 * std::sin((x * 0.35 + y * 0.11) * (1.0 + c));    // texture
+            v += static_cast<double>(rng.suivant() % 17) - 8.0;         // sensor noise
+            pixels[y * pas + x * saut] = static_cast<unsigned char>(std::min(255.0, std::max(0.0, v)));
+        }
+    }
+}
+
+/**
+ * @brief Times f: the number of calls is doubled until one repetition lasts tempsMin, then the best of a few is kept.
+ */
+template <typename F>
+sMesure mesurer(const sOptions &opt, sMesure m, F &&f)
+{
+    using horloge = std::chrono::steady_clock;
+    uint64_t n = 1;
+    for (;;) {
+        const auto debut = horloge::now();
+        for (uint64_t i = 0; i < n; ++i) f();
+        const double t = std::chrono::duration<double>(horloge::now() - debut).count();
+        if (t >= opt.tempsMin || n >= (uint64_t(1) << 40)) break;
+        // Aim slightly past the minimum to avoid a second doubling for noisy timers.
+        const double facteur = (t > 0.0) ? std::min(16.0, std::max(2.0, 1.2 * opt.tempsMin / t)) : 16.0;
+        n = static_cast<uint64_t>(static_cast<double>(n) * facteur);
+    }
+    double meilleur = 0.0;
+    for (unsigned int r = 0; r < opt.repetitions; ++r) {
+        const auto debut = horloge::now();
+        for (uint64_t i = 0; i < n; ++i) f();
+        const double t = std::chrono::duration<double>(horloge::now() - debut).count();
+        if (r == 0 || t < meilleur) meilleur = t;
+    }
+    m.iterations = n;
+    m.secondes = meilleur;
+    return m;
+}
+
+sMesure etape(const char *nom, const char *variante, uint64_t blocs, uint64_t octets)
+{
+    sMesure m;
+    m.categorie = "stage";
+    m.nom = nom;
+    m.variante = variante;
+    m.blocs = blocs;
+    m.octets = octets;
+    return m;
+}
+
+bool retenu(const sOptions &opt, const char *nom)
+{
+    return opt.filtre.empty() || std::string(nom).find(opt.filtre) != std::string::npos;
+}
+
+/** @brief DCT, quantization, RLE and entropy stages over a batch of blocks. */
+void mesurer_etapes_blocs(const sOptions &opt, std::vector<sMesure> &mesures)
+{
+    sAleatoire rng;
+    std::vector<unsigned char> pixels(kNbBlocs * 64);
+    synthetiser(pixels.data(), 256, static_cast<unsigned int>(kNbBlocs * 64 / 256), 256, 1, 0, rng);
+    // Blocks in raster order of a 256-wide plane, level-shifted.
+    std::vector<int16_t> blocs(kNbBlocs * 64);
+    for (size_t b = 0; b < kNbBlocs; ++b) {
+        const size_t x0 = (b % 32) * 8, y0 = (b / 32) * 8;
+        for (int r = 0; r < 8; ++r)
+            for (int c = 0; c < 8; ++c) blocs[b * 64 + r * 8 + c] = static_cast<int16_t>(pixels[(y0 + r) * 256 + x0 + c] - 128);
+    }
+    const cContexteQuant ctx(50, COMPOSANTE_LUMA);
+    std::vector<float> dct(kNbBlocs * 64);
+    std::vector<int16_t> coefs(kNbBlocs * 64), reconstruits(kNbBlocs * 64);
+    float Qinv[64], Q[64];
+    for (int k = 0; k < 64; ++k) {
+        Q[k] = static_cast<float>(ctx.getTable()[k]);
+        Qinv[k] = 1.0f / Q[k];
+    }
+
+    const char *noms[] = { "scalar", "sse4.1", "avx2", "neon" };
+    for (const char *nom : noms) {
+        const sDctKernels *k = dct_kernels_by_name(nom);
+        if (!k) continue;
+        if (retenu(opt, "dct"))
+            mesures.push_back(mesurer(opt, etape("dct", nom, kNbBlocs, kNbBlocs * 64), [&] {
+                k->dct(blocs.data(), dct.data(), kNbBlocs);
+                g_puits += static_cast<uint64_t>(dct[5]);
+            }));
+        if (retenu(opt, "dct_quant"))
+            mesures.push_back(mesurer(opt, etape("dct_quant", nom, kNbBlocs, kNbBlocs * 64), [&] {
+                k->dct_quant(blocs.data(), Qinv, coefs.data(), kNbBlocs);
+                g_puits += static_cast<uint64_t>(coefs[3]);
+            }));
+        k->dct_quant(blocs.data(), Qinv, coefs.data(), kNbBlocs);
+        if (retenu(opt, "dequant_idct"))
+            mesures.push_back(mesurer(opt, etape("dequant_idct", nom, kNbBlocs, kNbBlocs * 64), [&] {
+                k->dequant_idct(coefs.data(), Q, reconstruits.data(), kNbBlocs);
+                g_puits += static_cast<uint64_t>(reconstruits[9]);
+            }));
+    }
+
+    // The later stages start from these, whichever figures were filtered out.
+    dct_kernels().dct(blocs.data(), dct.data(), kNbBlocs);
+    dct_kernels().dct_quant(blocs.data(), Qinv, coefs.data(), kNbBlocs);
+
+    // Fixed-point transforms (PIPELINE_ENTIER).
+    std::vector<int32_t> dct8(kNbBlocs * 64);
+    if (retenu(opt, "dct_entier"))
+        mesures.push_back(mesurer(opt, etape("dct_entier", "scalar", kNbBlocs, kNbBlocs * 64), [&] {
+            for (size_t b = 0; b < kNbBlocs; ++b) Calcul_DCT_Block_Entier(blocs.data() + b * 64, dct8.data() + b * 64);
+            g_puits += static_cast<uint64_t>(dct8[7]);
+        }));
+    for (size_t b = 0; b < kNbBlocs; ++b) Calcul_DCT_Block_Entier(blocs.data() + b * 64, dct8.data() + b * 64);
+    if (retenu(opt, "idct_entier"))
+        mesures.push_back(mesurer(opt, etape("idct_entier", "scalar", kNbBlocs, kNbBlocs * 64), [&] {
+            for (size_t b = 0; b < kNbBlocs; ++b) Calcul_IDCT_Block_Entier(dct8.data() + b * 64, reconstruits.data() + b * 64);
+            g_puits += static_cast<uint64_t>(reconstruits[11]);
+        }));
+
+    // Legacy double-precision API on row pointers, block by block.
+    int entrees[64], sorties[64];
+    double reels[64];
+    int *lignesEntree[8], *lignesSortie[8];
+    double *lignesReels[8];
+    for (int r = 0; r < 8; ++r) {
+        lignesEntree[r] = entrees + r * 8;
+        lignesSortie[r] = sorties + r * 8;
+        lignesReels[r] = reels + r * 8;
+    }
+    const size_t nbLegacy = kNbBlocs / 8;
+    if (retenu(opt, "dct_double"))
+        mesures.push_back(mesurer(opt, etape("dct_double", "scalar", nbLegacy, nbLegacy * 64), [&] {
+            for (size_t b = 0; b < nbLegacy; ++b) {
+                for (int k = 0; k < 64; ++k) entrees[k] = blocs[b * 64 + k];
+                Calcul_DCT_Block(lignesEntree, lignesReels);
+                g_puits += static_cast<uint64_t>(reels[1]);
+            }
+        }));
+    if (retenu(opt, "idct_double"))
+        mesures.push_back(mesurer(opt, etape("idct_double", "scalar", nbLegacy, nbLegacy * 64), [&] {
+            for (size_t b = 0; b < nbLegacy; ++b) {
+                for (int k = 0; k < 64; ++k) reels[k] = dct[b * 64 + k];
+                Calcul_IDCT_Block(lignesReels, lignesSortie);
+                g_puits += static_cast<uint64_t>(sorties[1]);
+            }
+        }));
+    if (retenu(opt, "quant_JPEG"))
+        mesures.push_back(mesurer(opt, etape("quant_JPEG", "scalar", kNbBlocs, kNbBlocs * 64), [&] {
+            for (size_t b = 0; b < kNbBlocs; ++b) {
+                for (int k = 0; k < 64; ++k) reels[k] = dct[b * 64 + k];
+                quant_JPEG(lignesReels, lignesSortie, ctx);
+                g_puits += static_cast<uint64_t>(sorties[0]);
+            }
+        }));
+    if (retenu(opt, "dequant_JPEG"))
+        mesures.push_back(mesurer(opt, etape("dequant_JPEG", "scalar", kNbBlocs, kNbBlocs * 64), [&] {
+            for (size_t b = 0; b < kNbBlocs; ++b) {
+                for (int k = 0; k < 64; ++k) sorties[k] = coefs[b * 64 + k];
+                dequant_JPEG(lignesSortie, lignesReels, ctx);
+                g_puits += static_cast<uint64_t>(reels[0]);
+            }
+        }));
+
+    // Zigzag quantization and RLE, as in cCompression::RLE().
+    std::vector<int16_t> zigzag(kNbBlocs * 64);
+    if (retenu(opt, "quantifier_zigzag"))
+        mesures.push_back(mesurer(opt, etape("quantifier_zigzag", "scalar", kNbBlocs, kNbBlocs * 64), [&] {
+            for (size_t b = 0; b < kNbBlocs; ++b) ctx.quantifier_zigzag(dct.data() + b * 64, zigzag.data() + b * 64);
+            g_puits += static_cast<uint64_t>(zigzag[0]);
+        }));
+    std::vector<uint64_t> masques(kNbBlocs);
+    for (size_t b = 0; b < kNbBlocs; ++b) masques[b] = ctx.quantifier_zigzag(dct.data() + b * 64, zigzag.data() + b * 64);
+    std::vector<signed char> trame(kNbBlocs * 128);
+    size_t tailleTrame = 0;
+    auto rle = [&] {
+        int DC = 0;
+        tailleTrame = 0;
+        for (size_t b = 0; b < kNbBlocs; ++b) {
+            tailleTrame += static_cast<size_t>(cCompression::RLE_Block(zigzag.data() + b * 64, DC, trame.data() + tailleTrame));
+            DC = zigzag[b * 64];
+        }
+    };
+    if (retenu(opt, "RLE_Block"))
+        mesures.push_back(mesurer(opt, etape("RLE_Block", "scalar", kNbBlocs, kNbBlocs * 64 * sizeof(int16_t)), [&] {
+            rle();
+            g_puits += tailleTrame;
+        }));
+    // The same blocks with the masks given by the quantization.
+    if (retenu(opt, "RLE_Block"))
+        mesures.push_back(mesurer(opt, etape("RLE_Block", "mask", kNbBlocs, kNbBlocs * 64 * sizeof(int16_t)), [&] {
+            int DC = 0;
+            size_t taille = 0;
+            for (size_t b = 0; b < kNbBlocs; ++b) {
+                taille += static_cast<size_t>(cCompression::RLE_Block(zigzag.data() + b * 64, masques[b], DC, trame.data() + taille));
+                DC = zigzag[b * 64];
+            }
+            g_puits += taille;
+        }));
+    rle();
+
+    cCompression codec;
+    char Donnee[256];
+    double Frequence[256];
+    if (retenu(opt, "Histogramme"))
+        mesures.push_back(mesurer(opt, etape("Histogramme", "scalar", kNbBlocs, tailleTrame), [&] {
+            g_puits += codec.Histogramme(reinterpret_cast<char*>(trame.data()), static_cast<unsigned int>(tailleTrame), Donnee, Frequence);
+        }));
+
+    // Huffman coding of the RLE bytes with their optimal table.
+    uint32_t Comptes[256] = {0};
+    for (size_t i = 0; i < tailleTrame; ++i) ++Comptes[static_cast<unsigned char>(trame[i])];
+    uint8_t Longueurs[256];
+    uint32_t Codes[256];
+    cHuffman::CalculerLongueurs(Comptes, Longueurs);
+    cHuffman::CodesCanoniques(Longueurs, Codes);
+    std::vector<unsigned char> payload;
+    payload.reserve(tailleTrame * 2);
+    uint64_t nbBits = 0;
+    auto encoder = [&] {
+        payload.clear();
+        cEcrivainBits ecrivain(payload);
+        for (size_t i = 0; i < tailleTrame; ++i) {
+            const unsigned char c = static_cast<unsigned char>(trame[i]);
+            ecrivain.ecrire(Codes[c], Longueurs[c]);
+        }
+        ecrivain.aligner();
+        nbBits = ecrivain.getNbBits();
+    };
+    if (retenu(opt, "huffman_encode"))
+        mesures.push_back(mesurer(opt, etape("huffman_encode", "scalar", kNbBlocs, tailleTrame), [&] {
+            encoder();
+            g_puits += nbBits;
+        }));
+    encoder();
+    cHuffman h;
+    h.ConstruireDepuisLongueurs(Longueurs);
+    if (retenu(opt, "huffman_decode"))
+        mesures.push_back(mesurer(opt, etape("huffman_decode", "scalar", kNbBlocs, tailleTrame), [&] {
+            cLecteurHuffman lecteur(h, payload.data(), payload.size(), 0, nbBits);
+            uint64_t somme = 0;
+            for (int s = lecteur.lire(); s >= 0; s = lecteur.lire()) somme += static_cast<uint64_t>(s);
+            g_puits += somme;
+        }));
+    if (retenu(opt, "rle_decode"))
+        mesures.push_back(mesurer(opt, etape("rle_decode", "scalar", kNbBlocs, tailleTrame), [&] {
+            cLecteurHuffman lecteur(h, payload.data(), payload.size(), 0, nbBits);
+            int DC = 0;
+            for (size_t b = 0; b < kNbBlocs && cCompression::RLE_Decoder_Bloc(lecteur, DC, coefs.data() + b * 64); ++b) {}
+            g_puits += static_cast<uint64_t>(DC);
+        }));
+    if (retenu(opt, "rle_decode"))
+        mesures.push_back(mesurer(opt, etape("rle_decode", "mask", kNbBlocs, tailleTrame), [&] {
+            cLecteurHuffman lecteur(h, payload.data(), payload.size(), 0, nbBits);
+            int DC = 0;
+            uint64_t masque = 0;
+            for (size_t b = 0; b < kNbBlocs && cCompression::RLE_Decoder_Bloc(lecteur, DC, coefs.data() + b * 64, masque); ++b) {}
+            g_puits += static_cast<uint64_t>(DC);
+        }));
+}
+
+/** @brief Color conversion, subsampling and upsampling over one 1024 x 16 band. */
+void mesurer_etapes_couleur(const sOptions &opt, std::vector<sMesure> &mesures)
+{
+    const unsigned int w = 1024, h = 16;
+    const uint64_t nbPixels = static_cast<uint64_t>(w) * h;
+    const uint64_t groupes = nbPixels / 64;
+    sAleatoire rng;
+    std::vector<unsigned char> rgb(nbPixels * 3);
+    for (unsigned int c = 0; c < 3; ++c) synthetiser(rgb.data() + c, w, h, w * 3, 3, c, rng);
+    std::vector<uint8_t> Y(nbPixels);
+    std::vector<int32_t> Cb(nbPixels), Cr(nbPixels);
+
+    const char *noms[] = { "scalar", "sse4.1" };
+    for (const char *nom : noms) {
+        const sCouleurKernels *k = couleur_kernels_by_name(nom);
+        if (!k) continue;
+        if (retenu(opt, "rgb_ycbcr"))
+            mesures.push_back(mesurer(opt, etape("rgb_ycbcr", nom, groupes, nbPixels * 3), [&] {
+                k->rgb_ycbcr(rgb.data(), nbPixels, Y.data(), Cb.data(), Cr.data());
+                g_puits += Y[17];
+            }));
+        std::vector<uint8_t> Cb8(nbPixels, 100), Cr8(nbPixels, 150), sortie(nbPixels * 3);
+        if (retenu(opt, "ycbcr_rgb"))
+            mesures.push_back(mesurer(opt, etape("ycbcr_rgb", nom, groupes, nbPixels * 3), [&] {
+                k->ycbcr_rgb(Y.data(), Cb8.data(), Cr8.data(), nbPixels, sortie.data());
+                g_puits += sortie[23];
+            }));
+    }
+
+    // The fused front end (conversion + subsampling) and back end (upsampling + conversion).
+    const char *noyau = couleur_kernels().nom;
+    struct { const char *nom; unsigned int H, V; } modes[] = { { "444", 1, 1 }, { "422", 2, 1 }, { "420", 2, 2 } };
+    for (const auto &m : modes) {
+        const unsigned int hauteur = 8 * m.V;
+        std::vector<uint8_t> Yb(static_cast<size_t>(w) * hauteur), Cbb(static_cast<size_t>(w / m.H) * 8), Crb(Cbb.size());
+        const uint64_t pixelsBande = static_cast<uint64_t>(w) * hauteur;
+        const std::string variante = std::string(m.nom) + "/" + noyau;
+        if (retenu(opt, "subsample"))
+            mesures.push_back(mesurer(opt, etape("subsample", variante.c_str(), pixelsBande / 64, pixelsBande * 3), [&] {
+                rgb_vers_ycbcr_mcu(rgb.data(), static_cast<size_t>(w) * 3, w, hauteur, m.H, m.V, w, Yb.data(), Cbb.data(), Crb.data());
+                g_puits += Cbb[3];
+            }));
+        if (m.H == 1 && m.V == 1) continue;
+        rgb_vers_ycbcr_mcu(rgb.data(), static_cast<size_t>(w) * 3, w, hauteur, m.H, m.V, w, Yb.data(), Cbb.data(), Crb.data());
+        std::vector<uint8_t> sortie(pixelsBande * 3);
+        const eModeSurechantillonnage filtres[2] = { SURECHANTILLONNAGE_TRIANGLE, SURECHANTILLONNAGE_PROCHE };
+        for (eModeSurechantillonnage f : filtres) {
+            const std::string v = std::string(m.nom) + ((f == SURECHANTILLONNAGE_TRIANGLE) ? "/triangle/" : "/nearest/") + noyau;
+            if (retenu(opt, "upsample"))
+                mesures.push_back(mesurer(opt, etape("upsample", v.c_str(), pixelsBande / 64, pixelsBande * 3), [&] {
+                    ycbcr_vers_rgb_lignes(Yb.data(), w, Cbb.data(), Crb.data(), w / m.H, w, hauteur, m.H, m.V,
+                                          f, 0, hauteur, sortie.data(), static_cast<size_t>(w) * 3);
+                    g_puits += sortie[41];
+                }));
+        }
+    }
+}
+
+/** @brief Whole-image encode and decode, grayscale and 4:2:0 color, over the corpus sizes and qualities. */
+void mesurer_images(const sOptions &opt, std::vector<sMesure> &mesures)
+{
+    struct { unsigned int w, h; } tailles[] = { { 256, 256 }, { 1024, 768 }, { 1920, 1080 } };
+    const unsigned int qualites[] = { 25, 50, 90 };
+    const size_t nbTailles = opt.rapide ? 1 : sizeof(tailles) / sizeof(tailles[0]);
+
+    for (size_t t = 0; t < nbTailles; ++t) {
+        const unsigned int w = tailles[t].w, h = tailles[t].h;
+        const uint64_t nbBlocs = static_cast<uint64_t>(w / 8) * (h / 8);
+        sAleatoire rng;
+        std::vector<unsigned char> gris(static_cast<size_t>(w) * h), rgb(static_cast<size_t>(w) * h * 3);
+        synthetiser(gris.data(), w, h, w, 1, 0, rng);
+        for (unsigned int c = 0; c < 3; ++c) synthetiser(rgb.data() + c, w, h, static_cast<size_t>(w) * 3, 3, c, rng);
+        std::vector<unsigned char*> lignes(h);
+        for (unsigned int y = 0; y < h; ++y) lignes[y] = gris.data() + static_cast<size_t>(y) * w;
+
+        // Text .img input: the same image, parsed back (bytes counts the text).
+        if (retenu(opt, "parse_img")) {
+            std::string texte;
+            for (unsigned int y = 0; y < h; ++y) {
+                for (unsigned int x = 0; x < w; ++x) {
+                    texte += std::to_string(lignes[y][x]);
+                    texte += (x + 1 < w) ? ' ' : '\n';
+                }
+            }
+            std::vector<unsigned char> lus;
+            unsigned int lw = 0, lh = 0;
+            sMesure m;
+            m.categorie = "image";
+            m.nom = "parse_img";
+            m.variante = "from_chars";
+            m.largeur = w;
+            m.hauteur = h;
+            m.blocs = nbBlocs;
+            m.octets = texte.size();
+            mesures.push_back(mesurer(opt, m, [&] {
+                g_puits += cLecteurImage::ParserTexte(texte.data(), texte.size(), lus, lw, lh);
+            }));
+        }
+
+        for (unsigned int q : qualites) {
+            auto image = [&](const char *nom, const char *variante, uint64_t octets) {
+                sMesure m;
+                m.categorie = "image";
+                m.nom = nom;
+                m.variante = variante;
+                m.largeur = w;
+                m.hauteur = h;
+                m.qualite = q;
+                m.blocs = nbBlocs;
+                m.octets = octets;
+                return m;
+            };
+
+            // Grayscale: RLE + Compression_JPEG in memory, then decode into a buffer.
+            // The grayscale coder takes its quality from its context.
+            auto contexte = std::make_shared<cContexteCodec>(q);
+            cCompression codec(w, h, q, lignes.data());
+            codec.setContexte(contexte);
+            std::vector<signed char> trame;
+            std::vector<unsigned char> fichier;
+            std::vector<unsigned char> sortie(static_cast<size_t>(w) * h);
+            cCompression lecteur;
+            lecteur.setContexte(contexte);
+            if (retenu(opt, "encode_gray")) {
+                sMesure m = mesurer(opt, image("encode_gray", "huf2", static_cast<uint64_t>(w) * h), [&] {
+                    codec.RLE(trame);
+                    codec.Compression_JPEG(trame, fichier);
+                    g_puits += fichier.size();
+                });
+                m.octetsSortie = fichier.size();
+                mesures.push_back(m);
+            }
+            // The same file from the pipelined encoder: rows copied in from the source while earlier
+            // stripes are transformed and coded, with adaptive codes and with the built-in static table.
+            if (retenu(opt, "encode_gray")) {
+                const char *variantes[] = { "pipeline", "pipeline_static" };
+                for (int i = 0; i < 2; ++i) {
+                    cEncodeurPipeline pipeline(w, h, q);
+                    if (i == 1) pipeline.setTableStatique(cTablesHuffman::kIdDefaut);
+                    std::vector<unsigned char> fichierPipeline;
+                    unsigned int y = 0;
+                    auto source = [&](unsigned char *dst, size_t pas, unsigned int nb) {
+                        for (unsigned int k = 0; k < nb; ++k, ++y) std::memcpy(dst + k * pas, lignes[y], w);
+                        return true;
+                    };
+                    sMesure m = mesurer(opt, image("encode_gray", variantes[i], static_cast<uint64_t>(w) * h), [&] {
+                        y = 0;
+                        g_puits += pipeline.Encoder(source, fichierPipeline);
+                    });
+                    m.octetsSortie = fichierPipeline.size();
+                    mesures.push_back(m);
+                }
+            }
+            codec.RLE(trame);
+            codec.Compression_JPEG(trame, fichier);
+            // Entropy coding alone: a table per file (histogram, then coding) against the built-in static table.
+            if (retenu(opt, "entropy_gray")) {
+                std::vector<unsigned char> sortieEntropie;
+                const uint16_t tables[] = { 0, cTablesHuffman::kIdDefaut };
+                const char *variantes[] = { "huf2", "huf2_static" };
+                for (int i = 0; i < 2; ++i) {
+                    codec.setTableStatique(tables[i]);
+                    sMesure m = mesurer(opt, image("entropy_gray", variantes[i], trame.size()), [&] {
+                        codec.Compression_JPEG(trame, sortieEntropie);
+                        g_puits += sortieEntropie.size();
+                    });
+                    m.octetsSortie = sortieEntropie.size();
+                    mesures.push_back(m);
+                }
+                codec.setTableStatique(0);
+            }
+            if (retenu(opt, "decode_gray"))
+                mesures.push_back(mesurer(opt, image("decode_gray", "huf2", static_cast<uint64_t>(w) * h), [&] {
+                    g_puits += lecteur.Decompression_JPEG(fichier.data(), fichier.size(), sortie.data(), w, w, h);
+                }));
+            // Document-like content: flat tiles, where most blocks only have a DC coefficient.
+            if (retenu(opt, "encode_gray") || retenu(opt, "decode_gray")) {
+                std::vector<unsigned char> plat(gris.size());
+                std::vector<unsigned char*> lignesPlat(h);
+                for (unsigned int y = 0; y < h; ++y) {
+                    lignesPlat[y] = plat.data() + static_cast<size_t>(y) * w;
+                    for (unsigned int x = 0; x < w; ++x) lignesPlat[y][x] = (((x / 48 + y / 40) & 3) == 0) ? 224 : 32 + (y / 64) * 4;
+                }
+                cCompression codecPlat(w, h, q, lignesPlat.data());
+                codecPlat.setContexte(contexte);
+                std::vector<signed char> tramePlat;
+                std::vector<unsigned char> fichierPlat;
+                if (retenu(opt, "encode_gray")) {
+                    sMesure m = mesurer(opt, image("encode_gray", "huf2_flat", static_cast<uint64_t>(w) * h), [&] {
+                        codecPlat.RLE(tramePlat);
+                        codecPlat.Compression_JPEG(tramePlat, fichierPlat);
+                        g_puits += fichierPlat.size();
+                    });
+                    m.octetsSortie = fichierPlat.size();
+                    mesures.push_back(m);
+                }
+                codecPlat.RLE(tramePlat);
+                codecPlat.Compression_JPEG(tramePlat, fichierPlat);
+                if (retenu(opt, "decode_gray"))
+                    mesures.push_back(mesurer(opt, image("decode_gray", "huf2_flat", static_cast<uint64_t>(w) * h), [&] {
+                        g_puits += lecteur.Decompression_JPEG(fichierPlat.data(), fichierPlat.size(), sortie.data(), w, w, h);
+                    }));
+            }
+            // Previews: the same file decoded straight to a reduced size.
+            if (retenu(opt, "decode_gray_scaled")) {
+                const unsigned int echelles[] = { 2, 4, 8 };
+                const char *variantes[] = { "huf2_1/2", "huf2_1/4", "huf2_1/8" };
+                for (int i = 0; i < 3; ++i) {
+                    const unsigned int rw = cCompression::TailleReduite(w, echelles[i]);
+                    const unsigned int rh = cCompression::TailleReduite(h, echelles[i]);
+                    lecteur.setEchelle(echelles[i]);
+                    mesures.push_back(mesurer(opt, image("decode_gray_scaled", variantes[i], static_cast<uint64_t>(w) * h), [&] {
+                        g_puits += lecteur.Decompression_JPEG(fichier.data(), fichier.size(), sortie.data(), rw, rw, rh);
+                    }));
+                }
+                lecteur.setEchelle(1);
+            }
+            // A 256x256 tile at the centre, with one seek index entry per block row.
+            if (retenu(opt, "decode_region") && w >= 256 && h >= 256) {
+                std::vector<signed char> trameIndex;
+                std::vector<unsigned char> fichierIndex;
+                codec.setIntervalleIndex(w / 8);
+                codec.RLE(trameIndex);
+                codec.Compression_JPEG(trameIndex, fichierIndex);
+                codec.setIntervalleIndex(0);
+                const unsigned int x0 = (w - 256) / 2, y0 = (h - 256) / 2;
+                mesures.push_back(mesurer(opt, image("decode_region", "huf2_idx_256", 256 * 256), [&] {
+                    g_puits += lecteur.DecodeRegion(fichierIndex.data(), fichierIndex.size(), x0, y0, 256, 256, sortie.data(), 256);
+                }));
+            }
+
+            // Color: 4:2:0 container in memory.
+            cCompressionCouleur couleur;
+            std::vector<unsigned char> conteneur;
+            std::vector<unsigned char> sortieRGB(rgb.size());
+            if (retenu(opt, "encode_color")) {
+                sMesure m = mesurer(opt, image("encode_color", "hufc420", rgb.size()), [&] {
+                    g_puits += couleur.CompressRGB(rgb.data(), w, h, static_cast<size_t>(w) * 3, q, 420, conteneur);
+                });
+                m.octetsSortie = conteneur.size();
+                mesures.push_back(m);
+            }
+            couleur.CompressRGB(rgb.data(), w, h, static_cast<size_t>(w) * 3, q, 420, conteneur);
+            if (retenu(opt, "decode_color"))
+                mesures.push_back(mesurer(opt, image("decode_color", "hufc420", rgb.size()), [&] {
+                    g_puits += couleur.DecompressToRGB(conteneur.data(), conteneur.size(), sortieRGB.data(),
+                                                       static_cast<size_t>(w) * 3, w, h);
+                }));
+        }
+    }
+}
+
+void ecrire_csv(std::ostream &out, const std::vector<sMesure> &mesures)
+{
+    out << "category,name,variant,width,height,quality,iterations,blocks,bytes,seconds,ns_per_block,mb_per_s,output_bytes\n";
+    for (const sMesure &m : mesures) {
+        char ligne[512];
+        std::snprintf(ligne, sizeof(ligne), "%s,%s,%s,%u,%u,%u,%llu,%llu,%llu,%.6f,%.3f,%.3f,%llu\n",
+                      m.categorie.c_str(), m.nom.c_str(), m.variante.c_str(), m.largeur, m.hauteur, m.qualite,
+                      static_cast<unsigned long long>(m.iterations), static_cast<unsigned long long>(m.blocs),
+                      static_cast<unsigned long long>(m.octets), m.secondes, m.nsParBloc(), m.moParSeconde(),
+                      static_cast<unsigned long long>(m.octetsSortie));
+        out << ligne;
+    }
+}
+
+void ecrire_json(std::ostream &out, const std::vector<sMesure> &mesures)
+{
+    out << "{\n  \"dct_kernels\": \"" << dct_kernels().nom << "\",\n"
+        << "  \"couleur_kernels\": \"" << couleur_kernels().nom << "\",\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < mesures.size(); ++i) {
+        const sMesure &m = mesures[i];
+        char ligne[640];
+        std::snprintf(ligne, sizeof(ligne),
+                      "    {\"category\": \"%s\", \"name\": \"%s\", \"variant\": \"%s\", \"width\": %u, \"height\": %u, "
+                      "\"quality\": %u, \"iterations\": %llu, \"blocks\": %llu, \"bytes\": %llu, \"seconds\": %.6f, "
+                      "\"ns_per_block\": %.3f, \"mb_per_s\": %.3f, \"output_bytes\": %llu}%s\n",
+                      m.categorie.c_str(), m.nom.c_str(), m.variante.c_str(), m.largeur, m.hauteur, m.qualite,
+                      static_cast<unsigned long long>(m.iterations), static_cast<unsigned long long>(m.blocs),
+                      static_cast<unsigned long long>(m.octets), m.secondes, m.nsParBloc(), m.moParSeconde(),
+                      static_cast<unsigned long long>(m.octetsSortie), (i + 1 < mesures.size()) ? "," : "");
+        out << ligne;
+    }
+    out << "  ]\n}\n";
+}
+
+void usage()
+{
+    std::cout << "Usage: jpeg_bench [--csv | --json] [--min-time <seconds>] [--repeat <n>] [--quick]\n"
+                 "                  [--filter <name>] [--output <file>]\n\n"
+                 "  --csv / --json     Output format (JSON by default).\n"
+                 "  --min-time <s>     Minimum duration of one timed repetition (default 0.2).\n"
+                 "  --repeat <n>       Repetitions per figure; the fastest is kept (default 3).\n"
+                 "  --quick            Smallest image size only, for a smoke run.\n"
+                 "  --filter <name>    Only the figures whose name contains <name> (e.g. dct, encode).\n"
+                 "  --output <file>    Write the records to a file instead of stdout.\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    sOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a == "--csv") opt.csv = true;
+        else if (a == "--json") opt.csv = false;
+        else if (a == "--quick") opt.rapide = true;
+        else if (a == "--min-time" && i + 1 < argc) opt.tempsMin = std::atof(argv[++i]);
+        else if (a == "--repeat" && i + 1 < argc) opt.repetitions = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        else if (a == "--filter" && i + 1 < argc) opt.filtre = argv[++i];
+        else if (a == "--output" && i + 1 < argc) opt.sortie = argv[++i];
+        else {
+            usage();
+            return (a == "--help" || a == "-h") ? 0 : 1;
+        }
+    }
+
+    std::vector<sMesure> mesures;
+    mesurer_etapes_blocs(opt, mesures);
+    mesurer_etapes_couleur(opt, mesures);
+    mesurer_images(opt, mesures);
+
+    std::ofstream fichier;
+    if (!opt.sortie.empty()) {
+        fichier.open(opt.sortie);
+        if (!fichier) {
+            std::cerr << "cannot write " << opt.sortie << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = opt.sortie.empty() ? std::cout : fichier;
+    if (opt.csv) ecrire_csv(out, mesures);
+    else ecrire_json(out, mesures);
+    return 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * @file cArene.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines cArene, the scratch memory a codec instance reuses from one image to the next.
+ */
+
+#ifndef JPEG_COMPRESSOR_CARENE_H
+#define JPEG_COMPRESSOR_CARENE_H
+
+#include "core/cHuffman.h"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @enum eTamponArene
+ * @brief The growable buffers of an arena, one per use.
+ */
+enum eTamponArene {
+    TAMPON_RLE = 0,   ///< RLE bytes of a whole image (two-pass color encoding).
+    TAMPON_TAILLES,   ///< Byte count of each RLE block (two-pass color encoding).
+    TAMPON_FICHIER,   ///< A compressed file being built before it is written.
+    TAMPON_BITS,      ///< Huffman-coded bytes of a container, before they are flushed.
+    NB_TAMPONS_ARENE
+};
+
+/**
+ * @class cArene
+ * @brief Bump allocator plus a few growable buffers, all kept from one call to the next.
+ *
+ * Fixed-size scratch (block rows, planes, per-row tables) is carved out of
+ * large chunks with allouer() and released all at once when the enclosing
+ * cPorteeArene ends. Data whose size is only known once it is produced
+ * (RLE bytes, compressed files) goes to the tampon() vectors, which keep
+ * their capacity. The Huffman decoders also keep their tree and table
+ * storage. Once the memory needed by the largest image has been reserved,
+ * the codec makes no further heap allocation for images of that size.
+ *
+ * An arena is not synchronized: it must be used by one thread at a time.
+ * Several codec instances of the same thread may share one.
+ */
+class cArene {
+private:
+    /** @brief One chunk of the bump allocator. */
+    struct sBloc {
+        std::unique_ptr<unsigned char[]> donnees;
+        size_t taille;
+    };
+
+    /** @brief The chunks, in allocation order. */
+    std::vector<sBloc> mBlocs;
+    /** @brief Index of the chunk being carved. */
+    size_t mBloc;
+    /** @brief Offset of the first free byte in mBlocs[mBloc]. */
+    size_t mPosition;
+    /** @brief Number of chunks obtained from the heap so far. */
+    size_t mNbAllocations;
+    /** @brief The growable buffers. */
+    std::vector<unsigned char> mTampons[NB_TAMPONS_ARENE];
+    /** @brief Decoders of the luma and chroma tables. */
+    cHuffman mHuffman[2];
+
+public:
+    /**
+     * @struct sMarque
+     * @brief A position of the bump allocator, to return to with revenir().
+     */
+    struct sMarque {
+        size_t bloc;
+        size_t position;
+    };
+
+    /** @brief Size of the first chunk, in bytes. */
+    static constexpr size_t kTailleBlocMin = 64 * 1024;
+
+    /**
+     * @brief Creates an empty arena; no memory is reserved until the first allocation.
+     */
+    cArene();
+
+    cArene(const cArene &) = delete;
+    cArene &operator=(const cArene &) = delete;
+
+    /**
+     * @brief Carves uninitialized memory out of the current chunk, adding a chunk if it is full.
+     * @param octets The size in bytes.
+     * @param alignement The alignment, a power of two.
+     * @return The memory, valid until the arena goes back to a mark taken before this call.
+     */
+    void *allouer(size_t octets, size_t alignement = alignof(std::max_align_t));
+
+    /**
+     * @brief Typed form of allouer() for trivially copyable types.
+     * @param n The number of elements.
+     * @return Uninitialized storage for n elements.
+     */
+    template <typename T>
+    T *allouer(size_t n)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "arena memory is never destroyed");
+        return static_cast<T*>(allouer(n * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * @brief Gets the current position of the bump allocator.
+     * @return The mark.
+     */
+    sMarque marquer() const;
+
+    /**
+     * @brief Releases everything allocated since a mark.
+     *
+     * When the arena goes back to its start after several chunks were
+     * needed, they are merged into a single one of their total size, so
+     * that the next call of the same size fits in it.
+     *
+     * @param marque A mark from marquer().
+     */
+    void revenir(const sMarque &marque);
+
+    /**
+     * @brief Gets one of the growable buffers.
+     * @param t The buffer.
+     * @return The buffer; its content is left by the previous user, its capacity is kept.
+     */
+    std::vector<unsigned char> &tampon(eTamponArene t);
+
+    /**
+     * @brief Gets a Huffman decoder whose storage is reused when its table is rebuilt.
+     * @param classe 0 for luma, 1 for chroma.
+     * @return The decoder.
+     */
+    cHuffman &huffman(int classe);
+
+    /**
+     * @brief Gets the total size of the chunks.
+     * @return The capacity of the bump allocator in bytes.
+     */
+    size_t getCapacite() const;
+
+    /**
+     * @brief Gets the number of chunks obtained from the heap since the arena was created.
+     * @return The count; it stops growing once the arena is warm.
+     */
+    size_t getNbAllocations() const;
+};
+
+/**
+ * @class cPorteeArene
+ * @brief Marks an arena on construction and returns to the mark on destruction.
+ */
+class cPorteeArene {
+private:
+    cArene &mArene;
+    cArene::sMarque mMarque;
+
+public:
+    /**
+     * @brief Marks the arena.
+     * @param arene The arena.
+     */
+    explicit cPorteeArene(cArene &arene) : mArene(arene), mMarque(arene.marquer()) {}
+
+    /**
+     * @brief Releases what was allocated in the scope.
+     */
+    ~cPorteeArene() { mArene.revenir(mMarque); }
+
+    cPorteeArene(const cPorteeArene &) = delete;
+    cPorteeArene &operator=(const cPorteeArene &) = delete;
+};
+
+#endif // JPEG_COMPRESSOR_CARENE_H
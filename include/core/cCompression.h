@@ -9,6 +9,121 @@
 #define JPEG_COMPRESSOR_CCOMPRESSION_H
 
 #include "cHuffman.h"
+#include "cStatistiques.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class cThreadPool;
+class cContexteQuant;
+class cContexteCodec;
+class cArene;
+struct sTableHuffman;
+
+/**
+ * @enum eModePipeline
+ * @brief Arithmetic used by the block transforms of a cCompression instance.
+ */
+enum eModePipeline {
+    PIPELINE_FLOTTANT = 0, ///< Single-precision DCT, vectorized when the CPU allows it (default).
+    PIPELINE_ENTIER = 1    ///< Fixed-point DCT and integer quantization: identical output on every compiler and CPU.
+};
+
+/**
+ * @struct sAnalyseBloc
+ * @brief What one pass of the block pipeline yields for one 8x8 block.
+ */
+struct sAnalyseBloc {
+    int16_t zigzag[64] = {};            ///< The quantized coefficients in scan order, as RLE_Block() codes them.
+    unsigned char reconstruit[64] = {}; ///< The block as the decoder reconstructs it, row-major.
+    double eqm = 0.0;                   ///< Mean squared error between the block and its reconstruction.
+    double tauxZeros = 0.0;             ///< Fraction of the quantized coefficients that are zero.
+};
+
+/**
+ * @struct sAnalyseImage
+ * @brief One pass of the block pipeline over a whole image: coefficients, reconstruction and error totals.
+ *
+ * Filled by cCompression::Analyse_Image(); cCompression::RLE(const sAnalyseImage&, ...)
+ * codes the coefficients without transforming the image again. Reusing the
+ * same record keeps its buffers.
+ */
+struct sAnalyseImage {
+    unsigned int largeur = 0;                  ///< Width of the analysed image (0 if the analysis failed).
+    unsigned int hauteur = 0;                  ///< Height of the analysed image.
+    std::vector<int16_t> coefficients;         ///< 64 quantized coefficients per block in scan order, blocks in raster order.
+    std::vector<unsigned char> reconstruction; ///< The decoded image, largeur bytes per row.
+    uint64_t sommeErreurs = 0;                 ///< Sum of the squared pixel errors.
+    uint64_t zeros = 0;                        ///< Number of zero quantized coefficients.
+
+    /** @brief Gets the number of 8x8 blocks. */
+    size_t nbBlocs() const { return static_cast<size_t>(largeur / 8) * (hauteur / 8); }
+
+    /** @brief Gets the mean squared error of the image (also the mean of the block errors). */
+    double eqm() const { return nbBlocs() ? static_cast<double>(sommeErreurs) / (static_cast<double>(nbBlocs()) * 64.0) : 0.0; }
+
+    /** @brief Gets the fraction of zero quantized coefficients (also the mean block compression ratio). */
+    double tauxZeros() const { return nbBlocs() ? static_cast<double>(zeros) / (static_cast<double>(nbBlocs()) * 64.0) : 0.0; }
+
+    /**
+     * @brief Gets the peak signal-to-noise ratio of the reconstruction.
+     * @return The PSNR in dB (infinity when it is exact, 0 when nothing was analysed).
+     */
+    double psnr() const;
+};
+
+/**
+ * @enum eCible
+ * @brief What a targeted encoding (cCompression::Compression_Cible()) aims at.
+ */
+enum eCible {
+    CIBLE_TAILLE = 0, ///< The highest quality whose file is at most the given number of bytes.
+    CIBLE_PSNR = 1    ///< The lowest quality (smallest file) whose PSNR is at least the given number of dB.
+};
+
+/**
+ * @struct sResultatCible
+ * @brief The outcome of a targeted encoding.
+ */
+struct sResultatCible {
+    unsigned int qualite = 0; ///< The quality chosen and encoded.
+    uint64_t taille = 0;      ///< The size of the file, in bytes.
+    double psnr = 0.0;        ///< The PSNR at that quality, estimated from the coefficients (luma only for color).
+    bool atteinte = false;    ///< False if no quality meets the target (the closest one, 1 or 100, is encoded).
+    unsigned int essais = 0;  ///< The number of qualities tried.
+};
+
+/**
+ * @enum eTransformation
+ * @brief A lossless geometric transform applied to the quantized blocks (see cCompression::Transformation_JPEG()).
+ */
+enum eTransformation {
+    TRANSFORMATION_AUCUNE = 0,        ///< Copy (with the crop, and the settings of the instance).
+    TRANSFORMATION_MIROIR_H = 1,      ///< Mirror left to right.
+    TRANSFORMATION_MIROIR_V = 2,      ///< Mirror top to bottom.
+    TRANSFORMATION_ROTATION_90 = 3,   ///< Quarter turn clockwise.
+    TRANSFORMATION_ROTATION_180 = 4,  ///< Half turn.
+    TRANSFORMATION_ROTATION_270 = 5,  ///< Quarter turn counter-clockwise.
+    TRANSFORMATION_TRANSPOSITION = 6, ///< Mirror about the main diagonal (rows become columns).
+    TRANSFORMATION_TRANSVERSE = 7     ///< Mirror about the anti-diagonal.
+};
+
+/**
+ * @struct sRecadrage
+ * @brief A crop rectangle, in pixels of the source image, applied before the transform.
+ *
+ * The left and top edges fall on block boundaries (MCU boundaries for a
+ * color container); so do the right and bottom ones, unless they are the
+ * edges of the image.
+ */
+struct sRecadrage {
+    unsigned int x = 0;       ///< The left column.
+    unsigned int y = 0;       ///< The top row.
+    unsigned int largeur = 0; ///< The width (0 = up to the right edge).
+    unsigned int hauteur = 0; ///< The height (0 = down to the bottom edge).
+};
 
 /**
  * @class cCompression
@@ -31,6 +146,153 @@ private:
     unsigned char **mBuffer;
     /** @brief The per-instance quality setting (0-100), not directly used by static helpers. */
     unsigned int mQualite;
+    /** @brief The arithmetic used by RLE() and Decompression_JPEG(). */
+    eModePipeline mModePipeline;
+    /** @brief The number of threads used by RLE() (1 = serial). */
+    unsigned int mNbThreads;
+    /** @brief Restart interval in blocks (0 = a single monolithic stream). */
+    unsigned int mIntervalleRestart;
+    /** @brief Block interval of the seek index written by Compression_JPEG() (0 = no index). */
+    unsigned int mIntervalleIndex;
+    /** @brief Scale divisor of the decoded images: 1 (full size), 2, 4 or 8. */
+    unsigned int mEchelle;
+    /** @brief The static table Compression_JPEG() codes with (nullptr = a table built from the trame). */
+    const sTableHuffman *mTableStatique;
+    /** @brief The worker pool, created on demand when mNbThreads > 1 and shared by copies. */
+    std::shared_ptr<cThreadPool> mPool;
+    /** @brief The quality and tables used by this instance (nullptr = cContexteCodec::global()). */
+    std::shared_ptr<cContexteCodec> mContexte;
+
+    /**
+     * @brief Gets the context in use: the one set by setContexte(), or the global one.
+     * @return The codec context.
+     */
+    cContexteCodec &contexte() const;
+
+    /** @brief Scratch memory reused from call to call, created on first use and shared by copies. */
+    std::shared_ptr<cArene> mArene;
+    /** @brief Where the calls add their counters and stage times (nullptr = not measured). */
+    sStatistiques *mStatistiques;
+    /** @brief Receives the diagnostic messages of the calls (empty = silent). */
+    fTraceCodec mTrace;
+
+    /**
+     * @brief Encodes the block rows [ligne_debut, ligne_fin) of the image (rows counted in pixels).
+     *
+     * The first block is coded against a DC predictor of 0; the caller patches
+     * its DC byte (always the first byte of the output) once the DC of the
+     * preceding block is known.
+     *
+     * @param ligne_debut First pixel row of the stripe (multiple of 8).
+     * @param ligne_fin One past the last pixel row of the stripe (multiple of 8).
+     * @param ctx The quantization tables.
+     * @param row_blocks Scratch for one row of level-shifted blocks (largeur / 8 * 64 values).
+     * @param row_dct Scratch for their coefficients (same size).
+     * @param row_dct8 Scratch for the fixed-point coefficients (same size; PIPELINE_ENTIER only).
+     * @param row_masques Scratch for the nonzero masks of one block row.
+     * @param stats Receives the counters and stage times of the stripe (nullptr: not measured).
+     * @param[out] sortie The RLE bytes of the stripe (appended).
+     * @param[out] DC_premier The quantized DC of the first block.
+     * @param[out] DC_dernier The quantized DC of the last block.
+     */
+    void RLE_Bande(unsigned int ligne_debut, unsigned int ligne_fin, const cContexteQuant &ctx,
+                   int16_t *row_blocks, float *row_dct, int32_t *row_dct8, uint64_t *row_masques, sStatistiques *stats,
+                   std::vector<signed char> &sortie, int &DC_premier, int &DC_dernier);
+
+    /**
+     * @brief Analyses the block rows [ligne_debut, ligne_fin) of the image into the shared record.
+     *
+     * Writes the coefficients and reconstruction of these rows only, so the
+     * stripes of one image can run concurrently.
+     *
+     * @param ligne_debut First pixel row of the stripe (multiple of 8).
+     * @param ligne_fin One past the last pixel row of the stripe (multiple of 8).
+     * @param ctx The quantization tables.
+     * @param row_blocks Scratch for one row of level-shifted blocks (largeur / 8 * 64 values).
+     * @param row_dct Scratch for their coefficients (same size).
+     * @param row_dct8 Scratch for the fixed-point coefficients (same size; PIPELINE_ENTIER only).
+     * @param stats Receives the counters and stage times of the stripe (nullptr: not measured).
+     * @param[in,out] analyse The record, already sized for the image.
+     * @param[out] erreurs The sum of the squared pixel errors of the stripe.
+     * @param[out] zeros The number of zero coefficients of the stripe.
+     */
+    void Analyse_Bande(unsigned int ligne_debut, unsigned int ligne_fin, const cContexteQuant &ctx,
+                       int16_t *row_blocks, float *row_dct, int32_t *row_dct8, sStatistiques *stats,
+                       sAnalyseImage &analyse, uint64_t &erreurs, uint64_t &zeros);
+
+    /**
+     * @brief Copies the blocks of one block row of the image, level-shifted to -128..127.
+     * @param by The first pixel row of the block row.
+     * @param[out] row_blocks largeur / 8 blocks, row-major.
+     */
+    void decaler_ligne(unsigned int by, int16_t *row_blocks) const;
+
+    /**
+     * @brief Compresses an RLE byte stream into a HUF2 file, as Compression_JPEG() does.
+     * @param Trame The RLE bytes of the image.
+     * @param qualite The quality recorded in the file.
+     * @param memoriser True to cache the adaptive table in the codec context (for headerless streams).
+     * @param[out] Fichier The contents of the file.
+     */
+    void ecrire_huf2(const std::vector<signed char> &Trame, unsigned int qualite, bool memoriser,
+                     std::vector<unsigned char> &Fichier);
+
+protected:
+    /**
+     * @brief Gets the arena in use: the one set by setArene(), or one created on first use.
+     * @return The arena.
+     */
+    cArene &arene();
+
+    /**
+     * @brief Gets the trace hook set by setTrace().
+     * @return The hook (may be empty).
+     */
+    const fTraceCodec &getTrace() const;
+
+    /**
+     * @brief Binary search of the quality for a targeted encoding, shared by the grayscale and color coders.
+     *
+     * Assumes the size and the PSNR grow with the quality. On return, the
+     * last call to essayer was for the chosen quality, so the buffers it
+     * fills hold the encoding to emit.
+     *
+     * @param cible CIBLE_TAILLE or CIBLE_PSNR.
+     * @param valeur The largest size in bytes, or the smallest PSNR in dB.
+     * @param essayer Sizes the encoding at a quality (1-100): sets its size in bytes and its PSNR in dB.
+     * @param[out] resultat The chosen quality, its size and PSNR, and the number of qualities tried.
+     */
+    static void chercher_qualite(eCible cible, double valeur,
+                                 const std::function<void(unsigned int, uint64_t &, double &)> &essayer,
+                                 sResultatCible &resultat);
+
+    /**
+     * @brief Splits a transform into a transposition followed by mirrors of the transposed image.
+     * @param t The transform.
+     * @param[out] transposee True if rows become columns.
+     * @param[out] miroirX True if the columns are then reversed.
+     * @param[out] miroirY True if the rows are then reversed.
+     */
+    static void decomposer_transformation(eTransformation t, bool &transposee, bool &miroirX, bool &miroirY);
+
+    /**
+     * @brief Finds where a block of the transformed grid comes from.
+     * @param t The transform.
+     * @param largeurBlocs The width of the source grid, in blocks.
+     * @param hauteurBlocs The height of the source grid, in blocks.
+     * @param x The column of the block in the transformed grid.
+     * @param y The row of the block in the transformed grid.
+     * @param[out] sx The column of the source block.
+     * @param[out] sy The row of the source block.
+     */
+    static void bloc_source(eTransformation t, unsigned int largeurBlocs, unsigned int hauteurBlocs,
+                            unsigned int x, unsigned int y, unsigned int &sx, unsigned int &sy);
+
+    /**
+     * @brief Gets the worker pool to use, creating it on first use.
+     * @return The pool, or nullptr when the instance is configured for a single thread.
+     */
+    cThreadPool *getPoolActif();
 
 public:
     /**
@@ -71,6 +333,153 @@ public:
      */
     void setQualite(unsigned int qualite);
 
+    /**
+     * @brief Selects the floating-point or the fixed-point block pipeline.
+     *
+     * Both produce compatible streams; the fixed-point one yields the same
+     * bytes on every platform, which makes encoded output usable as a cache key.
+     *
+     * @param mode The pipeline to use for subsequent RLE() and Decompression_JPEG() calls.
+     */
+    void setModePipeline(eModePipeline mode);
+
+    /**
+     * @brief Sets the number of threads used by RLE().
+     *
+     * The image is cut into stripes of block rows encoded in parallel; the
+     * DC prediction is re-seeded at each stripe boundary from the preceding
+     * block, so the output is byte-identical to the serial encoder whatever
+     * the thread count.
+     *
+     * @param nbThreads The number of threads (1 = serial, the default; 0 = one per hardware thread).
+     */
+    void setNbThreads(unsigned int nbThreads);
+
+    /**
+     * @brief Runs the parallel stages on an existing worker pool.
+     *
+     * The pool may be shared by several instances (and other work); the
+     * thread count becomes the pool's. Passing nullptr returns to a pool
+     * created on demand from setNbThreads().
+     *
+     * @param pool The executor.
+     */
+    void setPool(const std::shared_ptr<cThreadPool> &pool);
+
+    /**
+     * @brief Enables restart intervals in the files written by Compression_JPEG().
+     *
+     * Every nbBlocs blocks the DC prediction is reset and the Huffman stream
+     * is byte-aligned; the segment offsets are stored in an 'RST1' extension
+     * after the width/height trailer. Decompression_JPEG() then decodes the
+     * segments in parallel (see setNbThreads()) and replaces a corrupted
+     * segment by flat blocks instead of failing. The same interval must be
+     * set when calling RLE() and Compression_JPEG(). Files written with
+     * restart intervals can only be read by decoders that know the extension.
+     *
+     * @param nbBlocs The interval in blocks (0 disables the feature, the default).
+     */
+    void setIntervalleRestart(unsigned int nbBlocs);
+
+    /**
+     * @brief Adds a seek index to the files written by Compression_JPEG(), for DecodeRegion().
+     *
+     * Every nbBlocs blocks (in raster order), the bit position of the block in
+     * the payload and the DC predictor it is coded against are recorded in an
+     * 'IDX1' extension written after the quality extension, which readers
+     * that do not know it ignore. Unlike restart intervals, the bitstream is
+     * unchanged: the index costs 8 bytes per entry and nothing else. An
+     * interval of largeur / 8 gives one entry per block row.
+     *
+     * @param nbBlocs The interval in blocks (0 disables the index, the default).
+     */
+    void setIntervalleIndex(unsigned int nbBlocs);
+
+    /**
+     * @brief Makes Compression_JPEG() code with a registered static table.
+     *
+     * The trame is coded in a single pass, with no histogram, and the header
+     * holds the 4-byte reference of the table instead of its code lengths
+     * (up to 272 bytes). The files are only readable where the same table
+     * is registered (see cTablesHuffman); the table cached for headerless
+     * streams is left unchanged. The ratio is usually a little worse than
+     * with a table fitted to the image, less so on small images.
+     *
+     * @param id The identifier of the table, or 0 to go back to per-file tables (the default).
+     * @param version Its version, or 0 for the highest registered one.
+     * @return False if the table is not registered (the setting is unchanged).
+     */
+    bool setTableStatique(uint16_t id, uint16_t version = 0);
+
+    /**
+     * @brief Makes the decoders produce images reduced by a power of two, for previews.
+     *
+     * At 1/8 each block becomes one pixel, its DC coefficient: no inverse
+     * transform runs at all. At 1/4 and 1/2 each block becomes 2x2 or 4x4
+     * pixels, from a reduced inverse DCT of its 2x2 or 4x4 lowest frequencies
+     * (see Calcul_IDCT_Reduite()). Each pixel is close to the mean of the
+     * pixels it covers in the full decode. The entropy decoding is unchanged,
+     * the output is written at its final size and nothing is resized
+     * afterwards. An image of W x H pixels decodes to
+     * TailleReduite(W, echelle) x TailleReduite(H, echelle).
+     *
+     * @param echelle The divisor: 1 (the default), 2, 4 or 8; other values are taken as 1.
+     */
+    void setEchelle(unsigned int echelle);
+
+    /**
+     * @brief Gives this instance its own codec context.
+     *
+     * RLE(), EQM() and Taux_Compression() then quantize with the context's
+     * quality, Compression_JPEG() caches its Huffman table there, and
+     * Decompression_JPEG() reads headerless streams with that table. Instances
+     * with distinct contexts can run concurrently; several instances may share
+     * one context (e.g. an encoder and the decoder of its headerless output)
+     * as long as they do not use it at the same time.
+     *
+     * @param contexte The context, or nullptr to go back to cContexteCodec::global().
+     */
+    void setContexte(const std::shared_ptr<cContexteCodec> &contexte);
+
+    /**
+     * @brief Sets the scratch memory used by the encoders and decoders of this instance.
+     *
+     * Without one, each instance creates its own on first use. Sharing an
+     * arena between the instances a thread uses keeps a single set of
+     * buffers warm; an arena must not be used by two threads at once.
+     *
+     * @param arene The arena, or nullptr to get a private one on next use.
+     */
+    void setArene(const std::shared_ptr<cArene> &arene);
+
+    /**
+     * @brief Sets the record the calls of this instance add their figures to.
+     *
+     * Encoders and decoders add their byte, block and symbol counts and the
+     * time of each stage; nothing is measured without a record. The record
+     * is not reset between calls. Ignored when the library is built with
+     * JPEG_STATS=0.
+     *
+     * @param stats The record (owned by the caller), or nullptr to stop measuring.
+     */
+    void setStatistiques(sStatistiques *stats);
+
+    /**
+     * @brief Gets the record set by setStatistiques().
+     * @return The record, or nullptr when none is set or the instrumentation is compiled out.
+     */
+    sStatistiques *getStatistiques() const;
+
+    /**
+     * @brief Sets the hook that receives the diagnostic messages (header parsed, corrupted segments...).
+     *
+     * The codec writes nothing to std::cerr; without a hook, the messages are
+     * not even formatted.
+     *
+     * @param trace The hook, or an empty function to go silent.
+     */
+    void setTrace(const fTraceCodec &trace);
+
     /**
      * @brief Attaches a caller-provided image buffer.
      * @param buffer A 2D array (unsigned char**) representing the image.
@@ -96,6 +505,56 @@ public:
      */
     unsigned int getQualite() const;
 
+    /**
+     * @brief Gets the selected block pipeline.
+     * @return PIPELINE_FLOTTANT (default) or PIPELINE_ENTIER.
+     */
+    eModePipeline getModePipeline() const;
+
+    /**
+     * @brief Gets the number of threads used by RLE().
+     * @return The configured thread count (0 = one per hardware thread).
+     */
+    unsigned int getNbThreads() const;
+
+    /**
+     * @brief Gets the restart interval.
+     * @return The interval in blocks (0 = disabled).
+     */
+    unsigned int getIntervalleRestart() const;
+
+    /**
+     * @brief Gets the seek index interval.
+     * @return The interval in blocks (0 = no index).
+     */
+    unsigned int getIntervalleIndex() const;
+
+    /**
+     * @brief Gets the static table Compression_JPEG() codes with.
+     * @return The table, or nullptr when each file carries its own.
+     */
+    const sTableHuffman *getTableStatique() const;
+
+    /**
+     * @brief Gets the scale of the decoded images.
+     * @return The divisor: 1, 2, 4 or 8.
+     */
+    unsigned int getEchelle() const;
+
+    /**
+     * @brief Gets a dimension of an image decoded at a reduced scale.
+     * @param taille The width or height at full size.
+     * @param echelle The divisor set by setEchelle().
+     * @return taille / echelle, rounded up.
+     */
+    static unsigned int TailleReduite(unsigned int taille, unsigned int echelle);
+
+    /**
+     * @brief Gets the codec context in use.
+     * @return The context set by setContexte(), or cContexteCodec::global().
+     */
+    const cContexteCodec &getContexte() const;
+
     /**
      * @brief Gets the attached image buffer.
      * @return A pointer to the 2D image buffer, or nullptr if not set.
@@ -103,19 +562,25 @@ public:
     unsigned char** getBuffer() const;
 
     /**
-     * @brief Gets the global quality factor used by static quantization helpers.
-     * @return The global quality setting (0-100).
+     * @brief Gets the quality of the global codec context.
+     *
+     * Compatibility wrapper for cContexteCodec::global().getQualite(); the
+     * global quality is used by the context-less quant_JPEG()/dequant_JPEG()
+     * and by instances without their own context.
+     *
+     * @return The global quality setting (1-100).
      */
     static unsigned int getQualiteGlobale();
 
     /**
-     * @brief Sets the global quality factor used by static quantization helpers.
-     * @param qualite The new global quality setting (0-100).
+     * @brief Sets the quality of the global codec context.
+     * @param qualite The new global quality setting (clamped to 1-100).
+     * @note Not thread-safe; give concurrent instances their own context instead.
      */
     static void setQualiteGlobale(unsigned int qualite);
 
     /**
-     * @brief Caches a Huffman table for later use (e.g., by the decompressor).
+     * @brief Caches a Huffman table in the global codec context (e.g., for the decompressor).
      * @param[in] symbols An array of symbol values.
      * @param[in] frequencies An array of corresponding frequencies.
      * @param[in] count The number of entries in the arrays.
@@ -123,7 +588,7 @@ public:
     static void storeHuffmanTable(const char *symbols, const double *frequencies, unsigned int count);
 
     /**
-     * @brief Retrieves the cached Huffman table.
+     * @brief Retrieves the Huffman table cached in the global codec context.
      * @param[out] symbols A buffer to store the symbol values.
      * @param[out] frequencies A buffer to store the frequency values.
      * @param[out] count The number of entries copied.
@@ -132,15 +597,41 @@ public:
     static bool loadHuffmanTable(char *symbols, double *frequencies, unsigned int &count);
 
     /**
-     * @brief Checks if a Huffman table is currently cached.
+     * @brief Checks if a Huffman table is cached in the global codec context.
      * @return True if a table is cached, false otherwise.
      */
     static bool hasStoredHuffmanTable();
 
+    /**
+     * @brief Runs the block pipeline once on an 8x8 block and reports everything it yields.
+     *
+     * Shift, DCT and quantization as RLE() does them, then dequantization and
+     * IDCT as Decompression_JPEG() does them, with the pipeline and quality of
+     * this instance.
+     *
+     * @param[in] Bloc8x8 An 8x8 integer block of original pixel data (0-255).
+     * @param[out] analyse The quantized block, its reconstruction, its MSE and its fraction of zeros.
+     */
+    void Analyse_Bloc(int **Bloc8x8, sAnalyseBloc &analyse);
+
+    /**
+     * @brief Runs the block pipeline once over the attached image.
+     *
+     * Fills the quantized coefficients RLE() would code, the image
+     * Decompression_JPEG() would decode (as long as the coefficients fit the
+     * byte-wide RLE symbols), and the image-level error totals. Stripes run
+     * in parallel like RLE(); the results do not depend on the thread count.
+     *
+     * @param[out] analyse The record (its buffers are reused).
+     * @return False if no buffer is attached or the size is not a multiple of 8.
+     */
+    bool Analyse_Image(sAnalyseImage &analyse);
+
     /**
      * @brief Calculates the Mean Squared Error (MSE) between an original 8x8 block and its compressed-decompressed version.
      * @param[in] Bloc8x8 An 8x8 integer block of original pixel data (0-255).
      * @return The calculated Mean Squared Error as a double.
+     * @note Runs Analyse_Bloc(); call it directly when the ratio or the coefficients are needed too.
      */
     double EQM(int **Bloc8x8);
 
@@ -149,6 +640,7 @@ public:
      * @param[in] Bloc8x8 An 8x8 integer block of original pixel data.
      * @return The compression ratio.
      * @note This ratio is based on the number of zero vs. non-zero coefficients after quantization.
+     *       Runs Analyse_Bloc(); call it directly when the error is needed too.
      */
     double Taux_Compression(int **Bloc8x8);
 
@@ -156,12 +648,134 @@ public:
      * @brief Performs Run-Length Encoding on a single quantized 8x8 block.
      * @param[in] Img_Quant An 8x8 block of quantized DCT coefficients.
      * @param[in] DC_precedent The DC coefficient from the previous block for differential coding.
-     * @param[out] Trame A buffer to receive the RLE-encoded byte stream.
+     * @param[out] Trame A buffer of at least 128 bytes to receive the RLE-encoded byte stream.
+     * @return The number of bytes written to Trame.
+     */
+    static int RLE_Block(int **Img_Quant, int DC_precedent, signed char *Trame);
+
+    /**
+     * @brief Performs Run-Length Encoding on a single block already in zigzag order.
+     *
+     * The DC difference is written first, followed by (run, value) pairs. An
+     * End-of-Block pair (0, 0) is only emitted when the block ends with zeros.
+     *
+     * @param[in] Zigzag 64 quantized coefficients in scan order (see cContexteQuant::quantifier_zigzag()).
+     * @param[in] DC_precedent The DC coefficient from the previous block for differential coding.
+     * @param[out] Trame A buffer of at least 128 bytes to receive the RLE-encoded byte stream.
+     * @return The number of bytes written to Trame (at most 127).
+     */
+    static int RLE_Block(const int16_t *Zigzag, int DC_precedent, signed char *Trame);
+
+    /**
+     * @brief RLE_Block() driven by the nonzero mask of the block.
+     *
+     * The runs come from the distances between the set bits of the mask
+     * (count trailing zeros), so the cost follows the number of nonzero
+     * coefficients instead of the 63 AC slots; a block without AC
+     * coefficients is its DC difference and one End-of-Block pair.
+     *
+     * @param[in] Zigzag 64 quantized coefficients in scan order.
+     * @param[in] Masque Its nonzero mask (see MasqueNonNuls(), cContexteQuant::quantifier_zigzag()).
+     * @param[in] DC_precedent The DC coefficient of the previous block.
+     * @param[out] Trame A buffer of at least 128 bytes.
+     * @return The number of bytes written to Trame (at most 127), the same bytes as RLE_Block().
      */
-    void RLE_Block(int **Img_Quant, int DC_precedent, signed char *Trame);
+    static int RLE_Block(const int16_t *Zigzag, uint64_t Masque, int DC_precedent, signed char *Trame);
+
+    /**
+     * @brief Computes the nonzero mask of a block in scan order.
+     * @param[in] Zigzag 64 quantized coefficients in scan order.
+     * @return The mask: bit k is set if Zigzag[k] != 0.
+     */
+    static uint64_t MasqueNonNuls(const int16_t *Zigzag);
+
+    /**
+     * @brief Applies a geometric transform to the quantized coefficients of one block.
+     *
+     * Mirroring the pixels of a block negates its odd horizontal (or
+     * vertical) frequencies, and transposing them transposes the
+     * coefficients, so the result is exact. A transform that transposes
+     * also calls for the transposed quantization table.
+     *
+     * @param[in] Coefs The 64 quantized coefficients, row-major, as RLE_Decoder_Bloc() gives them.
+     * @param t The transform.
+     * @param[out] Zigzag The coefficients of the transformed block in scan order, ready for RLE_Block().
+     */
+    static void TransformerBloc(const int16_t *Coefs, eTransformation t, int16_t *Zigzag);
+
+    /**
+     * @brief Reads one RLE block from a Huffman bitstream; the inverse of RLE_Block().
+     *
+     * Symbols are consumed up to the End-of-Block pair, or until the 63 AC
+     * coefficients are accounted for.
+     *
+     * @param lecteur The symbol reader.
+     * @param[in,out] DC_precedent The DC predictor, updated with the DC of the block.
+     * @param[out] Coefs The 64 quantized coefficients, row-major (de-zigzagged).
+     * @return False if the stream ended before the DC difference.
+     */
+    static bool RLE_Decoder_Bloc(cLecteurHuffman &lecteur, int &DC_precedent, int16_t *Coefs);
+
+    /**
+     * @brief RLE_Decoder_Bloc() that also tells which coefficients were coded.
+     *
+     * A block without AC coefficients (Masque <= 1) is decoded in constant
+     * time and only Coefs[0] is written: such a block is reconstructed from
+     * its DC alone (see Calcul_IDCT_DC()), without reading the other 63.
+     * Otherwise the 64 coefficients are written as by RLE_Decoder_Bloc().
+     *
+     * @param lecteur The symbol reader.
+     * @param[in,out] DC_precedent The DC predictor, updated with the DC of the block.
+     * @param[out] Coefs The quantized coefficients, row-major.
+     * @param[out] Masque Bit 0 always, and bit k for each nonzero AC coefficient, k being its scan position.
+     * @return False if the stream ended before the DC difference.
+     */
+    static bool RLE_Decoder_Bloc(cLecteurHuffman &lecteur, int &DC_precedent, int16_t *Coefs, uint64_t &Masque);
 
     /**
      * @brief Performs RLE on all 8x8 blocks of the attached image buffer.
+     * @param[out] Trame Receives the RLE bytes; resized to exactly the encoded length (empty on error).
+     * @note The image buffer must be set via setBuffer() before calling.
+     */
+    void RLE(std::vector<signed char> &Trame);
+
+    /**
+     * @brief RLE-codes the coefficients of an analysis, without transforming the image again.
+     *
+     * Produces the bytes RLE(Trame) writes for the analysed image, with the
+     * restart interval of this instance.
+     *
+     * @param[in] analyse The result of Analyse_Image().
+     * @param[out] Trame Receives the RLE bytes (empty if the analysis is empty).
+     */
+    void RLE(const sAnalyseImage &analyse, std::vector<signed char> &Trame);
+
+    /**
+     * @brief Performs RLE on a stripe of block rows, single-threaded.
+     *
+     * Only the rows [ligne_debut, ligne_fin) of the attached buffer are read,
+     * so the other row pointers may be null. Blocks are numbered as in the
+     * whole image for the restart intervals, and the first one is coded
+     * against a DC of 0: concatenated in order, with the first byte of each
+     * stripe re-coded against the last DC of the previous one (unless a
+     * restart interval starts there), the stripes give the bytes of
+     * RLE(Trame).
+     *
+     * @param ligne_debut The first row, a multiple of 8.
+     * @param ligne_fin The row after the stripe, a multiple of 8, at most the height.
+     * @param[out] Trame Receives the RLE bytes of the stripe (empty on error).
+     * @param[out] DC_premier The quantized DC of the first block.
+     * @param[out] DC_dernier The quantized DC of the last block.
+     */
+    void RLE(unsigned int ligne_debut, unsigned int ligne_fin, std::vector<signed char> &Trame,
+             int &DC_premier, int &DC_dernier);
+
+    /**
+     * @brief Performs RLE on all 8x8 blocks of the attached image buffer, one int per byte.
+     *
+     * Kept for existing callers; RLE(std::vector<signed char>&) needs a
+     * quarter of the memory and no worst-case preallocation.
+     *
      * @param[out] Trame An integer array where Trame[0] will be the total length, followed by the RLE data.
      * @note The image buffer must be set via setBuffer() before calling.
      */
@@ -184,13 +798,168 @@ public:
      */
     void Compression_JPEG(int *Trame_RLE, const char *Nom_Fichier);
 
+    /**
+     * @brief Compresses an RLE byte stream using Huffman coding and writes it to a file.
+     *
+     * The quality of the codec context is stored in a 'QLT1' extension after
+     * the width/height trailer, so the file decodes without configuring it.
+     *
+     * @param[in] Trame The RLE bytes from RLE(std::vector<signed char>&).
+     * @param[in] Nom_Fichier The name of the output file.
+     */
+    void Compression_JPEG(const std::vector<signed char> &Trame, const char *Nom_Fichier);
+
+    /**
+     * @brief Encodes the attached image at the quality that best meets a size or PSNR target.
+     *
+     * The forward DCT of every block is computed once and kept. Each
+     * quality tried by the binary search then only re-quantizes the kept
+     * coefficients, RLE-codes them and sizes the Huffman code from the
+     * symbol counts; nothing is written until the quality is chosen. The
+     * size is exact. The PSNR is computed from the quantization error of
+     * the coefficients (the DCT is orthonormal), which leaves out the
+     * rounding and clamping of the inverse transform; like the analysis,
+     * it assumes the coefficients fit the byte-wide RLE symbols, which
+     * stops holding at the highest qualities.
+     *
+     * The chosen quality is recorded in the file; the codec context is
+     * left unchanged. The file is the one RLE() and Compression_JPEG()
+     * would produce at that quality, restart intervals included.
+     *
+     * @param cible CIBLE_TAILLE or CIBLE_PSNR.
+     * @param valeur The largest size in bytes, or the smallest PSNR in dB.
+     * @param[out] Fichier The contents of the file.
+     * @param[out] resultat The chosen quality and what it yields (optional).
+     * @return False if no buffer is attached or the size is not a multiple of 8.
+     */
+    bool Compression_Cible(eCible cible, double valeur, std::vector<unsigned char> &Fichier,
+                           sResultatCible *resultat = nullptr);
+
+    /**
+     * @brief Compresses an RLE byte stream into a HUF2 file held in memory.
+     *
+     * Produces the bytes Compression_JPEG(Trame, Nom_Fichier) writes. The
+     * vector is cleared first; reusing it across calls keeps its capacity,
+     * so a warm encoder allocates nothing. With setTableStatique() the
+     * trame is read once instead of twice (histogram, then coding).
+     *
+     * @param[in] Trame The RLE bytes from RLE(std::vector<signed char>&).
+     * @param[out] Fichier The contents of the file.
+     */
+    void Compression_JPEG(const std::vector<signed char> &Trame, std::vector<unsigned char> &Fichier);
+
     /**
      * @brief Decompresses an image from a file and reconstructs the pixel data.
+     *
+     * The quality is read from the file when it carries the 'QLT1' extension,
+     * otherwise the quality of the codec context is assumed. getLargeur() and
+     * getHauteur() then give the size of the coded image; with setEchelle(),
+     * the returned image is reduced to TailleReduite() of it.
+     *
      * @param[in] Nom_Fichier_compresse The path to the compressed file.
      * @return A newly allocated 2D array (unsigned char**) containing the image data.
      * @note The caller is responsible for freeing the allocated memory.
      */
     unsigned char **Decompression_JPEG(const char *Nom_Fichier_compresse);
+
+    /**
+     * @brief Decompresses an image from a compressed file already in memory.
+     *
+     * The header, tables and payload are read in place: the bytes are not
+     * copied. Decompression_JPEG(const char*) maps the file and calls this.
+     *
+     * @param[in] Donnees The contents of a compressed file.
+     * @param[in] Taille The number of bytes.
+     * @return A newly allocated 2D array (unsigned char**) containing the image data, or nullptr on error.
+     * @note The caller is responsible for freeing the allocated memory.
+     */
+    unsigned char **Decompression_JPEG(const uint8_t *Donnees, size_t Taille);
+
+    /**
+     * @brief Decompresses an image from memory into a buffer owned by the caller.
+     *
+     * Decodes like Decompression_JPEG(Donnees, Taille) but writes the pixels
+     * at Image + y * Pas + x. The Huffman decoder and the scratch come from
+     * the arena, so once it is warm a call makes no heap allocation.
+     * Streams without a size trailer are decoded only if setLargeur() and
+     * setHauteur() were called; the grid is not inferred. With setEchelle(),
+     * the buffer only needs to hold the reduced image.
+     *
+     * @param[in] Donnees The contents of a compressed file.
+     * @param[in] Taille The number of bytes.
+     * @param[out] Image The first pixel of the output image.
+     * @param[in] Pas The distance between two output rows, in bytes.
+     * @param[in] LargeurMax The width of the buffer, in pixels.
+     * @param[in] HauteurMax The height of the buffer, in rows.
+     * @return True on success; false on error or if the image does not fit (see LireDimensions()).
+     */
+    bool Decompression_JPEG(const uint8_t *Donnees, size_t Taille, unsigned char *Image, size_t Pas,
+                            unsigned int LargeurMax, unsigned int HauteurMax);
+
+    /**
+     * @brief Decodes only a rectangle of a compressed image, into a buffer owned by the caller.
+     *
+     * Only the blocks that intersect the rectangle are dequantized and
+     * inverse-transformed. For each row of blocks, the decoder seeks to the
+     * nearest preceding point it can start from: an entry of the 'IDX1'
+     * index (see setIntervalleIndex()) or the start of a restart segment
+     * (see setIntervalleRestart()), whichever is closer. From there, the
+     * blocks up to the rectangle are only entropy-decoded. A file with
+     * neither is read from the start, once for the whole rectangle. With an
+     * index or restart segments, the rows of blocks are decoded in parallel
+     * (see setNbThreads()). A block that cannot be decoded is left flat.
+     * The scale set by setEchelle() is not applied.
+     *
+     * @param[in] Donnees The contents of a compressed file.
+     * @param[in] Taille The number of bytes.
+     * @param[in] x The left column of the rectangle.
+     * @param[in] y The top row of the rectangle.
+     * @param[in] largeur The width of the rectangle.
+     * @param[in] hauteur The height of the rectangle.
+     * @param[out] Image Receives pixel (x + i, y + j) at Image + j * Pas + i.
+     * @param[in] Pas The distance between two output rows, in bytes (at least largeur).
+     * @return False if the file is invalid, has no size (and setLargeur()/setHauteur() were not called),
+     *         or if the rectangle is empty or does not lie within the image.
+     */
+    bool DecodeRegion(const uint8_t *Donnees, size_t Taille, unsigned int x, unsigned int y,
+                      unsigned int largeur, unsigned int hauteur, unsigned char *Image, size_t Pas);
+
+    /**
+     * @brief Rotates, mirrors or crops a compressed image without decoding its pixels.
+     *
+     * The quantized blocks are read from the file, moved and transformed
+     * with TransformerBloc(), then RLE and Huffman coded again, with the
+     * restart interval, seek index and static table of this instance as in
+     * Compression_JPEG(). Nothing goes through the DCT, so there is no
+     * generation loss: the result decodes to the transformed image of the
+     * source decode (up to the last-bit rounding of the inverse DCT). A
+     * transform that transposes (quarter turns, transposition, transverse)
+     * marks the file as using the transposed quantization table, which the
+     * decoder then uses; two such transforms cancel out. Transforming with
+     * TRANSFORMATION_AUCUNE and no crop gives back the bytes the same
+     * settings give from RLE() and Compression_JPEG().
+     *
+     * @param[in] Donnees The contents of a HUF1/HUF2 file with a size trailer.
+     * @param[in] Taille The number of bytes.
+     * @param t The transform.
+     * @param[out] Fichier Receives the transformed file (empty on failure).
+     * @param[in] recadrage The crop, in pixels of the source image (nullptr = the whole image).
+     * @return False if the file is invalid or damaged, if the crop is not block-aligned or
+     *         not within the image, or if a DC difference of the new block order does not fit
+     *         the 8-bit RLE format (rare, at qualities above 90).
+     */
+    bool Transformation_JPEG(const uint8_t *Donnees, size_t Taille, eTransformation t,
+                             std::vector<unsigned char> &Fichier, const sRecadrage *recadrage = nullptr);
+
+    /**
+     * @brief Reads the image size stored in a compressed file, without decoding it.
+     * @param[in] Donnees The contents of a HUF1/HUF2 file.
+     * @param[in] Taille The number of bytes.
+     * @param[out] Largeur The width in pixels.
+     * @param[out] Hauteur The height in pixels.
+     * @return False if the file is malformed or has no size trailer.
+     */
+    static bool LireDimensions(const uint8_t *Donnees, size_t Taille, unsigned int &Largeur, unsigned int &Hauteur);
 };
 
 #endif //JPEG_COMPRESSOR_CCOMPRESSION_H
@@ -9,6 +9,7 @@
 #define JPEG_COMPRESSOR_CCOMPRESSIONCOULEUR_H
 
 #include "core/cCompression.h"
+#include "couleur/couleur.h"
 
 /**
  * @class cCompressionCouleur
@@ -17,8 +18,24 @@
  * This class manages the pipeline for compressing and decompressing P6 (binary)
  * PPM color images. It handles reading the PPM file, converting from RGB to
  * YCbCr color space, performing chroma subsampling (4:4:4, 4:2:2, 4:2:0), and
- * then uses the base cCompression functionality to compress each color component
- * (Y, Cb, Cr) into a separate file.
+ * coding the three components into a single file.
+ *
+ * The file ("HUFC" container) interleaves the components by MCU, as in
+ * baseline JPEG: each MCU holds the 1, 2 or 4 luma blocks covering one
+ * chroma block, then the Cb and the Cr block. Luma is quantized with the
+ * luminance table and coded with its own Huffman table; Cb and Cr share the
+ * chrominance quantization table and a second Huffman table. Layout:
+ * "HUFC", u8 version, u32 width, u32 height, u16 mode (444/422/420),
+ * u8 quality, u8 number of tables (2), each table as in a HUF2 header
+ * (mode byte, 16 counts, symbols), u32 payload bytes, u32 payload bits,
+ * then the payload. Version 2 adds a flags byte after the number of
+ * tables; it is only written for a container whose blocks use the
+ * transposed quantization tables (see TransformConteneur()).
+ *
+ * With setNbThreads() or setPool(), the color conversion, subsampling and
+ * transforms run in parallel across MCU rows, and the upsampling and color
+ * conversion of the decoder across row bands; the files do not depend on
+ * the thread count.
  */
 class cCompressionCouleur : public cCompression {
 private:
@@ -26,6 +43,16 @@ private:
     unsigned int mSubsamplingH;
     /** @brief Chroma subsampling factor for the vertical direction. (e.g., 2 for 4:2:0). */
     unsigned int mSubsamplingV;
+    /** @brief Chroma upsampling filter used by the decoder. */
+    eModeSurechantillonnage mSurechantillonnage;
+
+    /**
+     * @brief Decodes the former layout: basename.meta and one Huffman file per component.
+     * @param[in] basename The base name of the files ("image.meta", "image_Y.huff", ...).
+     * @param[in] outppm The path for the output PPM file.
+     * @return True on success, false on failure.
+     */
+    bool DecompressMultiFichiers(const char *basename, const char *outppm);
 
 public:
     /**
@@ -50,33 +77,154 @@ public:
     ~cCompressionCouleur();
 
     /**
-     * @brief Compresses a PPM (P6) image into three component Huffman files and a metadata file.
+     * @brief Compresses a PPM (P6) image into a single color container file.
+     *
+     * The file is memory-mapped and its rows are read in place (see
+     * cLecteurImage; a maxval other than 255 is rescaled first). Each MCU
+     * row is converted to YCbCr and subsampled; the RLE bytes are kept to
+     * build optimal luma and chroma Huffman tables before the payload is
+     * written.
+     *
+     * @param[in] ppmPath Path to the input PPM (P6) file.
+     * @param[in] outPath Path of the output file (e.g., "image.hufc").
+     * @param[in] qual The quality setting (1-100) for the JPEG quantization stage.
+     * @param[in] subsamplingMode The chroma subsampling mode. Supported values: 444, 422, 420.
+     * @return True on success, false on failure.
+     */
+    bool CompressPPM(const char *ppmPath, const char *outPath, unsigned int qual, unsigned int subsamplingMode = 444);
+
+    /**
+     * @brief Compresses a PPM (P6) image like CompressPPM(), in a single pass.
      *
-     * The process involves reading the PPM, converting RGB to YCbCr, optionally
-     * subsampling the Cb and Cr channels, and compressing each channel independently.
+     * Both component classes are coded with the built-in table of
+     * cEncodeurFlux and each MCU row is written as soon as it is coded, so
+     * memory use besides the mapped input is proportional to the image
+     * width. The files are slightly larger but decode to the same pixels.
      *
      * @param[in] ppmPath Path to the input PPM (P6) file.
-     * @param[in] basename The base name for the output files (e.g., "image").
-     *                     This will produce "image_Y.huff", "image_Cb.huff", etc.
+     * @param[in] outPath Path of the output file.
      * @param[in] qual The quality setting (1-100) for the JPEG quantization stage.
      * @param[in] subsamplingMode The chroma subsampling mode. Supported values: 444, 422, 420.
      * @return True on success, false on failure.
      */
-    bool CompressPPM(const char *ppmPath, const char *basename, unsigned int qual, unsigned int subsamplingMode = 444);
+    bool CompressPPMFlux(const char *ppmPath, const char *outPath, unsigned int qual, unsigned int subsamplingMode = 444);
 
     /**
-     * @brief Decompresses three component Huffman files and reconstructs a PPM (P6) image.
+     * @brief Decompresses a color container and reconstructs a PPM (P6) image.
      *
-     * This method reads the metadata file to determine image dimensions and subsampling,
-     * then decompresses each color channel, upsamples the chroma channels if necessary,
-     * converts YCbCr back to RGB, and writes the output PPM file.
+     * The MCUs are decoded in one pass over the payload; the chroma is then
+     * upsampled with the filter set by setSurechantillonnage() and converted
+     * back to RGB row by row, in fixed point, straight into the mapped output
+     * file (see cEcrivainImage). With setEchelle(), the image is decoded
+     * straight to 1/2, 1/4 or 1/8 of its size. If inPath is
+     * not a container, it is taken as the base name of the former four-file
+     * layout (basename.meta, basename_Y.huff, ...), which is still read, at
+     * full size only.
      *
-     * @param[in] basename The base name used during compression (e.g., "image").
-     *                     It expects to find "image.meta", "image_Y.huff", etc.
+     * @param[in] inPath The container file, or a legacy base name.
      * @param[in] outppm The path for the output PPM file to be created.
      * @return True on success, false on failure.
      */
-    bool DecompressToPPM(const char *basename, const char *outppm);
+    bool DecompressToPPM(const char *inPath, const char *outppm);
+
+    /**
+     * @brief Compresses an RGB image in memory into a container, like CompressPPM().
+     *
+     * The output vector is cleared and refilled: reused from one call to the
+     * next, it keeps its capacity. With the scratch taken from the arena, a
+     * warm single-threaded call makes no heap allocation.
+     *
+     * @param[in] rgb The first pixel, interleaved R, G, B.
+     * @param[in] largeur The width in pixels.
+     * @param[in] hauteur The height in pixels.
+     * @param[in] pas The distance between two rows, in bytes (at least 3 * largeur).
+     * @param[in] qual The quality setting (1-100).
+     * @param[in] subsamplingMode The chroma subsampling mode: 444, 422 or 420.
+     * @param[out] sortie The container bytes.
+     * @return True on success, false on invalid arguments.
+     */
+    bool CompressRGB(const unsigned char *rgb, unsigned int largeur, unsigned int hauteur, size_t pas,
+                     unsigned int qual, unsigned int subsamplingMode, std::vector<unsigned char> &sortie);
+
+    /**
+     * @brief Compresses an RGB image in memory at the quality that best meets a size or PSNR target.
+     *
+     * The color conversion, subsampling and forward DCT of every block run
+     * once; each quality tried then only re-quantizes the kept coefficients,
+     * RLE-codes them and sizes both Huffman codes from the symbol counts
+     * (see cCompression::Compression_Cible()). The size is exact; the PSNR is
+     * the luma PSNR computed from the quantization error of the coefficients.
+     * The container is the one CompressRGB() writes at the chosen quality.
+     *
+     * @param[in] rgb The first pixel, interleaved R, G, B.
+     * @param[in] largeur The width in pixels.
+     * @param[in] hauteur The height in pixels.
+     * @param[in] pas The distance between two rows, in bytes (at least 3 * largeur).
+     * @param[in] subsamplingMode The chroma subsampling mode: 444, 422 or 420.
+     * @param[in] cible CIBLE_TAILLE or CIBLE_PSNR.
+     * @param[in] valeur The largest size in bytes, or the smallest luma PSNR in dB.
+     * @param[out] sortie The container bytes.
+     * @param[out] resultat The chosen quality and what it yields (optional).
+     * @return True on success, false on invalid arguments.
+     */
+    bool CompressRGBCible(const unsigned char *rgb, unsigned int largeur, unsigned int hauteur, size_t pas,
+                          unsigned int subsamplingMode, eCible cible, double valeur, std::vector<unsigned char> &sortie,
+                          sResultatCible *resultat = nullptr);
+
+    /**
+     * @brief Decompresses a container in memory into an RGB buffer owned by the caller.
+     *
+     * Decodes like DecompressToPPM() and writes the pixels at
+     * rgb + y * pas + 3 * x; getLargeur() and getHauteur() then give the size.
+     * With setEchelle(), the buffer only needs to hold the reduced image,
+     * TailleReduite() of that size.
+     * A warm single-threaded call makes no heap allocation.
+     *
+     * @param[in] Donnees The container bytes.
+     * @param[in] Taille The number of bytes.
+     * @param[out] rgb The first pixel of the output.
+     * @param[in] pas The distance between two output rows, in bytes.
+     * @param[in] largeurMax The width of the buffer, in pixels.
+     * @param[in] hauteurMax The height of the buffer, in rows.
+     * @return True on success; false if the container is invalid or does not fit (see LireDimensions()).
+     */
+    bool DecompressToRGB(const uint8_t *Donnees, size_t Taille, unsigned char *rgb, size_t pas,
+                         unsigned int largeurMax, unsigned int hauteurMax);
+
+    /**
+     * @brief Reads the image size of a container, or of a grayscale file, without decoding it.
+     * @param[in] Donnees The file bytes.
+     * @param[in] Taille The number of bytes.
+     * @param[out] largeur The width in pixels.
+     * @param[out] hauteur The height in pixels.
+     * @return False if the file is malformed or carries no size.
+     */
+    static bool LireDimensions(const uint8_t *Donnees, size_t Taille, unsigned int &largeur, unsigned int &hauteur);
+
+    /**
+     * @brief Rotates, mirrors or crops a container without decoding its pixels.
+     *
+     * The three planes are transformed block by block (see
+     * cCompression::TransformerBloc()) on their own block grids and
+     * interleaved again by MCU, with new optimal Huffman tables, so the
+     * result decodes to the transformed image with no generation loss. A
+     * mirror that brings the padding of the last MCUs to the left or the
+     * top keeps it: that side of the result is rounded up to whole MCUs. A
+     * quarter turn of a 4:2:2 container is refused, its MCUs not being
+     * square. A grayscale file is handed to cCompression::Transformation_JPEG().
+     *
+     * @param[in] Donnees The container bytes.
+     * @param[in] Taille The number of bytes.
+     * @param t The transform.
+     * @param[out] Fichier Receives the transformed container (empty on failure).
+     * @param[in] recadrage The crop, in pixels of the source image, on MCU boundaries except at
+     *            the right and bottom edges of the image (nullptr = the whole image).
+     * @return False if the container is invalid or damaged, on a misaligned crop, on a quarter
+     *         turn of a 4:2:2 container, or if a DC difference of the new block order does not
+     *         fit the 8-bit RLE format.
+     */
+    bool TransformConteneur(const uint8_t *Donnees, size_t Taille, eTransformation t,
+                            std::vector<unsigned char> &Fichier, const sRecadrage *recadrage = nullptr);
 
     /**
      * @brief Sets the horizontal chroma subsampling factor.
@@ -101,6 +249,18 @@ public:
      * @return The vertical factor.
      */
     unsigned int getSubsamplingV() const;
+
+    /**
+     * @brief Sets the chroma upsampling filter of the decoder.
+     * @param mode SURECHANTILLONNAGE_TRIANGLE (default) or SURECHANTILLONNAGE_PROCHE.
+     */
+    void setSurechantillonnage(eModeSurechantillonnage mode);
+
+    /**
+     * @brief Gets the chroma upsampling filter of the decoder.
+     * @return The filter.
+     */
+    eModeSurechantillonnage getSurechantillonnage() const;
 };
 
 #endif // JPEG_COMPRESSOR_CCOMPRESSIONCOULEUR_H
@@ -0,0 +1,172 @@
+/**
+ * @file cCompressionLot.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines cCompressionLot, which compresses a list of images on a shared worker pool.
+ */
+
+#ifndef JPEG_COMPRESSOR_CCOMPRESSIONLOT_H
+#define JPEG_COMPRESSOR_CCOMPRESSIONLOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class cThreadPool;
+
+/**
+ * @struct sTacheLot
+ * @brief One image to compress.
+ *
+ * The input format selects the codec: a binary PGM (P5) or a text .img
+ * gives a grayscale HUF2 file, a binary PPM (P6) a color HUFC container
+ * (see cLecteurImage).
+ */
+struct sTacheLot {
+    /** @brief Path of the input image (.pgm, .ppm or .img). */
+    std::string entree;
+    /** @brief Path of the compressed file. */
+    std::string sortie;
+    /** @brief Quality (1-100). */
+    unsigned int qualite = 50;
+    /** @brief Chroma subsampling mode (444, 422, 420); ignored for grayscale images. */
+    unsigned int sousEchantillonnage = 444;
+};
+
+/**
+ * @struct sResultatLot
+ * @brief The outcome of one sTacheLot.
+ */
+struct sResultatLot {
+    /** @brief True if the output file was written. */
+    bool reussi = false;
+    /** @brief Why the job failed; empty on success. */
+    std::string erreur;
+    /** @brief Image width in pixels (0 if the input could not be read). */
+    unsigned int largeur = 0;
+    /** @brief Image height in pixels. */
+    unsigned int hauteur = 0;
+    /** @brief Size of the input file in bytes. */
+    uint64_t octetsEntree = 0;
+    /** @brief Size of the output file in bytes. */
+    uint64_t octetsSortie = 0;
+    /** @brief Time spent on the job, in seconds. */
+    double secondes = 0.0;
+    /** @brief True if the job was spread over the pool block by block rather than run on one worker. */
+    bool paralleleBlocs = false;
+};
+
+/**
+ * @struct sBilanLot
+ * @brief Aggregate figures of a batch.
+ */
+struct sBilanLot {
+    /** @brief Number of jobs that succeeded. */
+    size_t nbReussis = 0;
+    /** @brief Number of jobs that failed. */
+    size_t nbEchecs = 0;
+    /** @brief Total pixels of the successful jobs. */
+    uint64_t pixels = 0;
+    /** @brief Total input bytes of the successful jobs. */
+    uint64_t octetsEntree = 0;
+    /** @brief Total output bytes of the successful jobs. */
+    uint64_t octetsSortie = 0;
+    /** @brief Wall-clock time of the whole batch, in seconds. */
+    double secondes = 0.0;
+
+    /** @brief Successful images per second of wall-clock time. */
+    double imagesParSeconde() const;
+    /** @brief Successful megapixels per second of wall-clock time. */
+    double megapixelsParSeconde() const;
+};
+
+/**
+ * @class cCompressionLot
+ * @brief Compresses many images in one process, on one pool of worker threads.
+ *
+ * Two kinds of parallelism are used, chosen per image from its size in
+ * the file header. Images smaller than the threshold are independent jobs:
+ * each worker takes the next one and compresses it single-threaded, with a
+ * codec instance and pixel buffers it keeps from one job to the next.
+ * Larger images are compressed one at a time, their blocks spread over the
+ * whole pool, so that a few huge images do not leave the other workers
+ * idle. Either way the files are identical to those of a single
+ * CompressPPM() or RLE() + Compression_JPEG() call.
+ */
+class cCompressionLot {
+private:
+    /** @brief Number of worker threads (0 = one per hardware thread). */
+    unsigned int mNbThreads;
+    /** @brief Images with at least this many pixels use block-level parallelism. */
+    uint64_t mSeuilPixels;
+    /** @brief The pool, created on first use. */
+    std::shared_ptr<cThreadPool> mPool;
+
+public:
+    /** @brief Default size threshold between job- and block-level parallelism, in pixels. */
+    static constexpr uint64_t kSeuilPixelsDefaut = 4u * 1024u * 1024u;
+
+    /**
+     * @brief Constructs a batch compressor.
+     * @param nbThreads The number of worker threads (0 = one per hardware thread).
+     */
+    explicit cCompressionLot(unsigned int nbThreads = 0);
+
+    /**
+     * @brief Destructor.
+     */
+    ~cCompressionLot();
+
+    /**
+     * @brief Sets the number of worker threads.
+     * @param nbThreads The thread count (0 = one per hardware thread).
+     */
+    void setNbThreads(unsigned int nbThreads);
+
+    /**
+     * @brief Shares an existing pool instead of creating one.
+     * @param pool The pool (nullptr to go back to a private pool).
+     */
+    void setPool(const std::shared_ptr<cThreadPool> &pool);
+
+    /**
+     * @brief Sets the size from which an image is parallelized by blocks instead of as a whole job.
+     * @param pixels The threshold in pixels.
+     */
+    void setSeuilPixels(uint64_t pixels);
+
+    /**
+     * @brief Gets the job/block parallelism threshold.
+     * @return The threshold in pixels.
+     */
+    uint64_t getSeuilPixels() const;
+
+    /**
+     * @brief Compresses every job of the list.
+     *
+     * A failed job does not stop the others.
+     *
+     * @param[in] taches The jobs.
+     * @param[out] resultats One result per job, in the same order.
+     * @param[out] bilan The aggregate figures.
+     * @return True if every job succeeded.
+     */
+    bool Executer(const std::vector<sTacheLot> &taches, std::vector<sResultatLot> &resultats, sBilanLot &bilan);
+
+    /**
+     * @brief Reads a batch manifest.
+     *
+     * One job per line: "input output [quality] [subsampling]", separated by
+     * blanks. Empty lines and lines starting with '#' are skipped.
+     *
+     * @param[in] chemin Path of the manifest.
+     * @param[out] taches The jobs read.
+     * @param[out] ligneErreur The number of the first malformed line, 0 if none.
+     * @return True on success, false if the file cannot be read or a line is malformed.
+     */
+    static bool LireManifeste(const char *chemin, std::vector<sTacheLot> &taches, unsigned int &ligneErreur);
+};
+
+#endif // JPEG_COMPRESSOR_CCOMPRESSIONLOT_H
@@ -0,0 +1,93 @@
+/**
+ * @file cContexteCodec.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines cContexteCodec, the quality and tables shared by an encoder and its decoder.
+ */
+
+#ifndef JPEG_COMPRESSOR_CCONTEXTECODEC_H
+#define JPEG_COMPRESSOR_CCONTEXTECODEC_H
+
+#include "quantification/quantification.h"
+
+/**
+ * @class cContexteCodec
+ * @brief Holds the state that used to live in process-wide statics: the quality
+ *        factor, its quantization tables and the last Huffman table.
+ *
+ * Each cCompression instance can be given its own context (see
+ * cCompression::setContexte()); instances with distinct contexts share no
+ * mutable state and can encode or decode concurrently at different
+ * qualities. Instances without a context use global(), which backs the
+ * static compatibility API (cCompression::setQualiteGlobale(), ...).
+ *
+ * A context is not itself synchronized: it must not be modified while
+ * another thread encodes or decodes with it.
+ */
+class cContexteCodec {
+private:
+    /** @brief The luminance quantization tables for the current quality. */
+    cContexteQuant mQuant;
+    /** @brief Huffman symbols cached by the last Compression_JPEG() of this context. */
+    char mHuffSymboles[256];
+    /** @brief Frequencies corresponding to mHuffSymboles. */
+    double mHuffFrequences[256];
+    /** @brief Number of valid entries in the cached Huffman table. */
+    unsigned int mHuffNb;
+
+public:
+    /**
+     * @brief Creates a context with no cached Huffman table.
+     * @param qualite The quality factor (clamped to 1-100).
+     */
+    explicit cContexteCodec(unsigned int qualite = 50);
+
+    /**
+     * @brief Changes the quality factor and rebuilds the quantization tables.
+     * @param qualite The quality factor (clamped to 1-100).
+     */
+    void setQualite(unsigned int qualite);
+
+    /**
+     * @brief Gets the quality factor.
+     * @return The quality (1-100).
+     */
+    unsigned int getQualite() const;
+
+    /**
+     * @brief Gets the quantization tables for the current quality.
+     * @return The luminance tables.
+     */
+    const cContexteQuant &getQuant() const;
+
+    /**
+     * @brief Caches a Huffman table, for decoding streams that carry no header.
+     * @param[in] symbols An array of symbol values.
+     * @param[in] frequencies An array of corresponding frequencies.
+     * @param[in] count The number of entries (0 clears the cache).
+     */
+    void storeHuffmanTable(const char *symbols, const double *frequencies, unsigned int count);
+
+    /**
+     * @brief Retrieves the cached Huffman table.
+     * @param[out] symbols A buffer of 256 entries for the symbol values.
+     * @param[out] frequencies A buffer of 256 entries for the frequencies.
+     * @param[out] count The number of entries copied.
+     * @return True if a table was cached.
+     */
+    bool loadHuffmanTable(char *symbols, double *frequencies, unsigned int &count) const;
+
+    /**
+     * @brief Checks if a Huffman table is cached.
+     * @return True if a table is cached.
+     */
+    bool hasStoredHuffmanTable() const;
+
+    /**
+     * @brief Gets the process-wide context used by instances without their own.
+     * @return The global context (quality 50 until changed).
+     */
+    static cContexteCodec &global();
+};
+
+#endif // JPEG_COMPRESSOR_CCONTEXTECODEC_H
@@ -0,0 +1,163 @@
+/**
+ * @file cEcrivainHuf2.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines cEcrivainHuf2, which writes a HUF2 file from RLE bytes given a few blocks at a time.
+ */
+
+#ifndef JPEG_COMPRESSOR_CECRIVAINHUF2_H
+#define JPEG_COMPRESSOR_CECRIVAINHUF2_H
+
+#include "cHuffman.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+class cArene;
+struct sTableHuffman;
+
+/**
+ * @class cEcrivainHuf2
+ * @brief Writes the header, payload, trailer and extensions of a HUF2 file.
+ *
+ * The code table is fixed by commencer(); the RLE bytes then come in any
+ * number of calls to ajouter(), each holding whole blocks in raster order,
+ * and terminer() completes the file. The bytes are those of
+ * cCompression::Compression_JPEG() on the concatenated trame, which is
+ * written through this class: restart segments start on a byte and the
+ * seek index records the bit position and DC predictor of every N-th block.
+ * The format is described in cFormatHuf2.h.
+ *
+ * A file too large to be held can be streamed as it is coded: vider()
+ * moves the complete bytes to a seekable stream at any point, and
+ * terminer() then patches the payload size of the header in the stream.
+ *
+ * The segment and index tables are taken from an arena, so the caller
+ * keeps a cPorteeArene open until terminer() has returned.
+ */
+class cEcrivainHuf2 {
+private:
+    /** @brief The file being written. */
+    std::vector<unsigned char> &mFichier;
+    /** @brief The bit writer appending the payload to mFichier. */
+    cEcrivainBits mEcrivain;
+    /** @brief The code length of each byte value. */
+    uint8_t mLongueurs[256];
+    /** @brief The canonical code of each byte value. */
+    uint32_t mCodes[256];
+    /** @brief Position of the payload size fields in the file, patched by terminer(). */
+    size_t mPosTaille;
+    /** @brief Position of the first payload byte in the file. */
+    size_t mDebutPayload;
+    /** @brief Number of bytes moved out of mFichier by vider(); mFichier holds the file from there on. */
+    uint64_t mOctetsVides;
+    /** @brief The stream given to vider(), or nullptr if the whole file is in mFichier. */
+    std::ostream *mFlux;
+    /** @brief Position of the start of the file in mFlux. */
+    std::streampos mDebutFlux;
+    /** @brief Restart interval in blocks (0 = none). */
+    unsigned int mIntervalleRestart;
+    /** @brief Seek index interval in blocks (0 = none). */
+    unsigned int mIntervalleIndex;
+    /** @brief Byte offset and bit count of each restart segment. */
+    uint32_t *mSegOffsets, *mSegBits;
+    /** @brief Number of restart segments started. */
+    uint32_t mNbSeg;
+    /** @brief Bit position and DC predictor of each index entry. */
+    uint32_t *mIndexBits;
+    int32_t *mIndexDC;
+    /** @brief Number of index entries. */
+    uint32_t mNbIndex;
+    /** @brief Capacity of the segment and index tables, in blocks. */
+    size_t mMaxBlocs;
+    /** @brief Bit count at the beginning of the current restart segment. */
+    uint64_t mBitsDebut;
+    /** @brief Raster index of the next block. */
+    size_t mBloc;
+    /** @brief The DC predictor of the next block. */
+    int mDC;
+    /** @brief Number of RLE bytes coded. */
+    uint64_t mNbSymboles;
+
+    /** @brief Writes the payload size placeholder; the table is already in the header. */
+    void ouvrirPayload();
+
+public:
+    /**
+     * @brief Prepares a writer; nothing is written before commencer().
+     * @param Fichier The file, cleared by commencer().
+     * @param arene The arena of the segment and index tables.
+     * @param maxBlocs An upper bound on the number of blocks (the trame length will do).
+     * @param intervalleRestart The restart interval in blocks (0 = none).
+     * @param intervalleIndex The seek index interval in blocks (0 = none).
+     */
+    cEcrivainHuf2(std::vector<unsigned char> &Fichier, cArene &arene, size_t maxBlocs,
+                  unsigned int intervalleRestart, unsigned int intervalleIndex);
+
+    cEcrivainHuf2(const cEcrivainHuf2 &) = delete;
+    cEcrivainHuf2 &operator=(const cEcrivainHuf2 &) = delete;
+
+    /**
+     * @brief Starts a file whose header embeds the table.
+     * @param Longueurs The code length of each byte value (0: no code).
+     */
+    void commencer(const uint8_t Longueurs[256]);
+
+    /**
+     * @brief Starts a file whose header references a registered static table.
+     * @param table The table.
+     */
+    void commencer(const sTableHuffman &table);
+
+    /**
+     * @brief Codes RLE bytes.
+     * @param Trame Whole blocks, following those of the previous calls.
+     * @param Longueur The number of bytes.
+     */
+    void ajouter(const signed char *Trame, size_t Longueur);
+
+    /**
+     * @brief Completes the payload, then writes the trailer and the extensions.
+     * @param largeur The width stored in the trailer.
+     * @param hauteur The height stored in the trailer.
+     * @param qualite The quality stored in the quality extension.
+     * @param transposee True if the blocks are quantized with the transposed table (see cCompression::Transformation_JPEG()).
+     */
+    void terminer(uint32_t largeur, uint32_t hauteur, uint32_t qualite, bool transposee = false);
+
+    /**
+     * @brief Moves the complete bytes of the file to a stream and clears them from the file.
+     *
+     * Call it with the same stream each time, after commencer(); the bits
+     * of an incomplete byte stay pending. Once terminer() has returned, a
+     * last call writes the trailer and the extensions.
+     *
+     * @param sortie The stream, seekable since the header is patched by terminer().
+     * @return False if the stream has failed.
+     */
+    bool vider(std::ostream &sortie);
+
+    /**
+     * @brief Gets the number of RLE bytes coded so far.
+     * @return The number of symbols.
+     */
+    uint64_t getNbSymboles() const;
+
+    /**
+     * @brief Returns the number of bytes of the RLE block starting at Trame[pos].
+     *
+     * A block is its DC difference byte followed by (run, value) pairs, up to an
+     * End-of-Block pair or until the 63 AC coefficients are accounted for,
+     * exactly as the decoder consumes them.
+     *
+     * @param Trame The RLE bytes.
+     * @param Longueur The number of bytes.
+     * @param pos The first byte of the block.
+     * @return The length of the block (0 if pos is past the end).
+     */
+    static size_t LongueurBloc(const char *Trame, size_t Longueur, size_t pos);
+};
+
+#endif // JPEG_COMPRESSOR_CECRIVAINHUF2_H
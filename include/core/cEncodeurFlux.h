@@ -0,0 +1,202 @@
+/**
+ * @file cEncodeurFlux.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines cEncodeurFlux, a grayscale encoder fed one stripe of rows at a time.
+ */
+
+#ifndef JPEG_COMPRESSOR_CENCODEURFLUX_H
+#define JPEG_COMPRESSOR_CENCODEURFLUX_H
+
+#include "cArene.h"
+#include "cCompression.h"
+#include "cEcrivainHuf2.h"
+#include "cTablesHuffman.h"
+#include "quantification/quantification.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+/**
+ * @class cEncodeurFlux
+ * @brief Encodes a grayscale image into a HUF2 file without ever holding the whole image.
+ *
+ * Rows are pushed in any number per call; every time 8 rows are available
+ * the block row is transformed, quantized, RLE coded and Huffman coded, and
+ * the complete bytes are written to the output stream. Memory use is
+ * therefore proportional to the image width, not to its area.
+ *
+ * Since the symbol statistics are not known in advance, the Huffman codes
+ * come from a fixed table (getLongueursFixes(), the built-in table of
+ * cTablesHuffman), which is written in the file header like any other
+ * table: the files are read by cCompression::Decompression_JPEG()
+ * unchanged. Images whose sizes are not multiples of 8 are padded by
+ * replicating the last column and row; the trailer keeps the size of
+ * the image, and the decoder crops the padding away.
+ *
+ * The file is written by cEcrivainHuf2, as those of Compression_JPEG(),
+ * and moved to the stream after each stripe (cEcrivainHuf2::vider()). The
+ * output stream must be seekable: the payload size in the header is
+ * patched by terminer().
+ */
+class cEncodeurFlux {
+private:
+    /** @brief The destination of the HUF2 file. */
+    std::ostream &mSortie;
+    /** @brief The width of the image in pixels, as given by the caller. */
+    unsigned int mLargeur;
+    /** @brief The height of the image in pixels, as given by the caller. */
+    unsigned int mHauteur;
+    /** @brief The width rounded up to a multiple of 8. */
+    unsigned int mLargeurBlocs;
+    /** @brief The quantization tables. */
+    cContexteQuant mContexte;
+    /** @brief The arithmetic used by the block transforms. */
+    eModePipeline mModePipeline;
+    /** @brief Restart interval in blocks (0 = a single monolithic stream). */
+    unsigned int mIntervalleRestart;
+    /** @brief Seek index interval in blocks (0 = none). */
+    unsigned int mIntervalleIndex;
+
+    /** @brief The pending rows of the current stripe, 8 rows of mLargeurBlocs pixels. */
+    std::vector<unsigned char> mBande;
+    /** @brief Number of rows currently held in mBande. */
+    unsigned int mLignesBande;
+    /** @brief Number of rows received so far. */
+    unsigned int mLignesRecues;
+    /** @brief Index of the next block to encode, in raster order. */
+    size_t mBlocCourant;
+    /** @brief The quantized DC of the previous block. */
+    int mDC_precedent;
+
+    /** @brief The bytes of the file not yet moved to mSortie. */
+    std::vector<unsigned char> mOctets;
+    /** @brief The arena of the segment and index tables of mEcrivain. */
+    cArene mArene;
+    /** @brief The HUF2 writer, created by commencer() once the intervals are known. */
+    std::unique_ptr<cEcrivainHuf2> mEcrivain;
+
+    /** @brief The code table: the built-in one unless setTableStatique() chose another. */
+    const sTableHuffman *mTable;
+    /** @brief True if the header references mTable instead of embedding its lengths. */
+    bool mReference;
+
+    /** @brief Set once the header is written. */
+    bool mCommence;
+    /** @brief Set by terminer(), or by a write error. */
+    bool mTermine;
+    /** @brief False as soon as a write to mSortie has failed. */
+    bool mOk;
+
+    /** @brief Creates the writer and writes the HUF2 header, with a placeholder for the payload size. */
+    void commencer();
+
+    /** @brief Encodes the 8 rows held in mBande and flushes the complete bytes. */
+    void encoderBande();
+
+public:
+    /**
+     * @brief Prepares an encoder; nothing is written before the first rows arrive.
+     * @param sortie The seekable stream the file is written to.
+     * @param largeur The width of the image in pixels.
+     * @param hauteur The height of the image in pixels.
+     * @param qualite The quality factor (1-100).
+     */
+    cEncodeurFlux(std::ostream &sortie, unsigned int largeur, unsigned int hauteur, unsigned int qualite = 50);
+
+    cEncodeurFlux(const cEncodeurFlux &) = delete;
+    cEncodeurFlux &operator=(const cEncodeurFlux &) = delete;
+
+    /**
+     * @brief Selects the floating-point or the fixed-point block pipeline.
+     * @param mode The pipeline to use; must be set before the first rows.
+     */
+    void setModePipeline(eModePipeline mode);
+
+    /**
+     * @brief Enables restart intervals (see cCompression::setIntervalleRestart()).
+     * @param nbBlocs The interval in blocks (0 disables the feature, the default); must be set before the first rows.
+     */
+    void setIntervalleRestart(unsigned int nbBlocs);
+
+    /**
+     * @brief Writes a seek index (see cCompression::setIntervalleIndex()).
+     * @param nbBlocs The interval in blocks (0 disables the feature, the default); must be set before the first rows.
+     */
+    void setIntervalleIndex(unsigned int nbBlocs);
+
+    /**
+     * @brief Codes with a registered static table, referenced by the header instead of embedded.
+     *
+     * The file is then only readable where the same table is registered
+     * (see cTablesHuffman). Without this call the built-in table is used and
+     * embedded, as in any HUF2 file.
+     *
+     * @param id The identifier of the table.
+     * @param version Its version, or 0 for the highest registered one.
+     * @return False if the table is not registered or the first rows were already given.
+     */
+    bool setTableStatique(uint16_t id, uint16_t version = 0);
+
+    /**
+     * @brief Appends rows to the image.
+     * @param pixels The first pixel of the first row.
+     * @param pas The distance in bytes between two consecutive rows.
+     * @param nbLignes The number of rows; may be anything, stripes are cut internally.
+     * @return False if the image already has all its rows or the output failed.
+     */
+    bool ajouterLignes(const unsigned char *pixels, size_t pas, unsigned int nbLignes);
+
+    /**
+     * @brief Pads and encodes the last stripe, then completes the file.
+     * @return True if every row was received and the whole file was written.
+     */
+    bool terminer();
+
+    /**
+     * @brief Encodes a whole image pulled from a callback, one stripe of 8 rows at a time.
+     *
+     * The callback fills nbLignes rows of getLargeur() pixels, `pas` bytes
+     * apart, and returns false on error. The last stripe may be shorter.
+     *
+     * @param source The row provider.
+     * @return True on success (terminer() is called).
+     */
+    bool Encoder(const std::function<bool(unsigned char *lignes, size_t pas, unsigned int nbLignes)> &source);
+
+    /**
+     * @brief Encodes a whole image read from a stream of raw 8-bit rows (e.g. a PGM body).
+     * @param entree The stream, positioned at the first pixel.
+     * @return True on success (terminer() is called).
+     */
+    bool Encoder(std::istream &entree);
+
+    /**
+     * @brief Gets the width of the image.
+     * @return The width in pixels, before padding.
+     */
+    unsigned int getLargeur() const;
+
+    /**
+     * @brief Gets the height of the image.
+     * @return The height in pixels, before padding.
+     */
+    unsigned int getHauteur() const;
+
+    /**
+     * @brief Gets the code lengths of the built-in table.
+     *
+     * Every byte value has a code of at most cHuffman::kLongueurMax bits,
+     * and the lengths form a complete prefix code.
+     *
+     * @return 256 code lengths, indexed by byte value.
+     */
+    static const uint8_t *getLongueursFixes();
+};
+
+#endif // JPEG_COMPRESSOR_CENCODEURFLUX_H
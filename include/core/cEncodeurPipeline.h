@@ -0,0 +1,242 @@
+/**
+ * @file cEncodeurPipeline.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines cEncodeurPipeline, a grayscale encoder whose reading, transform and entropy stages overlap.
+ */
+
+#ifndef JPEG_COMPRESSOR_CENCODEURPIPELINE_H
+#define JPEG_COMPRESSOR_CENCODEURPIPELINE_H
+
+#include "cArene.h"
+#include "cCompression.h"
+#include "cContexteCodec.h"
+#include "cTablesHuffman.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <vector>
+
+/**
+ * @struct sMetriquesEtape
+ * @brief The time one stage of cEncodeurPipeline spent working and waiting.
+ *
+ * Times are summed over the threads of the stage.
+ */
+struct sMetriquesEtape {
+    /** @brief The name of the stage ("lecture", "transformation", "entropie"). */
+    const char *nom = "";
+    /** @brief The number of threads running the stage. */
+    unsigned int nbThreads = 1;
+    /** @brief The number of stripes the stage went through. */
+    uint64_t bandes = 0;
+    /** @brief Time spent on the stripes, in seconds. */
+    double secondesActives = 0.0;
+    /** @brief Time spent waiting for a stripe from the previous stage (starvation), in seconds. */
+    double secondesAttenteEntree = 0.0;
+    /** @brief Time spent waiting for room downstream (back-pressure), in seconds. */
+    double secondesAttenteSortie = 0.0;
+
+    /**
+     * @brief Gets the share of the threads' time spent working.
+     * @param secondes The wall-clock time of the encode.
+     * @return The occupation, from 0 to 1.
+     */
+    double occupation(double secondes) const;
+};
+
+/**
+ * @struct sMetriquesFile
+ * @brief The depth of one queue of cEncodeurPipeline over an encode.
+ */
+struct sMetriquesFile {
+    /** @brief The number of stripes the queue can hold. */
+    unsigned int capacite = 0;
+    /** @brief The largest number of stripes it held. */
+    unsigned int profondeurMax = 0;
+    /** @brief The number of stripes it held on average over time. */
+    double profondeurMoyenne = 0.0;
+};
+
+/**
+ * @struct sMetriquesPipeline
+ * @brief What cEncodeurPipeline::Encoder() measured, to tell which stage limits the throughput.
+ */
+struct sMetriquesPipeline {
+    /** @brief The reader: pulls the rows from the source and pads them. */
+    sMetriquesEtape lecture;
+    /** @brief The transform workers: DCT, quantization and RLE of a stripe. */
+    sMetriquesEtape transformation;
+    /** @brief The entropy coder: Huffman codes the stripes in order and writes the file. */
+    sMetriquesEtape entropie;
+    /** @brief Stripes read, waiting for a transform worker. */
+    sMetriquesFile fileTransformation;
+    /** @brief Stripes transformed, waiting for the entropy coder (including those ahead of their turn). */
+    sMetriquesFile fileEntropie;
+    /** @brief The number of pixel rows of a stripe. */
+    unsigned int lignesParBande = 0;
+    /** @brief Wall-clock time of the encode, in seconds. */
+    double secondes = 0.0;
+
+    /**
+     * @brief Gets the stage whose threads were the busiest, the one to speed up or give threads to.
+     * @return lecture, transformation or entropie.
+     */
+    const sMetriquesEtape &goulot() const;
+};
+
+/**
+ * @class cEncodeurPipeline
+ * @brief Encodes a grayscale image into a HUF2 file with reading, transform and
+ *        entropy coding running at the same time on successive stripes.
+ *
+ * A reader thread pulls stripes of rows from the source and pads them; a
+ * set of transform workers applies the DCT, quantization and RLE to each
+ * stripe (cCompression::RLE() on a stripe); the calling thread Huffman
+ * codes the stripes in raster order. A fixed number of stripe buffers
+ * (setProfondeur()) bounds both queues: when the entropy coder falls that
+ * far behind, the reader waits for a buffer to come back instead of
+ * reading ahead, so memory stays proportional to the width times the depth.
+ *
+ * With a static table (setTableStatique()) the payload is coded as the
+ * stripes arrive. With adaptive codes the histogram needs every symbol, so
+ * the RLE bytes are kept and coded once the last stripe is in: reading
+ * and transforms still overlap, only the Huffman pass is left at the end.
+ *
+ * The file is the one cCompression::RLE() and Compression_JPEG() give for
+ * the same settings. Images whose sizes are not multiples of 8 are padded
+ * by replicating the last column and row, as cEncodeurFlux does; the
+ * trailer keeps the size of the image.
+ */
+class cEncodeurPipeline {
+private:
+    /** @brief The width of the image in pixels, as given by the caller. */
+    unsigned int mLargeur;
+    /** @brief The height of the image in pixels, as given by the caller. */
+    unsigned int mHauteur;
+    /** @brief The codec context shared by every stage (quality and quantization tables). */
+    std::shared_ptr<cContexteCodec> mContexte;
+    /** @brief The arithmetic used by the block transforms. */
+    eModePipeline mModePipeline;
+    /** @brief Restart interval in blocks (0 = a single monolithic stream). */
+    unsigned int mIntervalleRestart;
+    /** @brief Seek index interval in blocks (0 = no index). */
+    unsigned int mIntervalleIndex;
+    /** @brief The static table to code with, or nullptr for adaptive codes. */
+    const sTableHuffman *mTableStatique;
+    /** @brief Number of transform workers (0 = one per hardware thread). */
+    unsigned int mNbThreads;
+    /** @brief Pixel rows per stripe, a multiple of 8. */
+    unsigned int mLignesParBande;
+    /** @brief Stripe buffers in flight (0 = two per transform worker, plus two). */
+    unsigned int mProfondeur;
+    /** @brief The arena of the entropy coder, kept from one encode to the next. */
+    std::shared_ptr<cArene> mArene;
+    /** @brief The RLE bytes of the whole image, for adaptive codes. */
+    std::vector<signed char> mTrame;
+    /** @brief What the last encode measured. */
+    sMetriquesPipeline mMetriques;
+
+public:
+    /** @brief Default number of pixel rows per stripe. */
+    static constexpr unsigned int kLignesParBandeDefaut = 64;
+
+    /**
+     * @brief Constructs an encoder.
+     * @param largeur The width of the image in pixels.
+     * @param hauteur The height of the image in pixels.
+     * @param qualite The quality (1-100).
+     */
+    cEncodeurPipeline(unsigned int largeur, unsigned int hauteur, unsigned int qualite = 50);
+
+    cEncodeurPipeline(const cEncodeurPipeline &) = delete;
+    cEncodeurPipeline &operator=(const cEncodeurPipeline &) = delete;
+
+    /**
+     * @brief Selects the arithmetic of the block transforms.
+     * @param mode PIPELINE_FLOTTANT or PIPELINE_ENTIER.
+     */
+    void setModePipeline(eModePipeline mode);
+
+    /**
+     * @brief Sets the restart interval, as cCompression::setIntervalleRestart().
+     * @param nbBlocs The interval in blocks (0 = none).
+     */
+    void setIntervalleRestart(unsigned int nbBlocs);
+
+    /**
+     * @brief Sets the seek index interval, as cCompression::setIntervalleIndex().
+     * @param nbBlocs The interval in blocks (0 = none).
+     */
+    void setIntervalleIndex(unsigned int nbBlocs);
+
+    /**
+     * @brief Codes with a registered static table, which lets the payload be written as the stripes arrive.
+     * @param id The identifier of the table.
+     * @param version The version, or 0 for the highest registered one.
+     * @return False if the table is not registered (the setting is unchanged).
+     */
+    bool setTableStatique(uint16_t id, uint16_t version = 0);
+
+    /**
+     * @brief Sets the number of transform workers.
+     * @param nbThreads The thread count (0 = one per hardware thread).
+     */
+    void setNbThreads(unsigned int nbThreads);
+
+    /**
+     * @brief Sets the height of a stripe, the unit handed from stage to stage.
+     * @param nbLignes The number of pixel rows, rounded up to a multiple of 8.
+     */
+    void setLignesParBande(unsigned int nbLignes);
+
+    /**
+     * @brief Sets the number of stripe buffers, which bounds how far the reader gets ahead of the entropy coder.
+     * @param nbBandes The number of stripes (0 = two per transform worker, plus two; at least 2).
+     */
+    void setProfondeur(unsigned int nbBandes);
+
+    /**
+     * @brief Gets the width of the image.
+     * @return The width in pixels.
+     */
+    unsigned int getLargeur() const;
+
+    /**
+     * @brief Gets the height of the image.
+     * @return The height in pixels.
+     */
+    unsigned int getHauteur() const;
+
+    /**
+     * @brief Gets what the last call to Encoder() measured.
+     * @return The metrics.
+     */
+    const sMetriquesPipeline &getMetriques() const;
+
+    /**
+     * @brief Encodes an image pulled from a source.
+     *
+     * The source is called from the reader thread, in order, until the
+     * height is reached; it must not touch the encoder.
+     *
+     * @param source Fills nbLignes rows of getLargeur() pixels, pas bytes apart; returns false on error.
+     * @param[out] Fichier Receives the HUF2 file.
+     * @return False if the source failed or the image is empty.
+     */
+    bool Encoder(const std::function<bool(unsigned char *lignes, size_t pas, unsigned int nbLignes)> &source,
+                 std::vector<unsigned char> &Fichier);
+
+    /**
+     * @brief Encodes an image read from a stream of raw 8-bit rows.
+     * @param entree The stream, positioned on the first pixel.
+     * @param[out] Fichier Receives the HUF2 file.
+     * @return False if the stream ends early or the image is empty.
+     */
+    bool Encoder(std::istream &entree, std::vector<unsigned char> &Fichier);
+};
+
+#endif // JPEG_COMPRESSOR_CENCODEURPIPELINE_H
@@ -0,0 +1,72 @@
+/**
+ * @file cFichierMappe.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines cFichierMappe, a read-only view of a whole file.
+ */
+
+#ifndef JPEG_COMPRESSOR_CFICHIERMAPPE_H
+#define JPEG_COMPRESSOR_CFICHIERMAPPE_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class cFichierMappe
+ * @brief Exposes the contents of a file as one contiguous, read-only byte range.
+ *
+ * On POSIX systems the file is memory-mapped, so its bytes are read in place
+ * from the page cache. Elsewhere, or if the mapping fails, the file is read
+ * into an owned buffer with a single bulk read.
+ */
+class cFichierMappe {
+private:
+    /** @brief The first byte of the file, or nullptr when nothing is open. */
+    const unsigned char *mDonnees;
+    /** @brief The size of the file in bytes. */
+    size_t mTaille;
+    /** @brief True if mDonnees points into a mapping that must be unmapped. */
+    bool mMappe;
+    /** @brief The file contents when it could not be mapped. */
+    std::vector<unsigned char> mCopie;
+
+public:
+    /** @brief Creates an empty view. */
+    cFichierMappe();
+
+    /** @brief Releases the mapping or the buffer. */
+    ~cFichierMappe();
+
+    cFichierMappe(const cFichierMappe &) = delete;
+    cFichierMappe &operator=(const cFichierMappe &) = delete;
+
+    /**
+     * @brief Opens a file, replacing any previously opened one.
+     * @param chemin The path of the file.
+     * @return True on success (an empty file is a success with getTaille() == 0).
+     */
+    bool ouvrir(const char *chemin);
+
+    /** @brief Releases the current file, if any. */
+    void fermer();
+
+    /**
+     * @brief Gets the contents of the file.
+     * @return The first byte, or nullptr if no file is open or it is empty.
+     */
+    const unsigned char *getDonnees() const;
+
+    /**
+     * @brief Gets the size of the file.
+     * @return The size in bytes.
+     */
+    size_t getTaille() const;
+
+    /**
+     * @brief Tells whether the contents are memory-mapped or copied.
+     * @return True if the file is mapped.
+     */
+    bool estMappe() const;
+};
+
+#endif // JPEG_COMPRESSOR_CFICHIERMAPPE_H
@@ -0,0 +1,40 @@
+/**
+ * @file cFormatHuf2.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines the magic number, table modes and extension tags of the HUF2 file format.
+ *
+ * A HUF2 file is the magic number, a table mode byte and the table (see
+ * kTableIntegree and kTableStatique), the payload size in bytes and in
+ * bits, the payload, then a width/height trailer followed by optional
+ * extensions, each introduced by its tag, in this order: restart segments,
+ * quality, seek index, transposed quantization. cEcrivainHuf2 writes the
+ * files and cCompression::Decompression_JPEG() reads them; the color
+ * container (see cCompressionCouleur) stores its tables the same way.
+ */
+
+#ifndef JPEG_COMPRESSOR_CFORMATHUF2_H
+#define JPEG_COMPRESSOR_CFORMATHUF2_H
+
+/** @brief The magic number that starts a HUF2 file. */
+inline constexpr char kMagiqueHuf2[4] = { 'H', 'U', 'F', '2' };
+
+/** @brief Table mode: the code lengths follow (16 counts per length, then the symbols in canonical order). */
+inline constexpr unsigned char kTableIntegree = 0;
+
+/** @brief Table mode: the identifier and version (u16 each) of a registered static table follow. */
+inline constexpr unsigned char kTableStatique = 1;
+
+/** @brief Tag of the restart-interval extension that follows the width/height trailer. */
+inline constexpr char kTagRestart[4] = { 'R', 'S', 'T', '1' };
+
+/** @brief Tag of the quality extension, written after the restart segments so that older readers ignore it. */
+inline constexpr char kTagQualite[4] = { 'Q', 'L', 'T', '1' };
+
+/** @brief Tag of the seek index extension, written after the quality extension. */
+inline constexpr char kTagIndex[4] = { 'I', 'D', 'X', '1' };
+
+/** @brief Tag of the transposed quantization extension, written after the seek index. */
+inline constexpr char kTagTransposee[4] = { 'Q', 'T', 'R', '1' };
+
+#endif // JPEG_COMPRESSOR_CFORMATHUF2_H
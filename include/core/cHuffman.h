@@ -14,6 +14,10 @@
 #include <iostream>
 #include <functional>
 #include <map>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/cStatistiques.h"
 
 
 /**
@@ -63,6 +67,24 @@ struct compare {
     }
 };
 
+/**
+ * @struct sEntreeDecodage
+ * @brief One entry of the lookup table used by cHuffman::Decoder().
+ *
+ * Indexed by the next cHuffman::kBitsTable bits of the stream. For codes of
+ * at most kBitsTable bits, the entry gives the symbol and the code length
+ * directly; for longer codes, mlongueur is 0 and mnoeud is the tree node
+ * reached after kBitsTable bits, from which the decoder walks bit by bit.
+ */
+struct sEntreeDecodage {
+    /** @brief The decoded symbol (when mlongueur != 0). */
+    char msymbole;
+    /** @brief The code length in bits, or 0 for the long-code slow path. */
+    uint8_t mlongueur;
+    /** @brief The subtree to continue from on the slow path. */
+    sNoeud *mnoeud;
+};
+
 /**
  * @class cHuffman
  * @brief Manages the creation of a Huffman tree and the generation of codes.
@@ -79,6 +101,20 @@ private:
     unsigned int mLongueur;
     /** @brief The root node of the constructed Huffman tree. */
     sNoeud *mRacine;
+    /** @brief Lookup table indexed by the next kBitsTable bits, rebuilt with the tree. */
+    std::vector<sEntreeDecodage> mTableDecodage;
+    /** @brief Storage of the trees built by ConstruireDepuisLongueurs(), kept to be reused. */
+    std::vector<sNoeud> mNoeuds;
+    /** @brief True if mRacine lives in mNoeuds rather than in individually allocated nodes. */
+    bool mRacineReservee;
+
+    /** @brief (Private Helper) Frees the current tree, or forgets it if it lives in mNoeuds. */
+    void LibererArbre();
+
+    /** @brief (Private Helper) Rebuilds mTableDecodage from mRacine. */
+    void ConstruireTableDecodage();
+
+    friend class cLecteurHuffman;
 
     /**
      * @brief (Private Helper) Recursively builds the Huffman code table.
@@ -99,6 +135,12 @@ private:
     static std::vector<char> HuffmanDecodeFile(const char *filename,
                                            cHuffman &h);
 public:
+    /** @brief Number of bits resolved by one lookup in the decoding table. */
+    static const int kBitsTable = 10;
+
+    /** @brief Maximum length of the canonical codes (as in baseline JPEG). */
+    static const int kLongueurMax = 16;
+
     /**
      * @brief Default constructor. Initializes root to nullptr.
      */
@@ -144,6 +186,44 @@ public:
      */
     void HuffmanCodes(char *Donnee, double *Frequence, unsigned int Taille);
 
+    /**
+     * @brief Computes length-limited Huffman code lengths from symbol counts.
+     *
+     * Lengths come from the usual Huffman merge on integer counts; if some
+     * exceed LongueurMax they are redistributed with the procedure of JPEG
+     * Annex K.3, which keeps the code complete. A lone symbol gets length 1.
+     * Works in fixed-size local arrays (no heap allocation).
+     *
+     * @param[in] Comptes The number of occurrences of each byte value (indexed as unsigned char).
+     * @param[out] Longueurs The code length of each byte value, 0 for absent symbols.
+     * @param[in] LongueurMax The maximum code length (at most 32).
+     */
+    static void CalculerLongueurs(const uint32_t Comptes[256], uint8_t Longueurs[256], int LongueurMax = kLongueurMax);
+
+    /**
+     * @brief Assigns canonical codes from code lengths.
+     *
+     * Symbols are ordered by length, then by byte value; each code is the
+     * previous one plus one, shifted left when the length grows.
+     *
+     * @param[in] Longueurs The code length of each byte value (0 = absent).
+     * @param[out] Codes The code of each byte value, right-aligned.
+     */
+    static void CodesCanoniques(const uint8_t Longueurs[256], uint32_t Codes[256]);
+
+    /**
+     * @brief Builds the decoding tree and lookup table from canonical code lengths.
+     *
+     * Replaces HuffmanCodes() on the decoder side when the lengths are known,
+     * so no frequency table has to be transmitted or merged. The nodes and
+     * the table reuse the storage of the previous call: rebuilding a
+     * decoder of no larger size allocates nothing.
+     *
+     * @param[in] Longueurs The code length of each byte value (0 = absent).
+     * @return False if the lengths do not describe a valid prefix code.
+     */
+    bool ConstruireDepuisLongueurs(const uint8_t Longueurs[256]);
+
     /**
      * @brief Displays the Huffman codes for all symbols by traversing the tree.
      * @param Racine The node to start traversal from (typically the root).
@@ -151,6 +231,22 @@ public:
      */
     void AfficherHuffman(sNoeud *Racine);
 
+    /**
+     * @brief Decodes a Huffman bitstream with the tree built by HuffmanCodes().
+     *
+     * Bits are read MSB first through a 64-bit buffer; each symbol costs one
+     * table lookup, except for codes longer than kBitsTable bits, which
+     * finish with a walk down the tree. A trailing incomplete code is ignored.
+     *
+     * @param[in] payload The encoded bytes.
+     * @param[in] taille The number of bytes available in payload.
+     * @param[in] debut The index of the first bit to decode.
+     * @param[in] nbBits The number of bits to decode.
+     * @param[out] sortie Receives the decoded symbols (appended).
+     * @return False if no tree is built, if the tree has a single leaf, or if the bit range exceeds the payload.
+     */
+    bool Decoder(const unsigned char *payload, size_t taille, uint64_t debut, uint64_t nbBits, std::vector<char> &sortie) const;
+
     /**
      * @brief Populates a map with symbol-to-code mappings by traversing the tree.
      * @param[out] table A map where the key is the symbol and the value is the Huffman code string.
@@ -158,5 +254,148 @@ public:
     void BuildTableCodes(std::map<char, std::string> &table);
 };
 
+/**
+ * @class cLecteurHuffman
+ * @brief Decodes the symbols of a bit range one at a time, for callers that consume them as they go.
+ *
+ * Uses the lookup table of a cHuffman (which must outlive the reader) with
+ * the same 64-bit MSB-first buffer as cHuffman::Decoder(); bytes past the
+ * end of the payload read as zero.
+ */
+class cLecteurHuffman {
+private:
+    /** @brief The code tables. */
+    const cHuffman *mHuffman;
+    /** @brief The payload. */
+    const unsigned char *mPayload;
+    /** @brief The payload size in bytes. */
+    size_t mTaille;
+    /** @brief The next byte to load into mTampon. */
+    size_t mOctet;
+    /** @brief Pending bits, MSB-aligned. */
+    uint64_t mTampon;
+    /** @brief Number of valid bits in mTampon. */
+    int mNbDispo;
+    /** @brief Bits of the range not consumed yet. */
+    uint64_t mRestants;
+    /** @brief Set when the bits do not form a valid code. */
+    bool mErreur;
+    /** @brief Symbols decoded so far (counted only when JPEG_STATS is on). */
+    uint64_t mNbSymboles;
+
+    /** @brief Tops mTampon up to at least 57 bits. */
+    inline void remplir()
+    {
+        while (mNbDispo <= 56) {
+            uint64_t b = (mOctet < mTaille) ? mPayload[mOctet] : 0;
+            ++mOctet;
+            mTampon |= b << (56 - mNbDispo);
+            mNbDispo += 8;
+        }
+    }
+
+    /** @brief Drops n bits from the front of mTampon. */
+    inline void consommer(int n)
+    {
+        mTampon = (n == 64) ? 0 : (mTampon << n);
+        mNbDispo -= n;
+    }
+
+    /** @brief Decodes a code longer than cHuffman::kBitsTable bits. */
+    int lireLong(const sEntreeDecodage &e);
+
+public:
+    /**
+     * @brief Starts reading a bit range.
+     * @param huffman The code tables (see cHuffman::ConstruireDepuisLongueurs()).
+     * @param payload The bitstream.
+     * @param taille Its size in bytes.
+     * @param debut The first bit to decode.
+     * @param nbBits The number of bits to decode.
+     */
+    cLecteurHuffman(const cHuffman &huffman, const unsigned char *payload, size_t taille, uint64_t debut, uint64_t nbBits);
+
+    /**
+     * @brief Decodes the next symbol.
+     * @return The symbol as a byte value (0-255), or -1 at the end of the range
+     *         (an incomplete trailing code is ignored) or on invalid bits (see erreur()).
+     */
+    inline int lire()
+    {
+        if (mRestants == 0 || mErreur) return -1;
+        remplir();
+        const sEntreeDecodage &e = mHuffman->mTableDecodage[static_cast<size_t>(mTampon >> (64 - cHuffman::kBitsTable))];
+        if (e.mlongueur == 0) return lireLong(e);
+        if (e.mlongueur > mRestants) { mRestants = 0; return -1; }
+        consommer(e.mlongueur);
+        mRestants -= e.mlongueur;
+        if (kStatistiques) ++mNbSymboles;
+        return static_cast<unsigned char>(e.msymbole);
+    }
+
+    /**
+     * @brief Switches to other code tables for the following symbols.
+     *
+     * Streams mixing codes of several tables (e.g. luma and chroma blocks)
+     * are read by switching at each change of component.
+     *
+     * @param huffman The new code tables; must be built and outlive the reader.
+     */
+    void setTable(const cHuffman &huffman) { mHuffman = &huffman; }
+
+    /** @brief Tells whether invalid bits were met. */
+    bool erreur() const { return mErreur; }
+
+    /** @brief Gets the number of bits of the range not consumed yet. */
+    uint64_t getRestants() const { return mRestants; }
+
+    /** @brief Gets the number of symbols decoded so far (0 when JPEG_STATS is off). */
+    uint64_t getNbSymboles() const { return mNbSymboles; }
+};
+
+/**
+ * @class cEcrivainBits
+ * @brief Appends variable-length codes to a byte vector, MSB first, through a 64-bit accumulator.
+ */
+class cEcrivainBits {
+private:
+    /** @brief The destination buffer. */
+    std::vector<unsigned char> &mSortie;
+    /** @brief Pending bits, right-aligned (only the low mNbBits are meaningful). */
+    uint64_t mAccumulateur;
+    /** @brief Number of pending bits, always < 8 between calls. */
+    int mNbBits;
+    /** @brief Number of code bits written so far, padding excluded. */
+    uint64_t mTotal;
+
+public:
+    /**
+     * @brief Starts writing at the end of a buffer.
+     * @param sortie The buffer to append to.
+     */
+    explicit cEcrivainBits(std::vector<unsigned char> &sortie);
+
+    /**
+     * @brief Appends one code.
+     * @param code The code, right-aligned.
+     * @param longueur Its length in bits (at most 32).
+     */
+    inline void ecrire(uint32_t code, int longueur)
+    {
+        mAccumulateur = (mAccumulateur << longueur) | code;
+        mNbBits += longueur;
+        mTotal += static_cast<uint64_t>(longueur);
+        while (mNbBits >= 8) {
+            mNbBits -= 8;
+            mSortie.push_back(static_cast<unsigned char>(mAccumulateur >> mNbBits));
+        }
+    }
+
+    /** @brief Pads with zero bits up to the next byte boundary and flushes. */
+    void aligner();
+
+    /** @brief Gets the number of code bits written, padding excluded. */
+    uint64_t getNbBits() const;
+};
 
 #endif //JPEG_COMPRESSOR_CHUFFMAN_H
@@ -0,0 +1,236 @@
+/**
+ * @file cImage.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines the image readers and writers: binary PGM/PPM and the text .img format.
+ */
+
+#ifndef JPEG_COMPRESSOR_CIMAGE_H
+#define JPEG_COMPRESSOR_CIMAGE_H
+
+#include "cFichierMappe.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct sVueImage
+ * @brief A read-only, strided view of 8-bit pixels: gray (1 channel) or interleaved RGB (3 channels).
+ */
+struct sVueImage {
+    const unsigned char *pixels = nullptr; ///< The first pixel of the first row.
+    unsigned int largeur = 0;              ///< Width in pixels.
+    unsigned int hauteur = 0;              ///< Height in pixels.
+    unsigned int canaux = 0;               ///< 1 (gray) or 3 (RGB).
+    size_t pas = 0;                        ///< Distance between two rows, in bytes.
+
+    /** @brief Gets the first pixel of row y. */
+    const unsigned char *ligne(unsigned int y) const { return pixels + static_cast<size_t>(y) * pas; }
+};
+
+/**
+ * @enum eFormatImage
+ * @brief The formats read by cLecteurImage.
+ */
+enum eFormatImage {
+    IMAGE_INCONNUE = 0, ///< Nothing open, or not recognized.
+    IMAGE_PGM,          ///< Binary PGM (P5).
+    IMAGE_PPM,          ///< Binary PPM (P6).
+    IMAGE_TEXTE         ///< Whitespace-separated gray levels, one image row per line (.img).
+};
+
+/**
+ * @struct sEntetePNM
+ * @brief The header of a binary PGM or PPM file.
+ */
+struct sEntetePNM {
+    eFormatImage format = IMAGE_INCONNUE; ///< IMAGE_PGM or IMAGE_PPM.
+    unsigned int largeur = 0;             ///< Width in pixels.
+    unsigned int hauteur = 0;             ///< Height in pixels.
+    unsigned int maxval = 0;              ///< Largest sample value (1..65535; above 255, samples take two bytes).
+    size_t debutPixels = 0;               ///< Offset of the first sample in the file.
+};
+
+/**
+ * @class cLecteurImage
+ * @brief Opens an image file and exposes its pixels as a sVueImage.
+ *
+ * The file is memory-mapped (cFichierMappe). An 8-bit PGM or PPM is read
+ * in place: the view points into the mapping and no pixel is copied, so
+ * it can be handed straight to the encoders. Other maxvals (16-bit files,
+ * or fewer than 8 bits) are rescaled to 0..255 into an owned buffer, unless
+ * the reader is told to refuse them. A text .img file is parsed in one
+ * pass with std::from_chars.
+ */
+class cLecteurImage {
+private:
+    /** @brief The mapped file. */
+    cFichierMappe mFichier;
+    /** @brief The pixels when they cannot be read in place. */
+    std::vector<unsigned char> mPixels;
+    /** @brief The view of the pixels. */
+    sVueImage mVue;
+    /** @brief The format of the open file. */
+    eFormatImage mFormat;
+    /** @brief The maxval of the file (255 for a text image). */
+    unsigned int mMaxval;
+    /** @brief Why the last ouvrir() failed. */
+    const char *mErreur;
+
+public:
+    /** @brief Creates a reader with nothing open. */
+    cLecteurImage();
+
+    cLecteurImage(const cLecteurImage &) = delete;
+    cLecteurImage &operator=(const cLecteurImage &) = delete;
+
+    /**
+     * @brief Opens an image, replacing any previously opened one.
+     *
+     * The format is recognized from the contents: a "P5" or "P6" magic
+     * number, otherwise a text image.
+     *
+     * @param chemin The path of the file.
+     * @param accepterAutresProfondeurs False to refuse any maxval other than 255 instead of rescaling.
+     * @return True on success; getErreur() tells why otherwise.
+     */
+    bool ouvrir(const char *chemin, bool accepterAutresProfondeurs = true);
+
+    /** @brief Releases the current image, if any. */
+    void fermer();
+
+    /**
+     * @brief Gets the pixels.
+     * @return The view (empty when nothing is open); valid until the reader is closed or reopened.
+     */
+    const sVueImage &getVue() const;
+
+    /**
+     * @brief Gets the format of the open image.
+     * @return The format, IMAGE_INCONNUE if nothing is open.
+     */
+    eFormatImage getFormat() const;
+
+    /**
+     * @brief Gets the maxval of the file.
+     * @return The maxval as stored; the view is always 8-bit.
+     */
+    unsigned int getMaxval() const;
+
+    /**
+     * @brief Tells whether the view points into the mapped file.
+     * @return True if no pixel was copied.
+     */
+    bool estEnPlace() const;
+
+    /**
+     * @brief Gets the reason of the last failure of ouvrir().
+     * @return A short message, or an empty string.
+     */
+    const char *getErreur() const;
+
+    /**
+     * @brief Parses the header of a binary PGM (P5) or PPM (P6) held in memory.
+     *
+     * Comments are skipped. The header is refused if the pixel data it
+     * announces does not fit in the given bytes.
+     *
+     * @param Donnees The file contents.
+     * @param Taille The size of the contents in bytes.
+     * @param[out] entete The header.
+     * @return True if the header is valid.
+     */
+    static bool LireEntetePNM(const unsigned char *Donnees, size_t Taille, sEntetePNM &entete);
+
+    /**
+     * @brief Parses a text image held in memory.
+     *
+     * The width is the number of values on the first line; every line must
+     * be complete. Values outside 0..255 are clamped.
+     *
+     * @param Donnees The text.
+     * @param Taille Its size in bytes.
+     * @param[out] pixels The gray levels, rows one after the other (replaced; keeps its capacity).
+     * @param[out] largeur The width.
+     * @param[out] hauteur The height.
+     * @return False on a token that is not an integer, an empty first line or an incomplete last row.
+     */
+    static bool ParserTexte(const char *Donnees, size_t Taille, std::vector<unsigned char> &pixels,
+                            unsigned int &largeur, unsigned int &hauteur);
+};
+
+/**
+ * @class cEcrivainImage
+ * @brief Creates a binary PGM or PPM file whose pixels are written in place.
+ *
+ * On POSIX systems the output file is sized up front and memory-mapped:
+ * a decoder writes its rows straight into the file. Elsewhere, or if the
+ * mapping fails, the pixels go to an owned buffer written out by fermer().
+ */
+class cEcrivainImage {
+private:
+    /** @brief The path of the file being written. */
+    const char *mChemin;
+    /** @brief The mapping of the whole file, or nullptr. */
+    unsigned char *mCarte;
+    /** @brief The size of the file. */
+    size_t mTaille;
+    /** @brief The size of the header. */
+    size_t mEntete;
+    /** @brief The whole file when it is not mapped. */
+    std::vector<unsigned char> mTampon;
+    /** @brief The layout of the pixels. */
+    unsigned int mLargeur, mHauteur, mCanaux;
+
+public:
+    /** @brief Creates a writer with nothing open. */
+    cEcrivainImage();
+
+    /** @brief Finishes the current file, if any. */
+    ~cEcrivainImage();
+
+    cEcrivainImage(const cEcrivainImage &) = delete;
+    cEcrivainImage &operator=(const cEcrivainImage &) = delete;
+
+    /**
+     * @brief Creates (or truncates) a file of the given size; its pixels are then filled through getPixels().
+     * @param chemin The path; it must stay valid until fermer().
+     * @param largeur Width in pixels.
+     * @param hauteur Height in pixels.
+     * @param canaux 1 for a PGM, 3 for a PPM.
+     * @return False if the file cannot be created.
+     */
+    bool ouvrir(const char *chemin, unsigned int largeur, unsigned int hauteur, unsigned int canaux);
+
+    /**
+     * @brief Gets the first pixel to fill; rows are getPas() bytes apart.
+     * @return The pixels, or nullptr if nothing is open.
+     */
+    unsigned char *getPixels();
+
+    /**
+     * @brief Gets the distance between two rows.
+     * @return largeur * canaux.
+     */
+    size_t getPas() const;
+
+    /**
+     * @brief Finishes the file: unmaps it, or writes the buffer out.
+     * @return True if the file is complete.
+     */
+    bool fermer();
+
+    /**
+     * @brief Drops the current file without finishing it (the partial file is removed).
+     */
+    void abandonner();
+
+    /**
+     * @brief Writes an image in one call.
+     * @param chemin The path.
+     * @param vue The pixels (1 or 3 channels).
+     * @return True on success.
+     */
+    static bool Ecrire(const char *chemin, const sVueImage &vue);
+};
+
+#endif // JPEG_COMPRESSOR_CIMAGE_H
@@ -0,0 +1,141 @@
+/**
+ * @file cStatistiques.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines the opt-in instrumentation of the codec: per-call counters, stage timers and a trace hook.
+ */
+
+#ifndef JPEG_COMPRESSOR_CSTATISTIQUES_H
+#define JPEG_COMPRESSOR_CSTATISTIQUES_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @def JPEG_STATS
+ * @brief 1 to compile the counters, timers and trace hook in, 0 to remove them.
+ *
+ * Set by the build (CMake option JPEG_STATS). With 0, the codec ignores
+ * setStatistiques() and setTrace(): no counter is updated, no clock is read
+ * and no message is formatted.
+ */
+#ifndef JPEG_STATS
+#define JPEG_STATS 1
+#endif
+
+/** @brief True when the instrumentation is compiled in. */
+constexpr bool kStatistiques = (JPEG_STATS != 0);
+
+/**
+ * @enum eEtapeCodec
+ * @brief The stages whose time is measured.
+ *
+ * When the dequantization is fused into the inverse DCT (floating-point
+ * decoder), its time is counted as ETAPE_DCT. ETAPE_HUFFMAN covers the
+ * table construction and the bit coding; on the decoder side it also
+ * covers the expansion of the RLE pairs, which happens as symbols are read.
+ */
+enum eEtapeCodec {
+    ETAPE_COULEUR = 0, ///< Color conversion, subsampling and upsampling.
+    ETAPE_DCT,         ///< Level shift and forward or inverse DCT.
+    ETAPE_QUANT,       ///< Quantization (zigzag order) or dequantization.
+    ETAPE_RLE,         ///< Run-length coding of the quantized blocks.
+    ETAPE_HUFFMAN,     ///< Huffman tables and bitstream.
+    NB_ETAPES_CODEC
+};
+
+/**
+ * @struct sStatistiques
+ * @brief Counters and stage times filled by the codec calls of an instance.
+ *
+ * Every call adds to the counters: call reinitialiser() before a call to
+ * get its own figures. Times are in seconds; a stage that runs on the pool
+ * has its time summed over the workers, so with several threads the stage
+ * times can exceed the elapsed time.
+ */
+struct sStatistiques {
+    /** @brief Bytes read: pixels for an encoder, compressed bytes for a decoder. */
+    uint64_t octetsEntree = 0;
+    /** @brief Bytes produced: compressed bytes for an encoder, pixels for a decoder. */
+    uint64_t octetsSortie = 0;
+    /** @brief 8x8 blocks coded or decoded. */
+    uint64_t blocs = 0;
+    /** @brief Huffman symbols (RLE bytes) coded or decoded. */
+    uint64_t symboles = 0;
+    /** @brief Restart segments replaced by flat blocks because they did not decode. */
+    uint64_t segmentsCorrompus = 0;
+    /** @brief Time spent in each stage. */
+    double secondes[NB_ETAPES_CODEC] = {};
+
+    /** @brief Sets everything back to zero. */
+    void reinitialiser();
+
+    /**
+     * @brief Adds the figures of another record (one worker's share of a call).
+     * @param autre The record to add.
+     */
+    void ajouter(const sStatistiques &autre);
+
+    /**
+     * @brief Gets the sum of the stage times.
+     * @return The time in seconds.
+     */
+    double secondesTotal() const;
+
+    /**
+     * @brief Gets the short name of a stage ("color", "dct", "quant", "rle", "huffman").
+     * @param etape The stage.
+     * @return The name.
+     */
+    static const char *nomEtape(eEtapeCodec etape);
+};
+
+/**
+ * @brief Receives one human-readable line per notable event of a call
+ *        (header parsed, grid inferred, corrupted segment...), without a trailing newline.
+ */
+using fTraceCodec = std::function<void(const char *message)>;
+
+/**
+ * @brief Formats a message and passes it to a trace hook; does nothing (formats nothing) without a hook.
+ * @param trace The hook (may be empty).
+ * @param format A printf format.
+ */
+void tracer_codec(const fTraceCodec &trace, const char *format, ...)
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+/**
+ * @class cChronoEtape
+ * @brief Adds the time of a scope to one stage of a record; nothing is measured without a record.
+ */
+class cChronoEtape {
+#if JPEG_STATS
+private:
+    sStatistiques *mStats;
+    eEtapeCodec mEtape;
+    std::chrono::steady_clock::time_point mDebut;
+
+public:
+    cChronoEtape(sStatistiques *stats, eEtapeCodec etape) : mStats(stats), mEtape(etape)
+    {
+        if (mStats) mDebut = std::chrono::steady_clock::now();
+    }
+
+    ~cChronoEtape()
+    {
+        if (mStats) mStats->secondes[mEtape] += std::chrono::duration<double>(std::chrono::steady_clock::now() - mDebut).count();
+    }
+#else
+public:
+    cChronoEtape(sStatistiques *, eEtapeCodec) {}
+#endif
+
+    cChronoEtape(const cChronoEtape &) = delete;
+    cChronoEtape &operator=(const cChronoEtape &) = delete;
+};
+
+#endif // JPEG_COMPRESSOR_CSTATISTIQUES_H
@@ -0,0 +1,139 @@
+/**
+ * @file cTablesHuffman.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines cTablesHuffman, the registry of static Huffman tables that files reference by identifier.
+ */
+
+#ifndef JPEG_COMPRESSOR_CTABLESHUFFMAN_H
+#define JPEG_COMPRESSOR_CTABLESHUFFMAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+/**
+ * @struct sTableHuffman
+ * @brief A static code table: every byte value has a code, so any trame can be coded with it.
+ */
+struct sTableHuffman {
+    /** @brief The identifier written in the files that use the table. */
+    uint16_t id;
+    /** @brief The version of the table under this identifier (1 and up). */
+    uint16_t version;
+    /** @brief A descriptive name, for listings and traces. */
+    std::string nom;
+    /** @brief The code length of each byte value (1 to cHuffman::kLongueurMax). */
+    uint8_t Longueurs[256];
+    /** @brief The canonical code of each byte value, right-aligned. */
+    uint32_t Codes[256];
+};
+
+/**
+ * @class cTablesHuffman
+ * @brief The static Huffman tables known to the process, looked up by identifier and version.
+ *
+ * A file coded with a static table stores a 4-byte reference (identifier,
+ * version) instead of its code lengths, and the encoder makes a single pass
+ * over the trame since no histogram is needed. The decoder must know the
+ * same table: the built-in one (kIdDefaut, version 1, the table of
+ * cEncodeurFlux) is always registered, others are loaded from the files
+ * written by Ecrire(), typically trained with Entrainer() on a corpus.
+ *
+ * Registration and lookup are synchronized; registered tables are never
+ * moved or removed, so the pointers returned by trouver() stay valid for
+ * the lifetime of the registry.
+ */
+class cTablesHuffman {
+private:
+    /** @brief Guards mTables. */
+    mutable std::mutex mVerrou;
+    /** @brief The registered tables, in registration order (a deque keeps them in place). */
+    std::deque<sTableHuffman> mTables;
+
+public:
+    /** @brief The identifier of the built-in table. */
+    static const uint16_t kIdDefaut = 1;
+
+    /** @brief Creates a registry holding the built-in table. */
+    cTablesHuffman();
+
+    cTablesHuffman(const cTablesHuffman &) = delete;
+    cTablesHuffman &operator=(const cTablesHuffman &) = delete;
+
+    /**
+     * @brief Registers a table.
+     *
+     * Registering the same lengths twice under one identifier and version is
+     * accepted and changes nothing.
+     *
+     * @param id The identifier (not 0).
+     * @param version The version (not 0).
+     * @param nom A descriptive name.
+     * @param Longueurs The code length of every byte value.
+     * @return False if some byte value has no code or a code longer than
+     *         cHuffman::kLongueurMax bits, if the lengths do not form a prefix
+     *         code, or if another table has this identifier and version.
+     */
+    bool enregistrer(uint16_t id, uint16_t version, const char *nom, const uint8_t Longueurs[256]);
+
+    /**
+     * @brief Finds a table.
+     * @param id The identifier.
+     * @param version The version, or 0 for the highest registered one.
+     * @return The table, or nullptr if it is not registered.
+     */
+    const sTableHuffman *trouver(uint16_t id, uint16_t version = 0) const;
+
+    /**
+     * @brief Registers the table stored in a file written by Ecrire().
+     * @param chemin The path of the file.
+     * @param[out] table Receives the registered table (may be nullptr).
+     * @return False if the file cannot be read, is malformed, or conflicts with a registered table.
+     */
+    bool charger(const char *chemin, const sTableHuffman **table = nullptr);
+
+    /**
+     * @brief Gets the number of registered tables.
+     * @return At least 1 (the built-in table).
+     */
+    size_t getNombre() const;
+
+    /**
+     * @brief Gets a registered table.
+     * @param i The index, below getNombre(), in registration order.
+     * @return The table.
+     */
+    const sTableHuffman &getTable(size_t i) const;
+
+    /**
+     * @brief Writes a table to a file: 'HTB1', identifier and version (u16),
+     *        name length (u8) and name, then the 256 code lengths.
+     * @param chemin The path of the file.
+     * @param table The table.
+     * @return False if the file cannot be written.
+     */
+    static bool Ecrire(const char *chemin, const sTableHuffman &table);
+
+    /**
+     * @brief Builds the code lengths of a static table from the symbol counts of a corpus.
+     *
+     * Every byte value is counted once more than it occurred, so that symbols
+     * the corpus never produced still get a (long) code; counts too large for
+     * cHuffman::CalculerLongueurs() are scaled down first.
+     *
+     * @param[in] Comptes The occurrences of each byte value in the RLE trames of the corpus.
+     * @param[out] Longueurs The code length of each byte value.
+     */
+    static void Entrainer(const uint64_t Comptes[256], uint8_t Longueurs[256]);
+
+    /**
+     * @brief Gets the process-wide registry, used by the encoders and decoders.
+     * @return The registry.
+     */
+    static cTablesHuffman &global();
+};
+
+#endif // JPEG_COMPRESSOR_CTABLESHUFFMAN_H
@@ -0,0 +1,89 @@
+/**
+ * @file cThreadPool.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Defines cThreadPool, a fixed-size pool of worker threads used by the parallel encoders.
+ */
+
+#ifndef JPEG_COMPRESSOR_CTHREADPOOL_H
+#define JPEG_COMPRESSOR_CTHREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class cThreadPool
+ * @brief A fixed set of worker threads consuming a shared FIFO of tasks.
+ *
+ * The threads are started by the constructor and joined by the destructor,
+ * after the queue has been drained. The pool can be shared: several callers
+ * may submit work concurrently.
+ */
+class cThreadPool {
+private:
+    /** @brief The worker threads. */
+    std::vector<std::thread> mThreads;
+    /** @brief Pending tasks, in submission order. */
+    std::deque<std::function<void()>> mFile;
+    /** @brief Protects mFile and mArret. */
+    std::mutex mMutex;
+    /** @brief Signalled when a task is queued or the pool stops. */
+    std::condition_variable mCond;
+    /** @brief Set by the destructor to let the workers exit. */
+    bool mArret;
+
+    /** @brief The loop run by each worker thread. */
+    void boucle();
+
+public:
+    /**
+     * @brief Starts the worker threads.
+     * @param nbThreads The number of threads (0 selects nbThreadsMateriel()).
+     */
+    explicit cThreadPool(unsigned int nbThreads);
+
+    /**
+     * @brief Runs the remaining tasks, then stops and joins the threads.
+     */
+    ~cThreadPool();
+
+    cThreadPool(const cThreadPool &) = delete;
+    cThreadPool &operator=(const cThreadPool &) = delete;
+
+    /**
+     * @brief Gets the number of worker threads.
+     * @return The thread count.
+     */
+    unsigned int getNbThreads() const;
+
+    /**
+     * @brief Queues a task for asynchronous execution.
+     * @param tache The task to run on one of the worker threads.
+     */
+    void soumettre(std::function<void()> tache);
+
+    /**
+     * @brief Runs tache(0) ... tache(nbTaches - 1) on the pool and waits for all of them.
+     *
+     * The calling thread takes part in the work, so this may be called from
+     * within a task without risking a deadlock. Indices are handed out in
+     * increasing order, but may complete in any order.
+     *
+     * @param nbTaches The number of indices to process.
+     * @param tache The work for one index.
+     */
+    void paralleliser(size_t nbTaches, const std::function<void(size_t)> &tache);
+
+    /**
+     * @brief Gets the number of hardware threads, or 1 if it cannot be determined.
+     * @return The hardware concurrency.
+     */
+    static unsigned int nbThreadsMateriel();
+};
+
+#endif // JPEG_COMPRESSOR_CTHREADPOOL_H
@@ -0,0 +1,137 @@
+/**
+ * @file couleur.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Declares the fixed-point color conversion front and back ends and their runtime-dispatched row kernels.
+ *
+ * The conversions use the JFIF (BT.601 full-range) matrix in 16-bit fixed
+ * point, as libjpeg does. The row kernels work on interleaved RGB; a scalar
+ * implementation is always available and vectorized ones are selected on
+ * first use from the capabilities of the running CPU, as for the block
+ * kernels (see dct_kernels.h). Being integer-only, all implementations
+ * produce identical results.
+ */
+
+#ifndef JPEG_COMPRESSOR_COULEUR_H
+#define JPEG_COMPRESSOR_COULEUR_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct sCouleurKernels
+ * @brief A set of color conversion kernels for one instruction set.
+ */
+struct sCouleurKernels {
+    /** @brief Name of the instruction set ("scalar" or "sse4.1"). */
+    const char *nom;
+
+    /**
+     * @brief Converts one row of interleaved RGB pixels.
+     *
+     * Y is rounded to 8 bits. The chroma values are left unrounded and
+     * without their +128 offset, scaled by 2^16, so that the subsampling can
+     * add those of several pixels before rounding once.
+     *
+     * @param[in] RGB n pixels, 3 bytes each.
+     * @param[in] n The number of pixels.
+     * @param[out] Y n luma samples.
+     * @param[out] Cb n chroma values (-11059 R - 21709 G + 32768 B).
+     * @param[out] Cr n chroma values (32768 R - 27439 G - 5329 B).
+     */
+    void (*rgb_ycbcr)(const uint8_t *RGB, size_t n, uint8_t *Y, int32_t *Cb, int32_t *Cr);
+
+    /**
+     * @brief Converts one row of full-resolution Y, Cb and Cr samples to interleaved RGB.
+     * @param[in] Y n luma samples.
+     * @param[in] Cb n blue-difference samples.
+     * @param[in] Cr n red-difference samples.
+     * @param[in] n The number of pixels.
+     * @param[out] RGB n pixels, 3 bytes each, clamped to [0, 255].
+     */
+    void (*ycbcr_rgb)(const uint8_t *Y, const uint8_t *Cb, const uint8_t *Cr, size_t n, uint8_t *RGB);
+};
+
+/**
+ * @enum eModeSurechantillonnage
+ * @brief Chroma upsampling filter of the decoder back end.
+ */
+enum eModeSurechantillonnage {
+    SURECHANTILLONNAGE_TRIANGLE = 0, ///< Triangle filter ("fancy" upsampling): 3:1 weights of the two nearest samples on each axis (default).
+    SURECHANTILLONNAGE_PROCHE = 1    ///< Nearest sample: each chroma sample is replicated over the pixels it covers.
+};
+
+/**
+ * @brief Returns the kernels selected for the running CPU.
+ *
+ * The choice is made once and cached. The JPEG_COULEUR_KERNELS environment
+ * variable ("scalar", "sse4.1") forces a given set when it is supported.
+ */
+const sCouleurKernels &couleur_kernels();
+
+/**
+ * @brief Returns the portable scalar kernels, the reference for all other implementations.
+ */
+const sCouleurKernels &couleur_kernels_scalar();
+
+/**
+ * @brief Looks up a kernel set by name.
+ * @param nom The instruction set name.
+ * @return The kernel set, or nullptr if it is not compiled in or not supported by this CPU.
+ */
+const sCouleurKernels *couleur_kernels_by_name(const char *nom);
+
+/**
+ * @brief Converts and subsamples one MCU row of an RGB image in a single pass.
+ *
+ * Reads interleaved RGB and writes the luma stripe and the subsampled
+ * chroma stripes directly at their padded size: pixels past the right or
+ * bottom edge replicate the last column and row. Each chroma sample is the
+ * average of the facteurH x facteurV pixels it covers, rounded once.
+ *
+ * @param[in] RGB The first of nbLignes rows of largeur RGB pixels.
+ * @param[in] pasRGB The distance between two RGB rows, in bytes (at least 3 * largeur).
+ * @param[in] largeur The image width in pixels.
+ * @param[in] nbLignes The number of rows available (1 to 8 * facteurV).
+ * @param[in] facteurH Horizontal subsampling factor (1 or 2).
+ * @param[in] facteurV Vertical subsampling factor (1 or 2).
+ * @param[in] largeurY The padded luma width, a multiple of 8 * facteurH, at least largeur.
+ * @param[out] Y 8 * facteurV rows of largeurY luma samples.
+ * @param[out] Cb 8 rows of largeurY / facteurH chroma samples.
+ * @param[out] Cr 8 rows of largeurY / facteurH chroma samples.
+ */
+void rgb_vers_ycbcr_mcu(const uint8_t *RGB, size_t pasRGB, unsigned int largeur, unsigned int nbLignes,
+                        unsigned int facteurH, unsigned int facteurV, unsigned int largeurY,
+                        uint8_t *Y, uint8_t *Cb, uint8_t *Cr);
+
+/**
+ * @brief Upsamples the chroma and converts rows [j_debut, j_fin) of an image to RGB in a single pass.
+ *
+ * Each output row is built from at most two chroma rows, so no
+ * full-resolution chroma plane is ever formed. The planes may be padded
+ * (strides larger than the image); only the largeur x hauteur pixels are
+ * written, and the chroma samples read are limited to the
+ * ceil(largeur / facteurH) x ceil(hauteur / facteurV) that cover the image.
+ * Disjoint row ranges can be converted concurrently.
+ *
+ * @param[in] Y The luma plane, at least largeur x hauteur.
+ * @param[in] pasY The stride of the luma plane, in bytes.
+ * @param[in] Cb The blue-difference plane.
+ * @param[in] Cr The red-difference plane.
+ * @param[in] pasC The stride of both chroma planes, in bytes.
+ * @param[in] largeur The image width in pixels.
+ * @param[in] hauteur The image height in pixels.
+ * @param[in] facteurH Horizontal subsampling factor (1 or 2).
+ * @param[in] facteurV Vertical subsampling factor (1 or 2).
+ * @param[in] mode The upsampling filter (ignored for 4:4:4).
+ * @param[in] j_debut The first row to convert.
+ * @param[in] j_fin One past the last row to convert.
+ * @param[out] RGB The packed output image; row j starts at RGB + j * pasRGB.
+ * @param[in] pasRGB The stride of the output image, in bytes (at least 3 * largeur).
+ */
+void ycbcr_vers_rgb_lignes(const uint8_t *Y, size_t pasY, const uint8_t *Cb, const uint8_t *Cr, size_t pasC,
+                           unsigned int largeur, unsigned int hauteur, unsigned int facteurH, unsigned int facteurV,
+                           eModeSurechantillonnage mode, unsigned int j_debut, unsigned int j_fin,
+                           uint8_t *RGB, size_t pasRGB);
+
+#endif // JPEG_COMPRESSOR_COULEUR_H
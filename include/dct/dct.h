@@ -8,6 +8,8 @@
 #ifndef JPEG_COMPRESSOR_DCT_H
 #define JPEG_COMPRESSOR_DCT_H
 
+#include <cstdint>
+
 /**
  * @brief Computes the forward 2D-DCT of an 8x8 block.
  *
@@ -32,6 +34,89 @@ void Calcul_DCT_Block(int **Bloc8x8, double **DCT_Img);
  */
 void Calcul_IDCT_Block(double **DCT_Img, int **Bloc8x8);
 
+/**
+ * @brief Computes the forward 2D-DCT of a contiguous 8x8 block.
+ *
+ * Flat counterpart of Calcul_DCT_Block(int**, double**) for callers that keep
+ * blocks in contiguous, row-major storage (element (i,j) at index i*8+j).
+ * The computation is carried out in single precision.
+ *
+ * @param[in] Bloc 64 input samples (typically level-shifted by -128).
+ * @param[out] DCT 64 output DCT coefficients.
+ */
+void Calcul_DCT_Block(const int16_t *Bloc, float *DCT);
+
+/**
+ * @brief Computes the inverse 2D-DCT of a contiguous 8x8 block.
+ *
+ * Flat counterpart of Calcul_IDCT_Block(double**, int**). Results are rounded
+ * half away from zero and saturated to the int16_t range.
+ *
+ * @param[in] DCT 64 input DCT coefficients, row-major.
+ * @param[out] Bloc 64 reconstructed spatial samples, row-major.
+ */
+void Calcul_IDCT_Block(const float *DCT, int16_t *Bloc);
+
+/**
+ * @brief Computes the forward 2D-DCT of a contiguous 8x8 block in fixed point.
+ *
+ * Integer-only transform (islow factorization, 13-bit constants): the output
+ * is bit-exact on every compiler and CPU. Coefficients are scaled by 8
+ * compared to Calcul_DCT_Block(), so quantization must divide by 8*Q.
+ *
+ * @param[in] Bloc 64 input samples, level-shifted by -128, row-major.
+ * @param[out] DCT 64 output coefficients, scaled by 8, row-major.
+ */
+void Calcul_DCT_Block_Entier(const int16_t *Bloc, int32_t *DCT);
+
+/**
+ * @brief Computes the inverse 2D-DCT of a contiguous 8x8 block in fixed point.
+ *
+ * Counterpart of Calcul_DCT_Block_Entier(), but takes unscaled (dequantized)
+ * coefficients, like Calcul_IDCT_Block(). Results are rounded to nearest and
+ * saturated to the int16_t range.
+ *
+ * @param[in] DCT 64 dequantized coefficients, row-major.
+ * @param[out] Bloc 64 reconstructed spatial samples (still level-shifted), row-major.
+ */
+void Calcul_IDCT_Block_Entier(const int32_t *DCT, int16_t *Bloc);
+
+/**
+ * @brief Inverse transform of a block whose AC coefficients are all zero.
+ *
+ * All 64 samples of such a block are equal; this gives their value without
+ * running the transform, bit-identical to Calcul_IDCT_Block() and to every
+ * dequant_idct() kernel on the dequantized block.
+ *
+ * @param Coef The quantized DC coefficient.
+ * @param Q The DC quantization step (the first entry of the float table).
+ * @return The value of every sample (still level-shifted).
+ */
+int16_t Calcul_IDCT_DC(int16_t Coef, float Q);
+
+/**
+ * @brief Fixed-point counterpart of Calcul_IDCT_DC(), bit-identical to Calcul_IDCT_Block_Entier().
+ * @param DC The dequantized DC coefficient.
+ * @return The value of every sample (still level-shifted).
+ */
+int16_t Calcul_IDCT_DC_Entier(int32_t DC);
+
+/**
+ * @brief Dequantizes the low frequencies of a block and computes a reduced inverse 2D-DCT.
+ *
+ * Only the N x N lowest-frequency coefficients are read and an N-point
+ * inverse transform is applied along each axis, scaled so that every output
+ * sample is the mean of the (8/N) x (8/N) pixels it stands for. N = 1 reduces
+ * to the DC coefficient divided by 8, without any transform. This is how the
+ * decoder produces an image at 1/2, 1/4 or 1/8 of its size.
+ *
+ * @param[in] Coefs 64 quantized coefficients, row-major.
+ * @param[in] Q The quantization table, row-major.
+ * @param[in] N The output block size: 1, 2 or 4.
+ * @param[out] Bloc N * N samples (still level-shifted), row-major, rounded half away from zero.
+ */
+void Calcul_IDCT_Reduite(const int16_t *Coefs, const float *Q, unsigned int N, int16_t *Bloc);
+
 /**
  * @brief A debugging utility to print the contents of an 8x8 DCT block to the console.
  *
@@ -0,0 +1,77 @@
+/**
+ * @file dct_kernels.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Declares the block kernels (DCT, DCT + quantization, dequantization + IDCT) and their runtime dispatch.
+ *
+ * Each kernel works on contiguous, row-major 8x8 blocks and accepts a batch of
+ * blocks laid out back to back (block b starts at index 64*b). A scalar
+ * implementation is always available; vectorized ones (SSE4.1, AVX2, NEON)
+ * are compiled in when the toolchain supports them and selected once, on
+ * first use, from the capabilities of the running CPU. All implementations
+ * produce bit-identical results.
+ */
+
+#ifndef JPEG_COMPRESSOR_DCT_KERNELS_H
+#define JPEG_COMPRESSOR_DCT_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct sDctKernels
+ * @brief A set of block kernels for one instruction set.
+ */
+struct sDctKernels {
+    /** @brief Name of the instruction set ("scalar", "sse4.1", "avx2" or "neon"). */
+    const char *nom;
+
+    /**
+     * @brief Forward DCT.
+     * @param[in] Blocs nbBlocs level-shifted 8x8 sample blocks.
+     * @param[out] DCT nbBlocs blocks of DCT coefficients, row-major.
+     * @param[in] nbBlocs Number of blocks in the batch.
+     */
+    void (*dct)(const int16_t *Blocs, float *DCT, size_t nbBlocs);
+
+    /**
+     * @brief Forward DCT followed by quantization.
+     * @param[in] Blocs nbBlocs level-shifted 8x8 sample blocks.
+     * @param[in] Q_inv 64 reciprocals of the quantization table (1/Q), row-major.
+     * @param[out] Coefs nbBlocs blocks of quantized coefficients, row-major (not zigzagged).
+     * @param[in] nbBlocs Number of blocks in the batch.
+     */
+    void (*dct_quant)(const int16_t *Blocs, const float *Q_inv, int16_t *Coefs, size_t nbBlocs);
+
+    /**
+     * @brief Dequantization followed by the inverse DCT.
+     * @param[in] Coefs nbBlocs blocks of quantized coefficients, row-major.
+     * @param[in] Q 64 quantization table values, row-major.
+     * @param[out] Blocs nbBlocs reconstructed blocks (still level-shifted, not clamped).
+     * @param[in] nbBlocs Number of blocks in the batch.
+     */
+    void (*dequant_idct)(const int16_t *Coefs, const float *Q, int16_t *Blocs, size_t nbBlocs);
+};
+
+/**
+ * @brief Returns the kernels selected for the running CPU.
+ *
+ * The choice is made once and cached. The JPEG_DCT_KERNELS environment
+ * variable ("scalar", "sse4.1", "avx2", "neon") forces a given set when it is
+ * supported, which is useful to compare implementations on one machine.
+ */
+const sDctKernels &dct_kernels();
+
+/**
+ * @brief Returns the portable scalar kernels, the reference for all other implementations.
+ */
+const sDctKernels &dct_kernels_scalar();
+
+/**
+ * @brief Looks up a kernel set by name.
+ * @param nom The instruction set name.
+ * @return The kernel set, or nullptr if it is not compiled in or not supported by this CPU.
+ */
+const sDctKernels *dct_kernels_by_name(const char *nom);
+
+#endif // JPEG_COMPRESSOR_DCT_KERNELS_H
@@ -9,6 +9,129 @@
 #define JPEG_COMPRESSOR_QUANTIFICATION_H
 
 #include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief The zigzag scan order: ZIGZAG[k] is the row-major index of the k-th coefficient in scan order.
+ */
+extern const int ZIGZAG[64];
+
+/**
+ * @enum eComposante
+ * @brief The image component a quantization table is meant for.
+ */
+enum eComposante {
+    COMPOSANTE_LUMA = 0,   ///< Luminance (Y), standard table K.1.
+    COMPOSANTE_CHROMA = 1  ///< Chrominance (Cb, Cr), standard table K.2.
+};
+
+/**
+ * @class cContexteQuant
+ * @brief Quantization state for one quality and one component, built once and shared by every block.
+ *
+ * Holds the scaled table and its reciprocals in the layouts the block kernels
+ * use, so that per-block work reduces to multiplications. The object is
+ * immutable after construction (or after setQualite()) and can be read
+ * concurrently from several threads.
+ */
+class cContexteQuant {
+private:
+    /** @brief The quality the tables were built for (1-100). */
+    unsigned int mQualite;
+    /** @brief The component the tables were built for. */
+    eComposante mComposante;
+    /** @brief True if the table is transposed (files turned on their side in the coefficient domain). */
+    bool mTransposee;
+    /** @brief The scaled table, row-major. */
+    int mQ[64];
+    /** @brief The scaled table as floats, row-major (for the dequantization kernels). */
+    float mQf[64];
+    /** @brief 1/Q as floats, row-major (for the DCT + quantization kernels). */
+    float mQinv[64];
+    /** @brief 1/Q in double precision, row-major (for quant_JPEG()). */
+    double mQinvD[64];
+    /** @brief 1/Q as floats, in zigzag order (for quantifier_zigzag()). */
+    float mQinvZigzag[64];
+    /** @brief Integer reciprocals m = ceil(2^s / 8Q), in zigzag order (for quantifier_zigzag_entier()). */
+    uint32_t mRecipZigzag[64];
+    /** @brief Shifts s = 16 + ceil(log2(8Q)) matching mRecipZigzag. */
+    uint8_t mDecalageZigzag[64];
+
+public:
+    /**
+     * @brief Builds the tables for a quality and a component.
+     * @param qualite The quality setting, clamped to 1-100.
+     * @param composante The component (luma by default).
+     * @param transposee True for the transposed table, Q[v][u] at (u, v): the table of the
+     *        blocks of a file transposed by cCompression::Transformation_JPEG() or cCompressionCouleur::TransformConteneur().
+     */
+    explicit cContexteQuant(unsigned int qualite = 50, eComposante composante = COMPOSANTE_LUMA, bool transposee = false);
+
+    /**
+     * @brief Rebuilds the tables for another quality, keeping the component.
+     * @param qualite The quality setting, clamped to 1-100.
+     */
+    void setQualite(unsigned int qualite);
+
+    /** @brief Gets the quality the tables were built for. */
+    unsigned int getQualite() const;
+
+    /** @brief Gets the component the tables were built for. */
+    eComposante getComposante() const;
+
+    /** @brief Tells whether the table is transposed. */
+    bool getTransposee() const;
+
+    /** @brief Gets the scaled table, 64 values, row-major. */
+    const int *getTable() const;
+
+    /** @brief Gets the scaled table as floats, 64 values, row-major. */
+    const float *getTableF() const;
+
+    /** @brief Gets the reciprocals 1/Q as floats, 64 values, row-major. */
+    const float *getInverses() const;
+
+    /**
+     * @brief Quantizes one block and writes it directly in zigzag order.
+     *
+     * Zigzag[k] = round(DCT[ZIGZAG[k]] / Q[ZIGZAG[k]]), rounded half away from
+     * zero and saturated to int16_t, exactly as the dct_quant() kernels do.
+     *
+     * @param[in] DCT 64 DCT coefficients, row-major.
+     * @param[out] Zigzag 64 quantized coefficients in scan order, ready for cCompression::RLE_Block().
+     * @return The nonzero mask of the block: bit k is set if Zigzag[k] != 0.
+     */
+    uint64_t quantifier_zigzag(const float *DCT, int16_t *Zigzag) const;
+
+    /**
+     * @brief Quantizes one fixed-point block and writes it directly in zigzag order.
+     *
+     * Integer counterpart of quantifier_zigzag() for the output of
+     * Calcul_DCT_Block_Entier() (coefficients scaled by 8). The division by
+     * 8*Q, rounded half away from zero, is done as a multiplication by a
+     * precomputed reciprocal followed by a shift; it is exact for every
+     * magnitude below 2^16, which covers all 8-bit input blocks.
+     *
+     * @param[in] DCT8 64 fixed-point DCT coefficients, row-major.
+     * @param[out] Zigzag 64 quantized coefficients in scan order.
+     * @return The nonzero mask of the block, as quantifier_zigzag().
+     */
+    uint64_t quantifier_zigzag_entier(const int32_t *DCT8, int16_t *Zigzag) const;
+
+    /**
+     * @brief Quantizes an 8x8 block (double precision, row-major).
+     * @param[in] img_DCT An 8x8 block of DCT coefficients.
+     * @param[out] Img_Quant The quantized coefficients.
+     */
+    void quantifier(double **img_DCT, int **Img_Quant) const;
+
+    /**
+     * @brief De-quantizes an 8x8 block.
+     * @param[in] Img_Quant An 8x8 block of quantized coefficients.
+     * @param[out] img_DCT The de-quantized DCT coefficients.
+     */
+    void dequantifier(int **Img_Quant, double **img_DCT) const;
+};
 
 /**
  * @brief Builds the 8x8 luminance quantization table based on a global quality setting.
@@ -20,29 +143,58 @@
  */
 void build_Q_table(int Qtab[8][8]);
 
+/**
+ * @brief Builds an 8x8 quantization table for an explicit quality and component.
+ * @param[out] Qtab An 8x8 integer array to be filled with the quantization table values.
+ * @param[in] qualite The quality setting (1-100).
+ * @param[in] composante The component whose base table is scaled.
+ */
+void build_Q_table(int Qtab[8][8], unsigned int qualite, eComposante composante);
+
 /**
  * @brief Quantizes an 8x8 block of DCT coefficients.
  *
- * This function divides each DCT coefficient by the corresponding value in the
- * quantization table (scaled by the global quality factor) and rounds to the
- * nearest integer.
+ * This function multiplies each DCT coefficient by the reciprocal of the
+ * corresponding value in the quantization table (scaled by the global quality
+ * factor) and rounds to the nearest integer. The table is cached per thread
+ * and only rebuilt when the global quality changes.
  *
  * @param[in] img_DCT An 8x8 block of DCT coefficients.
  * @param[out] Img_Quant An 8x8 block to be filled with the resulting quantized integer coefficients.
  */
 void quant_JPEG(double **img_DCT, int **Img_Quant);
 
+/**
+ * @brief Quantizes an 8x8 block of DCT coefficients with explicit tables.
+ *
+ * Reentrant counterpart of quant_JPEG(double**, int**): nothing global is read.
+ *
+ * @param[in] img_DCT An 8x8 block of DCT coefficients.
+ * @param[out] Img_Quant An 8x8 block to be filled with the quantized coefficients.
+ * @param[in] ctx The quantization tables (e.g. cContexteCodec::getQuant()).
+ */
+void quant_JPEG(double **img_DCT, int **Img_Quant, const cContexteQuant &ctx);
+
 /**
  * @brief De-quantizes an 8x8 block of coefficients.
  *
  * This function reverses the quantization process by multiplying each integer
- * coefficient by the corresponding value in the quantization table.
+ * coefficient by the corresponding value in the quantization table (cached
+ * like in quant_JPEG()).
  *
  * @param[in] Img_Quant An 8x8 block of quantized integer coefficients.
  * @param[out] img_DCT An 8x8 block to be filled with the de-quantized DCT coefficients.
  */
 void dequant_JPEG(int **Img_Quant, double **img_DCT);
 
+/**
+ * @brief De-quantizes an 8x8 block of coefficients with explicit tables.
+ * @param[in] Img_Quant An 8x8 block of quantized integer coefficients.
+ * @param[out] img_DCT An 8x8 block to be filled with the de-quantized DCT coefficients.
+ * @param[in] ctx The quantization tables used for quantization.
+ */
+void dequant_JPEG(int **Img_Quant, double **img_DCT, const cContexteQuant &ctx);
+
 /**
  * @brief (Standalone) Calculates the Mean Squared Error for an 8x8 block.
  *
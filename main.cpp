@@ -1,6 +1,6 @@
 // main.cpp
-// Pipeline: read ASCII image, level-shift, DCT, quant, dequant, IDCT,
-// compute EQM (MSE) and Taux_Compression via cCompression, and produce RLE trame.
+// Pipeline: read ASCII image, level-shift, DCT, quant, dequant, IDCT in one
+// analysis pass (EQM/MSE, Taux_Compression, PSNR), and produce the RLE trame from it.
 
 #include <iostream>
 #include <fstream>
@@ -10,14 +10,84 @@
 #include <iomanip>
 #include <cmath>
 #include <algorithm>
+#include <memory>
 
 #include "core/cCompression.h"
+#include "core/cContexteCodec.h"
 #include "dct/dct.h"
 #include "quantification/quantification.h"
 #include "core/cCompressionCouleur.h"
+#include "core/cEncodeurFlux.h"
+#include "core/cEncodeurPipeline.h"
+#include "core/cCompressionLot.h"
+#include "core/cImage.h"
+#include "core/cStatistiques.h"
+#include "core/cTablesHuffman.h"
 
 using namespace std;
 
+// --stats: the codec calls of the command fill this record, printed at the end.
+static bool g_afficherStats = false;
+static sStatistiques g_stats;
+
+// --scale: the decompress commands write the image reduced by this divisor.
+static unsigned int g_echelle = 1;
+
+// --index: the grayscale compress commands add a seek index, one entry per block row.
+static bool g_index = false;
+
+// --table: the grayscale compress commands code with this static table (0 = a table per file).
+static uint16_t g_tableId = 0, g_tableVersion = 0;
+
+// Selects the --table static table on a grayscale encoder.
+template <class tEncodeur>
+static bool choisir_table(tEncodeur &encodeur) {
+    if (g_tableId == 0 || encodeur.setTableStatique(g_tableId, g_tableVersion)) return true;
+    std::cerr << "Static table " << g_tableId << " is not registered (see --tables)\n";
+    return false;
+}
+
+// Reads the header of a binary (P5) PGM and leaves the stream on the first pixel.
+static bool lire_entete_p5(std::istream &pin, unsigned int &w, unsigned int &h) {
+    std::string magic;
+    unsigned int maxv = 0;
+    pin >> magic;
+    while (pin >> std::ws && pin.peek() == '#') { std::string line; std::getline(pin, line); }
+    pin >> w >> h >> maxv;
+    pin.get(); // single whitespace before the pixels
+    return pin && magic == "P5" && maxv == 255;
+}
+
+// Attaches the record and a trace hook to std::cerr when --stats was given.
+static void suivre(cCompression &codec) {
+    if (!g_afficherStats) return;
+    codec.setStatistiques(&g_stats);
+    codec.setTrace([](const char *message) { std::cerr << message << '\n'; });
+}
+
+static void print_stats() {
+    if (!g_afficherStats) return;
+    if (!kStatistiques) {
+        cout << "--stats: this build has JPEG_STATS=0, nothing was measured\n";
+        return;
+    }
+    const double total = g_stats.secondesTotal();
+    cout << "--- Stats ---\n";
+    cout << "  bytes in       " << g_stats.octetsEntree << "\n";
+    cout << "  bytes out      " << g_stats.octetsSortie << "\n";
+    cout << "  blocks         " << g_stats.blocs << "\n";
+    cout << "  symbols        " << g_stats.symboles << "\n";
+    if (g_stats.segmentsCorrompus) cout << "  corrupted segs " << g_stats.segmentsCorrompus << "\n";
+    cout << fixed << setprecision(3);
+    for (int e = 0; e < NB_ETAPES_CODEC; ++e) {
+        cout << "  " << left << setw(15) << sStatistiques::nomEtape(static_cast<eEtapeCodec>(e)) << right
+             << setw(10) << g_stats.secondes[e] * 1e3 << " ms\n";
+    }
+    cout << "  " << left << setw(15) << "total" << right << setw(10) << total * 1e3 << " ms";
+    if (total > 0) cout << "  (" << setprecision(1) << g_stats.octetsEntree / total / 1e6 << " MB/s in)";
+    cout << "\n";
+}
+
 // --- Helper functions for printing blocks ---
 void print_int_block(const std::string& title, int* block[8]) {
     cout << "\n--- " << title << " ---\n";
@@ -45,22 +115,96 @@ void print_help() {
     cout << "JPEG Compressor - Educational Tool\n\n";
     cout << "Usage: ./build/jpeg_cli [command] [options...]\n\n";
     cout << "Commands:\n";
-    cout << "  (no command)              Compress a grayscale image.\n";
+    cout << "  (no command)              Compress a grayscale image (text .img or binary PGM).\n";
     cout << "                            Args: [infile] [quality]\n";
     cout << "                            Default: lenna.img 50\n\n";
     cout << "  --process [infile] [qual] Show step-by-step pipeline for the first 8x8 block.\n";
     cout << "                            Default: lenna.img 50\n\n";
     cout << "  --decompress <file.huff>  Decompress a .huff file into a .pgm image.\n\n";
+    cout << "  --region <file.huff> <out.pgm> <x> <y> <w> <h> [threads]\n";
+    cout << "                            Decode only a rectangle; fast on files written with --index or restart intervals.\n\n";
+    cout << "  --transform <in> <out> <op> [x y w h]\n";
+    cout << "                            Rotate, mirror or crop a .huff or .hufc file without re-encoding (lossless):\n";
+    cout << "                            op is none, flip-h, flip-v, rot90, rot180, rot270, transpose or transverse; the\n";
+    cout << "                            crop (in source pixels, w or h 0 = to the edge) is on 8-pixel (color: MCU) boundaries.\n\n";
     cout << "  --color-compress ...      Compress a color PPM image.\n";
-    cout << "                            Args: <input.ppm> <basename> [quality] [subsampling]\n";
+    cout << "                            Args: <input.ppm> <output.hufc> [quality] [subsampling] [threads]\n";
     cout << "                            Subsampling modes: 444, 422, 420\n\n";
     cout << "  --color-decompress ...    Decompress a color image.\n";
-    cout << "                            Args: <basename> <output.ppm>\n\n";
+    cout << "                            Args: <file.hufc | legacy basename> <output.ppm> [threads] [upsampling]\n";
+    cout << "                            Upsampling filters: triangle (default), nearest\n\n";
+    cout << "  --stream <in.pgm> <out.huff> [quality]\n";
+    cout << "                            Compress a binary (P5) PGM 8 rows at a time, in bounded memory.\n\n";
+    cout << "  --pipeline <in.pgm> <out.huff> [quality] [threads] [rows]\n";
+    cout << "                            Compress a binary (P5) PGM with reading, transforms (threads workers, 0 = all cores)\n";
+    cout << "                            and entropy coding overlapped on stripes of rows (default 64); prints the time each\n";
+    cout << "                            stage worked and waited, the queue depths and the bottleneck stage.\n\n";
+    cout << "  --color-stream ...        Like --color-compress, in a single pass with the built-in tables.\n";
+    cout << "                            Args: <input.ppm> <output.hufc> [quality] [subsampling]\n\n";
+    cout << "  --target-size <in> <out> <KB> [subsampling]\n";
+    cout << "                            Encode at the highest quality whose file fits in KB kilobytes (1 KB = 1024 bytes);\n";
+    cout << "                            .pgm/.img to HUF2, .ppm to HUFC. The DCT is computed once for the whole search.\n\n";
+    cout << "  --target-psnr <in> <out> <dB> [subsampling]\n";
+    cout << "                            Encode at the lowest quality reaching the PSNR (of luma for color images).\n\n";
+    cout << "  --batch <manifest> [threads]\n";
+    cout << "                            Compress every job of a manifest (one \"in out [quality] [subsampling]\" per line,\n";
+    cout << "                            .pgm to HUF2, .ppm to HUFC) on a pool of worker threads (0 = all cores).\n\n";
+    cout << "  --train-tables <out.htb> <id> <version> <name> <image>...\n";
+    cout << "                            Train a static Huffman table on grayscale images (.img/.pgm, RLE trames at qualities\n";
+    cout << "                            25 to 90) and write it for --tables; files coded with it reference it by id and version.\n\n";
     cout << "  --histogram <file.rle>    Show frequency histogram of an RLE file.\n\n";
-    cout << "  -h, --help                Show this help message.\n";
+    cout << "  -h, --help                Show this help message.\n\n";
+    cout << "Options:\n";
+    cout << "  --stats                   With the compress, target and decompress commands: print bytes, blocks, symbols\n";
+    cout << "                            and the time of each stage, and the codec's diagnostics on stderr.\n";
+    cout << "  --index                   With the grayscale compress, target, pipeline and transform commands: add a seek index\n";
+    cout << "                            (one entry per block row, 8 bytes each) so that --region seeks instead of decoding\n";
+    cout << "                            from the start.\n";
+    cout << "  --tables <file.htb>       Register a static Huffman table written by --train-tables (repeatable); needed to\n";
+    cout << "                            decode the files that reference it.\n";
+    cout << "  --table <id[:version]>    With the grayscale compress, target, stream, pipeline and transform commands: code in a single\n";
+    cout << "                            pass with a registered static table (1 = built-in) referenced by the file instead\n";
+    cout << "                            of embedded.\n";
+    cout << "  --scale <1/2|1/4|1/8>     With --decompress and --color-decompress: decode straight to a reduced image\n";
+    cout << "                            (1/8 uses the DC coefficients only), for thumbnails and previews.\n";
 }
 
 int main(int argc, char** argv) {
+    // --stats, --scale, --index, --tables and --table may appear anywhere; the commands do not see them.
+    {
+        int n = 1;
+        for (int i = 1; i < argc; ++i) {
+            if (string(argv[i]) == "--stats") g_afficherStats = true;
+            else if (string(argv[i]) == "--index") g_index = true;
+            else if (string(argv[i]) == "--tables" && i + 1 < argc) {
+                const sTableHuffman *t = nullptr;
+                if (!cTablesHuffman::global().charger(argv[++i], &t)) {
+                    std::cerr << "Cannot register the table of " << argv[i] << '\n';
+                    return 1;
+                }
+                std::cout << "Registered table " << t->id << ":" << t->version << " (" << t->nom << ")\n";
+            }
+            else if (string(argv[i]) == "--table" && i + 1 < argc) {
+                const string t = argv[++i];
+                const size_t deux = t.find(':');
+                g_tableId = static_cast<uint16_t>(stoul(t.substr(0, deux)));
+                g_tableVersion = (deux == string::npos) ? 0 : static_cast<uint16_t>(stoul(t.substr(deux + 1)));
+            }
+            else if (string(argv[i]) == "--scale" && i + 1 < argc) {
+                string d = argv[++i];
+                if (d.compare(0, 2, "1/") == 0) d = d.substr(2);
+                g_echelle = static_cast<unsigned int>(stoi(d));
+                if (g_echelle != 1 && g_echelle != 2 && g_echelle != 4 && g_echelle != 8) {
+                    std::cerr << "--scale takes 1, 1/2, 1/4 or 1/8\n";
+                    return 1;
+                }
+            }
+            else argv[n++] = argv[i];
+        }
+        argc = n;
+        argv[argc] = nullptr;
+    }
+
     if (argc > 1 && (string(argv[1]) == "--help" || string(argv[1]) == "-h")) {
         print_help();
         return 0;
@@ -100,29 +244,14 @@ int main(int argc, char** argv) {
         string infile = (argc > 2) ? argv[2] : "lenna.img";
         unsigned int qual = (argc > 3) ? static_cast<unsigned int>(stoi(argv[3])) : 50;
 
-        ifstream fin(infile);
-        if (!fin) { cerr << "Cannot open " << infile << '\n'; return 1; }
-
-        string firstline;
-        if (!getline(fin, firstline)) { cerr << "Empty file" << '\n'; return 1; }
-
-        size_t width = 0;
-        {
-            istringstream iss(firstline);
-            int tmp; while (iss >> tmp) ++width;
-        }
-        if (width == 0) { cerr << "Failed to detect width" << '\n'; return 1; }
-
-        vector<int> vals;
-        {
-            istringstream iss(firstline);
-            int v; while (iss >> v) vals.push_back(v);
-            int x; while (fin >> x) vals.push_back(x);
+        cLecteurImage image;
+        if (!image.ouvrir(infile.c_str()) || image.getFormat() == IMAGE_PPM) {
+            cerr << "Cannot read " << infile << ": " << (image.getFormat() == IMAGE_PPM ? "not a grayscale image" : image.getErreur()) << '\n';
+            return 1;
         }
-        fin.close();
-
-        if (vals.size() % width != 0) { cerr << "Malformed input" << '\n'; return 1; }
-        size_t height = vals.size() / width;
+        const sVueImage &vue = image.getVue();
+        const size_t width = vue.largeur;
+        const size_t height = vue.hauteur;
 
         cout << "Loaded " << infile << " (" << width << "x" << height << "), showing first 8x8 block with Quality=" << qual << "\n";
         cCompression::setQualiteGlobale(qual);
@@ -155,7 +284,7 @@ int main(int argc, char** argv) {
         // 1. Original Block
         for (int r = 0; r < B; ++r) {
             for (int c = 0; c < B; ++c) {
-                int val = vals[r * width + c];
+                int val = vue.ligne(static_cast<unsigned int>(r))[c];
                 original[r][c] = val < 0 ? 0 : (val > 255 ? 255 : val);
             }
         }
@@ -199,84 +328,352 @@ int main(int argc, char** argv) {
 
 	if (argc > 1 && std::string(argv[1]) == "--decompress") {
 		const char *inpath = (argc > 2) ? argv[2] : "lenna.huff";
+		const char *outpath = "decomp_lenna.pgm";
+		cCompression compressor;
+		compressor.setEchelle(g_echelle);
+		suivre(compressor);
+		cFichierMappe fichier;
+		if (!fichier.ouvrir(inpath)) { std::cerr << "Cannot open " << inpath << '\n'; return 1; }
+		unsigned int w = 0, h = 0;
+		if (cCompression::LireDimensions(fichier.getDonnees(), fichier.getTaille(), w, h)) {
+			// decode straight into the output PGM
+			w = cCompression::TailleReduite(w, g_echelle);
+			h = cCompression::TailleReduite(h, g_echelle);
+			cEcrivainImage sortie;
+			if (!sortie.ouvrir(outpath, w, h, 1)) { std::cerr << "Cannot write output file\n"; return 1; }
+			if (!compressor.Decompression_JPEG(fichier.getDonnees(), fichier.getTaille(), sortie.getPixels(), sortie.getPas(), w, h)) {
+				sortie.abandonner();
+				std::cerr << "Decompression failed\n";
+				return 1;
+			}
+			if (!sortie.fermer()) { std::cerr << "Cannot write output file\n"; return 1; }
+		} else {
+			// older files without dimensions: the decoder infers the block grid
+			unsigned char **rows = compressor.Decompression_JPEG(fichier.getDonnees(), fichier.getTaille());
+			if (!rows) { std::cerr << "Decompression failed\n"; return 1; }
+			w = cCompression::TailleReduite(compressor.getLargeur(), g_echelle);
+			h = cCompression::TailleReduite(compressor.getHauteur(), g_echelle);
+			sVueImage vue;
+			vue.pixels = rows[0]; vue.largeur = w; vue.hauteur = h; vue.canaux = 1; vue.pas = w;
+			const bool ecrit = cEcrivainImage::Ecrire(outpath, vue);
+			// free allocated buffer: rows[0] points to buffer
+			delete[] rows[0]; delete[] rows;
+			if (!ecrit) { std::cerr << "Cannot write output file\n"; return 1; }
+		}
+		std::cout << "Wrote " << outpath << " (" << w << "x" << h << ")\n";
+		print_stats();
+		return 0;
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--region") {
+		// usage: --region in.huff out.pgm x y w h [threads]
+		if (argc < 8) { print_help(); return 1; }
+		const unsigned int x = static_cast<unsigned int>(std::stoul(argv[4])), y = static_cast<unsigned int>(std::stoul(argv[5]));
+		const unsigned int w = static_cast<unsigned int>(std::stoul(argv[6])), h = static_cast<unsigned int>(std::stoul(argv[7]));
 		cCompression compressor;
-		unsigned char **rows = compressor.Decompression_JPEG(inpath);
-		if (!rows) { std::cerr << "Decompression failed\n"; return 1; }
-		// write output PGM using stored dimensions
-		unsigned int w = compressor.getLargeur();
-		unsigned int h = compressor.getHauteur();
-		std::ofstream fout("decomp_lenna.pgm", std::ios::binary);
-		if (!fout) { std::cerr << "Cannot write output file\n"; return 1; }
-		fout << "P5\n" << w << " " << h << "\n255\n";
-		for (unsigned int r = 0; r < h; ++r) fout.write(reinterpret_cast<char*>(rows[r]), w);
-		fout.close();
-		std::cout << "Wrote decomp_lenna.pgm (" << w << "x" << h << ")\n";
-		// free allocated buffer: rows[0] points to buffer
-		delete[] rows[0]; delete[] rows;
+		compressor.setNbThreads((argc > 8) ? static_cast<unsigned int>(std::stoi(argv[8])) : 1);
+		suivre(compressor);
+		cFichierMappe fichier;
+		if (!fichier.ouvrir(argv[2])) { std::cerr << "Cannot open " << argv[2] << '\n'; return 1; }
+		cEcrivainImage sortie;
+		if (!sortie.ouvrir(argv[3], w, h, 1)) { std::cerr << "Cannot write output file\n"; return 1; }
+		if (!compressor.DecodeRegion(fichier.getDonnees(), fichier.getTaille(), x, y, w, h, sortie.getPixels(), sortie.getPas())) {
+			sortie.abandonner();
+			std::cerr << "Region decode failed (outside the image, or no stored size)\n";
+			return 1;
+		}
+		if (!sortie.fermer()) { std::cerr << "Cannot write output file\n"; return 1; }
+		std::cout << "Wrote " << argv[3] << " (" << w << "x" << h << " at " << x << "," << y << ")\n";
+		print_stats();
+		return 0;
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--transform") {
+		// usage: --transform in out op [x y w h]
+		if (argc < 5) { print_help(); return 1; }
+		const std::string op = argv[4];
+		const char *noms[] = { "none", "flip-h", "flip-v", "rot90", "rot180", "rot270", "transpose", "transverse" };
+		int t = 0;
+		while (t < 8 && op != noms[t]) ++t;
+		if (t == 8) { std::cerr << "Unknown transform: " << op << '\n'; return 1; }
+		sRecadrage recadrage;
+		if (argc > 8) {
+			recadrage.x = static_cast<unsigned int>(std::stoul(argv[5]));
+			recadrage.y = static_cast<unsigned int>(std::stoul(argv[6]));
+			recadrage.largeur = static_cast<unsigned int>(std::stoul(argv[7]));
+			recadrage.hauteur = static_cast<unsigned int>(std::stoul(argv[8]));
+		}
+		cFichierMappe fichier;
+		unsigned int w = 0, h = 0;
+		if (!fichier.ouvrir(argv[2]) || !cCompressionCouleur::LireDimensions(fichier.getDonnees(), fichier.getTaille(), w, h)) {
+			std::cerr << "Cannot read " << argv[2] << '\n';
+			return 1;
+		}
+		cCompressionCouleur cc;
+		suivre(cc);
+		// A grayscale file is coded again with --index and --table; the index has one entry per block row of the result.
+		const bool transpose = (t == TRANSFORMATION_ROTATION_90 || t == TRANSFORMATION_ROTATION_270
+		                        || t == TRANSFORMATION_TRANSPOSITION || t == TRANSFORMATION_TRANSVERSE);
+		const unsigned int largeur = transpose ? (recadrage.hauteur ? recadrage.hauteur : h - std::min(h, recadrage.y))
+		                                       : (recadrage.largeur ? recadrage.largeur : w - std::min(w, recadrage.x));
+		if (g_index) cc.setIntervalleIndex(std::max(1u, largeur / 8));
+		if (!choisir_table(cc)) return 1;
+		std::vector<unsigned char> sortie;
+		if (!cc.TransformConteneur(fichier.getDonnees(), fichier.getTaille(), static_cast<eTransformation>(t), sortie,
+		                           (argc > 8) ? &recadrage : nullptr)) {
+			std::cerr << "Transform failed (crop not block-aligned or outside the image, quarter turn of a 4:2:2 file,\n"
+			          << "DC differences that no longer fit the format, or a damaged file)\n";
+			return 1;
+		}
+		std::ofstream out(argv[3], std::ios::binary);
+		out.write(reinterpret_cast<const char*>(sortie.data()), static_cast<std::streamsize>(sortie.size()));
+		if (!out) { std::cerr << "Cannot write " << argv[3] << '\n'; return 1; }
+		cCompressionCouleur::LireDimensions(sortie.data(), sortie.size(), w, h);
+		std::cout << "Wrote " << argv[3] << " (" << op << ", " << w << "x" << h << ", " << sortie.size() << " bytes)\n";
+		print_stats();
 		return 0;
 	}
 
 	if (argc > 1 && std::string(argv[1]) == "--color-compress") {
-		// usage: --color-compress input.ppm basename [quality] [mode]
+		// usage: --color-compress input.ppm out.hufc [quality] [mode] [threads]
 		const char *ppm = (argc > 2) ? argv[2] : "lenna.ppm";
-		const char *basename = (argc > 3) ? argv[3] : "lenna_color";
+		const char *outfile = (argc > 3) ? argv[3] : "lenna_color.hufc";
 		unsigned int qual = (argc > 4) ? static_cast<unsigned int>(std::stoi(argv[4])) : 50;
 		unsigned int mode = (argc > 5) ? static_cast<unsigned int>(std::stoi(argv[5])) : 444;
 		cCompressionCouleur cc;
-		bool ok = cc.CompressPPM(ppm, basename, qual, mode);
+		cc.setNbThreads((argc > 6) ? static_cast<unsigned int>(std::stoi(argv[6])) : 1);
+		suivre(cc);
+		bool ok = cc.CompressPPM(ppm, outfile, qual, mode);
 		std::cout << "Compress color result: " << (ok?"OK":"FAIL") << std::endl;
+		print_stats();
 		return ok ? 0 : 1;
 	}
 
 	if (argc > 1 && std::string(argv[1]) == "--color-decompress") {
-		// usage: --color-decompress basename out.ppm
-		const char *basename = (argc > 2) ? argv[2] : "lenna_color";
+		// usage: --color-decompress in.hufc out.ppm [threads] [triangle|nearest] (or a legacy basename)
+		const char *infile = (argc > 2) ? argv[2] : "lenna_color.hufc";
 		const char *outppm = (argc > 3) ? argv[3] : "decomp_color.ppm";
 		cCompressionCouleur cc;
-		bool ok = cc.DecompressToPPM(basename, outppm);
+		cc.setNbThreads((argc > 4) ? static_cast<unsigned int>(std::stoi(argv[4])) : 1);
+		if (argc > 5 && std::string(argv[5]) == "nearest") cc.setSurechantillonnage(SURECHANTILLONNAGE_PROCHE);
+		cc.setEchelle(g_echelle);
+		suivre(cc);
+		bool ok = cc.DecompressToPPM(infile, outppm);
 		std::cout << "Decompress color result: " << (ok?"OK":"FAIL") << std::endl;
+		print_stats();
 		return ok ? 0 : 1;
 	}
 
-	string infile = (argc > 1) ? argv[1] : "lenna.img";
-	unsigned int qual = (argc > 2) ? static_cast<unsigned int>(stoi(argv[2])) : 50;
+	if (argc > 1 && std::string(argv[1]) == "--stream") {
+		// usage: --stream in.pgm out.huff [quality]
+		if (argc < 4) { print_help(); return 1; }
+		unsigned int qual = (argc > 4) ? static_cast<unsigned int>(std::stoi(argv[4])) : 50;
+		std::ifstream pin(argv[2], std::ios::binary);
+		unsigned int w = 0, h = 0;
+		if (!lire_entete_p5(pin, w, h)) { std::cerr << "Cannot read binary PGM: " << argv[2] << '\n'; return 1; }
+		std::ofstream out(argv[3], std::ios::binary);
+		if (!out) { std::cerr << "Cannot write " << argv[3] << '\n'; return 1; }
+		cCompression::setQualiteGlobale(qual);
+		cEncodeurFlux encodeur(out, w, h, cCompression::getQualiteGlobale());
+		if (!choisir_table(encodeur)) return 1;
+		bool ok = encodeur.Encoder(pin);
+		std::cout << "Stream compress result: " << (ok?"OK":"FAIL") << std::endl;
+		return ok ? 0 : 1;
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--pipeline") {
+		// usage: --pipeline in.pgm out.huff [quality] [threads] [rows]
+		if (argc < 4) { print_help(); return 1; }
+		unsigned int qual = (argc > 4) ? static_cast<unsigned int>(std::stoi(argv[4])) : 50;
+		std::ifstream pin(argv[2], std::ios::binary);
+		unsigned int w = 0, h = 0;
+		if (!lire_entete_p5(pin, w, h)) { std::cerr << "Cannot read binary PGM: " << argv[2] << '\n'; return 1; }
+		cEncodeurPipeline encodeur(w, h, qual);
+		if (argc > 5) encodeur.setNbThreads(static_cast<unsigned int>(std::stoi(argv[5])));
+		if (argc > 6) encodeur.setLignesParBande(static_cast<unsigned int>(std::stoi(argv[6])));
+		if (g_index) encodeur.setIntervalleIndex((w + 7) / 8);
+		if (!choisir_table(encodeur)) return 1;
+		std::vector<unsigned char> fichier;
+		bool ok = encodeur.Encoder(pin, fichier);
+		if (ok) {
+			std::ofstream out(argv[3], std::ios::binary);
+			out.write(reinterpret_cast<const char*>(fichier.data()), static_cast<std::streamsize>(fichier.size()));
+			ok = static_cast<bool>(out);
+			if (!ok) std::cerr << "Cannot write " << argv[3] << '\n';
+		}
+		std::cout << "Pipeline compress result: " << (ok?"OK":"FAIL") << std::endl;
+		if (ok) {
+			const sMetriquesPipeline &m = encodeur.getMetriques();
+			std::cout << std::fixed << std::setprecision(1) << "Stripes of " << m.lignesParBande << " rows, "
+			          << m.entropie.bandes << " stripes in " << m.secondes * 1e3 << " ms\n";
+			for (const sMetriquesEtape *e : { &m.lecture, &m.transformation, &m.entropie }) {
+				std::cout << "  " << std::left << std::setw(15) << e->nom << std::right << e->nbThreads << " thread(s)  busy "
+				          << std::setw(5) << 100.0 * e->occupation(m.secondes) << "%  active " << e->secondesActives * 1e3
+				          << " ms  starved " << e->secondesAttenteEntree * 1e3 << " ms  blocked " << e->secondesAttenteSortie * 1e3
+				          << " ms\n";
+			}
+			std::cout << std::setprecision(2) << "  queue to transform: max " << m.fileTransformation.profondeurMax << "/"
+			          << m.fileTransformation.capacite << ", mean " << m.fileTransformation.profondeurMoyenne << "\n"
+			          << "  queue to entropy:   max " << m.fileEntropie.profondeurMax << "/" << m.fileEntropie.capacite
+			          << ", mean " << m.fileEntropie.profondeurMoyenne << "\n"
+			          << "  bottleneck: " << m.goulot().nom << "\n";
+		}
+		return ok ? 0 : 1;
+	}
 
-	ifstream fin(infile);
-	if (!fin) { cerr << "Cannot open " << infile << '\n'; return 1; }
+	if (argc > 1 && std::string(argv[1]) == "--color-stream") {
+		// usage: --color-stream input.ppm out.hufc [quality] [mode]
+		const char *ppm = (argc > 2) ? argv[2] : "lenna.ppm";
+		const char *outfile = (argc > 3) ? argv[3] : "lenna_color.hufc";
+		unsigned int qual = (argc > 4) ? static_cast<unsigned int>(std::stoi(argv[4])) : 50;
+		unsigned int mode = (argc > 5) ? static_cast<unsigned int>(std::stoi(argv[5])) : 444;
+		cCompressionCouleur cc;
+		suivre(cc);
+		bool ok = cc.CompressPPMFlux(ppm, outfile, qual, mode);
+		std::cout << "Stream compress color result: " << (ok?"OK":"FAIL") << std::endl;
+		print_stats();
+		return ok ? 0 : 1;
+	}
 
-	string firstline;
-	if (!getline(fin, firstline)) { cerr << "Empty file" << '\n'; return 1; }
+	if (argc > 1 && (std::string(argv[1]) == "--target-size" || std::string(argv[1]) == "--target-psnr")) {
+		// usage: --target-size in out <kilobytes> [mode] | --target-psnr in out <dB> [mode]
+		if (argc < 5) { print_help(); return 1; }
+		const eCible cible = (std::string(argv[1]) == "--target-size") ? CIBLE_TAILLE : CIBLE_PSNR;
+		const double valeur = std::atof(argv[4]) * ((cible == CIBLE_TAILLE) ? 1024.0 : 1.0);
+		cLecteurImage image;
+		if (!image.ouvrir(argv[2])) { std::cerr << "Cannot read " << argv[2] << ": " << image.getErreur() << '\n'; return 1; }
+		const sVueImage &vue = image.getVue();
+		std::vector<unsigned char> fichier;
+		sResultatCible r;
+		bool ok = false;
+		if (image.getFormat() == IMAGE_PPM) {
+			unsigned int mode = (argc > 5) ? static_cast<unsigned int>(std::stoi(argv[5])) : 444;
+			cCompressionCouleur cc;
+			suivre(cc);
+			ok = cc.CompressRGBCible(vue.pixels, vue.largeur, vue.hauteur, vue.pas, mode, cible, valeur, fichier, &r);
+		} else {
+			vector<unsigned char*> rows(vue.hauteur);
+			for (unsigned int y = 0; y < vue.hauteur; ++y) rows[y] = const_cast<unsigned char*>(vue.ligne(y));
+			cCompression compressor(vue.largeur, vue.hauteur, 50, rows.data());
+			if (g_index) compressor.setIntervalleIndex(vue.largeur / 8);
+			if (!choisir_table(compressor)) return 1;
+			suivre(compressor);
+			ok = compressor.Compression_Cible(cible, valeur, fichier, &r);
+			if (!ok) std::cerr << "Image dimensions must be multiples of 8\n";
+		}
+		if (ok) {
+			std::ofstream out(argv[3], std::ios::binary);
+			out.write(reinterpret_cast<const char*>(fichier.data()), static_cast<std::streamsize>(fichier.size()));
+			ok = static_cast<bool>(out);
+			if (!ok) std::cerr << "Cannot write " << argv[3] << '\n';
+		}
+		if (ok) {
+			std::cout << "Quality=" << r.qualite << " size=" << r.taille << " bytes PSNR=" << std::fixed << std::setprecision(2)
+			          << r.psnr << " dB (" << r.essais << " qualities tried)" << (r.atteinte ? "" : ", target not reached") << "\n";
+		}
+		print_stats();
+		return ok ? 0 : 1;
+	}
 
-	// detect width by counting integers in first line
-	size_t width = 0;
-	{
-		istringstream iss(firstline);
-		int tmp; while (iss >> tmp) ++width;
+	if (argc > 1 && std::string(argv[1]) == "--train-tables") {
+		// usage: --train-tables out.htb id version name image...
+		if (argc < 7) { print_help(); return 1; }
+		sTableHuffman table;
+		table.id = static_cast<uint16_t>(std::stoul(argv[3]));
+		table.version = static_cast<uint16_t>(std::stoul(argv[4]));
+		table.nom = argv[5];
+		uint64_t Comptes[256] = {0};
+		uint64_t bitsParFichier = 0, nbTrames = 0;
+		const unsigned int qualites[] = { 25, 50, 75, 90 };
+		for (int i = 6; i < argc; ++i) {
+			cLecteurImage image;
+			if (!image.ouvrir(argv[i]) || image.getFormat() == IMAGE_PPM) {
+				std::cerr << "Cannot read " << argv[i] << ": " << (image.getFormat() == IMAGE_PPM ? "not a grayscale image" : image.getErreur()) << '\n';
+				return 1;
+			}
+			const sVueImage &vue = image.getVue();
+			vector<unsigned char*> rows(vue.hauteur);
+			for (unsigned int y = 0; y < vue.hauteur; ++y) rows[y] = const_cast<unsigned char*>(vue.ligne(y));
+			cCompression compressor(vue.largeur, vue.hauteur, 50, rows.data());
+			auto contexte = std::make_shared<cContexteCodec>(50);
+			compressor.setContexte(contexte);
+			for (unsigned int q : qualites) {
+				contexte->setQualite(q);
+				std::vector<signed char> trame;
+				compressor.RLE(trame);
+				if (trame.empty()) { std::cerr << argv[i] << ": image dimensions must be multiples of 8\n"; return 1; }
+				// What a table fitted to this trame alone would cost, for comparison.
+				uint32_t ComptesTrame[256] = {0};
+				uint8_t Longueurs[256];
+				for (signed char c : trame) ++ComptesTrame[static_cast<unsigned char>(c)];
+				cHuffman::CalculerLongueurs(ComptesTrame, Longueurs);
+				for (int c = 0; c < 256; ++c) {
+					Comptes[c] += ComptesTrame[c];
+					bitsParFichier += static_cast<uint64_t>(ComptesTrame[c]) * Longueurs[c];
+				}
+				++nbTrames;
+			}
+		}
+		cTablesHuffman::Entrainer(Comptes, table.Longueurs);
+		uint64_t bitsStatiques = 0, symboles = 0;
+		for (int c = 0; c < 256; ++c) {
+			bitsStatiques += Comptes[c] * table.Longueurs[c];
+			symboles += Comptes[c];
+		}
+		if (!cTablesHuffman::Ecrire(argv[2], table)) { std::cerr << "Cannot write " << argv[2] << '\n'; return 1; }
+		std::cout << "Wrote " << argv[2] << " (table " << table.id << ":" << table.version << " \"" << table.nom << "\", "
+		          << nbTrames << " trames, " << symboles << " symbols): " << std::fixed << std::setprecision(3)
+		          << static_cast<double>(bitsStatiques) / symboles << " bits/symbol, "
+		          << static_cast<double>(bitsParFichier) / symboles << " with a table per trame\n";
+		return 0;
 	}
-	if (width == 0) { cerr << "Failed to detect width" << '\n'; return 1; }
-
-	// read all pixel values (first line already read)
-	vector<int> vals;
-	{
-		istringstream iss(firstline);
-		int v; while (iss >> v) vals.push_back(v);
-		int x; while (fin >> x) vals.push_back(x);
+
+	if (argc > 1 && std::string(argv[1]) == "--batch") {
+		// usage: --batch manifest.txt [threads]
+		if (argc < 3) { print_help(); return 1; }
+		std::vector<sTacheLot> taches;
+		unsigned int ligne = 0;
+		if (!cCompressionLot::LireManifeste(argv[2], taches, ligne)) {
+			if (ligne) std::cerr << argv[2] << ":" << ligne << ": malformed job\n";
+			else std::cerr << "Cannot read manifest " << argv[2] << '\n';
+			return 1;
+		}
+		cCompressionLot lot((argc > 3) ? static_cast<unsigned int>(std::stoi(argv[3])) : 0);
+		std::vector<sResultatLot> resultats;
+		sBilanLot bilan;
+		bool ok = lot.Executer(taches, resultats, bilan);
+		for (size_t i = 0; i < taches.size(); ++i) {
+			const sResultatLot &r = resultats[i];
+			std::cout << taches[i].entree << " -> " << taches[i].sortie << ": ";
+			if (!r.reussi) { std::cout << "FAIL (" << r.erreur << ")\n"; continue; }
+			std::cout << r.largeur << "x" << r.hauteur << ", " << r.octetsEntree << " -> " << r.octetsSortie << " bytes, "
+			          << std::fixed << std::setprecision(1) << r.secondes * 1000.0 << " ms"
+			          << (r.paralleleBlocs ? " (block-parallel)" : "") << "\n";
+		}
+		std::cout << bilan.nbReussis << " OK, " << bilan.nbEchecs << " failed in " << std::fixed << std::setprecision(3)
+		          << bilan.secondes << " s: " << std::setprecision(1) << bilan.imagesParSeconde() << " images/s, "
+		          << std::setprecision(2) << bilan.megapixelsParSeconde() << " MP/s\n";
+		return ok ? 0 : 1;
 	}
-	fin.close();
 
-	if (vals.size() % width != 0) { cerr << "Malformed input" << '\n'; return 1; }
-	size_t height = vals.size() / width;
+	string infile = (argc > 1) ? argv[1] : "lenna.img";
+	unsigned int qual = (argc > 2) ? static_cast<unsigned int>(stoi(argv[2])) : 50;
+
+	// text .img (width = values on the first line) or binary PGM, parsed or mapped in one go
+	cLecteurImage image;
+	if (!image.ouvrir(infile.c_str()) || image.getFormat() == IMAGE_PPM) {
+		cerr << "Cannot read " << infile << ": " << (image.getFormat() == IMAGE_PPM ? "not a grayscale image" : image.getErreur()) << '\n';
+		return 1;
+	}
+	const sVueImage &vue = image.getVue();
+	const size_t width = vue.largeur;
+	const size_t height = vue.hauteur;
 
 	cout << "Loaded " << infile << " (" << width << "x" << height << ")\n";
 
-	// clamp to byte and build row pointers
-	vector<unsigned char> pixels(width * height);
-	for (size_t i = 0; i < vals.size(); ++i) {
-		int vv = vals[i]; if (vv < 0) vv = 0; if (vv > 255) vv = 255;
-		pixels[i] = static_cast<unsigned char>(vv);
-	}
+	// row pointers straight into the image; the encoder only reads them
 	vector<unsigned char*> rows(height);
-	for (size_t r = 0; r < height; ++r) rows[r] = pixels.data() + r * width;
+	for (size_t r = 0; r < height; ++r) rows[r] = const_cast<unsigned char*>(vue.ligne(static_cast<unsigned int>(r)));
 
 	// configure global quality used by quantization helpers
 	cCompression::setQualiteGlobale(qual);
@@ -287,107 +684,37 @@ int main(int argc, char** argv) {
 		return 1;
 	}
 
-	size_t blocks_w = width / B;
-	size_t blocks_h = height / B;
-
-	cCompression compressor; // to call EQM, Taux_Compression and RLE
-
-	double sumEQM = 0.0;
-	double sumTaux = 0.0;
-	size_t nblocks = 0;
-
-	vector<unsigned char> recon(width * height, 0);
+	// one pass of the block pipeline gives the error, the zero ratio, the reconstruction
+	// and the coefficients the RLE trame is coded from
+	cCompression compressor(static_cast<unsigned int>(width), static_cast<unsigned int>(height), qual, rows.data());
+	if (g_index) compressor.setIntervalleIndex(static_cast<unsigned int>(width / B));
+	if (!choisir_table(compressor)) return 1;
+	suivre(compressor);
 
-	// per-block local buffers
-	int block[8][8];
-	int* block_ptrs[8];
-	double dct[8][8]; double* dct_ptrs[8];
-	int quantized[8][8]; int* quant_ptrs[8];
-	double deq[8][8]; double* deq_ptrs[8];
-	int idct_out[8][8]; int* idct_ptrs[8];
-
-	for (int i = 0; i < 8; ++i) {
-		block_ptrs[i] = block[i];
-		dct_ptrs[i] = dct[i];
-		quant_ptrs[i] = quantized[i];
-		deq_ptrs[i] = deq[i];
-		idct_ptrs[i] = idct_out[i];
-	}
-
-	for (size_t by = 0; by < blocks_h; ++by) {
-		for (size_t bx = 0; bx < blocks_w; ++bx) {
-			// fill block with spatial values (0..255)
-			for (int r = 0; r < B; ++r) for (int c = 0; c < B; ++c) {
-				size_t y = by * B + r;
-				size_t x = bx * B + c;
-				block[r][c] = static_cast<int>(rows[y][x]);
-			}
-
-			// Use cCompression helpers (they encapsulate level-shift/DCT/quant internally)
-			double blockEQM = compressor.EQM(block_ptrs);
-			double blockTaux = compressor.Taux_Compression(block_ptrs);
-
-			sumEQM += blockEQM;
-			sumTaux += blockTaux;
-			++nblocks;
-
-			// Build reconstruction using the same primitive helpers so output matches EQM calculation
-			// Level shift
-			int shifted[8][8]; int* shifted_ptrs[8];
-			for (int i = 0; i < B; ++i) { shifted_ptrs[i] = shifted[i]; for (int j = 0; j < B; ++j) shifted[i][j] = block[i][j] - 128; }
-
-			// DCT, quantize, dequantize, IDCT
-			Calcul_DCT_Block(shifted_ptrs, dct_ptrs);
-			quant_JPEG(dct_ptrs, quant_ptrs);
-			dequant_JPEG(quant_ptrs, deq_ptrs);
-			Calcul_IDCT_Block(deq_ptrs, idct_ptrs);
-
-			// store reconstructed (shift back +128)
-			for (int r = 0; r < B; ++r) for (int c = 0; c < B; ++c) {
-				int val = idct_out[r][c] + 128;
-				if (val < 0) val = 0; if (val > 255) val = 255;
-				size_t y = by * B + r;
-				size_t x = bx * B + c;
-				recon[y * width + x] = static_cast<unsigned char>(val);
-			}
-		}
-	}
-
-	double avgEQM = (nblocks>0) ? sumEQM / static_cast<double>(nblocks) : 0.0;
-	double avgTaux = (nblocks>0) ? sumTaux / static_cast<double>(nblocks) : 0.0;
+	sAnalyseImage analyse;
+	compressor.Analyse_Image(analyse);
 
 	cout.setf(std::ios::fixed);
 	cout << setprecision(6);
-	cout << "Quality=" << qual << " Avg EQM(MSE)=" << avgEQM << " Avg Taux=" << avgTaux << "\n";
+	cout << "Quality=" << qual << " Avg EQM(MSE)=" << analyse.eqm() << " Avg Taux=" << analyse.tauxZeros()
+	     << " PSNR=" << setprecision(2) << analyse.psnr() << " dB\n";
 
 	// write reconstructed image
-	ofstream fout("recon_lenna.pgm", ios::binary);
-	if (fout) {
-		fout << "P5\n" << width << " " << height << "\n255\n";
-		fout.write(reinterpret_cast<char*>(recon.data()), recon.size());
-		fout.close();
-		cout << "Wrote recon_lenna.pgm\n";
-	} else cerr << "Cannot write recon file\n";
-
-	// Now produce the pedagogic RLE trame using cCompression::RLE()
-	compressor.setLargeur(static_cast<unsigned int>(width));
-	compressor.setHauteur(static_cast<unsigned int>(height));
-	compressor.setBuffer(rows.data());
-
-	size_t maxBlocks = blocks_w * blocks_h;
-	size_t maxBytes = maxBlocks * 128; // safe upper bound
-	int *Trame_RLE = new int[1 + maxBytes];
-	compressor.RLE(Trame_RLE);
-	int trameLen = Trame_RLE[0];
-	if (trameLen > 0) {
+	sVueImage vueRecon;
+	vueRecon.pixels = analyse.reconstruction.data(); vueRecon.largeur = static_cast<unsigned int>(width); vueRecon.hauteur = static_cast<unsigned int>(height);
+	vueRecon.canaux = 1; vueRecon.pas = width;
+	if (cEcrivainImage::Ecrire("recon_lenna.pgm", vueRecon)) cout << "Wrote recon_lenna.pgm\n";
+	else cerr << "Cannot write recon file\n";
+
+	// Now produce the pedagogic RLE trame from the same coefficients
+	std::vector<signed char> Trame_RLE;
+	compressor.RLE(analyse, Trame_RLE);
+	if (!Trame_RLE.empty()) {
 		ofstream rf("lenna.rle", ios::binary);
 		if (rf) {
-			for (int i = 0; i < trameLen; ++i) {
-				signed char b = static_cast<signed char>(Trame_RLE[i + 1]);
-				rf.put(static_cast<char>(b));
-			}
+			rf.write(reinterpret_cast<const char*>(Trame_RLE.data()), static_cast<std::streamsize>(Trame_RLE.size()));
 			rf.close();
-			cout << "Wrote lenna.rle (" << trameLen << " bytes)\n";
+			cout << "Wrote lenna.rle (" << Trame_RLE.size() << " bytes)\n";
 		} else {
 			cerr << "Cannot write RLE file\n";
 		}
@@ -397,8 +724,7 @@ int main(int argc, char** argv) {
 	// additionally compress the RLE trame with Huffman coding and write output file
 	compressor.Compression_JPEG(Trame_RLE, "lenna.huff");
 	cout << "Called Compression_JPEG to produce lenna.huff (Huffman output)\n";
-
-	delete[] Trame_RLE;
+	print_stats();
 
 	return 0;
 }
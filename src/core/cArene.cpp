@@ -0,0 +1,90 @@
+/**
+ * @file cArene.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements cArene.
+ */
+
+#include "core/cArene.h"
+
+#include <cstdint>
+
+cArene::cArene()
+    : mBloc(0), mPosition(0), mNbAllocations(0)
+{
+}
+
+void *cArene::allouer(size_t octets, size_t alignement)
+{
+    if (octets == 0) octets = 1;
+    for (;;) {
+        if (mBloc < mBlocs.size()) {
+            sBloc &b = mBlocs[mBloc];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(b.donnees.get());
+            const uintptr_t debut = (base + mPosition + alignement - 1) & ~static_cast<uintptr_t>(alignement - 1);
+            if (debut + octets <= base + b.taille) {
+                mPosition = static_cast<size_t>(debut - base) + octets;
+                return reinterpret_cast<void*>(debut);
+            }
+            // Later chunks were kept from a previous call: try them before growing.
+            if (mBloc + 1 < mBlocs.size()) {
+                ++mBloc;
+                mPosition = 0;
+                continue;
+            }
+        }
+        // New chunk: at least the request, and twice the current capacity.
+        size_t taille = getCapacite();
+        if (taille < kTailleBlocMin) taille = kTailleBlocMin;
+        if (taille < octets + alignement) taille = octets + alignement;
+        sBloc b;
+        b.donnees.reset(new unsigned char[taille]);
+        b.taille = taille;
+        mBlocs.push_back(std::move(b));
+        ++mNbAllocations;
+        mBloc = mBlocs.size() - 1;
+        mPosition = 0;
+    }
+}
+
+cArene::sMarque cArene::marquer() const
+{
+    return sMarque{ mBloc, mPosition };
+}
+
+void cArene::revenir(const sMarque &marque)
+{
+    mBloc = marque.bloc;
+    mPosition = marque.position;
+    if (mBloc == 0 && mPosition == 0 && mBlocs.size() > 1) {
+        const size_t total = getCapacite();
+        mBlocs.clear();
+        sBloc b;
+        b.donnees.reset(new unsigned char[total]);
+        b.taille = total;
+        mBlocs.push_back(std::move(b));
+        ++mNbAllocations;
+    }
+}
+
+std::vector<unsigned char> &cArene::tampon(eTamponArene t)
+{
+    return mTampons[t];
+}
+
+cHuffman &cArene::huffman(int classe)
+{
+    return mHuffman[classe ? 1 : 0];
+}
+
+size_t cArene::getCapacite() const
+{
+    size_t total = 0;
+    for (const sBloc &b : mBlocs) total += b.taille;
+    return total;
+}
+
+size_t cArene::getNbAllocations() const
+{
+    return mNbAllocations;
+}
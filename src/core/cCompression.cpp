@@ -6,28 +6,699 @@
  */
 
 #include "core/cCompression.h"
+#include "core/cArene.h"
+#include "core/cEcrivainHuf2.h"
+#include "core/cFormatHuf2.h"
+#include "core/cContexteCodec.h"
+#include "core/cThreadPool.h"
+#include "core/cFichierMappe.h"
+#include "core/cTablesHuffman.h"
+#include <algorithm>
 #include <vector>
+#include <array>
+#include <limits>
 #include <cstring>
 #include <fstream>
-#include <map>
 #include <string>
 #include <cmath>
+#include <utility>
 
 #include "dct/dct.h"
+#include "dct/dct_kernels.h"
 #include "quantification/quantification.h"
-#include <iostream>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
-// --- Static Member Definitions ---
+namespace {
 
-/** @brief Global quality parameter backing the static quantization helpers. */
-static unsigned int gQualiteGlobale = 50;
-/** @brief Cached Huffman symbols from the most recent encoding operation. */
-static char   gHuffSymbols[256];
-/** @brief Cached Huffman frequencies corresponding to gHuffSymbols. */
-static double gHuffFreqs[256];
-/** @brief Number of valid entries in the cached Huffman table. */
-static unsigned int gHuffCount = 0;
+/**
+ * @brief Parses an RLE byte stream into quantized blocks (row-major, de-zigzagged).
+ * @param trame The RLE bytes.
+ * @param n The number of bytes.
+ * @param[out] blocs Receives the decoded blocks (appended).
+ * @note The DC prediction starts from 0 at the beginning of the stream.
+ */
+void parser_blocs_rle(const char *trame, size_t n, std::vector<std::array<int,64>> &blocs)
+{
+    int previous_DC = 0;
+    size_t p = 0;
+    while (p < n) {
+        std::array<int,64> q{};
+
+        signed char dc_diff = static_cast<signed char>(trame[p++]);
+        int DC = static_cast<int>(dc_diff) + previous_DC;
+        q[0] = DC;
+        previous_DC = DC;
+
+        int idx = 1;
+        // Need two bytes (run,val) to decode an AC pair. Ensure bounds strictly.
+        while ((p + 1) < n && idx < 64) {
+            unsigned char run_u = static_cast<unsigned char>(trame[p++]);
+            signed char val_s = static_cast<signed char>(trame[p++]);
+            if (run_u == 0 && static_cast<unsigned char>(val_s) == 0) break; // EOB
+            idx += static_cast<int>(run_u);
+            if (idx >= 64) break;
+            q[ZIGZAG[idx]] = static_cast<int>(val_s);
+            idx++;
+        }
+        blocs.push_back(q);
+    }
+}
+
+/** @brief Number of blocks reconstructed per kernel call by the decoder. */
+constexpr size_t kLotBlocs = 16;
+
+/** @brief Index of the lowest set bit of a nonzero mask. */
+inline int compter_zeros_fin(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return static_cast<int>(i);
+#else
+    int n = 0;
+    while ((x & 1) == 0) { x >>= 1; ++n; }
+    return n;
+#endif
+}
+
+/** @brief Allocates a width x height image as one buffer plus row pointers (freed with delete[] rows[0], rows). */
+unsigned char **allouer_image(unsigned int largeur, unsigned int hauteur)
+{
+    unsigned char *buf = new unsigned char[static_cast<size_t>(largeur) * hauteur];
+    unsigned char **rows = new unsigned char*[hauteur];
+    for (unsigned int r = 0; r < hauteur; ++r) rows[r] = buf + static_cast<size_t>(r) * largeur;
+    return rows;
+}
+
+/**
+ * @brief Dequantizes and inverse-transforms consecutive blocks and writes them into the image.
+ *
+ * With masques, blocks without AC coefficients (mask <= 1) skip the
+ * transform: their 64 pixels are the value of Calcul_IDCT_DC() (or
+ * Calcul_IDCT_DC_Entier()), which is what the transform would give, and
+ * only their DC coefficient is read. The other blocks go to the kernels
+ * in runs of consecutive blocks.
+ *
+ * @param coefs nb blocks of quantized coefficients, row-major.
+ * @param nb The number of blocks.
+ * @param premier The raster index of the first block.
+ * @param ctx The quantization tables.
+ * @param mode The arithmetic of the inverse transform.
+ * @param image The first pixel of the image.
+ * @param pas The distance between two rows of the image, in bytes.
+ * @param blocks_w The number of blocks per row of the image.
+ * @param stats Receives the stage times (nullptr: not measured).
+ * @param masques The nonzero masks of the blocks (see cCompression::RLE_Decoder_Bloc()), or nullptr to transform them all.
+ */
+void reconstruire_blocs(const int16_t *coefs, size_t nb, size_t premier, const cContexteQuant &ctx,
+                        eModePipeline mode, unsigned char *image, size_t pas, size_t blocks_w, sStatistiques *stats,
+                        const uint64_t *masques = nullptr)
+{
+    int16_t pixels[kLotBlocs * 64];
+    const int *Q = ctx.getTable();
+    const float *Qf = ctx.getTableF();
+    size_t i = 0;
+    while (i < nb) {
+        if (masques && masques[i] <= 1) {
+            cChronoEtape chrono(stats, ETAPE_DCT);
+            const int16_t v = (mode == PIPELINE_ENTIER) ? Calcul_IDCT_DC_Entier(coefs[i * 64] * Q[0])
+                                                        : Calcul_IDCT_DC(coefs[i * 64], Qf[0]);
+            std::fill(pixels + i * 64, pixels + i * 64 + 64, v);
+            ++i;
+            continue;
+        }
+        size_t fin = i + 1;
+        while (fin < nb && !(masques && masques[fin] <= 1)) ++fin;
+        const int16_t *c = coefs + i * 64;
+        int16_t *p = pixels + i * 64;
+        if (mode == PIPELINE_ENTIER) {
+            int32_t dequant[kLotBlocs * 64];
+            {
+                cChronoEtape chrono(stats, ETAPE_QUANT);
+                for (size_t k = 0; k < (fin - i) * 64; ++k) dequant[k] = c[k] * Q[k % 64];
+            }
+            cChronoEtape chrono(stats, ETAPE_DCT);
+            for (size_t b = 0; b < fin - i; ++b) Calcul_IDCT_Block_Entier(dequant + b * 64, p + b * 64);
+        } else {
+            cChronoEtape chrono(stats, ETAPE_DCT);
+            dct_kernels().dequant_idct(c, Qf, p, fin - i);
+        }
+        i = fin;
+    }
+
+    cChronoEtape chrono(stats, ETAPE_DCT);
+    for (size_t i = 0; i < nb; ++i) {
+        const int16_t *bloc = pixels + i * 64;
+        const size_t x0 = ((premier + i) % blocks_w) * 8;
+        const size_t y0 = ((premier + i) / blocks_w) * 8;
+        for (int r = 0; r < 8; ++r) {
+            unsigned char *ligne = image + (y0 + r) * pas + x0;
+            for (int c = 0; c < 8; ++c) {
+                int val = bloc[r * 8 + c] + 128;
+                ligne[c] = static_cast<unsigned char>((val < 0) ? 0 : (val > 255) ? 255 : val);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Reconstructs consecutive blocks at a reduced scale: each block becomes cote x cote pixels.
+ *
+ * Only the cote x cote lowest-frequency coefficients are dequantized, and
+ * transformed by Calcul_IDCT_Reduite(); at cote 1 the pixel is the DC
+ * coefficient alone. The result does not depend on the pipeline mode.
+ *
+ * @param coefs nb blocks of quantized coefficients, row-major.
+ * @param nb The number of blocks.
+ * @param premier The raster index of the first block.
+ * @param ctx The quantization tables.
+ * @param cote The size of an output block: 1, 2 or 4.
+ * @param image The first pixel of the reduced image.
+ * @param pas The distance between two rows of the reduced image, in bytes.
+ * @param blocks_w The number of blocks per row of the image.
+ * @param stats Receives the stage times (nullptr: not measured).
+ */
+void reconstruire_blocs_reduits(const int16_t *coefs, size_t nb, size_t premier, const cContexteQuant &ctx,
+                                unsigned int cote, unsigned char *image, size_t pas, size_t blocks_w, sStatistiques *stats)
+{
+    cChronoEtape chrono(stats, ETAPE_DCT);
+    const float *Q = ctx.getTableF();
+    int16_t bloc[16];
+    for (size_t i = 0; i < nb; ++i) {
+        Calcul_IDCT_Reduite(coefs + i * 64, Q, cote, bloc);
+        const size_t x0 = ((premier + i) % blocks_w) * cote;
+        const size_t y0 = ((premier + i) / blocks_w) * cote;
+        for (unsigned int r = 0; r < cote; ++r) {
+            unsigned char *ligne = image + (y0 + r) * pas + x0;
+            for (unsigned int c = 0; c < cote; ++c) {
+                int val = bloc[r * cote + c] + 128;
+                ligne[c] = static_cast<unsigned char>((val < 0) ? 0 : (val > 255) ? 255 : val);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Forward transform and quantization of consecutive level-shifted blocks.
+ * @param decales nb blocks of level-shifted pixels (-128..127), row-major.
+ * @param nb The number of blocks.
+ * @param ctx The quantization tables.
+ * @param mode The arithmetic of the transform.
+ * @param dct Scratch for the coefficients (nb * 64 values; PIPELINE_FLOTTANT only).
+ * @param dct8 Scratch for the fixed-point coefficients (nb * 64 values; PIPELINE_ENTIER only).
+ * @param[out] zigzag The quantized coefficients in scan order (may be decales: the transform reads all blocks first).
+ * @param stats Receives the stage times (nullptr: not measured).
+ * @param[out] masques Receives the nonzero mask of each block (may be nullptr).
+ */
+void transformer_blocs(const int16_t *decales, size_t nb, const cContexteQuant &ctx, eModePipeline mode,
+                       float *dct, int32_t *dct8, int16_t *zigzag, sStatistiques *stats, uint64_t *masques = nullptr)
+{
+    {
+        cChronoEtape chrono(stats, ETAPE_DCT);
+        if (mode == PIPELINE_FLOTTANT) dct_kernels().dct(decales, dct, nb);
+        else for (size_t b = 0; b < nb; ++b) Calcul_DCT_Block_Entier(decales + b * 64, dct8 + b * 64);
+    }
+    cChronoEtape chrono(stats, ETAPE_QUANT);
+    for (size_t b = 0; b < nb; ++b) {
+        const uint64_t masque = (mode == PIPELINE_ENTIER) ? ctx.quantifier_zigzag_entier(dct8 + b * 64, zigzag + b * 64)
+                                                          : ctx.quantifier_zigzag(dct + b * 64, zigzag + b * 64);
+        if (masques) masques[b] = masque;
+    }
+}
+
+/**
+ * @brief Decodes consecutive blocks given in scan order into the image, as the decoder would.
+ * @param zigzag nb blocks of quantized coefficients in scan order.
+ * @param nb The number of blocks.
+ * @param premier The raster index of the first block.
+ * @param ctx The quantization tables.
+ * @param mode The arithmetic of the inverse transform.
+ * @param image The first pixel of the image.
+ * @param pas The distance between two rows of the image, in bytes.
+ * @param blocks_w The number of blocks per row of the image.
+ * @param stats Receives the stage times (nullptr: not measured).
+ */
+void reconstruire_zigzag(const int16_t *zigzag, size_t nb, size_t premier, const cContexteQuant &ctx,
+                         eModePipeline mode, unsigned char *image, size_t pas, size_t blocks_w, sStatistiques *stats)
+{
+    int16_t coefs[kLotBlocs * 64];
+    uint64_t masques[kLotBlocs];
+    for (size_t fait = 0; fait < nb; fait += kLotBlocs) {
+        const size_t lot = std::min(kLotBlocs, nb - fait);
+        for (size_t i = 0; i < lot; ++i) {
+            const int16_t *zz = zigzag + (fait + i) * 64;
+            uint64_t masque = 0;
+            for (int k = 0; k < 64; ++k) {
+                coefs[i * 64 + ZIGZAG[k]] = zz[k];
+                masque |= static_cast<uint64_t>(zz[k] != 0) << k;
+            }
+            masques[i] = masque | 1;
+        }
+        reconstruire_blocs(coefs, lot, premier + fait, ctx, mode, image, pas, blocks_w, stats, masques);
+    }
+}
+
+/**
+ * @brief RLE-codes consecutive blocks given in scan order.
+ * @param zigzag nb blocks of quantized coefficients in scan order.
+ * @param nb The number of blocks.
+ * @param premier The raster index of the first block (for the restart intervals).
+ * @param intervalle The restart interval in blocks (0 = none).
+ * @param[in,out] DC_precedent The DC predictor.
+ * @param[in,out] sortie The output; grown as needed, its first taille bytes are kept.
+ * @param taille The number of bytes already in sortie.
+ * @param masques The nonzero masks of the blocks (see transformer_blocs()), or nullptr to compute them.
+ * @return The number of bytes in sortie after the blocks.
+ */
+size_t coder_blocs_rle(const int16_t *zigzag, size_t nb, size_t premier, unsigned int intervalle,
+                       int &DC_precedent, std::vector<signed char> &sortie, size_t taille,
+                       const uint64_t *masques = nullptr)
+{
+    for (size_t b = 0; b < nb; ++b) {
+        // DC prediction restarts at the beginning of each restart interval.
+        if (intervalle != 0 && (premier + b) % intervalle == 0) DC_precedent = 0;
+
+        // Encode in place: keep room for a worst-case block at the end of the output.
+        if (taille + 128 > sortie.size()) sortie.resize(sortie.size() * 2 + 128);
+        const uint64_t masque = masques ? masques[b] : cCompression::MasqueNonNuls(zigzag + b * 64);
+        taille += static_cast<size_t>(cCompression::RLE_Block(zigzag + b * 64, masque, DC_precedent, sortie.data() + taille));
+        DC_precedent = zigzag[b * 64];
+    }
+    return taille;
+}
+
+/** @brief Fills nb consecutive cote x cote blocks, starting at raster index premier, with mid-gray (an all-zero block). */
+void remplir_blocs_gris(size_t premier, size_t nb, unsigned int cote, unsigned char *image, size_t pas, size_t blocks_w)
+{
+    for (size_t i = premier; i < premier + nb; ++i) {
+        const size_t x0 = (i % blocks_w) * cote;
+        const size_t y0 = (i / blocks_w) * cote;
+        for (unsigned int r = 0; r < cote; ++r) std::memset(image + (y0 + r) * pas + x0, 128, cote);
+    }
+}
+
+/**
+ * @brief Decodes up to nb blocks from a bitstream straight into the image.
+ * @param lecteur The symbol reader, positioned at a DC difference coded against 0.
+ * @param premier The raster index of the first block.
+ * @param nb The number of blocks to decode.
+ * @param ctx The quantization tables.
+ * @param mode The arithmetic of the inverse transform.
+ * @param cote The size of an output block: 8, or 4, 2, 1 for a reduced scale (see reconstruire_blocs_reduits()).
+ * @param image The first pixel of the image.
+ * @param pas The distance between two rows of the image, in bytes.
+ * @param blocks_w The number of blocks per row of the image.
+ * @param stats Receives the counters and stage times (nullptr: not measured).
+ * @return The number of blocks decoded (fewer than nb if the stream ends early).
+ */
+size_t decoder_blocs(cLecteurHuffman &lecteur, size_t premier, size_t nb, const cContexteQuant &ctx, eModePipeline mode,
+                     unsigned int cote, unsigned char *image, size_t pas, size_t blocks_w, sStatistiques *stats)
+{
+    int16_t coefs[kLotBlocs * 64];
+    uint64_t masques[kLotBlocs];
+    int DC_precedent = 0;
+    size_t faits = 0;
+    while (faits < nb) {
+        size_t lot = 0;
+        {
+            cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+            while (lot < kLotBlocs && faits + lot < nb
+                   && cCompression::RLE_Decoder_Bloc(lecteur, DC_precedent, coefs + lot * 64, masques[lot])) {
+                // The reduced scales read the low frequencies of every block.
+                if (cote != 8 && masques[lot] <= 1) std::memset(coefs + lot * 64 + 1, 0, 63 * sizeof(int16_t));
+                ++lot;
+            }
+        }
+        if (lot == 0) break;
+        if (cote == 8) {
+            reconstruire_blocs(coefs, lot, premier + faits, ctx, mode, image, pas, blocks_w, stats, masques);
+        } else {
+            reconstruire_blocs_reduits(coefs, lot, premier + faits, ctx, cote, image, pas, blocks_w, stats);
+        }
+        faits += lot;
+        if (lot < kLotBlocs && faits < nb) break; // the stream ended
+    }
+    if (kStatistiques && stats) {
+        stats->blocs += faits;
+        stats->symboles += lecteur.getNbSymboles();
+    }
+    return faits;
+}
+
+/**
+ * @struct sFluxHuf
+ * @brief What the header and extensions of a HUF1/HUF2 file (or a headerless stream) tell about it.
+ *
+ * The payload and the restart table point into the file bytes, which are not copied.
+ */
+struct sFluxHuf {
+    const unsigned char *payload = nullptr; ///< The Huffman-coded bits.
+    size_t taille = 0;                      ///< Payload size in bytes.
+    uint64_t bitsValides = 0;               ///< Number of meaningful payload bits.
+    unsigned int largeur = 0, hauteur = 0;  ///< Size from the trailer, 0 if absent.
+    unsigned int qualite = 0;               ///< Quality of the file, or the context's one.
+    uint32_t intervalle = 0;                ///< Restart interval in blocks, 0 if absent.
+    const unsigned char *segments = nullptr; ///< nbSeg (byte offset, bit count) pairs of uint32.
+    size_t nbSeg = 0;                       ///< Number of restart segments.
+    uint32_t intervalleIndex = 0;           ///< Seek index interval in blocks, 0 if absent.
+    const unsigned char *index = nullptr;   ///< nbIndex (bit position, DC predictor) pairs of uint32/int32.
+    size_t nbIndex = 0;                     ///< Number of index entries.
+    bool transposee = false;                ///< True if the blocks use the transposed quantization table.
+    bool canonique = false;                 ///< True if Longueurs holds the table, false for HUF1 counts.
+    unsigned int nbSym = 0;                 ///< Number of symbols of the table.
+    uint8_t Longueurs[256];                 ///< Canonical code lengths.
+    char Donnee[256];                       ///< HUF1 symbols.
+    double Frequence[256];                  ///< HUF1 counts.
+};
+
+/**
+ * @brief Parses a compressed file without decoding its payload.
+ * @param Donnees The file contents.
+ * @param Taille The number of bytes.
+ * @param codec The context whose cached table reads a headerless stream (nullptr: such streams are rejected).
+ * @param trace The trace hook (may be empty).
+ * @param[out] f What was read.
+ * @return False if the file is truncated, malformed or empty.
+ */
+bool lire_flux_huf(const uint8_t *Donnees, size_t Taille, const cContexteCodec *codec, const fTraceCodec &trace, sFluxHuf &f)
+{
+    if (!Donnees || Taille == 0) return false;
+    f.qualite = codec ? codec->getQualite() : 0;
+    std::memset(f.Longueurs, 0, sizeof(f.Longueurs));
+    uint32_t payload_bits = 0;
+
+    // HUF2 stores canonical code lengths; HUF1 (older files) stores symbol counts.
+    const bool huf1 = Taille >= 4 && std::memcmp(Donnees, "HUF1", 4) == 0;
+    const bool huf2 = Taille >= 4 && std::memcmp(Donnees, kMagiqueHuf2, sizeof(kMagiqueHuf2)) == 0;
+
+    if (huf1 || huf2) {
+        // Custom header found. Parse it to extract the Huffman table and payload info.
+        size_t pos = 4;
+        if (huf1) {
+            if (pos + sizeof(uint16_t) > Taille) return false;
+            uint16_t nb = 0; std::memcpy(&nb, Donnees+pos, sizeof(nb)); pos += sizeof(nb);
+            f.nbSym = nb;
+            if (f.nbSym > 256) return false;
+
+            for (unsigned int i = 0; i < f.nbSym; ++i) {
+                if (pos + 1 + sizeof(uint32_t) > Taille) return false;
+                f.Donnee[i] = static_cast<char>(Donnees[pos++]);
+                uint32_t cnt = 0; std::memcpy(&cnt, Donnees+pos, sizeof(cnt)); pos += sizeof(cnt);
+                f.Frequence[i] = static_cast<double>(cnt);
+            }
+        } else {
+            if (pos + 1 > Taille) return false;
+            const unsigned char modeTable = Donnees[pos++];
+            if (modeTable == kTableStatique) {
+                // Static table: only its reference is stored, the lengths come from the registry.
+                if (pos + sizeof(uint16_t) * 2 > Taille) return false;
+                uint16_t id = 0, version = 0;
+                std::memcpy(&id, Donnees + pos, sizeof(id)); pos += sizeof(id);
+                std::memcpy(&version, Donnees + pos, sizeof(version)); pos += sizeof(version);
+                const sTableHuffman *table = cTablesHuffman::global().trouver(id, version);
+                if (version == 0 || !table) {
+                    tracer_codec(trace, "[Decompression_JPEG] Static table %u version %u is not registered",
+                                 static_cast<unsigned int>(id), static_cast<unsigned int>(version));
+                    return false;
+                }
+                std::memcpy(f.Longueurs, table->Longueurs, sizeof(f.Longueurs));
+                f.nbSym = 256;
+            } else {
+                if (modeTable != kTableIntegree) return false; // unknown table mode
+                if (pos + cHuffman::kLongueurMax > Taille) return false;
+                const unsigned char *nbParLongueur = Donnees + pos;
+                pos += cHuffman::kLongueurMax;
+                for (int l = 1; l <= cHuffman::kLongueurMax; ++l) {
+                    for (unsigned int c = 0; c < nbParLongueur[l - 1]; ++c) {
+                        if (pos >= Taille || f.nbSym >= 256) return false;
+                        f.Longueurs[Donnees[pos++]] = static_cast<uint8_t>(l);
+                        ++f.nbSym;
+                    }
+                }
+            }
+            f.canonique = true;
+        }
+
+        if (pos + sizeof(uint32_t) * 2 > Taille) return false;
+        uint32_t payload_bytes = 0; std::memcpy(&payload_bytes, Donnees+pos, sizeof(payload_bytes)); pos += sizeof(payload_bytes);
+        std::memcpy(&payload_bits, Donnees+pos, sizeof(payload_bits)); pos += sizeof(payload_bits);
+
+        if (pos + payload_bytes > Taille) return false;
+        f.payload = Donnees + pos;
+        f.taille = payload_bytes;
+        tracer_codec(trace, "[Decompression_JPEG] Parsed %s header: nbSym=%u payload_bytes=%u payload_bits=%u",
+                     huf1 ? "HUF1" : "HUF2", f.nbSym, payload_bytes, payload_bits);
+
+        // Optional width/height trailer (added for correctness). If absent, fall back to inference later.
+        size_t trailer_pos = pos + payload_bytes;
+        if (trailer_pos + sizeof(uint32_t) * 2 <= Taille) {
+            uint32_t w = 0, h = 0;
+            std::memcpy(&w, Donnees + trailer_pos, sizeof(uint32_t));
+            std::memcpy(&h, Donnees + trailer_pos + sizeof(uint32_t), sizeof(uint32_t));
+            if (w != 0 && h != 0) {
+                f.largeur = w;
+                f.hauteur = h;
+            }
+
+            // Optional extensions, each introduced by its tag.
+            size_t ext_pos = trailer_pos + sizeof(uint32_t) * 2;
+            if (ext_pos + sizeof(kTagRestart) + sizeof(uint32_t) * 2 <= Taille &&
+                std::memcmp(Donnees + ext_pos, kTagRestart, sizeof(kTagRestart)) == 0) {
+                ext_pos += sizeof(kTagRestart);
+                uint32_t nbSeg = 0;
+                std::memcpy(&f.intervalle, Donnees + ext_pos, sizeof(uint32_t));
+                std::memcpy(&nbSeg, Donnees + ext_pos + sizeof(uint32_t), sizeof(uint32_t));
+                ext_pos += sizeof(uint32_t) * 2;
+                if (f.intervalle == 0 || ext_pos + static_cast<size_t>(nbSeg) * 8 > Taille) return false;
+                f.segments = Donnees + ext_pos;
+                f.nbSeg = nbSeg;
+                ext_pos += static_cast<size_t>(nbSeg) * 8;
+            }
+            if (ext_pos + sizeof(kTagQualite) + sizeof(uint32_t) <= Taille &&
+                std::memcmp(Donnees + ext_pos, kTagQualite, sizeof(kTagQualite)) == 0) {
+                uint32_t q = 0;
+                std::memcpy(&q, Donnees + ext_pos + sizeof(kTagQualite), sizeof(q));
+                if (q < 1 || q > 100) return false;
+                f.qualite = q;
+                ext_pos += sizeof(kTagQualite) + sizeof(uint32_t);
+            }
+            if (ext_pos + sizeof(kTagIndex) + sizeof(uint32_t) * 2 <= Taille &&
+                std::memcmp(Donnees + ext_pos, kTagIndex, sizeof(kTagIndex)) == 0) {
+                ext_pos += sizeof(kTagIndex);
+                uint32_t nbIndex = 0;
+                std::memcpy(&f.intervalleIndex, Donnees + ext_pos, sizeof(uint32_t));
+                std::memcpy(&nbIndex, Donnees + ext_pos + sizeof(uint32_t), sizeof(uint32_t));
+                ext_pos += sizeof(uint32_t) * 2;
+                if (f.intervalleIndex == 0 || ext_pos + static_cast<size_t>(nbIndex) * 8 > Taille) return false;
+                f.index = Donnees + ext_pos;
+                f.nbIndex = nbIndex;
+                ext_pos += static_cast<size_t>(nbIndex) * 8;
+            }
+            if (ext_pos + sizeof(kTagTransposee) <= Taille &&
+                std::memcmp(Donnees + ext_pos, kTagTransposee, sizeof(kTagTransposee)) == 0) {
+                f.transposee = true;
+                ext_pos += sizeof(kTagTransposee);
+            }
+        }
+    } else {
+        // No header. Fall back to a cached Huffman table if available.
+        if (!codec || !codec->loadHuffmanTable(f.Donnee, f.Frequence, f.nbSym)) {
+            return false; // No table available. Cannot decompress.
+        }
+        // Rebuild the canonical lengths exactly as Compression_JPEG() derived them.
+        uint32_t Comptes[256] = {0};
+        for (unsigned int i = 0; i < f.nbSym; ++i) {
+            Comptes[static_cast<unsigned char>(f.Donnee[i])] = static_cast<uint32_t>(f.Frequence[i]);
+        }
+        cHuffman::CalculerLongueurs(Comptes, f.Longueurs);
+        f.canonique = true;
+        f.payload = Donnees;
+        f.taille = Taille;
+    }
+
+    // Empty payload cannot produce blocks; treat as failure to let callers fall back gracefully.
+    if (payload_bits == 0 && f.taille == 0) return false;
+    f.bitsValides = (payload_bits > 0) ? payload_bits : static_cast<uint64_t>(f.taille) * 8ULL;
+    return f.nbSym != 0;
+}
+
+/** @brief Builds the decoder of a parsed file into h; its storage is reused when h already held a table. */
+bool construire_decodeur(sFluxHuf &f, cHuffman &h)
+{
+    if (f.canonique) return h.ConstruireDepuisLongueurs(f.Longueurs);
+    h.HuffmanCodes(f.Donnee, f.Frequence, f.nbSym);
+    return h.getRacine() != nullptr;
+}
+
+/**
+ * @brief Decodes a parsed file whose size is known into an image.
+ *
+ * Each block goes from the bitstream through RLE expansion, dequantization
+ * and IDCT into the image, a few blocks at a time, so nothing but the
+ * image itself grows with its size. Restart segments are independent and
+ * cover disjoint blocks: they are decoded concurrently on the pool. A
+ * segment that fails to decode, or does not hold exactly its blocks, is
+ * replaced by flat blocks so that the rest of the image survives. With a
+ * cote below 8 the image is written at a reduced scale, cote / 8 of the
+ * size, and the high frequencies of the blocks are never transformed.
+ *
+ * @param corrompu Scratch of f.nbSeg flags.
+ * @param stats Receives the counters and stage times (nullptr: not measured).
+ * @param parSegment Scratch of f.nbSeg records when stats is set: one per concurrent segment.
+ * @param trace The trace hook (may be empty).
+ * @return False if the stream (without restart segments) cannot be decoded at all.
+ */
+bool decoder_image(const sFluxHuf &f, const cHuffman &h, unsigned int largeur, unsigned int hauteur,
+                   eModePipeline mode, unsigned int cote, cThreadPool *pool, char *corrompu, sStatistiques *stats, sStatistiques *parSegment,
+                   const fTraceCodec &trace, unsigned char *image, size_t pas)
+{
+    const cContexteQuant ctx(f.qualite, COMPOSANTE_LUMA, f.transposee);
+    const size_t blocks_w = largeur / 8;
+    const size_t blocks_h = hauteur / 8;
+    const size_t total = blocks_w * blocks_h;
+    if (total == 0) return false;
+
+    if (f.nbSeg == 0) {
+        cLecteurHuffman lecteur(h, f.payload, f.taille, 0, f.bitsValides);
+        const size_t decodes = decoder_blocs(lecteur, 0, total, ctx, mode, cote, image, pas, blocks_w, stats);
+        if (lecteur.erreur() || decodes == 0) return false;
+        if (decodes < total) remplir_blocs_gris(decodes, total - decodes, cote, image, pas, blocks_w);
+        tracer_codec(trace, "[Decompression_JPEG] Decoded %zu blocks", decodes);
+        return true;
+    }
+
+    auto decoder_segment = [&](size_t i) {
+        corrompu[i] = 0;
+        sStatistiques *s = (kStatistiques && stats) ? &(parSegment[i] = sStatistiques()) : nullptr;
+        const size_t premier = i * f.intervalle;
+        if (premier >= total) return;
+        const size_t attendus = (i + 1 < f.nbSeg && total - premier > f.intervalle) ? f.intervalle : total - premier;
+        uint32_t octet = 0, bits = 0;
+        std::memcpy(&octet, f.segments + i * 8, sizeof(octet));
+        std::memcpy(&bits, f.segments + i * 8 + sizeof(octet), sizeof(bits));
+        cLecteurHuffman lecteur(h, f.payload, f.taille, static_cast<uint64_t>(octet) * 8ULL, bits);
+        const size_t decodes = decoder_blocs(lecteur, premier, attendus, ctx, mode, cote, image, pas, blocks_w, s);
+        if (lecteur.erreur() || decodes != attendus || lecteur.lire() >= 0 || lecteur.erreur()) {
+            corrompu[i] = 1;
+            remplir_blocs_gris(premier, attendus, cote, image, pas, blocks_w);
+        }
+    };
+
+    if (pool && f.nbSeg > 1) {
+        pool->paralleliser(f.nbSeg, decoder_segment);
+    } else {
+        for (size_t i = 0; i < f.nbSeg; ++i) decoder_segment(i);
+    }
+    for (size_t i = 0; i < f.nbSeg; ++i) {
+        if (kStatistiques && stats) {
+            stats->ajouter(parSegment[i]);
+            stats->segmentsCorrompus += corrompu[i];
+        }
+        if (corrompu[i]) tracer_codec(trace, "[Decompression_JPEG] Restart segment %zu is corrupted, replaced by flat blocks", i);
+    }
+    return true;
+}
+
+/**
+ * @brief decoder_image() for any image size.
+ *
+ * A size that is not a multiple of 8 (a file streamed by cEncodeurFlux
+ * keeps the size it was given) is decoded as its whole blocks into scratch
+ * from the arena, then cropped into the image.
+ */
+bool decoder_image_recadree(const sFluxHuf &f, const cHuffman &h, unsigned int largeur, unsigned int hauteur,
+                            eModePipeline mode, unsigned int cote, cThreadPool *pool, char *corrompu, sStatistiques *stats,
+                            sStatistiques *parSegment, const fTraceCodec &trace, cArene &arene, unsigned char *image, size_t pas)
+{
+    const unsigned int largeurBlocs = ((largeur + 7) / 8) * 8, hauteurBlocs = ((hauteur + 7) / 8) * 8;
+    if (largeurBlocs == largeur && hauteurBlocs == hauteur) {
+        return decoder_image(f, h, largeur, hauteur, mode, cote, pool, corrompu, stats, parSegment, trace, image, pas);
+    }
+    const unsigned int echelle = 8 / cote;
+    const size_t pasBlocs = largeurBlocs / echelle;
+    unsigned char *blocs = arene.allouer<unsigned char>(pasBlocs * (hauteurBlocs / echelle));
+    if (!decoder_image(f, h, largeurBlocs, hauteurBlocs, mode, cote, pool, corrompu, stats, parSegment, trace, blocs, pasBlocs)) {
+        return false;
+    }
+    const unsigned int largeurSortie = cCompression::TailleReduite(largeur, echelle);
+    const unsigned int hauteurSortie = cCompression::TailleReduite(hauteur, echelle);
+    for (unsigned int y = 0; y < hauteurSortie; ++y) std::memcpy(image + y * pas, blocs + y * pasBlocs, largeurSortie);
+    return true;
+}
+
+/**
+ * @struct sCurseurBlocs
+ * @brief A position in the bitstream of a parsed file: the next block to decode and its DC predictor.
+ */
+struct sCurseurBlocs {
+    cLecteurHuffman lecteur;   ///< Reads the symbols of the current restart segment (or of the whole stream).
+    size_t bloc = SIZE_MAX;    ///< Raster index of the next block; SIZE_MAX when not positioned.
+    size_t segment = 0;        ///< Restart segment the reader is in (0 without restart segments).
+    int DC = 0;                ///< The DC predictor of the next block.
+
+    explicit sCurseurBlocs(const cHuffman &h) : lecteur(h, nullptr, 0, 0, 0) {}
+};
+
+/**
+ * @brief Brings a cursor to block b, ready to decode it.
+ *
+ * The cursor goes on from where it is if that is in the same segment and
+ * not past b; otherwise it is moved to the closest start point before b:
+ * the index entry, or the start of the restart segment. The blocks in
+ * between are entropy-decoded and discarded.
+ *
+ * @param scratch Room for the coefficients of one block.
+ * @return False if b cannot be reached (the cursor is then not positioned).
+ */
+bool positionner_curseur(const sFluxHuf &f, const cHuffman &h, size_t b, sCurseurBlocs &cur, int16_t *scratch)
+{
+    size_t segment = 0, depart = 0;
+    uint64_t bit = 0, fin = f.bitsValides;
+    int DC = 0;
+    if (f.nbSeg != 0) {
+        segment = b / f.intervalle;
+        if (segment >= f.nbSeg) return false;
+        uint32_t octet = 0, bits = 0;
+        std::memcpy(&octet, f.segments + segment * 8, sizeof(octet));
+        std::memcpy(&bits, f.segments + segment * 8 + sizeof(octet), sizeof(bits));
+        depart = segment * f.intervalle;
+        bit = static_cast<uint64_t>(octet) * 8ULL;
+        fin = bit + bits;
+    }
+    if (f.nbIndex != 0 && b / f.intervalleIndex < f.nbIndex && (b / f.intervalleIndex) * f.intervalleIndex >= depart) {
+        const size_t e = b / f.intervalleIndex;
+        uint32_t position = 0;
+        int32_t dc = 0;
+        std::memcpy(&position, f.index + e * 8, sizeof(position));
+        std::memcpy(&dc, f.index + e * 8 + sizeof(position), sizeof(dc));
+        if (position < bit || position > fin) return false;
+        depart = e * f.intervalleIndex;
+        bit = position;
+        DC = dc;
+    }
+
+    if (cur.bloc == SIZE_MAX || cur.segment != segment || cur.bloc > b || cur.bloc < depart) {
+        cur.lecteur = cLecteurHuffman(h, f.payload, f.taille, bit, fin - bit);
+        cur.bloc = depart;
+        cur.segment = segment;
+        cur.DC = DC;
+    }
+    uint64_t masque = 0;
+    for (; cur.bloc < b; ++cur.bloc) {
+        if (!cCompression::RLE_Decoder_Bloc(cur.lecteur, cur.DC, scratch, masque)) {
+            cur.bloc = SIZE_MAX;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
 
 
 // --- cCompression Method Implementations ---
@@ -38,6 +709,13 @@ cCompression::cCompression()
     this->mHauteur = 0;
     this->mQualite = 50;
     this->mBuffer = nullptr;
+    this->mModePipeline = PIPELINE_FLOTTANT;
+    this->mNbThreads = 1;
+    this->mIntervalleRestart = 0;
+    this->mIntervalleIndex = 0;
+    this->mEchelle = 1;
+    this->mTableStatique = nullptr;
+    this->mStatistiques = nullptr;
 }
 
 cCompression::cCompression(unsigned int largeur, unsigned int hauteur, unsigned int qualite, unsigned char **buffer)
@@ -46,6 +724,13 @@ cCompression::cCompression(unsigned int largeur, unsigned int hauteur, unsigned
     this->mHauteur = hauteur;
     this->mQualite = qualite;
     this->mBuffer = buffer;
+    this->mModePipeline = PIPELINE_FLOTTANT;
+    this->mNbThreads = 1;
+    this->mIntervalleRestart = 0;
+    this->mIntervalleIndex = 0;
+    this->mEchelle = 1;
+    this->mTableStatique = nullptr;
+    this->mStatistiques = nullptr;
 }
 
 cCompression::~cCompression()
@@ -68,6 +753,60 @@ void cCompression::setQualite(unsigned int qualite)
     this->mQualite = qualite;
 }
 
+void cCompression::setModePipeline(eModePipeline mode)
+{
+    this->mModePipeline = mode;
+}
+
+void cCompression::setNbThreads(unsigned int nbThreads)
+{
+    this->mNbThreads = nbThreads;
+    if (this->mPool && this->mPool->getNbThreads() != ((nbThreads == 0) ? cThreadPool::nbThreadsMateriel() : nbThreads)) {
+        this->mPool.reset();
+    }
+}
+
+void cCompression::setPool(const std::shared_ptr<cThreadPool> &pool)
+{
+    this->mPool = pool;
+    if (pool) this->mNbThreads = pool->getNbThreads();
+}
+
+cThreadPool *cCompression::getPoolActif()
+{
+    const unsigned int nbThreads = (mNbThreads == 0) ? cThreadPool::nbThreadsMateriel() : mNbThreads;
+    if (nbThreads <= 1) return nullptr;
+    if (!mPool) mPool = std::make_shared<cThreadPool>(nbThreads);
+    return mPool.get();
+}
+
+void cCompression::setIntervalleRestart(unsigned int nbBlocs)
+{
+    this->mIntervalleRestart = nbBlocs;
+}
+
+void cCompression::setIntervalleIndex(unsigned int nbBlocs)
+{
+    this->mIntervalleIndex = nbBlocs;
+}
+
+bool cCompression::setTableStatique(uint16_t id, uint16_t version)
+{
+    if (id == 0) {
+        this->mTableStatique = nullptr;
+        return true;
+    }
+    const sTableHuffman *table = cTablesHuffman::global().trouver(id, version);
+    if (!table) return false;
+    this->mTableStatique = table;
+    return true;
+}
+
+void cCompression::setEchelle(unsigned int echelle)
+{
+    this->mEchelle = (echelle == 2 || echelle == 4 || echelle == 8) ? echelle : 1;
+}
+
 void cCompression::setBuffer(unsigned char **buffer)
 {
     this->mBuffer = buffer;
@@ -88,206 +827,695 @@ unsigned int cCompression::getQualite() const
     return this->mQualite;
 }
 
+eModePipeline cCompression::getModePipeline() const
+{
+    return this->mModePipeline;
+}
+
+unsigned int cCompression::getNbThreads() const
+{
+    return this->mNbThreads;
+}
+
+unsigned int cCompression::getIntervalleRestart() const
+{
+    return this->mIntervalleRestart;
+}
+
+unsigned int cCompression::getIntervalleIndex() const
+{
+    return this->mIntervalleIndex;
+}
+
+const sTableHuffman *cCompression::getTableStatique() const
+{
+    return this->mTableStatique;
+}
+
+unsigned int cCompression::getEchelle() const
+{
+    return this->mEchelle;
+}
+
+unsigned int cCompression::TailleReduite(unsigned int taille, unsigned int echelle)
+{
+    return (echelle > 1) ? (taille + echelle - 1) / echelle : taille;
+}
+
 unsigned char **cCompression::getBuffer() const
 {
     return this->mBuffer;
 }
 
+void cCompression::setContexte(const std::shared_ptr<cContexteCodec> &contexte)
+{
+    this->mContexte = contexte;
+}
+
+const cContexteCodec &cCompression::getContexte() const
+{
+    return contexte();
+}
+
+cContexteCodec &cCompression::contexte() const
+{
+    return this->mContexte ? *this->mContexte : cContexteCodec::global();
+}
+
+void cCompression::setArene(const std::shared_ptr<cArene> &arene)
+{
+    this->mArene = arene;
+}
+
+cArene &cCompression::arene()
+{
+    if (!this->mArene) this->mArene = std::make_shared<cArene>();
+    return *this->mArene;
+}
+
+void cCompression::setStatistiques(sStatistiques *stats)
+{
+    this->mStatistiques = stats;
+}
+
+sStatistiques *cCompression::getStatistiques() const
+{
+    return kStatistiques ? this->mStatistiques : nullptr;
+}
+
+void cCompression::setTrace(const fTraceCodec &trace)
+{
+    this->mTrace = trace;
+}
+
+const fTraceCodec &cCompression::getTrace() const
+{
+    return this->mTrace;
+}
+
 unsigned int cCompression::getQualiteGlobale()
 {
-    return gQualiteGlobale;
+    return cContexteCodec::global().getQualite();
 }
 
 void cCompression::setQualiteGlobale(unsigned int qualite)
 {
-    gQualiteGlobale = (qualite < 1) ? 1 : (qualite > 100) ? 100 : qualite;
+    cContexteCodec::global().setQualite(qualite);
 }
 
 void cCompression::storeHuffmanTable(const char *symbols, const double *frequencies, unsigned int count)
 {
-    if (!symbols || !frequencies || count == 0) {
-        gHuffCount = 0;
-        return;
-    }
-    gHuffCount = (count > 256) ? 256 : count;
-    std::memcpy(gHuffSymbols, symbols, gHuffCount);
-    for (unsigned int i = 0; i < gHuffCount; ++i) {
-        gHuffFreqs[i] = frequencies[i];
-    }
+    cContexteCodec::global().storeHuffmanTable(symbols, frequencies, count);
 }
 
 bool cCompression::loadHuffmanTable(char *symbols, double *frequencies, unsigned int &count)
 {
-    if (!symbols || !frequencies || gHuffCount == 0) {
-        count = 0;
-        return false;
-    }
-    std::memcpy(symbols, gHuffSymbols, gHuffCount);
-    for (unsigned int i = 0; i < gHuffCount; ++i) {
-        frequencies[i] = gHuffFreqs[i];
-    }
-    count = gHuffCount;
-    return true;
+    return cContexteCodec::global().loadHuffmanTable(symbols, frequencies, count);
 }
 
 bool cCompression::hasStoredHuffmanTable()
 {
-    return gHuffCount != 0;
+    return cContexteCodec::global().hasStoredHuffmanTable();
 }
 
-double cCompression::EQM(int **Bloc8x8)
+double sAnalyseImage::psnr() const
 {
-    if (!Bloc8x8) return 0.0;
+    const double mse = eqm();
+    if (nbBlocs() == 0) return 0.0;
+    if (mse <= 0.0) return std::numeric_limits<double>::infinity();
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
 
-    // Buffers for the pipeline
-    int shifted[8][8];      int* shifted_ptrs[8];
-    double dct[8][8];       double* dct_ptrs[8];
-    int quant[8][8];        int* quant_ptrs[8];
-    double dequant[8][8];   double* dequant_ptrs[8];
-    int recon[8][8];        int* recon_ptrs[8];
-    for (int i=0; i<8; ++i) {
-        shifted_ptrs[i] = shifted[i]; dct_ptrs[i] = dct[i]; quant_ptrs[i] = quant[i];
-        dequant_ptrs[i] = dequant[i]; recon_ptrs[i] = recon[i];
-    }
-
-    // Pipeline: Shift -> DCT -> Quant -> Dequant -> IDCT
-    for (int i = 0; i < 8; ++i) for (int j = 0; j < 8; ++j) shifted[i][j] = Bloc8x8[i][j] - 128;
-    Calcul_DCT_Block(shifted_ptrs, dct_ptrs);
-    quant_JPEG(dct_ptrs, quant_ptrs);
-    dequant_JPEG(quant_ptrs, dequant_ptrs);
-    Calcul_IDCT_Block(dequant_ptrs, recon_ptrs);
-
-    // Calculate sum of squared differences
-    double sum_sq_err = 0.0;
+void cCompression::Analyse_Bloc(int **Bloc8x8, sAnalyseBloc &analyse)
+{
+    if (!Bloc8x8) {
+        analyse = sAnalyseBloc();
+        return;
+    }
+
+    // Shift -> DCT -> Quant, then Dequant -> IDCT exactly as the decoder reconstructs the block
+    const cContexteQuant &ctx = contexte().getQuant();
+    int16_t decale[64];
+    float dct[64];
+    int32_t dct8[64];
+    for (int i = 0; i < 8; ++i) for (int j = 0; j < 8; ++j) decale[i * 8 + j] = static_cast<int16_t>(Bloc8x8[i][j] - 128);
+    transformer_blocs(decale, 1, ctx, mModePipeline, dct, dct8, analyse.zigzag, nullptr);
+    reconstruire_zigzag(analyse.zigzag, 1, 0, ctx, mModePipeline, analyse.reconstruit, 8, 1, nullptr);
+
+    int somme = 0, zeros = 0;
     for (int i = 0; i < 8; ++i) {
         for (int j = 0; j < 8; ++j) {
-            int reconstructed_val = recon[i][j] + 128;
-            reconstructed_val = (reconstructed_val < 0) ? 0 : (reconstructed_val > 255) ? 255 : reconstructed_val;
-            double diff = static_cast<double>(Bloc8x8[i][j] - reconstructed_val);
-            sum_sq_err += diff * diff;
+            const int diff = Bloc8x8[i][j] - analyse.reconstruit[i * 8 + j];
+            somme += diff * diff;
         }
     }
-    return sum_sq_err / 64.0;
+    for (int k = 0; k < 64; ++k) if (analyse.zigzag[k] == 0) ++zeros;
+    analyse.eqm = somme / 64.0;
+    analyse.tauxZeros = zeros / 64.0;
+}
+
+double cCompression::EQM(int **Bloc8x8)
+{
+    if (!Bloc8x8) return 0.0;
+    sAnalyseBloc analyse;
+    Analyse_Bloc(Bloc8x8, analyse);
+    return analyse.eqm;
 }
 
 double cCompression::Taux_Compression(int **Bloc8x8)
 {
     if (!Bloc8x8) return 0.0;
+    sAnalyseBloc analyse;
+    Analyse_Bloc(Bloc8x8, analyse);
+    return analyse.tauxZeros;
+}
+
+int cCompression::RLE_Block(int **Img_Quant, int DC_precedent, signed char *Trame)
+{
+    if (!Img_Quant || !Trame) return 0;
 
-    // Buffers
-    int shifted[8][8];      int* shifted_ptrs[8];
-    double dct[8][8];       double* dct_ptrs[8];
-    int quant[8][8];        int* quant_ptrs[8];
-    for (int i=0; i<8; ++i) {
-        shifted_ptrs[i] = shifted[i]; dct_ptrs[i] = dct[i]; quant_ptrs[i] = quant[i];
+    int16_t zigzag[64];
+    for (int k = 0; k < 64; ++k) {
+        zigzag[k] = static_cast<int16_t>(Img_Quant[ZIGZAG[k] / 8][ZIGZAG[k] % 8]);
     }
+    return RLE_Block(zigzag, DC_precedent, Trame);
+}
 
-    // Pipeline: Shift -> DCT -> Quant
-    for (int i = 0; i < 8; ++i) for (int j = 0; j < 8; ++j) shifted[i][j] = Bloc8x8[i][j] - 128;
-    Calcul_DCT_Block(shifted_ptrs, dct_ptrs);
-    quant_JPEG(dct_ptrs, quant_ptrs);
+int cCompression::RLE_Block(const int16_t *Zigzag, int DC_precedent, signed char *Trame)
+{
+    if (!Zigzag || !Trame) return 0;
+    return RLE_Block(Zigzag, MasqueNonNuls(Zigzag), DC_precedent, Trame);
+}
 
-    // Count zero coefficients
-    int zero_count = 0;
-    for (int i = 0; i < 8; ++i) for (int j = 0; j < 8; ++j) if (quant[i][j] == 0) ++zero_count;
+int cCompression::RLE_Block(const int16_t *Zigzag, uint64_t Masque, int DC_precedent, signed char *Trame)
+{
+    if (!Zigzag || !Trame) return 0;
 
-    return static_cast<double>(zero_count) / 64.0;
+    int pos = 0;
+    // DC coefficient is differentially coded
+    int dc_diff = Zigzag[0] - DC_precedent;
+    Trame[pos++] = static_cast<signed char>(dc_diff);
+
+    // AC coefficients are run-length encoded: each set bit is a nonzero
+    // coefficient, the run is the distance from the previous one.
+    int dernier = 0;
+    for (uint64_t ac = Masque & ~uint64_t(1); ac != 0; ac &= ac - 1) {
+        const int k = compter_zeros_fin(ac);
+        int zero_run = k - dernier - 1;
+        while (zero_run > 15) { // Max run length is 15
+            Trame[pos++] = 0x0F; // (15, 0)
+            Trame[pos++] = 0x00;
+            zero_run -= 16;
+        }
+        Trame[pos++] = static_cast<signed char>(zero_run);
+        Trame[pos++] = static_cast<signed char>(Zigzag[k]);
+        dernier = k;
+    }
+
+    // End-of-Block marker, only needed when the block ends with zeros:
+    // the decoder stops by itself once the 64th coefficient is filled.
+    if (dernier < 63) {
+        Trame[pos++] = 0x00; // (0, 0)
+        Trame[pos++] = 0x00;
+    }
+    return pos;
 }
 
-void cCompression::RLE_Block(int **Img_Quant, int DC_precedent, signed char *Trame)
+uint64_t cCompression::MasqueNonNuls(const int16_t *Zigzag)
 {
-    if (!Img_Quant || !Trame) return;
+    // One byte per group of 8 coefficients keeps the groups independent of each other.
+    uint64_t masque = 0;
+    for (int g = 0; g < 64; g += 8) {
+        unsigned int octet = 0;
+        for (int k = 0; k < 8; ++k) octet |= static_cast<unsigned int>(Zigzag[g + k] != 0) << k;
+        masque |= static_cast<uint64_t>(octet) << g;
+    }
+    return masque;
+}
 
-    // Zigzag scan order
-    static const int zigzag[64] = {
-         0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
-        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
-        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
-        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
-    };
+bool cCompression::RLE_Decoder_Bloc(cLecteurHuffman &lecteur, int &DC_precedent, int16_t *Coefs)
+{
+    uint64_t masque = 0;
+    if (!RLE_Decoder_Bloc(lecteur, DC_precedent, Coefs, masque)) return false;
+    if (masque <= 1) std::memset(Coefs + 1, 0, 63 * sizeof(int16_t));
+    return true;
+}
 
-    int linear_quant[64];
-    for(int i=0; i<64; ++i) {
-        linear_quant[i] = Img_Quant[zigzag[i]/8][zigzag[i]%8];
+bool cCompression::RLE_Decoder_Bloc(cLecteurHuffman &lecteur, int &DC_precedent, int16_t *Coefs, uint64_t &Masque)
+{
+    const int dc = lecteur.lire();
+    if (dc < 0) return false;
+    DC_precedent += static_cast<signed char>(dc);
+    Coefs[0] = static_cast<int16_t>(DC_precedent);
+    Masque = 1;
+
+    // Flat blocks: End-of-Block right after the DC, nothing else to write.
+    int run = lecteur.lire();
+    if (run < 0) return true;
+    int val = lecteur.lire();
+    if (val < 0 || (run == 0 && val == 0)) return true;
+
+    std::memset(Coefs + 1, 0, 63 * sizeof(int16_t));
+    int idx = 1;
+    for (;;) {
+        idx += run;
+        if (idx >= 64) break;
+        Coefs[ZIGZAG[idx]] = static_cast<signed char>(val);
+        Masque |= static_cast<uint64_t>(val != 0) << idx;
+        if (++idx >= 64) break;
+        run = lecteur.lire();
+        if (run < 0) break;
+        val = lecteur.lire();
+        if (val < 0) break;
+        if (run == 0 && val == 0) break; // EOB
     }
+    return true;
+}
 
-    int pos = 0;
-    // DC coefficient is differentially coded
-    int dc_diff = linear_quant[0] - DC_precedent;
-    Trame[pos++] = static_cast<signed char>(dc_diff);
+void cCompression::decomposer_transformation(eTransformation t, bool &transposee, bool &miroirX, bool &miroirY)
+{
+    transposee = (t == TRANSFORMATION_ROTATION_90 || t == TRANSFORMATION_ROTATION_270
+                  || t == TRANSFORMATION_TRANSPOSITION || t == TRANSFORMATION_TRANSVERSE);
+    miroirX = (t == TRANSFORMATION_MIROIR_H || t == TRANSFORMATION_ROTATION_180
+               || t == TRANSFORMATION_ROTATION_90 || t == TRANSFORMATION_TRANSVERSE);
+    miroirY = (t == TRANSFORMATION_MIROIR_V || t == TRANSFORMATION_ROTATION_180
+               || t == TRANSFORMATION_ROTATION_270 || t == TRANSFORMATION_TRANSVERSE);
+}
 
-    // AC coefficients are run-length encoded
-    int zero_run = 0;
-    for (int k = 1; k < 64; ++k) {
-        if (linear_quant[k] == 0) {
-            zero_run++;
-        } else {
-            while (zero_run > 15) { // Max run length is 15
-                Trame[pos++] = 0x0F; // (15, 0)
-                Trame[pos++] = 0x00;
-                zero_run -= 16;
+void cCompression::bloc_source(eTransformation t, unsigned int largeurBlocs, unsigned int hauteurBlocs,
+                               unsigned int x, unsigned int y, unsigned int &sx, unsigned int &sy)
+{
+    bool transposee, miroirX, miroirY;
+    decomposer_transformation(t, transposee, miroirX, miroirY);
+    // The grid after the transposition, which the mirrors then reverse.
+    const unsigned int largeurT = transposee ? hauteurBlocs : largeurBlocs;
+    const unsigned int hauteurT = transposee ? largeurBlocs : hauteurBlocs;
+    const unsigned int tx = miroirX ? largeurT - 1 - x : x;
+    const unsigned int ty = miroirY ? hauteurT - 1 - y : y;
+    sx = transposee ? ty : tx;
+    sy = transposee ? tx : ty;
+}
+
+void cCompression::TransformerBloc(const int16_t *Coefs, eTransformation t, int16_t *Zigzag)
+{
+    bool transposee, miroirX, miroirY;
+    decomposer_transformation(t, transposee, miroirX, miroirY);
+    for (int k = 0; k < 64; ++k) {
+        const int v = ZIGZAG[k] / 8, u = ZIGZAG[k] % 8;
+        const int c = transposee ? Coefs[u * 8 + v] : Coefs[ZIGZAG[k]];
+        // A mirror negates the odd frequencies along its axis.
+        const bool negatif = (miroirX && (u & 1)) != (miroirY && (v & 1));
+        Zigzag[k] = static_cast<int16_t>(negatif ? -c : c);
+    }
+}
+
+void cCompression::decaler_ligne(unsigned int by, int16_t *row_blocks) const
+{
+    const unsigned int blocks_w = mLargeur / 8;
+    for (unsigned int b = 0; b < blocks_w; ++b) {
+        int16_t *block = row_blocks + static_cast<size_t>(b) * 64;
+        for (int r = 0; r < 8; ++r) for (int c = 0; c < 8; ++c) {
+            block[r * 8 + c] = static_cast<int16_t>(static_cast<int>(mBuffer[by + r][b * 8 + c]) - 128);
+        }
+    }
+}
+
+void cCompression::RLE_Bande(unsigned int ligne_debut, unsigned int ligne_fin, const cContexteQuant &ctx,
+                             int16_t *row_blocks, float *row_dct, int32_t *row_dct8, uint64_t *row_masques,
+                             sStatistiques *stats, std::vector<signed char> &sortie, int &DC_premier, int &DC_dernier)
+{
+    int previous_DC = 0;
+    DC_premier = 0;
+    DC_dernier = 0;
+
+    // One block row is transformed per kernel call.
+    const unsigned int blocks_w = mLargeur / 8;
+    size_t taille = sortie.size();
+
+    for (unsigned int by = ligne_debut; by < ligne_fin; by += 8) {
+        {
+            // Level-shift and copy the blocks of this row
+            cChronoEtape chrono(stats, ETAPE_DCT);
+            decaler_ligne(by, row_blocks);
+        }
+        // DCT of the whole row, then quantization straight into scan order over the level-shifted blocks
+        transformer_blocs(row_blocks, blocks_w, ctx, mModePipeline, row_dct, row_dct8, row_blocks, stats, row_masques);
+        if (by == ligne_debut) DC_premier = row_blocks[0];
+
+        // RLE encoding of the row
+        cChronoEtape chrono(stats, ETAPE_RLE);
+        taille = coder_blocs_rle(row_blocks, blocks_w, static_cast<size_t>(by / 8) * blocks_w, mIntervalleRestart,
+                                 previous_DC, sortie, taille, row_masques);
+    }
+    sortie.resize(taille);
+    DC_dernier = previous_DC;
+    if (kStatistiques && stats) stats->blocs += static_cast<uint64_t>((ligne_fin - ligne_debut) / 8) * blocks_w;
+}
+
+void cCompression::Analyse_Bande(unsigned int ligne_debut, unsigned int ligne_fin, const cContexteQuant &ctx,
+                                 int16_t *row_blocks, float *row_dct, int32_t *row_dct8, sStatistiques *stats,
+                                 sAnalyseImage &analyse, uint64_t &erreurs, uint64_t &zeros)
+{
+    const unsigned int blocks_w = mLargeur / 8;
+    const size_t tailleLigne = static_cast<size_t>(blocks_w) * 64;
+    erreurs = 0;
+    zeros = 0;
+
+    for (unsigned int by = ligne_debut; by < ligne_fin; by += 8) {
+        {
+            cChronoEtape chrono(stats, ETAPE_DCT);
+            decaler_ligne(by, row_blocks);
+        }
+        const size_t premier = static_cast<size_t>(by / 8) * blocks_w;
+        int16_t *zigzag = analyse.coefficients.data() + premier * 64;
+        transformer_blocs(row_blocks, blocks_w, ctx, mModePipeline, row_dct, row_dct8, zigzag, stats);
+        reconstruire_zigzag(zigzag, blocks_w, premier, ctx, mModePipeline, analyse.reconstruction.data(),
+                            mLargeur, blocks_w, stats);
+
+        for (size_t k = 0; k < tailleLigne; ++k) zeros += (zigzag[k] == 0);
+        for (unsigned int r = by; r < by + 8; ++r) {
+            const unsigned char *original = mBuffer[r];
+            const unsigned char *decode = analyse.reconstruction.data() + static_cast<size_t>(r) * mLargeur;
+            uint64_t somme = 0;
+            for (unsigned int x = 0; x < mLargeur; ++x) {
+                const int diff = static_cast<int>(original[x]) - decode[x];
+                somme += static_cast<uint64_t>(diff * diff);
             }
-            Trame[pos++] = static_cast<signed char>(zero_run);
-            Trame[pos++] = static_cast<signed char>(linear_quant[k]);
-            zero_run = 0;
+            erreurs += somme;
         }
     }
+    if (kStatistiques && stats) stats->blocs += static_cast<uint64_t>((ligne_fin - ligne_debut) / 8) * blocks_w;
+}
 
-    // End-of-Block marker
-    if (pos < 128) {
-        Trame[pos++] = 0x00; // (0, 0)
-        Trame[pos++] = 0x00;
+bool cCompression::Analyse_Image(sAnalyseImage &analyse)
+{
+    analyse.largeur = 0;
+    analyse.hauteur = 0;
+    analyse.sommeErreurs = 0;
+    analyse.zeros = 0;
+    if (!mBuffer || mLargeur == 0 || mHauteur == 0) return false;
+    if ((mLargeur % 8) || (mHauteur % 8)) return false;
+
+    analyse.largeur = mLargeur;
+    analyse.hauteur = mHauteur;
+    analyse.coefficients.resize(analyse.nbBlocs() * 64);
+    analyse.reconstruction.resize(static_cast<size_t>(mLargeur) * mHauteur);
+
+    // Same stripes and scratch as RLE(); each stripe writes its own rows of the results.
+    const cContexteQuant &ctx = contexte().getQuant();
+    const unsigned int blocks_h = mHauteur / 8;
+    unsigned int nbThreads = (mNbThreads == 0) ? cThreadPool::nbThreadsMateriel() : mNbThreads;
+    unsigned int nbBandes = (nbThreads <= 1) ? 1 : nbThreads * 4;
+    if (nbBandes > blocks_h) nbBandes = blocks_h;
+
+    cPorteeArene portee(arene());
+    const size_t tailleLigne = static_cast<size_t>(mLargeur / 8) * 64;
+    int16_t *row_blocks = arene().allouer<int16_t>(tailleLigne * nbBandes);
+    float *row_dct = arene().allouer<float>(tailleLigne * nbBandes);
+    int32_t *row_dct8 = arene().allouer<int32_t>((mModePipeline == PIPELINE_ENTIER) ? tailleLigne * nbBandes : 0);
+    uint64_t *erreurs = arene().allouer<uint64_t>(nbBandes);
+    uint64_t *zeros = arene().allouer<uint64_t>(nbBandes);
+    sStatistiques *stats = getStatistiques();
+    if (stats) stats->octetsEntree += static_cast<uint64_t>(mLargeur) * mHauteur;
+    sStatistiques *parBande = (stats && nbBandes > 1) ? arene().allouer<sStatistiques>(nbBandes) : nullptr;
+
+    auto analyser_bande = [&](size_t i) {
+        unsigned int debut = static_cast<unsigned int>(blocks_h * i / nbBandes) * 8;
+        unsigned int fin = static_cast<unsigned int>(blocks_h * (i + 1) / nbBandes) * 8;
+        sStatistiques *s = parBande ? &(parBande[i] = sStatistiques()) : stats;
+        Analyse_Bande(debut, fin, ctx, row_blocks + i * tailleLigne, row_dct + i * tailleLigne,
+                      (mModePipeline == PIPELINE_ENTIER) ? row_dct8 + i * tailleLigne : nullptr, s,
+                      analyse, erreurs[i], zeros[i]);
+    };
+    if (nbBandes == 1) analyser_bande(0);
+    else getPoolActif()->paralleliser(nbBandes, analyser_bande);
+    if (parBande) for (unsigned int i = 0; i < nbBandes; ++i) stats->ajouter(parBande[i]);
+
+    for (unsigned int i = 0; i < nbBandes; ++i) {
+        analyse.sommeErreurs += erreurs[i];
+        analyse.zeros += zeros[i];
     }
+    return true;
 }
 
-void cCompression::RLE(signed int *Trame)
+void cCompression::RLE(const sAnalyseImage &analyse, std::vector<signed char> &Trame)
 {
-    if (!Trame || !mBuffer || mLargeur == 0 || mHauteur == 0) return;
-    if ((mLargeur % 8) || (mHauteur % 8)) return;
+    Trame.clear();
+    const size_t nbBlocs = analyse.nbBlocs();
+    if (nbBlocs == 0 || analyse.coefficients.size() != nbBlocs * 64) return;
 
-    std::vector<signed char> out_stream;
+    cChronoEtape chrono(getStatistiques(), ETAPE_RLE);
     int previous_DC = 0;
+    Trame.resize(coder_blocs_rle(analyse.coefficients.data(), nbBlocs, 0, mIntervalleRestart, previous_DC, Trame, 0));
+}
+
+void cCompression::RLE(unsigned int ligne_debut, unsigned int ligne_fin, std::vector<signed char> &Trame,
+                       int &DC_premier, int &DC_dernier)
+{
+    Trame.clear();
+    DC_premier = 0;
+    DC_dernier = 0;
+    if (!mBuffer || mLargeur == 0 || (mLargeur % 8) || (ligne_debut % 8) || (ligne_fin % 8)
+        || ligne_debut >= ligne_fin || ligne_fin > mHauteur) return;
+
+    cPorteeArene portee(arene());
+    const size_t tailleLigne = static_cast<size_t>(mLargeur / 8) * 64;
+    int16_t *row_blocks = arene().allouer<int16_t>(tailleLigne);
+    float *row_dct = arene().allouer<float>(tailleLigne);
+    int32_t *row_dct8 = arene().allouer<int32_t>((mModePipeline == PIPELINE_ENTIER) ? tailleLigne : 0);
+    uint64_t *row_masques = arene().allouer<uint64_t>(mLargeur / 8);
+    sStatistiques *stats = getStatistiques();
+    if (stats) stats->octetsEntree += static_cast<uint64_t>(mLargeur) * (ligne_fin - ligne_debut);
+    RLE_Bande(ligne_debut, ligne_fin, contexte().getQuant(), row_blocks, row_dct, row_dct8, row_masques, stats,
+              Trame, DC_premier, DC_dernier);
+}
+
+void cCompression::RLE(std::vector<signed char> &Trame)
+{
+    Trame.clear();
+    if (!mBuffer || mLargeur == 0 || mHauteur == 0) return;
+    if ((mLargeur % 8) || (mHauteur % 8)) return;
 
-    // Buffers for block processing
-    int block[8][8];        int* block_ptrs[8];
-    double dct[8][8];       double* dct_ptrs[8];
-    int quant[8][8];        int* quant_ptrs[8];
-    for (int i=0; i<8; ++i) {
-        block_ptrs[i] = block[i]; dct_ptrs[i] = dct[i]; quant_ptrs[i] = quant[i];
+    // The quantization tables of the codec context serve the whole image.
+    const cContexteQuant &ctx = contexte().getQuant();
+
+    // Stripes of block rows: a few per thread so that uneven rows balance out.
+    const unsigned int blocks_h = mHauteur / 8;
+    unsigned int nbThreads = (mNbThreads == 0) ? cThreadPool::nbThreadsMateriel() : mNbThreads;
+    unsigned int nbBandes = (nbThreads <= 1) ? 1 : nbThreads * 4;
+    if (nbBandes > blocks_h) nbBandes = blocks_h;
+
+    // Block-row scratch of each stripe, taken from the arena before the work is handed out.
+    cPorteeArene portee(arene());
+    const size_t tailleLigne = static_cast<size_t>(mLargeur / 8) * 64;
+    int16_t *row_blocks = arene().allouer<int16_t>(tailleLigne * nbBandes);
+    float *row_dct = arene().allouer<float>(tailleLigne * nbBandes);
+    int32_t *row_dct8 = arene().allouer<int32_t>((mModePipeline == PIPELINE_ENTIER) ? tailleLigne * nbBandes : 0);
+    uint64_t *row_masques = arene().allouer<uint64_t>(static_cast<size_t>(mLargeur / 8) * nbBandes);
+    sStatistiques *stats = getStatistiques();
+    if (stats) stats->octetsEntree += static_cast<uint64_t>(mLargeur) * mHauteur;
+
+    // Serial encoding writes straight into the caller's vector.
+    if (nbBandes == 1) {
+        int DC_premier = 0, DC_dernier = 0;
+        RLE_Bande(0, mHauteur, ctx, row_blocks, row_dct, row_dct8, row_masques, stats, Trame, DC_premier, DC_dernier);
+        return;
     }
 
-    for (unsigned int by = 0; by < mHauteur; by += 8) {
-        for (unsigned int bx = 0; bx < mLargeur; bx += 8) {
-            // Level-shift and copy block
-            for (int r = 0; r < 8; ++r) for (int c = 0; c < 8; ++c) {
-                block[r][c] = static_cast<int>(mBuffer[by + r][bx + c]) - 128;
-            }
+    // Each stripe measures into its own record; they are added up once the stripes are done.
+    sStatistiques *parBande = stats ? arene().allouer<sStatistiques>(nbBandes) : nullptr;
+
+    std::vector<std::vector<signed char>> bandes(nbBandes);
+    std::vector<int> DC_premier(nbBandes), DC_dernier(nbBandes);
+    auto encoder_bande = [&](size_t i) {
+        unsigned int debut = static_cast<unsigned int>(blocks_h * i / nbBandes) * 8;
+        unsigned int fin = static_cast<unsigned int>(blocks_h * (i + 1) / nbBandes) * 8;
+        sStatistiques *s = stats ? &(parBande[i] = sStatistiques()) : nullptr;
+        RLE_Bande(debut, fin, ctx, row_blocks + i * tailleLigne, row_dct + i * tailleLigne,
+                  (mModePipeline == PIPELINE_ENTIER) ? row_dct8 + i * tailleLigne : nullptr,
+                  row_masques + i * (mLargeur / 8), s, bandes[i], DC_premier[i], DC_dernier[i]);
+    };
+    getPoolActif()->paralleliser(nbBandes, encoder_bande);
+    if (stats) for (unsigned int i = 0; i < nbBandes; ++i) stats->ajouter(parBande[i]);
+
+    // Re-seed the DC prediction across stripe boundaries, then concatenate in order.
+    size_t total = 0;
+    for (unsigned int i = 0; i < nbBandes; ++i) {
+        const size_t premier_bloc = static_cast<size_t>(blocks_h * i / nbBandes) * (mLargeur / 8);
+        const bool restart = (mIntervalleRestart != 0 && premier_bloc % mIntervalleRestart == 0);
+        if (i > 0 && !restart) bandes[i][0] = static_cast<signed char>(DC_premier[i] - DC_dernier[i - 1]);
+        total += bandes[i].size();
+    }
+    Trame.reserve(total);
+    for (const std::vector<signed char> &bande : bandes) Trame.insert(Trame.end(), bande.begin(), bande.end());
+}
 
-            // DCT and Quantization
-            Calcul_DCT_Block(block_ptrs, dct_ptrs);
-            quant_JPEG(dct_ptrs, quant_ptrs);
+void cCompression::chercher_qualite(eCible cible, double valeur,
+                                   const std::function<void(unsigned int, uint64_t &, double &)> &essayer,
+                                   sResultatCible &resultat)
+{
+    // Largest quality within the size, or smallest quality reaching the PSNR.
+    unsigned int bas = 1, haut = 100, choisie = 0, derniere = 0;
+    uint64_t taille = 0;
+    double psnr = 0.0;
+    resultat = sResultatCible();
+    while (bas <= haut) {
+        const unsigned int q = (bas + haut) / 2;
+        essayer(q, taille, psnr);
+        ++resultat.essais;
+        derniere = q;
+        const bool atteinte = (cible == CIBLE_TAILLE) ? (static_cast<double>(taille) <= valeur) : (psnr >= valeur);
+        if (atteinte) {
+            choisie = q;
+            resultat.taille = taille;
+            resultat.psnr = psnr;
+            if (cible == CIBLE_TAILLE) bas = q + 1;
+            else haut = q - 1;
+        } else {
+            if (cible == CIBLE_TAILLE) haut = q - 1;
+            else bas = q + 1;
+        }
+    }
+    resultat.atteinte = (choisie != 0);
+    if (choisie == 0) choisie = (cible == CIBLE_TAILLE) ? 1 : 100;
+    resultat.qualite = choisie;
+    if (derniere != choisie) {
+        essayer(choisie, taille, psnr);
+        ++resultat.essais;
+        resultat.taille = taille;
+        resultat.psnr = psnr;
+    } else if (!resultat.atteinte) {
+        resultat.taille = taille;
+        resultat.psnr = psnr;
+    }
+}
+
+bool cCompression::Compression_Cible(eCible cible, double valeur, std::vector<unsigned char> &Fichier,
+                                     sResultatCible *resultat)
+{
+    Fichier.clear();
+    if (!mBuffer || mLargeur == 0 || mHauteur == 0) return false;
+    if ((mLargeur % 8) || (mHauteur % 8)) return false;
+
+    const unsigned int blocks_w = mLargeur / 8;
+    const unsigned int blocks_h = mHauteur / 8;
+    const size_t nbBlocs = static_cast<size_t>(blocks_w) * blocks_h;
+    const bool entier = (mModePipeline == PIPELINE_ENTIER);
+    sStatistiques *stats = getStatistiques();
+    if (stats) {
+        stats->octetsEntree += static_cast<uint64_t>(mLargeur) * mHauteur;
+        stats->blocs += nbBlocs;
+    }
 
-            // RLE encoding for the block
-            signed char block_trame[128] = {0};
-            RLE_Block(quant_ptrs, previous_DC, block_trame);
-            previous_DC = quant[0][0]; // Update previous DC for next block
+    // 1. The forward DCT of every block, once, by stripes of block rows like RLE().
+    cPorteeArene portee(arene());
+    float *dct = arene().allouer<float>(entier ? 0 : nbBlocs * 64);
+    int32_t *dct8 = arene().allouer<int32_t>(entier ? nbBlocs * 64 : 0);
+    unsigned int nbThreads = (mNbThreads == 0) ? cThreadPool::nbThreadsMateriel() : mNbThreads;
+    unsigned int nbBandes = (nbThreads <= 1) ? 1 : nbThreads * 4;
+    if (nbBandes > blocks_h) nbBandes = blocks_h;
+    const size_t tailleLigne = static_cast<size_t>(blocks_w) * 64;
+    int16_t *row_blocks = arene().allouer<int16_t>(tailleLigne * nbBandes);
+    {
+        cChronoEtape chrono(stats, ETAPE_DCT);
+        auto transformer_bande = [&](size_t i) {
+            int16_t *ligne = row_blocks + i * tailleLigne;
+            for (size_t by = blocks_h * i / nbBandes; by < blocks_h * (i + 1) / nbBandes; ++by) {
+                decaler_ligne(static_cast<unsigned int>(by * 8), ligne);
+                const size_t premier = by * blocks_w;
+                if (!entier) dct_kernels().dct(ligne, dct + premier * 64, blocks_w);
+                else for (size_t b = 0; b < blocks_w; ++b) Calcul_DCT_Block_Entier(ligne + b * 64, dct8 + (premier + b) * 64);
+            }
+        };
+        if (nbBandes == 1) transformer_bande(0);
+        else getPoolActif()->paralleliser(nbBandes, transformer_bande);
+    }
 
-            // Append RLE data to the main stream until EOB is found
-            for(int i=0; i<128; i+=2) {
-                out_stream.push_back(block_trame[i]);
-                out_stream.push_back(block_trame[i+1]);
-                if (block_trame[i] == 0 && block_trame[i+1] == 0) {
-                    break;
+    // 2. Each quality tried: quantization, RLE by restart segment, then the size from the symbol counts.
+    const size_t nbSegments = (mIntervalleRestart == 0) ? 1 : (nbBlocs + mIntervalleRestart - 1) / mIntervalleRestart;
+    const size_t blocsParSegment = (mIntervalleRestart == 0) ? nbBlocs : mIntervalleRestart;
+    int16_t *zigzag = arene().allouer<int16_t>(nbBlocs * 64);
+    size_t *finSegment = arene().allouer<size_t>(nbSegments);
+    std::vector<signed char> Trame;
+    size_t longueur = 0;
+    auto essayer = [&](unsigned int q, uint64_t &taille, double &psnr) {
+        const cContexteQuant ctx(q);
+        const int *Q = ctx.getTable();
+        double erreur = 0.0;
+        {
+            cChronoEtape chrono(stats, ETAPE_QUANT);
+            for (size_t b = 0; b < nbBlocs; ++b) {
+                int16_t *zz = zigzag + b * 64;
+                if (entier) ctx.quantifier_zigzag_entier(dct8 + b * 64, zz);
+                else ctx.quantifier_zigzag(dct + b * 64, zz);
+                for (int k = 0; k < 64; ++k) {
+                    const int i = ZIGZAG[k];
+                    const double c = entier ? dct8[b * 64 + i] / 8.0 : static_cast<double>(dct[b * 64 + i]);
+                    const double d = c - static_cast<double>(zz[k]) * Q[i];
+                    erreur += d * d;
                 }
             }
         }
-    }
+        cChronoEtape chrono(stats, ETAPE_RLE);
+        int DC = 0;
+        longueur = 0;
+        for (size_t s = 0; s < nbSegments; ++s) {
+            const size_t premier = s * blocsParSegment;
+            const size_t nb = std::min(blocsParSegment, nbBlocs - premier);
+            longueur = coder_blocs_rle(zigzag + premier * 64, nb, premier, mIntervalleRestart, DC, Trame, longueur);
+            finSegment[s] = longueur;
+        }
+
+        // The file: header and table, payload (each restart segment starts on a byte), trailer and extensions.
+        uint32_t Comptes[256] = {0};
+        for (size_t i = 0; i < longueur; ++i) ++Comptes[static_cast<unsigned char>(Trame[i])];
+        uint8_t LongueursTrame[256];
+        if (!mTableStatique) cHuffman::CalculerLongueurs(Comptes, LongueursTrame);
+        const uint8_t *Longueurs = mTableStatique ? mTableStatique->Longueurs : LongueursTrame;
+        uint64_t payload = 0;
+        unsigned int nbSym = 0;
+        if (nbSegments == 1) {
+            uint64_t bits = 0;
+            for (int c = 0; c < 256; ++c) bits += static_cast<uint64_t>(Comptes[c]) * Longueurs[c];
+            payload = (bits + 7) / 8;
+        } else {
+            size_t p = 0;
+            for (size_t s = 0; s < nbSegments; ++s) {
+                uint64_t bits = 0;
+                for (; p < finSegment[s]; ++p) bits += Longueurs[static_cast<unsigned char>(Trame[p])];
+                payload += (bits + 7) / 8;
+            }
+        }
+        for (int c = 0; c < 256; ++c) nbSym += (Longueurs[c] != 0);
+        taille = 4 + 1 + (mTableStatique ? 4 : cHuffman::kLongueurMax + nbSym) + 8 + payload + 8 + 8;
+        if (mIntervalleRestart != 0) taille += 12 + 8 * static_cast<uint64_t>(nbSegments);
+        if (mIntervalleIndex != 0) taille += 12 + 8 * static_cast<uint64_t>((nbBlocs + mIntervalleIndex - 1) / mIntervalleIndex);
+
+        const double eqm = erreur / (static_cast<double>(nbBlocs) * 64.0);
+        psnr = (eqm > 0.0) ? 10.0 * std::log10(255.0 * 255.0 / eqm) : std::numeric_limits<double>::infinity();
+    };
+    sResultatCible r;
+    chercher_qualite(cible, valeur, essayer, r);
+    if (resultat) *resultat = r;
+
+    // 3. The chosen encoding, from the trame of the last quality tried.
+    // The quality goes to the file only: the context, possibly shared, is left as it was.
+    Trame.resize(longueur);
+    ecrire_huf2(Trame, r.qualite, false, Fichier);
+    return true;
+}
+
+void cCompression::RLE(signed int *Trame)
+{
+    if (!Trame || !mBuffer || mLargeur == 0 || mHauteur == 0) return;
+    if ((mLargeur % 8) || (mHauteur % 8)) return;
+
+    std::vector<signed char> octets;
+    RLE(octets);
 
     // Copy to the output integer array format
-    Trame[0] = static_cast<int>(out_stream.size());
-    for (size_t i = 0; i < out_stream.size(); ++i) {
-        Trame[i + 1] = static_cast<int>(out_stream[i]);
-    }
+    Trame[0] = static_cast<int>(octets.size());
+    for (size_t i = 0; i < octets.size(); ++i) Trame[i + 1] = static_cast<int>(octets[i]);
 }
 
 unsigned int cCompression::Histogramme(char *Trame, unsigned int Longueur_Trame, char *Donnee, double *Frequence)
@@ -314,289 +1542,444 @@ void cCompression::Compression_JPEG(int *Trame_RLE, const char *Nom_Fichier)
 {
     if (!Trame_RLE || !Nom_Fichier) return;
 
-    // 1. Convert integer RLE trame to a byte stream.
-    unsigned int len = static_cast<unsigned int>(Trame_RLE[0]);
-    std::vector<char> trame(len);
-    for (unsigned int i = 0; i < len; ++i) {
-        trame[i] = static_cast<char>(Trame_RLE[i + 1]);
+    // Convert integer RLE trame to a byte stream.
+    const size_t len = static_cast<size_t>(Trame_RLE[0]);
+    std::vector<signed char> trame(len);
+    for (size_t i = 0; i < len; ++i) {
+        trame[i] = static_cast<signed char>(Trame_RLE[i + 1]);
     }
+    Compression_JPEG(trame, Nom_Fichier);
+}
 
-    // 2. Build frequency histogram and cache the Huffman table.
-    char Donnee[256];
-    double Frequence[256];
-    unsigned int nbSym = Histogramme(trame.data(), len, Donnee, Frequence);
-    storeHuffmanTable(Donnee, Frequence, nbSym);
-
-    // 3. Generate Huffman codes.
-    cHuffman h(trame.data(), len);
-    h.HuffmanCodes(Donnee, Frequence, nbSym);
-    std::map<char, std::string> codeTable;
-    h.BuildTableCodes(codeTable);
-
-    // 4. Encode the byte stream into a bitstream.
-    std::vector<unsigned char> bitBytes;
-    uint32_t payload_bits = 0;
-    unsigned char current_byte = 0;
-    int bit_pos = 7;
-
-    for (char sym : trame) {
-        const std::string& code = codeTable[sym];
-        for (char bit : code) {
-            if (bit == '1') {
-                current_byte |= (1u << bit_pos);
-            }
-            bit_pos--;
-            payload_bits++;
-            if (bit_pos < 0) {
-                bitBytes.push_back(current_byte);
-                current_byte = 0;
-                bit_pos = 7;
-            }
-        }
-    }
-    if (bit_pos != 7) { // Push the last partially filled byte
-        bitBytes.push_back(current_byte);
-    }
+void cCompression::Compression_JPEG(const std::vector<signed char> &Trame, const char *Nom_Fichier)
+{
+    if (!Nom_Fichier) return;
+    std::vector<unsigned char> &fichier = arene().tampon(TAMPON_FICHIER);
+    Compression_JPEG(Trame, fichier);
 
-    // 5. Write the custom 'HUF1' file format.
     std::ofstream out(Nom_Fichier, std::ios::binary);
     if (!out) return;
+    out.write(reinterpret_cast<const char*>(fichier.data()), static_cast<std::streamsize>(fichier.size()));
+    out.close();
+}
 
-    out.write("HUF1", 4); // Magic number
-
-    uint16_t nbSym16 = static_cast<uint16_t>(nbSym); // Symbol count
-    out.write(reinterpret_cast<const char*>(&nbSym16), sizeof(nbSym16));
-
-    for (unsigned int i = 0; i < nbSym; ++i) { // Symbol table
-        char sym = Donnee[i];
-        uint32_t cnt = static_cast<uint32_t>(Frequence[i]);
-        out.put(sym);
-        out.write(reinterpret_cast<const char*>(&cnt), sizeof(cnt));
-    }
+void cCompression::Compression_JPEG(const std::vector<signed char> &Trame, std::vector<unsigned char> &Fichier)
+{
+    ecrire_huf2(Trame, contexte().getQualite(), true, Fichier);
+}
 
-    uint32_t payload_bytes = static_cast<uint32_t>(bitBytes.size()); // Payload info
-    out.write(reinterpret_cast<const char*>(&payload_bytes), sizeof(payload_bytes));
-    out.write(reinterpret_cast<const char*>(&payload_bits), sizeof(payload_bits));
+void cCompression::ecrire_huf2(const std::vector<signed char> &Trame, unsigned int qualite, bool memoriser,
+                               std::vector<unsigned char> &Fichier)
+{
+    const char *trame = reinterpret_cast<const char*>(Trame.data());
+    const size_t len = Trame.size();
+    Fichier.clear();
+    sStatistiques *stats = getStatistiques();
+    cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+
+    cPorteeArene portee(arene());
+    cEcrivainHuf2 ecrivain(Fichier, arene(), len, mIntervalleRestart, mIntervalleIndex);
+    if (mTableStatique) {
+        // 1-4. A static table: no pass over the trame, the header only references it.
+        ecrivain.commencer(*mTableStatique);
+    } else {
+        // 1-2. Build the frequency histogram and cache the Huffman table.
+        uint32_t Comptes[256] = {0};
+        for (size_t i = 0; i < len; ++i) ++Comptes[static_cast<unsigned char>(trame[i])];
+        char Donnee[256];
+        double Frequence[256];
+        unsigned int nbSym = 0;
+        for (int c = 0; c < 256; ++c) {
+            if (Comptes[c] == 0) continue;
+            Donnee[nbSym] = static_cast<char>(c);
+            Frequence[nbSym++] = static_cast<double>(Comptes[c]);
+        }
+        if (memoriser) contexte().storeHuffmanTable(Donnee, Frequence, nbSym);
 
-    if (!bitBytes.empty()) { // Payload data
-        out.write(reinterpret_cast<const char*>(bitBytes.data()), bitBytes.size());
+        // 3-4. Length-limited canonical Huffman codes, stored in the 'HUF2' header.
+        uint8_t Longueurs[256];
+        cHuffman::CalculerLongueurs(Comptes, Longueurs);
+        ecrivain.commencer(Longueurs);
     }
 
-    // Optional width/height trailer to avoid guessing during decompression.
-    // Old files do not include this, so the reader treats it as optional.
-    if (mLargeur != 0 && mHauteur != 0) {
-        uint32_t w = mLargeur;
-        uint32_t h = mHauteur;
-        out.write(reinterpret_cast<const char*>(&w), sizeof(w));
-        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    // 5. Encode the byte stream into a bitstream, right after the header,
+    // then the trailer and the extensions.
+    ecrivain.ajouter(Trame.data(), len);
+    ecrivain.terminer(mLargeur, mHauteur, qualite);
+    if (stats) {
+        stats->symboles += len;
+        stats->octetsSortie += Fichier.size();
     }
-
-    out.close();
 }
 
 unsigned char **cCompression::Decompression_JPEG(const char *Nom_Fichier_compresse)
 {
     if (!Nom_Fichier_compresse) return nullptr;
 
-    // 1. Read the entire compressed file into a byte vector.
-    std::ifstream in(Nom_Fichier_compresse, std::ios::binary);
-    if (!in) return nullptr;
-    std::vector<unsigned char> filedata((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-    in.close();
-
-    // 2. Prepare the Huffman table.
-    // This involves either parsing our custom 'HUF1' header or using a previously cached table.
-    char Donnee[256];
-    double Frequence[256];
-    unsigned int nbSym = 0;
-    const unsigned char *payload = nullptr;
-    size_t payload_size = 0;
-    uint32_t payload_bits = 0;
+    // 1. Map the compressed file; it is decoded in place.
+    cFichierMappe fichier;
+    if (!fichier.ouvrir(Nom_Fichier_compresse)) return nullptr;
+    return Decompression_JPEG(fichier.getDonnees(), fichier.getTaille());
+}
 
-    if (filedata.size() >= 4 && filedata[0]=='H' && filedata[1]=='U' && filedata[2]=='F' && filedata[3]=='1') {
-        // Custom 'HUF1' header found. Parse it to extract the Huffman table and payload info.
-        size_t pos = 4;
-        if (pos + sizeof(uint16_t) > filedata.size()) return nullptr;
-        uint16_t nb = 0; std::memcpy(&nb, filedata.data()+pos, sizeof(nb)); pos += sizeof(nb);
-        nbSym = nb;
-        if (nbSym > 256) return nullptr;
+unsigned char **cCompression::Decompression_JPEG(const uint8_t *Donnees, size_t Taille)
+{
+    // 2. Parse the custom 'HUF2'/'HUF1' header, or use a previously cached table.
+    sStatistiques *stats = getStatistiques();
+    sFluxHuf f;
+    if (!lire_flux_huf(Donnees, Taille, &contexte(), mTrace, f)) return nullptr;
+    if (f.largeur != 0) {
+        this->mLargeur = f.largeur;
+        this->mHauteur = f.hauteur;
+    }
 
-        for (unsigned int i = 0; i < nbSym; ++i) {
-            if (pos + 1 + sizeof(uint32_t) > filedata.size()) return nullptr;
-            Donnee[i] = static_cast<char>(filedata[pos++]);
-            uint32_t cnt = 0; std::memcpy(&cnt, filedata.data()+pos, sizeof(cnt)); pos += sizeof(cnt);
-            Frequence[i] = static_cast<double>(cnt);
+    // 3. Build the Huffman decoding tree and its lookup table.
+    cHuffman &h = arene().huffman(0);
+    {
+        cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+        if (!construire_decodeur(f, h)) return nullptr;
+    }
+    tracer_codec(mTrace, "[Decompression_JPEG] Built Huffman tree, root=%p", static_cast<void*>(h.getRacine()));
+
+    if (this->mLargeur == 0 || this->mHauteur == 0) {
+        // 4-5. Without stored dimensions the block grid is only known once every
+        // block has been counted: decode the whole stream, then infer a layout.
+        const cContexteQuant ctx(f.qualite, COMPOSANTE_LUMA, f.transposee);
+        std::vector<char> trameDec;
+        std::vector<std::array<int,64>> quantBlocks;
+        {
+            cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+            if (!h.Decoder(f.payload, f.taille, 0, f.bitsValides, trameDec)) return nullptr;
+            if (trameDec.empty()) return nullptr;
+            parser_blocs_rle(trameDec.data(), trameDec.size(), quantBlocks);
         }
+        tracer_codec(mTrace, "[Decompression_JPEG] Decoded %zu symbols into trameDec", trameDec.size());
+        if (quantBlocks.empty()) return nullptr;
 
-        if (pos + sizeof(uint32_t) * 2 > filedata.size()) return nullptr;
-        uint32_t payload_bytes = 0; std::memcpy(&payload_bytes, filedata.data()+pos, sizeof(payload_bytes)); pos += sizeof(payload_bytes);
-        std::memcpy(&payload_bits, filedata.data()+pos, sizeof(payload_bits)); pos += sizeof(payload_bits);
-
-        if (pos + payload_bytes > filedata.size()) return nullptr;
-        payload = filedata.data() + pos;
-        payload_size = payload_bytes;
-        std::cerr << "[Decompression_JPEG] Parsed HUF1 header: nbSym=" << nbSym << " payload_bytes=" << payload_bytes << " payload_bits=" << payload_bits << "\n";
+        // Prefer a layout close to square.
+        const size_t nblocks = quantBlocks.size();
+        size_t blocks_w = static_cast<size_t>(std::floor(std::sqrt(static_cast<double>(nblocks))));
+        if (blocks_w == 0) blocks_w = 1;
+        while (blocks_w > 1 && (nblocks % blocks_w) != 0) {
+            --blocks_w;
+        }
+        const size_t blocks_h = (nblocks + blocks_w - 1) / blocks_w; // ceil division
+        tracer_codec(mTrace, "[Decompression_JPEG] Inferred block grid: blocks_w=%zu blocks_h=%zu (nblocks=%zu)", blocks_w, blocks_h, nblocks);
+        this->mLargeur = static_cast<unsigned int>(blocks_w * 8);
+        this->mHauteur = static_cast<unsigned int>(blocks_h * 8);
 
-        // Optional width/height trailer (added for correctness). If absent, fall back to inference later.
-        size_t trailer_pos = pos + payload_bytes;
-        if (trailer_pos + sizeof(uint32_t) * 2 <= filedata.size()) {
-            uint32_t w = 0, h = 0;
-            std::memcpy(&w, filedata.data() + trailer_pos, sizeof(uint32_t));
-            std::memcpy(&h, filedata.data() + trailer_pos + sizeof(uint32_t), sizeof(uint32_t));
-            if (w != 0 && h != 0) {
-                this->mLargeur = w;
-                this->mHauteur = h;
+        const unsigned int cote = 8 / mEchelle;
+        const unsigned int largeurSortie = static_cast<unsigned int>(blocks_w * cote);
+        unsigned char **rows = allouer_image(largeurSortie, static_cast<unsigned int>(blocks_h * cote));
+        std::vector<int16_t> coefs(kLotBlocs * 64);
+        for (size_t premier = 0; premier < nblocks; premier += kLotBlocs) {
+            const size_t nb = (nblocks - premier < kLotBlocs) ? nblocks - premier : kLotBlocs;
+            for (size_t i = 0; i < nb; ++i) {
+                for (int k = 0; k < 64; ++k) coefs[i * 64 + k] = static_cast<int16_t>(quantBlocks[premier + i][k]);
+            }
+            if (cote == 8) {
+                reconstruire_blocs(coefs.data(), nb, premier, ctx, mModePipeline, rows[0], largeurSortie, blocks_w, stats);
+            } else {
+                reconstruire_blocs_reduits(coefs.data(), nb, premier, ctx, cote, rows[0], largeurSortie, blocks_w, stats);
             }
         }
-    } else {
-        // No header. Fall back to a cached Huffman table if available.
-        if (!cCompression::loadHuffmanTable(Donnee, Frequence, nbSym)) {
-            return nullptr; // No table available. Cannot decompress.
+        if (stats) {
+            stats->octetsEntree += Taille;
+            stats->octetsSortie += static_cast<uint64_t>(largeurSortie) * blocks_h * cote;
+            stats->blocs += nblocks;
+            stats->symboles += trameDec.size();
         }
-        payload = filedata.data();
-        payload_size = filedata.size();
+        return rows;
     }
 
-    // Empty payload cannot produce blocks; treat as failure to let callers fall back gracefully.
-    if (payload_bits == 0 && payload_size == 0) {
+    // 4-6. Fused decode into a newly allocated image.
+    const unsigned int largeurSortie = TailleReduite(this->mLargeur, mEchelle);
+    const unsigned int hauteurSortie = TailleReduite(this->mHauteur, mEchelle);
+    unsigned char **rows = allouer_image(largeurSortie, hauteurSortie);
+    cPorteeArene portee(arene());
+    char *corrompu = arene().allouer<char>(f.nbSeg);
+    sStatistiques *parSegment = stats ? arene().allouer<sStatistiques>(f.nbSeg) : nullptr;
+    if (!decoder_image_recadree(f, h, this->mLargeur, this->mHauteur, mModePipeline, 8 / mEchelle, (f.nbSeg > 1) ? getPoolActif() : nullptr,
+                                corrompu, stats, parSegment, mTrace, arene(), rows[0], largeurSortie)) {
+        delete[] rows[0];
+        delete[] rows;
         return nullptr;
     }
+    if (stats) {
+        stats->octetsEntree += Taille;
+        stats->octetsSortie += static_cast<uint64_t>(largeurSortie) * hauteurSortie;
+    }
+    return rows;
+}
 
-    // 3. Build the Huffman decoding tree.
-    cHuffman h;
-    if (nbSym == 0) return nullptr;
-    h.HuffmanCodes(Donnee, Frequence, nbSym);
-    sNoeud *root = h.getRacine();
-    if (!root) return nullptr;
-    std::cerr << "[Decompression_JPEG] Built Huffman tree, root=" << root << "\n";
-
-    // 4. Decode the bitstream payload into an RLE byte stream.
-    std::vector<char> trameDec;
-    uint64_t valid_bits = (payload_bits > 0) ? payload_bits : static_cast<uint64_t>(payload_size) * 8ULL;
-
-    sNoeud *cursor = root;
-    for (uint64_t bitIndex = 0; bitIndex < valid_bits; ++bitIndex) {
-        int bit = 7 - static_cast<int>(bitIndex % 8ULL);
-        unsigned char byte = payload[bitIndex / 8ULL];
-        int val = ((byte >> bit) & 1);
-
-        cursor = (val == 0) ? cursor->mgauche : cursor->mdroit;
-        if (!cursor) return nullptr; // Invalid bitstream
-
-        if (!cursor->mgauche && !cursor->mdroit) { // Leaf node found
-            trameDec.push_back(cursor->mdonnee);
-            cursor = root; // Reset for next symbol
-        }
+bool cCompression::Decompression_JPEG(const uint8_t *Donnees, size_t Taille, unsigned char *Image, size_t Pas,
+                                      unsigned int LargeurMax, unsigned int HauteurMax)
+{
+    if (!Image) return false;
+    sStatistiques *stats = getStatistiques();
+    sFluxHuf f;
+    if (!lire_flux_huf(Donnees, Taille, &contexte(), mTrace, f)) return false;
+    const unsigned int largeur = f.largeur ? f.largeur : this->mLargeur;
+    const unsigned int hauteur = f.largeur ? f.hauteur : this->mHauteur;
+    const unsigned int largeurSortie = TailleReduite(largeur, mEchelle);
+    const unsigned int hauteurSortie = TailleReduite(hauteur, mEchelle);
+    if (largeur == 0 || hauteur == 0 || largeurSortie > LargeurMax || hauteurSortie > HauteurMax || Pas < largeurSortie) return false;
+
+    cHuffman &h = arene().huffman(0);
+    {
+        cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+        if (!construire_decodeur(f, h)) return false;
+    }
+    cPorteeArene portee(arene());
+    char *corrompu = arene().allouer<char>(f.nbSeg);
+    sStatistiques *parSegment = stats ? arene().allouer<sStatistiques>(f.nbSeg) : nullptr;
+    if (!decoder_image_recadree(f, h, largeur, hauteur, mModePipeline, 8 / mEchelle, (f.nbSeg > 1) ? getPoolActif() : nullptr, corrompu,
+                                stats, parSegment, mTrace, arene(), Image, Pas)) return false;
+    this->mLargeur = largeur;
+    this->mHauteur = hauteur;
+    if (stats) {
+        stats->octetsEntree += Taille;
+        stats->octetsSortie += static_cast<uint64_t>(largeurSortie) * hauteurSortie;
     }
-    if (trameDec.empty()) return nullptr;
-    std::cerr << "[Decompression_JPEG] Decoded " << trameDec.size() << " symbols into trameDec\n";
+    return true;
+}
 
-    // 5. Parse the RLE stream into 8x8 quantized blocks.
-    static const int zigzag[64] = { // Zigzag scan order
-         0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
-        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
-        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
-        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+bool cCompression::DecodeRegion(const uint8_t *Donnees, size_t Taille, unsigned int x, unsigned int y,
+                                unsigned int largeur, unsigned int hauteur, unsigned char *Image, size_t Pas)
+{
+    if (!Image) return false;
+    sStatistiques *stats = getStatistiques();
+    sFluxHuf f;
+    if (!lire_flux_huf(Donnees, Taille, &contexte(), mTrace, f)) return false;
+    const unsigned int largeurImage = f.largeur ? f.largeur : this->mLargeur;
+    const unsigned int hauteurImage = f.largeur ? f.hauteur : this->mHauteur;
+    const size_t blocks_w = (largeurImage + 7) / 8;
+    if (largeur == 0 || hauteur == 0 || Pas < largeur || blocks_w == 0
+        || static_cast<uint64_t>(x) + largeur > largeurImage || static_cast<uint64_t>(y) + hauteur > hauteurImage) return false;
+
+    cHuffman &h = arene().huffman(0);
+    {
+        cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+        if (!construire_decodeur(f, h)) return false;
+    }
+    const cContexteQuant ctx(f.qualite, COMPOSANTE_LUMA, f.transposee);
+    const unsigned int bx0 = x / 8, bx1 = (x + largeur - 1) / 8;
+    const unsigned int by0 = y / 8, by1 = (y + hauteur - 1) / 8;
+    const size_t nbx = bx1 - bx0 + 1;
+    const unsigned int nbLignes = by1 - by0 + 1;
+
+    // Rows of blocks can only be decoded independently when there are points to seek to.
+    cThreadPool *pool = (f.nbSeg != 0 || f.nbIndex != 0) && nbLignes > 1 ? getPoolActif() : nullptr;
+    const unsigned int nbBandes = pool ? std::min(nbLignes, pool->getNbThreads() * 4) : 1;
+    cPorteeArene portee(arene());
+    unsigned char *bandes = arene().allouer<unsigned char>(nbx * 64 * nbBandes);
+    int16_t *coefs = arene().allouer<int16_t>(kLotBlocs * 64 * nbBandes);
+    uint64_t *masques = arene().allouer<uint64_t>(kLotBlocs * nbBandes);
+    sStatistiques *parBande = stats ? arene().allouer<sStatistiques>(nbBandes) : nullptr;
+    size_t *plats = arene().allouer<size_t>(nbBandes);
+
+    // A band of block rows, one cursor: the rows are decoded into a strip, then cropped into the output.
+    auto decoder_bande = [&](size_t i) {
+        sStatistiques *st = (kStatistiques && stats) ? &(parBande[i] = sStatistiques()) : nullptr;
+        unsigned char *bande = bandes + i * nbx * 64;
+        int16_t *c = coefs + i * kLotBlocs * 64;
+        uint64_t *m = masques + i * kLotBlocs;
+        sCurseurBlocs cur(h);
+        plats[i] = 0;
+        const unsigned int r0 = by0 + static_cast<unsigned int>(nbLignes * i / nbBandes);
+        const unsigned int r1 = by0 + static_cast<unsigned int>(nbLignes * (i + 1) / nbBandes);
+        for (unsigned int r = r0; r < r1; ++r) {
+            for (size_t fait = 0; fait < nbx; fait += kLotBlocs) {
+                const size_t lot = std::min(kLotBlocs, nbx - fait);
+                {
+                    cChronoEtape chrono(st, ETAPE_HUFFMAN);
+                    for (size_t k = 0; k < lot; ++k) {
+                        const size_t b = r * blocks_w + bx0 + fait + k;
+                        int16_t *bloc = c + k * 64;
+                        // Within a row the cursor is already there, unless a restart segment starts.
+                        const bool place = (cur.bloc == b && (f.nbSeg == 0 || b % f.intervalle != 0))
+                                           || positionner_curseur(f, h, b, cur, bloc);
+                        const bool ok = place && cCompression::RLE_Decoder_Bloc(cur.lecteur, cur.DC, bloc, m[k]);
+                        if (ok) {
+                            ++cur.bloc;
+                        } else {
+                            std::memset(bloc, 0, 64 * sizeof(int16_t));
+                            m[k] = 1;
+                            cur.bloc = SIZE_MAX;
+                            ++plats[i];
+                        }
+                    }
+                }
+                reconstruire_blocs(c, lot, fait, ctx, mModePipeline, bande, nbx * 8, nbx, st, m);
+            }
+            const unsigned int j0 = std::max(y, r * 8), j1 = std::min(y + hauteur, r * 8 + 8);
+            for (unsigned int j = j0; j < j1; ++j)
+                std::memcpy(Image + (j - y) * Pas, bande + (j - r * 8) * nbx * 8 + (x - bx0 * 8), largeur);
+        }
+        if (kStatistiques && st) st->blocs += static_cast<uint64_t>(r1 - r0) * nbx;
     };
+    if (pool && nbBandes > 1) {
+        pool->paralleliser(nbBandes, decoder_bande);
+    } else {
+        decoder_bande(0);
+    }
 
-    std::vector<std::array<int,64>> quantBlocks;
-    int previous_DC = 0;
-    size_t p = 0;
-    while (p < trameDec.size()) {
-        std::array<int,64> q{};
-        q.fill(0);
+    size_t nbPlats = 0;
+    for (unsigned int i = 0; i < nbBandes; ++i) {
+        nbPlats += plats[i];
+        if (kStatistiques && stats) stats->ajouter(parBande[i]);
+    }
+    if (nbPlats != 0) tracer_codec(mTrace, "[DecodeRegion] %zu blocks could not be decoded, left flat", nbPlats);
+    this->mLargeur = largeurImage;
+    this->mHauteur = hauteurImage;
+    if (stats) {
+        stats->octetsEntree += Taille;
+        stats->octetsSortie += static_cast<uint64_t>(largeur) * hauteur;
+    }
+    return true;
+}
 
-        signed char dc_diff = static_cast<signed char>(trameDec[p++]);
-        int DC = static_cast<int>(dc_diff) + previous_DC;
-        q[0] = DC;
-        previous_DC = DC;
+bool cCompression::Transformation_JPEG(const uint8_t *Donnees, size_t Taille, eTransformation t,
+                                       std::vector<unsigned char> &Fichier, const sRecadrage *recadrage)
+{
+    Fichier.clear();
+    sStatistiques *stats = getStatistiques();
+    sFluxHuf f;
+    if (!lire_flux_huf(Donnees, Taille, &contexte(), mTrace, f) || f.largeur == 0) return false;
+    const unsigned int largeurImage = f.largeur;
+    const unsigned int hauteurImage = f.hauteur;
+
+    // 1. The crop, on block boundaries; its right and bottom edges may be those of the image.
+    sRecadrage r;
+    if (recadrage) r = *recadrage;
+    if (r.x % 8 != 0 || r.y % 8 != 0 || r.x >= largeurImage || r.y >= hauteurImage) return false;
+    if (r.largeur == 0) r.largeur = largeurImage - r.x;
+    if (r.hauteur == 0) r.hauteur = hauteurImage - r.y;
+    if (r.largeur > largeurImage - r.x || r.hauteur > hauteurImage - r.y
+        || (r.largeur % 8 != 0 && r.x + r.largeur != largeurImage)
+        || (r.hauteur % 8 != 0 && r.y + r.hauteur != hauteurImage)) {
+        tracer_codec(mTrace, "[Transformation_JPEG] The crop %ux%u at (%u, %u) is not block-aligned within %ux%u",
+                     r.largeur, r.hauteur, r.x, r.y, largeurImage, hauteurImage);
+        return false;
+    }
+    const size_t blocks_w = (largeurImage + 7) / 8;
+    const unsigned int bx0 = r.x / 8, by0 = r.y / 8;
+    const unsigned int nbx = (r.largeur + 7) / 8, nby = (r.hauteur + 7) / 8;
+    const size_t nbBlocs = static_cast<size_t>(nbx) * nby;
+
+    cHuffman &h = arene().huffman(0);
+    {
+        cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+        if (!construire_decodeur(f, h)) return false;
+    }
 
-        int idx = 1;
-        // Need two bytes (run,val) to decode an AC pair. Ensure bounds strictly.
-        while ((p + 1) < trameDec.size() && idx < 64) {
-            unsigned char run_u = static_cast<unsigned char>(trameDec[p++]);
-            signed char val_s = static_cast<signed char>(trameDec[p++]);
-            if (run_u == 0 && static_cast<unsigned char>(val_s) == 0) break; // EOB
-            idx += static_cast<int>(run_u);
-            if (idx >= 64) break;
-            int zz = zigzag[idx];
-            if (zz < 0 || zz >= 64) {
-                std::cerr << "[Decompression_JPEG] Zigzag index out of range: idx=" << idx << " zz=" << zz << "\n";
-                break;
+    // 2. The quantized blocks of the crop, a band of block rows per cursor as
+    // in DecodeRegion(). A transform has nothing to stand in for a damaged
+    // block: any block that does not decode fails the call.
+    cThreadPool *pool = (f.nbSeg != 0 || f.nbIndex != 0) && nby > 1 ? getPoolActif() : nullptr;
+    const unsigned int nbBandes = pool ? std::min(nby, pool->getNbThreads() * 4) : 1;
+    cPorteeArene portee(arene());
+    int16_t *coefs = arene().allouer<int16_t>(nbBlocs * 64);
+    char *echecs = arene().allouer<char>(nbBandes);
+    auto decoder_bande = [&](size_t i) {
+        sCurseurBlocs cur(h);
+        echecs[i] = 0;
+        const unsigned int r0 = static_cast<unsigned int>(static_cast<size_t>(nby) * i / nbBandes);
+        const unsigned int r1 = static_cast<unsigned int>(static_cast<size_t>(nby) * (i + 1) / nbBandes);
+        for (unsigned int ry = r0; ry < r1 && !echecs[i]; ++ry) {
+            for (unsigned int rx = 0; rx < nbx; ++rx) {
+                const size_t b = (by0 + ry) * blocks_w + bx0 + rx;
+                int16_t *bloc = coefs + (static_cast<size_t>(ry) * nbx + rx) * 64;
+                const bool place = (cur.bloc == b && (f.nbSeg == 0 || b % f.intervalle != 0))
+                                   || positionner_curseur(f, h, b, cur, bloc);
+                if (!place || !RLE_Decoder_Bloc(cur.lecteur, cur.DC, bloc) || cur.lecteur.erreur()) {
+                    echecs[i] = 1;
+                    break;
+                }
+                ++cur.bloc;
             }
-            q[zz] = static_cast<int>(val_s);
-            idx++;
         }
-        quantBlocks.push_back(q);
-    }
-    if (quantBlocks.empty()) return nullptr;
-    std::cerr << "[Decompression_JPEG] Parsed " << quantBlocks.size() << " quant blocks\n";
-
-    // 6. Reconstruct the image from the quantized blocks.
-    size_t nblocks = quantBlocks.size();
-    // Try to infer a rectangular block grid. Prefer a layout close to square.
-    size_t blocks_w = 0, blocks_h = 0;
-    // If dimensions were stored in the header, trust them; otherwise infer.
-    if (this->mLargeur != 0 && this->mHauteur != 0) {
-        blocks_w = this->mLargeur / 8;
-        blocks_h = this->mHauteur / 8;
-    } else {
-        blocks_w = static_cast<size_t>(std::floor(std::sqrt(static_cast<double>(nblocks))));
-        if (blocks_w == 0) blocks_w = 1;
-        while (blocks_w > 1 && (nblocks % blocks_w) != 0) {
-            --blocks_w;
+    };
+    {
+        cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+        if (pool && nbBandes > 1) {
+            pool->paralleliser(nbBandes, decoder_bande);
+        } else {
+            decoder_bande(0);
         }
-        blocks_h = (nblocks + blocks_w - 1) / blocks_w; // ceil division
-        if (blocks_w * blocks_h < nblocks) blocks_h = (nblocks + blocks_w - 1) / blocks_w;
-        std::cerr << "[Decompression_JPEG] Inferred block grid: blocks_w=" << blocks_w << " blocks_h=" << blocks_h << " (nblocks=" << nblocks << ")\n";
-        this->mLargeur = static_cast<unsigned int>(blocks_w * 8);
-        this->mHauteur = static_cast<unsigned int>(blocks_h * 8);
     }
-
-    if (blocks_w == 0 || blocks_h == 0) return nullptr;
-
-    size_t width = static_cast<size_t>(this->mLargeur);
-    size_t height = static_cast<size_t>(this->mHauteur);
-    if (width == 0 || height == 0) return nullptr;
-
-    unsigned char *buf = new unsigned char[width * height];
-    unsigned char **rows = new unsigned char*[height];
-    for (size_t r = 0; r < height; ++r) rows[r] = buf + r * width;
-
-    // Buffers for block processing
-    double dequantized_block[8][8]; double* dequantized_ptrs[8];
-    int reconstructed_block[8][8]; int* reconstructed_ptrs[8];
-    int quant_matrix[8][8]; int* quant_ptrs[8];
-    for (int i=0; i<8; ++i) {
-        dequantized_ptrs[i] = dequantized_block[i];
-        reconstructed_ptrs[i] = reconstructed_block[i];
-        quant_ptrs[i] = quant_matrix[i];
+    for (unsigned int i = 0; i < nbBandes; ++i) {
+        if (echecs[i]) {
+            tracer_codec(mTrace, "[Transformation_JPEG] A block of the crop could not be decoded");
+            return false;
+        }
     }
 
-    for (size_t i = 0; i < nblocks; ++i) {
-        for (int k = 0; k < 64; ++k) {
-            quant_matrix[k/8][k%8] = quantBlocks[i][k];
+    // 3. The blocks in the raster order of the transformed grid, RLE coded
+    // again. DC differences are taken in the new order; the 8-bit format
+    // may not hold them, nor an AC value of -128 once negated.
+    bool transposee, miroirX, miroirY;
+    decomposer_transformation(t, transposee, miroirX, miroirY);
+    const unsigned int nbxSortie = transposee ? nby : nbx;
+    const unsigned int nbySortie = transposee ? nbx : nby;
+    // A mirror brings the padding of the last blocks to the left (or the
+    // top), where it is part of the image: that axis keeps its padded size.
+    const unsigned int largeurSortie = miroirX ? nbxSortie * 8 : (transposee ? r.hauteur : r.largeur);
+    const unsigned int hauteurSortie = miroirY ? nbySortie * 8 : (transposee ? r.largeur : r.hauteur);
+    signed char *trame = arene().allouer<signed char>(nbBlocs * 130);
+    size_t len = 0;
+    {
+        cChronoEtape chrono(stats, ETAPE_RLE);
+        int16_t zz[64];
+        int DC = 0;
+        for (size_t b = 0; b < nbBlocs; ++b) {
+            unsigned int sx = 0, sy = 0;
+            bloc_source(t, nbx, nby, static_cast<unsigned int>(b % nbxSortie), static_cast<unsigned int>(b / nbxSortie), sx, sy);
+            TransformerBloc(coefs + (static_cast<size_t>(sy) * nbx + sx) * 64, t, zz);
+            if (mIntervalleRestart != 0 && b % mIntervalleRestart == 0) DC = 0;
+            bool code = zz[0] - DC >= -128 && zz[0] - DC <= 127;
+            for (int k = 1; k < 64 && code; ++k) code = zz[k] <= 127;
+            if (!code) {
+                tracer_codec(mTrace, "[Transformation_JPEG] Block %zu does not fit the 8-bit RLE format after the transform", b);
+                return false;
+            }
+            len += static_cast<size_t>(RLE_Block(zz, MasqueNonNuls(zz), DC, trame + len));
+            DC = zz[0];
         }
+    }
 
-        dequant_JPEG(quant_ptrs, dequantized_ptrs);
-        Calcul_IDCT_Block(dequantized_ptrs, reconstructed_ptrs);
-
-        size_t block_row = i / blocks_w;
-        size_t block_col = i % blocks_w;
-        if (block_row >= blocks_h || block_col >= blocks_w) continue; // safety
-
-        for (int r = 0; r < 8; ++r) {
-            size_t ry = block_row * 8 + static_cast<size_t>(r);
-            if (ry >= height) continue;
-            for (int c = 0; c < 8; ++c) {
-                size_t rx = block_col * 8 + static_cast<size_t>(c);
-                if (rx >= width) continue;
-                int val = reconstructed_block[r][c] + 128;
-                val = (val < 0) ? 0 : (val > 255) ? 255 : val;
-                rows[ry][rx] = static_cast<unsigned char>(val);
-            }
+    // 4. The Huffman pass, with the settings of this instance, as Compression_JPEG() does.
+    {
+        cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+        cEcrivainHuf2 ecrivain(Fichier, arene(), len, mIntervalleRestart, mIntervalleIndex);
+        if (mTableStatique) {
+            ecrivain.commencer(*mTableStatique);
+        } else {
+            uint32_t Comptes[256] = {0};
+            for (size_t i = 0; i < len; ++i) ++Comptes[static_cast<unsigned char>(trame[i])];
+            uint8_t Longueurs[256];
+            cHuffman::CalculerLongueurs(Comptes, Longueurs);
+            ecrivain.commencer(Longueurs);
         }
+        ecrivain.ajouter(trame, len);
+        ecrivain.terminer(largeurSortie, hauteurSortie, f.qualite, f.transposee != transposee);
+    }
+    tracer_codec(mTrace, "[Transformation_JPEG] %zu blocks, %ux%u -> %ux%u", nbBlocs, r.largeur, r.hauteur,
+                 largeurSortie, hauteurSortie);
+    if (stats) {
+        stats->octetsEntree += Taille;
+        stats->octetsSortie += Fichier.size();
+        stats->blocs += nbBlocs;
+        stats->symboles += len;
     }
+    return true;
+}
 
-    return rows;
+bool cCompression::LireDimensions(const uint8_t *Donnees, size_t Taille, unsigned int &Largeur, unsigned int &Hauteur)
+{
+    sFluxHuf f;
+    if (!lire_flux_huf(Donnees, Taille, nullptr, fTraceCodec(), f) || f.largeur == 0) return false;
+    Largeur = f.largeur;
+    Hauteur = f.hauteur;
+    return true;
 }
@@ -6,232 +6,786 @@
  */
 
 #include "core/cCompressionCouleur.h"
+#include "core/cArene.h"
 #include "core/cCompression.h"
+#include "core/cContexteCodec.h"
+#include "core/cEncodeurFlux.h"
+#include "core/cFichierMappe.h"
+#include "core/cFormatHuf2.h"
+#include "core/cImage.h"
+#include "core/cThreadPool.h"
+#include "couleur/couleur.h"
+#include "dct/dct.h"
+#include "dct/dct_kernels.h"
+#include "quantification/quantification.h"
 
 #include <vector>
 #include <fstream>
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <string>
+#include <limits>
+#include <memory>
 
-// --- Static Helper Functions for Color Image Processing ---
+// --- Single-file container ---
+
+namespace {
+
+/** @brief Magic number of the single-file color container. */
+const char kMagicConteneur[4] = { 'H', 'U', 'F', 'C' };
+/** @brief Version of the container layout. */
+const unsigned char kVersionConteneur = 1;
+/** @brief Version of the layout with a flags byte after the number of tables, written only when a flag is set. */
+const unsigned char kVersionDrapeaux = 2;
+/** @brief Flag: the blocks are quantized with the transposed tables (see cCompressionCouleur::TransformConteneur()). */
+const unsigned char kDrapeauTransposee = 1;
 
 /**
- * @brief Reads a binary (P6) PPM file.
- * @param[in] path Path to the PPM file.
- * @param[out] w Width of the image.
- * @param[out] h Height of the image.
- * @param[out] rgb A vector to be filled with the raw RGB pixel data.
- * @return True on success, false on failure.
+ * @struct sGeometrieMCU
+ * @brief Plane and MCU sizes of a color image for one subsampling mode.
+ *
+ * An MCU covers facteurH x facteurV luma blocks and one block of each
+ * chroma component; the planes are padded to whole MCUs.
  */
-static bool readPPM(const char *path, unsigned int &w, unsigned int &h, std::vector<unsigned char> &rgb)
+struct sGeometrieMCU {
+    unsigned int largeur, hauteur;   ///< Image size in pixels.
+    unsigned int mode;               ///< 444, 422 or 420.
+    unsigned int facteurH, facteurV; ///< Luma blocks per MCU, horizontally and vertically.
+    unsigned int nbMcuX, nbMcuY;     ///< Number of MCUs.
+    unsigned int largeurY, hauteurY; ///< Padded luma plane.
+    unsigned int largeurC, hauteurC; ///< Padded chroma planes.
+};
+
+/** @brief Fills g for an image; returns false for an empty image or an unknown mode. */
+bool calculer_geometrie(unsigned int w, unsigned int h, unsigned int mode, sGeometrieMCU &g)
+{
+    if (w == 0 || h == 0 || (mode != 444 && mode != 422 && mode != 420)) return false;
+    g.largeur = w;
+    g.hauteur = h;
+    g.mode = mode;
+    g.facteurH = (mode == 444) ? 1 : 2;
+    g.facteurV = (mode == 420) ? 2 : 1;
+    g.nbMcuX = (w + 8 * g.facteurH - 1) / (8 * g.facteurH);
+    g.nbMcuY = (h + 8 * g.facteurV - 1) / (8 * g.facteurV);
+    g.largeurY = g.nbMcuX * 8 * g.facteurH;
+    g.hauteurY = g.nbMcuY * 8 * g.facteurV;
+    g.largeurC = g.nbMcuX * 8;
+    g.hauteurC = g.nbMcuY * 8;
+    return true;
+}
+
+/** @brief Level-shifts one 8x8 block of a plane. */
+void decaler_bloc(const unsigned char *src, size_t pas, int16_t *bloc)
+{
+    for (int r = 0; r < 8; ++r) {
+        for (int c = 0; c < 8; ++c) bloc[r * 8 + c] = static_cast<int16_t>(static_cast<int>(src[r * pas + c]) - 128);
+    }
+}
+
+/** @brief Writes one inverse-transformed block into a plane, clamped to 0..255. */
+void ecrire_bloc(const int16_t *pixels, unsigned char *dst, size_t pas)
+{
+    for (int r = 0; r < 8; ++r) {
+        for (int c = 0; c < 8; ++c) {
+            int val = pixels[r * 8 + c] + 128;
+            dst[r * pas + c] = static_cast<unsigned char>((val < 0) ? 0 : (val > 255) ? 255 : val);
+        }
+    }
+}
+
+/** @brief Writes one cote x cote block of a reduced-scale decode into a plane, clamped to 0..255. */
+void ecrire_bloc_reduit(const int16_t *pixels, unsigned int cote, unsigned char *dst, size_t pas)
 {
-    std::ifstream in(path, std::ios::binary);
-    if (!in) return false;
-    std::string magic; in >> magic; if (magic != "P6") return false;
-    while (in.peek() == '#') { std::string line; std::getline(in, line); }
-    in >> w >> h;
-    int maxv; in >> maxv;
-    in.get(); // Consume whitespace
-    size_t n = static_cast<size_t>(w) * static_cast<size_t>(h) * 3;
-    rgb.resize(n);
-    in.read(reinterpret_cast<char*>(rgb.data()), n);
-    return static_cast<size_t>(in.gcount()) == n;
+    for (unsigned int r = 0; r < cote; ++r) {
+        for (unsigned int c = 0; c < cote; ++c) {
+            int val = pixels[r * cote + c] + 128;
+            dst[r * pas + c] = static_cast<unsigned char>((val < 0) ? 0 : (val > 255) ? 255 : val);
+        }
+    }
 }
 
 /**
- * @brief Writes a binary (P6) PPM file.
- * @param[in] path Path for the output PPM file.
- * @param[in] w Width of the image.
- * @param[in] h Height of the image.
- * @param[in] rgb A vector containing the raw RGB pixel data.
- * @return True on success, false on failure.
+ * @brief Dequantizes and inverse-transforms consecutive blocks of one component.
+ *
+ * As reconstruire_blocs() does for grayscale images, blocks without AC
+ * coefficients (mask <= 1) are filled with the value of Calcul_IDCT_DC()
+ * (or Calcul_IDCT_DC_Entier()) and only their DC is read; the other blocks
+ * go to the kernels in runs of consecutive blocks.
+ *
+ * @param coefs nb blocks of quantized coefficients, row-major.
+ * @param masques Their nonzero masks (see cCompression::RLE_Decoder_Bloc()).
+ * @param dequant Scratch of nb * 64 values for PIPELINE_ENTIER.
+ * @param[out] pixels The nb level-shifted blocks.
  */
-static bool writePPM(const char *path, unsigned int w, unsigned int h, const std::vector<unsigned char> &rgb)
+void reconstruire_composante(const int16_t *coefs, const uint64_t *masques, size_t nb, const cContexteQuant &ctx,
+                             eModePipeline pipeline, int32_t *dequant, int16_t *pixels, sStatistiques *stats)
 {
-    std::ofstream out(path, std::ios::binary);
-    if (!out) return false;
-    out << "P6\n" << w << " " << h << "\n255\n";
-    out.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
-    return true;
+    const int *Q = ctx.getTable();
+    const float *Qf = ctx.getTableF();
+    size_t i = 0;
+    while (i < nb) {
+        if (masques[i] <= 1) {
+            cChronoEtape chrono(stats, ETAPE_DCT);
+            const int16_t v = (pipeline == PIPELINE_ENTIER) ? Calcul_IDCT_DC_Entier(coefs[i * 64] * Q[0])
+                                                            : Calcul_IDCT_DC(coefs[i * 64], Qf[0]);
+            std::fill(pixels + i * 64, pixels + i * 64 + 64, v);
+            ++i;
+            continue;
+        }
+        size_t fin = i + 1;
+        while (fin < nb && masques[fin] > 1) ++fin;
+        if (pipeline == PIPELINE_ENTIER) {
+            {
+                cChronoEtape chrono(stats, ETAPE_QUANT);
+                for (size_t k = i * 64; k < fin * 64; ++k) dequant[k] = coefs[k] * Q[k % 64];
+            }
+            cChronoEtape chrono(stats, ETAPE_DCT);
+            for (size_t b = i; b < fin; ++b) Calcul_IDCT_Block_Entier(dequant + b * 64, pixels + b * 64);
+        } else {
+            cChronoEtape chrono(stats, ETAPE_DCT);
+            dct_kernels().dequant_idct(coefs + i * 64, Qf, pixels + i * 64, fin - i);
+        }
+        i = fin;
+    }
 }
 
 /**
- * @brief Converts a pixel from RGB to YCbCr color space.
- * @param[in] R Red component (0-255).
- * @param[in] G Green component (0-255).
- * @param[in] B Blue component (0-255).
- * @param[out] Y Luma component (0-255).
- * @param[out] Cb Blue-difference chroma (0-255).
- * @param[out] Cr Red-difference chroma (0-255).
+ * @struct sLigneMCU
+ * @brief The RLE bytes of one MCU row, coded independently of the other rows.
+ *
+ * The DC prediction of each component starts from 0; the differences of the
+ * first blocks are patched with the DC of the preceding row once the rows
+ * are put back in order (see recoller_ligne_mcu()). All buffers are carved
+ * out of the arena before the rows are handed out to the pool.
  */
-static inline void rgb_to_ycbcr(unsigned char R, unsigned char G, unsigned char B, unsigned char &Y, unsigned char &Cb, unsigned char &Cr)
+struct sLigneMCU {
+    unsigned char *Y, *Cb, *Cr;         ///< Scratch: the converted and subsampled stripes of the row.
+    int16_t *blocs;                     ///< Scratch: the level-shifted blocks, then their quantized coefficients in scan order.
+    float *dct;                         ///< Scratch: the coefficients of the blocks (PIPELINE_FLOTTANT).
+    int32_t *dct8;                      ///< Scratch: the fixed-point coefficients of the blocks (PIPELINE_ENTIER).
+    uint64_t *masques;                  ///< Scratch: the nonzero mask of each quantized block.
+    sStatistiques *stats;               ///< The figures of the row (nullptr: not measured).
+    signed char *rle;                   ///< The RLE bytes, blocks in coding order (room for the worst case).
+    unsigned char *tailles;             ///< The number of bytes of each block.
+    size_t nbOctets;                    ///< The number of RLE bytes.
+    size_t nbBlocs;                     ///< The number of blocks.
+    int DC_premier[3];                  ///< Quantized DC of the first block of each component.
+    int DC_dernier[3];                  ///< Quantized DC of the last block of each component.
+};
+
+/** @brief Carves the buffers of a sLigneMCU for geometry g out of the arena (with a record when mesurer is set). */
+void preparer_ligne_mcu(const sGeometrieMCU &g, eModePipeline pipeline, bool mesurer, cArene &arene, sLigneMCU &ligne)
 {
-    double r = static_cast<double>(R), g = static_cast<double>(G), b = static_cast<double>(B);
-    double y  =  0.299 * r + 0.587 * g + 0.114 * b;
-    double cb = -0.168736 * r - 0.331264 * g + 0.5 * b + 128.0;
-    double cr =  0.5 * r - 0.418688 * g - 0.081312 * b + 128.0;
-    Y = static_cast<unsigned char>(std::max(0, std::min(255, static_cast<int>(std::round(y)))));
-    Cb = static_cast<unsigned char>(std::max(0, std::min(255, static_cast<int>(std::round(cb)))));
-    Cr = static_cast<unsigned char>(std::max(0, std::min(255, static_cast<int>(std::round(cr)))));
+    ligne.nbBlocs = static_cast<size_t>(g.nbMcuX) * (g.facteurH * g.facteurV + 2);
+    ligne.Y = arene.allouer<unsigned char>(static_cast<size_t>(g.largeurY) * 8 * g.facteurV);
+    ligne.Cb = arene.allouer<unsigned char>(static_cast<size_t>(g.largeurC) * 8);
+    ligne.Cr = arene.allouer<unsigned char>(static_cast<size_t>(g.largeurC) * 8);
+    ligne.blocs = arene.allouer<int16_t>(ligne.nbBlocs * 64);
+    ligne.dct = arene.allouer<float>((pipeline == PIPELINE_FLOTTANT) ? ligne.nbBlocs * 64 : 0);
+    ligne.dct8 = arene.allouer<int32_t>((pipeline == PIPELINE_ENTIER) ? ligne.nbBlocs * 64 : 0);
+    ligne.masques = arene.allouer<uint64_t>(ligne.nbBlocs);
+    ligne.stats = mesurer ? arene.allouer<sStatistiques>(1) : nullptr;
+    ligne.rle = arene.allouer<signed char>(ligne.nbBlocs * 128);
+    ligne.tailles = arene.allouer<unsigned char>(ligne.nbBlocs);
+    ligne.nbOctets = 0;
 }
 
 /**
- * @brief Converts a pixel from YCbCr to RGB color space.
- * @param[in] Y Luma component (0-255).
- * @param[in] Cb Blue-difference chroma (0-255).
- * @param[in] Cr Red-difference chroma (0-255).
- * @param[out] R Red component (0-255).
- * @param[out] G Green component (0-255).
- * @param[out] B Blue component (0-255).
+ * @brief Converts one MCU row and computes the DCT of its blocks, in coding order, into ligne.dct (or ligne.dct8).
+ * @param rgb The first of nbLignes rows of RGB pixels.
+ * @param pas The distance between two RGB rows, in bytes.
+ * @param nbLignes The number of rows available (at most 8 * facteurV).
+ * @param[out] ligne The row, prepared by preparer_ligne_mcu(); its record is reset first.
  */
-static inline void ycbcr_to_rgb(unsigned char Y, unsigned char Cb, unsigned char Cr, unsigned char &R, unsigned char &G, unsigned char &B)
+void transformer_ligne_mcu(const unsigned char *rgb, size_t pas, unsigned int nbLignes, const sGeometrieMCU &g,
+                           eModePipeline pipeline, sLigneMCU &ligne)
 {
-    double y = static_cast<double>(Y), cb = static_cast<double>(Cb) - 128.0, cr = static_cast<double>(Cr) - 128.0;
-    double r = y + 1.402 * cr;
-    double g = y - 0.344136 * cb - 0.714136 * cr;
-    double b = y + 1.772 * cb;
-    R = static_cast<unsigned char>(std::max(0, std::min(255, static_cast<int>(std::round(r)))));
-    G = static_cast<unsigned char>(std::max(0, std::min(255, static_cast<int>(std::round(g)))));
-    B = static_cast<unsigned char>(std::max(0, std::min(255, static_cast<int>(std::round(b)))));
+    sStatistiques *stats = ligne.stats;
+    if (stats) *stats = sStatistiques();
+    {
+        cChronoEtape chrono(stats, ETAPE_COULEUR);
+        rgb_vers_ycbcr_mcu(rgb, pas, g.largeur, nbLignes, g.facteurH, g.facteurV, g.largeurY, ligne.Y, ligne.Cb, ligne.Cr);
+    }
+
+    cChronoEtape chrono(stats, ETAPE_DCT);
+    int16_t *bloc = ligne.blocs;
+    for (unsigned int mx = 0; mx < g.nbMcuX; ++mx) {
+        for (unsigned int v = 0; v < g.facteurV; ++v) {
+            for (unsigned int u = 0; u < g.facteurH; ++u, bloc += 64) {
+                decaler_bloc(ligne.Y + static_cast<size_t>(v) * 8 * g.largeurY + (mx * g.facteurH + u) * 8, g.largeurY, bloc);
+            }
+        }
+        decaler_bloc(ligne.Cb + mx * 8, g.largeurC, bloc);
+        decaler_bloc(ligne.Cr + mx * 8, g.largeurC, bloc + 64);
+        bloc += 128;
+    }
+    if (pipeline == PIPELINE_ENTIER) {
+        for (size_t b = 0; b < ligne.nbBlocs; ++b) Calcul_DCT_Block_Entier(ligne.blocs + b * 64, ligne.dct8 + b * 64);
+    } else {
+        dct_kernels().dct(ligne.blocs, ligne.dct, ligne.nbBlocs);
+    }
 }
 
 /**
- * @brief Subsamples a chroma plane using 4:2:0 scheme (averages a 2x2 block).
- * @param[in] src The source chroma plane.
- * @param[in] w Width of the source plane.
- * @param[in] h Height of the source plane.
- * @param[out] dst The destination vector for the subsampled data.
- * @param[out] cw The new width of the subsampled plane.
- * @param[out] ch The new height of the subsampled plane.
+ * @brief Converts and RLE-codes one MCU row: for each MCU, its luma blocks in raster order, then Cb, then Cr.
+ * @param rgb The first of nbLignes rows of RGB pixels.
+ * @param pas The distance between two RGB rows, in bytes.
+ * @param nbLignes The number of rows available (at most 8 * facteurV).
+ * @param[out] ligne The coded row, prepared by preparer_ligne_mcu().
  */
-static void subsample420(const std::vector<unsigned char> &src, unsigned int w, unsigned int h, std::vector<unsigned char> &dst, unsigned int &cw, unsigned int &ch)
+void encoder_ligne_mcu(const unsigned char *rgb, size_t pas, unsigned int nbLignes, const sGeometrieMCU &g, eModePipeline pipeline,
+                       const cContexteQuant &ctxY, const cContexteQuant &ctxC, sLigneMCU &ligne)
 {
-    cw = (w + 1) / 2; ch = (h + 1) / 2;
-    dst.assign(static_cast<size_t>(cw) * ch, 0);
-    for (unsigned int y = 0; y < ch; ++y) {
-        for (unsigned int x = 0; x < cw; ++x) {
-            int sum = 0, count = 0;
-            for (int yy = 0; yy < 2; ++yy) for (int xx = 0; xx < 2; ++xx) {
-                if (x*2 + xx < w && y*2 + yy < h) {
-                    sum += src[(y*2 + yy) * w + (x*2 + xx)];
-                    ++count;
-                }
-            }
-            dst[y * cw + x] = static_cast<unsigned char>((count > 0) ? (sum / count) : 0);
+    // Each stage runs over the whole row: level shift and DCT, quantization, then RLE.
+    transformer_ligne_mcu(rgb, pas, nbLignes, g, pipeline, ligne);
+    sStatistiques *stats = ligne.stats;
+    const size_t blocsParMcu = static_cast<size_t>(g.facteurH) * g.facteurV + 2;
+    {
+        cChronoEtape chrono(stats, ETAPE_QUANT);
+        for (size_t b = 0; b < ligne.nbBlocs; ++b) {
+            const cContexteQuant &ctx = (b % blocsParMcu < blocsParMcu - 2) ? ctxY : ctxC;
+            ligne.masques[b] = (pipeline == PIPELINE_ENTIER) ? ctx.quantifier_zigzag_entier(ligne.dct8 + b * 64, ligne.blocs + b * 64)
+                                                             : ctx.quantifier_zigzag(ligne.dct + b * 64, ligne.blocs + b * 64);
         }
     }
+
+    cChronoEtape chrono(stats, ETAPE_RLE);
+    size_t taille = 0;
+    int DC[3] = { 0, 0, 0 };
+    bool premier[3] = { true, true, true };
+    for (size_t b = 0; b < ligne.nbBlocs; ++b) {
+        const size_t k = b % blocsParMcu;
+        const int composante = (k < blocsParMcu - 2) ? 0 : static_cast<int>(k - (blocsParMcu - 2)) + 1;
+        const int16_t *zigzag = ligne.blocs + b * 64;
+        const int n = cCompression::RLE_Block(zigzag, ligne.masques[b], DC[composante], ligne.rle + taille);
+        if (premier[composante]) ligne.DC_premier[composante] = zigzag[0];
+        premier[composante] = false;
+        DC[composante] = zigzag[0];
+        ligne.tailles[b] = static_cast<unsigned char>(n);
+        taille += static_cast<size_t>(n);
+    }
+    ligne.nbOctets = taille;
+    for (int c = 0; c < 3; ++c) ligne.DC_dernier[c] = DC[c];
+    if (stats) {
+        stats->blocs += ligne.nbBlocs;
+        stats->symboles += taille;
+    }
 }
 
 /**
- * @brief Subsamples a chroma plane using 4:2:2 scheme (averages 2 horizontal pixels).
+ * @brief Chains a row coded by encoder_ligne_mcu() to the preceding one.
+ * @param ligne The row; the DC differences of its first Y, Cb and Cr blocks are rewritten.
+ * @param[in,out] DC The DC of the last block of each component so far; updated with this row.
  */
-static void subsample422(const std::vector<unsigned char> &src, unsigned int w, unsigned int h, std::vector<unsigned char> &dst, unsigned int &cw, unsigned int &ch)
+void recoller_ligne_mcu(sLigneMCU &ligne, const sGeometrieMCU &g, int DC[3])
 {
-    cw = (w + 1) / 2; ch = h;
-    dst.assign(static_cast<size_t>(cw) * ch, 0);
-    for (unsigned int y = 0; y < ch; ++y) {
-        for (unsigned int x = 0; x < cw; ++x) {
-            int sum = 0, count = 0;
-            for (int xx = 0; xx < 2; ++xx) {
-                if (x*2 + xx < w) {
-                    sum += src[y * w + (x*2 + xx)];
-                    ++count;
-                }
-            }
-            dst[y * cw + x] = static_cast<unsigned char>((count > 0) ? (sum / count) : 0);
+    const size_t nbY = static_cast<size_t>(g.facteurH) * g.facteurV;
+    size_t debut[3] = { 0, 0, 0 };
+    for (size_t b = 0; b < nbY; ++b) debut[1] += ligne.tailles[b];
+    debut[2] = debut[1] + ligne.tailles[nbY];
+    for (int c = 0; c < 3; ++c) {
+        ligne.rle[debut[c]] = static_cast<signed char>(ligne.DC_premier[c] - DC[c]);
+        DC[c] = ligne.DC_dernier[c];
+    }
+}
+
+/**
+ * @struct sSortieFlux
+ * @brief Container output to a stream (a file).
+ */
+struct sSortieFlux {
+    std::ostream &out;
+
+    void ecrire(const void *p, size_t n) { out.write(static_cast<const char*>(p), static_cast<std::streamsize>(n)); }
+    size_t position() { return static_cast<size_t>(out.tellp()); }
+    void reecrire(size_t pos, const void *p, size_t n)
+    {
+        const std::streampos fin = out.tellp();
+        out.seekp(static_cast<std::streamoff>(pos));
+        ecrire(p, n);
+        out.seekp(fin);
+    }
+    bool ok() const { return static_cast<bool>(out); }
+};
+
+/**
+ * @struct sSortieMemoire
+ * @brief Container output appended to a byte vector, which keeps its capacity from one image to the next.
+ */
+struct sSortieMemoire {
+    std::vector<unsigned char> &octets;
+
+    void ecrire(const void *p, size_t n)
+    {
+        const unsigned char *c = static_cast<const unsigned char*>(p);
+        octets.insert(octets.end(), c, c + n);
+    }
+    size_t position() const { return octets.size(); }
+    void reecrire(size_t pos, const void *p, size_t n) { std::memcpy(octets.data() + pos, p, n); }
+    bool ok() const { return true; }
+};
+
+/** @brief Writes a little-endian integer of the given width. */
+template <typename Sortie, typename T>
+void ecrire_entier(Sortie &out, T v)
+{
+    out.ecrire(&v, sizeof(v));
+}
+
+/** @brief Writes a code table as in a HUF2 header: mode byte, 16 counts per length, symbols in canonical order. */
+template <typename Sortie>
+void ecrire_table(Sortie &out, const uint8_t Longueurs[256])
+{
+    unsigned char table[1 + cHuffman::kLongueurMax + 256];
+    size_t n = 0;
+    table[n++] = kTableIntegree;
+    unsigned char *nbParLongueur = table + n;
+    std::memset(nbParLongueur, 0, cHuffman::kLongueurMax);
+    n += cHuffman::kLongueurMax;
+    for (int c = 0; c < 256; ++c) {
+        if (Longueurs[c] != 0) ++nbParLongueur[Longueurs[c] - 1];
+    }
+    for (int l = 1; l <= cHuffman::kLongueurMax; ++l) {
+        for (int c = 0; c < 256; ++c) {
+            if (Longueurs[c] == l) table[n++] = static_cast<unsigned char>(c);
+        }
+    }
+    out.ecrire(table, n);
+}
+
+/** @brief Reads a table written by ecrire_table(); returns false if it is truncated or unknown. */
+bool lire_table(const unsigned char *d, size_t n, size_t &pos, uint8_t Longueurs[256])
+{
+    std::memset(Longueurs, 0, 256);
+    if (pos + 1 + cHuffman::kLongueurMax > n || d[pos++] != kTableIntegree) return false;
+    const unsigned char *nbParLongueur = d + pos;
+    pos += cHuffman::kLongueurMax;
+    unsigned int nbSym = 0;
+    for (int l = 1; l <= cHuffman::kLongueurMax; ++l) {
+        for (unsigned int c = 0; c < nbParLongueur[l - 1]; ++c) {
+            if (pos >= n || nbSym >= 256) return false;
+            Longueurs[d[pos++]] = static_cast<uint8_t>(l);
+            ++nbSym;
         }
     }
+    return nbSym != 0;
 }
 
 /**
- * @brief Performs bilinear upsampling on a single channel.
- * @param[in] src The source (smaller) data plane.
- * @param[in] cw Width of the source plane.
- * @param[in] ch Height of the source plane.
- * @param[out] dst The destination vector for the upsampled data.
- * @param[in] w The target width.
- * @param[in] h The target height.
+ * @brief Huffman-codes RLE blocks in coding order; the class of a block (luma or chroma) is given by its place in the MCU.
+ * @param rle The RLE bytes of the blocks, one after the other.
+ * @param tailles The number of bytes of each block.
+ * @param nbBlocs The number of blocks.
+ * @param blocsParMcu The number of blocks of an MCU (luma blocks, then Cb and Cr).
  */
-static void upsample_bilinear(const std::vector<unsigned char> &src, unsigned int cw, unsigned int ch, std::vector<unsigned char> &dst, unsigned int w, unsigned int h)
+void coder_blocs_huffman(cEcrivainBits &ecrivain, const signed char *rle, const unsigned char *tailles, size_t nbBlocs,
+                         size_t blocsParMcu, const uint8_t Longueurs[2][256], const uint32_t Codes[2][256])
 {
-    dst.assign(static_cast<size_t>(w) * h, 0);
-    if (cw == 0 || ch == 0) return;
-    double sx_ratio = (cw > 1) ? (double)(cw - 1) / (w - 1) : 0;
-    double sy_ratio = (ch > 1) ? (double)(ch - 1) / (h - 1) : 0;
-
-    for (unsigned int j = 0; j < h; ++j) {
-        double sy = sy_ratio * j;
-        unsigned int y0 = static_cast<unsigned int>(sy);
-        unsigned int y1 = std::min(y0 + 1, ch - 1);
-        double v = sy - y0;
-
-        for (unsigned int i = 0; i < w; ++i) {
-            double sx = sx_ratio * i;
-            unsigned int x0 = static_cast<unsigned int>(sx);
-            unsigned int x1 = std::min(x0 + 1, cw - 1);
-            double u = sx - x0;
-
-            double p00 = src[y0 * cw + x0];
-            double p01 = src[y0 * cw + x1];
-            double p10 = src[y1 * cw + x0];
-            double p11 = src[y1 * cw + x1];
-            
-            double val = p00 * (1-u)*(1-v) + p01 * u*(1-v) + p10 * (1-u)*v + p11 * u*v;
-            dst[j * w + i] = static_cast<unsigned char>(std::max(0, std::min(255, static_cast<int>(std::round(val)))));
+    size_t p = 0;
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        const int classe = (b % blocsParMcu < blocsParMcu - 2) ? 0 : 1;
+        for (size_t k = 0; k < tailles[b]; ++k) {
+            const unsigned char c = static_cast<unsigned char>(rle[p + k]);
+            ecrivain.ecrire(Codes[classe][c], Longueurs[classe][c]);
         }
+        p += tailles[b];
     }
 }
 
 /**
- * @brief Pads a single-channel image to be a multiple of 8x8 blocks by replicating border pixels.
- * @param[in] src Source image data.
- * @param[in] w Width of source.
- * @param[in] h Height of source.
- * @param[out] dst Destination vector for padded data.
- * @param[out] pw New padded width.
- * @param[out] ph New padded height.
+ * @brief Writes the container header, up to the payload size fields (written as zero).
+ * @return The output position of the payload size fields.
+ */
+template <typename Sortie>
+size_t ecrire_entete_conteneur(Sortie &out, const sGeometrieMCU &g, unsigned int qual,
+                               const uint8_t LongueursY[256], const uint8_t LongueursC[256], bool transposee = false)
+{
+    unsigned char entete[sizeof(kMagicConteneur) + 1 + 4 + 4 + 2 + 1 + 1 + 1];
+    const uint32_t w = g.largeur, h = g.hauteur;
+    const uint16_t mode = static_cast<uint16_t>(g.mode);
+    size_t n = 0;
+    std::memcpy(entete + n, kMagicConteneur, sizeof(kMagicConteneur)); n += sizeof(kMagicConteneur);
+    entete[n++] = transposee ? kVersionDrapeaux : kVersionConteneur;
+    std::memcpy(entete + n, &w, sizeof(w)); n += sizeof(w);
+    std::memcpy(entete + n, &h, sizeof(h)); n += sizeof(h);
+    std::memcpy(entete + n, &mode, sizeof(mode)); n += sizeof(mode);
+    entete[n++] = static_cast<unsigned char>(qual);
+    entete[n++] = 2; // number of tables: luma, then chroma
+    if (transposee) entete[n++] = kDrapeauTransposee;
+    out.ecrire(entete, n);
+    ecrire_table(out, LongueursY);
+    ecrire_table(out, LongueursC);
+    const size_t pos = out.position();
+    ecrire_entier<Sortie, uint32_t>(out, 0); // payload bytes
+    ecrire_entier<Sortie, uint32_t>(out, 0); // payload bits
+    return pos;
+}
+
+/**
+ * @brief Encodes an RGB image into the container, a few MCU rows at a time.
+ *
+ * Each MCU row is converted, subsampled and RLE-coded on its own, in
+ * parallel on the pool when there is one; the rows are then chained in
+ * order, so the output does not depend on the thread count. With
+ * deuxPasses, the RLE bytes of the whole image are kept (they are a
+ * fraction of its size) to build one optimal table per component class
+ * before coding; otherwise the built-in table of cEncodeurFlux is used
+ * for both and the bits are written as each group of rows is coded.
+ * Every buffer comes from the arena.
+ *
+ * @param lire Returns the first of nb rows starting at row y0 (lire(y0, nb)), nullptr on a read error.
+ * @param pas The distance between two rows returned by lire, in bytes.
+ * @param stats Receives the counters and stage times (nullptr: not measured).
  */
-static void padToMultipleOf8(const std::vector<unsigned char> &src, unsigned int w, unsigned int h, std::vector<unsigned char> &dst, unsigned int &pw, unsigned int &ph)
+template <typename Source, typename Sortie>
+bool encoder_conteneur(Source &&lire, size_t pas, const sGeometrieMCU &g, Sortie &out, unsigned int qual,
+                       eModePipeline pipeline, bool deuxPasses, cThreadPool *pool, cArene &arene, sStatistiques *stats)
 {
-    pw = ((w + 7) / 8) * 8;
-    ph = ((h + 7) / 8) * 8;
-    if (pw == w && ph == h) {
-        dst = src;
-        return;
-    }
-    dst.assign(static_cast<size_t>(pw) * ph, 0);
-    for (unsigned int y = 0; y < ph; ++y) {
-        unsigned int sy = std::min(y, h - 1);
-        for (unsigned int x = 0; x < pw; ++x) {
-            unsigned int sx = std::min(x, w - 1);
-            dst[y * pw + x] = src[sy * w + sx];
+    qual = (qual < 1) ? 1 : (qual > 100) ? 100 : qual;
+    const cContexteQuant ctxY(qual, COMPOSANTE_LUMA);
+    const cContexteQuant ctxC(qual, COMPOSANTE_CHROMA);
+
+    uint8_t Longueurs[2][256];
+    uint32_t Codes[2][256];
+    std::vector<unsigned char> &octets = arene.tampon(TAMPON_BITS);
+    octets.clear();
+    cEcrivainBits ecrivain(octets);
+    uint64_t octetsEcrits = 0;
+    size_t posTaille = 0;
+    const size_t debut = out.position();
+    const size_t blocsParMcu = static_cast<size_t>(g.facteurH) * g.facteurV + 2;
+
+    auto vider = [&]() {
+        out.ecrire(octets.data(), octets.size());
+        octetsEcrits += octets.size();
+        octets.clear();
+    };
+    auto coder = [&](const signed char *rle, const unsigned char *tailles, size_t nbBlocs) {
+        coder_blocs_huffman(ecrivain, rle, tailles, nbBlocs, blocsParMcu, Longueurs, Codes);
+    };
+
+    // Two-pass mode: RLE bytes and block sizes of the whole image, in coding order.
+    std::vector<unsigned char> &rle = arene.tampon(TAMPON_RLE);
+    std::vector<unsigned char> &tailles = arene.tampon(TAMPON_TAILLES);
+    rle.clear();
+    tailles.clear();
+    uint32_t Comptes[2][256] = {{0}};
+    if (!deuxPasses) {
+        cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+        for (int classe = 0; classe < 2; ++classe) {
+            std::memcpy(Longueurs[classe], cEncodeurFlux::getLongueursFixes(), 256);
+            cHuffman::CodesCanoniques(Longueurs[classe], Codes[classe]);
         }
+        posTaille = ecrire_entete_conteneur(out, g, qual, Longueurs[0], Longueurs[1]);
     }
+
+    // A group of MCU rows is read at once: one row per task, a few tasks per thread.
+    cPorteeArene portee(arene);
+    const unsigned int hauteurBande = 8 * g.facteurV;
+    const unsigned int nbGroupe = pool ? pool->getNbThreads() * 2 : 1;
+    sLigneMCU *lignes = arene.allouer<sLigneMCU>(nbGroupe);
+    for (unsigned int i = 0; i < nbGroupe; ++i) preparer_ligne_mcu(g, pipeline, stats != nullptr, arene, lignes[i]);
+    int DC[3] = { 0, 0, 0 };
+    for (unsigned int my0 = 0; my0 < g.nbMcuY; my0 += nbGroupe) {
+        const unsigned int nbMcu = (g.nbMcuY - my0 < nbGroupe) ? g.nbMcuY - my0 : nbGroupe;
+        const unsigned int y0 = my0 * hauteurBande;
+        const unsigned int nb = (g.hauteur - y0 < nbMcu * hauteurBande) ? g.hauteur - y0 : nbMcu * hauteurBande;
+        const unsigned char *rgb = lire(y0, nb);
+        if (!rgb) return false;
+
+        auto encoder_ligne = [&](size_t i) {
+            const unsigned int debut = static_cast<unsigned int>(i) * hauteurBande;
+            const unsigned int nbLignes = (nb - debut < hauteurBande) ? nb - debut : hauteurBande;
+            encoder_ligne_mcu(rgb + pas * debut, pas, nbLignes, g, pipeline, ctxY, ctxC, lignes[i]);
+        };
+        if (pool && nbMcu > 1) {
+            pool->paralleliser(nbMcu, encoder_ligne);
+        } else {
+            for (unsigned int i = 0; i < nbMcu; ++i) encoder_ligne(i);
+        }
+
+        cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+        for (unsigned int i = 0; i < nbMcu; ++i) {
+            sLigneMCU &ligne = lignes[i];
+            if (stats) stats->ajouter(*ligne.stats);
+            recoller_ligne_mcu(ligne, g, DC);
+            if (deuxPasses) {
+                size_t p = 0;
+                for (size_t b = 0; b < ligne.nbBlocs; ++b) {
+                    const int classe = (b % blocsParMcu < blocsParMcu - 2) ? 0 : 1;
+                    for (size_t k = 0; k < ligne.tailles[b]; ++k) ++Comptes[classe][static_cast<unsigned char>(ligne.rle[p + k])];
+                    p += ligne.tailles[b];
+                }
+                const unsigned char *octetsRle = reinterpret_cast<const unsigned char*>(ligne.rle);
+                rle.insert(rle.end(), octetsRle, octetsRle + ligne.nbOctets);
+                tailles.insert(tailles.end(), ligne.tailles, ligne.tailles + ligne.nbBlocs);
+            } else {
+                coder(ligne.rle, ligne.tailles, ligne.nbBlocs);
+            }
+        }
+        if (!deuxPasses) vider();
+    }
+
+    // Second pass: optimal tables, then the bits.
+    cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+    if (deuxPasses) {
+        for (int classe = 0; classe < 2; ++classe) {
+            cHuffman::CalculerLongueurs(Comptes[classe], Longueurs[classe]);
+            cHuffman::CodesCanoniques(Longueurs[classe], Codes[classe]);
+        }
+        posTaille = ecrire_entete_conteneur(out, g, qual, Longueurs[0], Longueurs[1]);
+        coder(reinterpret_cast<const signed char*>(rle.data()), tailles.data(), tailles.size());
+    }
+    ecrivain.aligner();
+    vider();
+
+    // Patch the payload size now that it is known.
+    const uint32_t tailles_payload[2] = { static_cast<uint32_t>(octetsEcrits), static_cast<uint32_t>(ecrivain.getNbBits()) };
+    out.reecrire(posTaille, tailles_payload, sizeof(tailles_payload));
+    if (stats) {
+        stats->octetsEntree += static_cast<uint64_t>(g.largeur) * g.hauteur * 3;
+        stats->octetsSortie += out.position() - debut;
+    }
+    return out.ok();
+}
+
+/** @brief Encodes a PPM file into a container file; the rows are read in place from the mapped file. */
+bool encoder_ppm(const char *ppmPath, const char *cheminSortie, unsigned int qual, unsigned int mode,
+                 eModePipeline pipeline, bool deuxPasses, cThreadPool *pool, cArene &arene, sStatistiques *stats)
+{
+    cLecteurImage image;
+    if (!image.ouvrir(ppmPath) || image.getFormat() != IMAGE_PPM) return false;
+    const sVueImage &vue = image.getVue();
+    sGeometrieMCU g;
+    if (!calculer_geometrie(vue.largeur, vue.hauteur, mode, g)) return false;
+
+    std::ofstream fichier(cheminSortie, std::ios::binary);
+    if (!fichier) return false;
+    sSortieFlux out{ fichier };
+    auto lire = [&](unsigned int y0, unsigned int) { return vue.ligne(y0); };
+    return encoder_conteneur(lire, vue.pas, g, out, qual, pipeline, deuxPasses, pool, arene, stats);
+}
+
+/** @brief Tells whether a byte range starts with the container magic number. */
+bool est_conteneur(const unsigned char *d, size_t n)
+{
+    return d && n >= sizeof(kMagicConteneur) && std::memcmp(d, kMagicConteneur, sizeof(kMagicConteneur)) == 0;
 }
 
 /**
- * @brief Creates a 2D array of row pointers from a flat image buffer.
- * @param[in] buf The flat vector containing the image data.
- * @param[in] w Width of the image.
- * @param[in] h Height of the image.
- * @return A newly allocated array of row pointers (unsigned char**).
- * @note The caller is responsible for deleting the returned array of pointers.
+ * @struct sConteneur
+ * @brief The header of a container; the payload points into the file bytes.
  */
-static unsigned char **makeRowPointers(std::vector<unsigned char> &buf, unsigned int w, unsigned int h)
+struct sConteneur {
+    sGeometrieMCU g;
+    unsigned int qualite;
+    bool transposee;
+    uint8_t Longueurs[2][256];
+    const unsigned char *payload;
+    uint32_t octets, bits;
+};
+
+/** @brief Parses the header of a container; returns false if it is truncated or invalid. */
+bool lire_conteneur(const unsigned char *d, size_t n, sConteneur &c)
 {
-    unsigned char **rows = new unsigned char*[h];
-    for (unsigned int y = 0; y < h; ++y) rows[y] = buf.data() + static_cast<size_t>(y) * w;
-    return rows;
+    if (!est_conteneur(d, n)) return false;
+    size_t pos = sizeof(kMagicConteneur);
+    if (pos + 1 + 4 + 4 + 2 + 1 + 1 > n) return false;
+    const unsigned char version = d[pos++];
+    if (version != kVersionConteneur && version != kVersionDrapeaux) return false;
+    uint32_t w = 0, h = 0;
+    uint16_t mode = 0;
+    std::memcpy(&w, d + pos, sizeof(w)); pos += sizeof(w);
+    std::memcpy(&h, d + pos, sizeof(h)); pos += sizeof(h);
+    std::memcpy(&mode, d + pos, sizeof(mode)); pos += sizeof(mode);
+    c.qualite = d[pos++];
+    if (d[pos++] != 2) return false;
+    c.transposee = false;
+    if (version == kVersionDrapeaux) {
+        if (pos >= n || (d[pos] & ~kDrapeauTransposee) != 0) return false; // unknown flags
+        c.transposee = (d[pos++] & kDrapeauTransposee) != 0;
+    }
+    if (!calculer_geometrie(w, h, mode, c.g) || c.qualite < 1 || c.qualite > 100) return false;
+
+    for (int classe = 0; classe < 2; ++classe) {
+        if (!lire_table(d, n, pos, c.Longueurs[classe])) return false;
+    }
+    if (pos + 8 > n) return false;
+    std::memcpy(&c.octets, d + pos, sizeof(c.octets)); pos += sizeof(c.octets);
+    std::memcpy(&c.bits, d + pos, sizeof(c.bits)); pos += sizeof(c.bits);
+    if (pos + c.octets > n || static_cast<uint64_t>(c.bits) > static_cast<uint64_t>(c.octets) * 8ULL) return false;
+    c.payload = d + pos;
+    return true;
 }
 
+/**
+ * @brief Decodes a parsed container into an RGB image.
+ *
+ * The payload is one interleaved Huffman stream, so the entropy decoding
+ * is sequential; it runs a group of MCU rows ahead, and the dequantization
+ * and inverse DCT of the rows of a group run in parallel on the pool when
+ * there is one. The fused upsampling and color conversion then run in
+ * parallel across row bands, reading the padded planes in place. The
+ * planes, coefficients and Huffman decoders come from the arena.
+ *
+ * With a cote below 8 every block is reconstructed as cote x cote pixels
+ * (see Calcul_IDCT_Reduite()), so the planes and the output are cote / 8 of
+ * the full size and the upsampling runs on the reduced planes.
+ *
+ * @param rgb The first pixel of the output, TailleReduite(g.largeur) x TailleReduite(g.hauteur) RGB pixels.
+ * @param pas The distance between two output rows, in bytes.
+ * @param stats Receives the counters and stage times (nullptr: not measured).
+ */
+bool decoder_conteneur(const sConteneur &conteneur, unsigned char *rgb, size_t pas, eModePipeline pipeline, unsigned int cote,
+                       eModeSurechantillonnage surechantillonnage, cThreadPool *pool, cArene &arene, sStatistiques *stats)
+{
+    const sGeometrieMCU &g = conteneur.g;
+    const unsigned int echelle = 8 / cote;
+    const unsigned int largeur = cCompression::TailleReduite(g.largeur, echelle);
+    const unsigned int hauteur = cCompression::TailleReduite(g.hauteur, echelle);
+    const size_t largeurY = g.largeurY / echelle, largeurC = g.largeurC / echelle;
+    cHuffman *tables[2] = { &arene.huffman(0), &arene.huffman(1) };
+    {
+        cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+        for (int classe = 0; classe < 2; ++classe) {
+            if (!tables[classe]->ConstruireDepuisLongueurs(conteneur.Longueurs[classe])) return false;
+        }
+    }
+
+    cPorteeArene portee(arene);
+    const cContexteQuant ctxY(conteneur.qualite, COMPOSANTE_LUMA, conteneur.transposee);
+    const cContexteQuant ctxC(conteneur.qualite, COMPOSANTE_CHROMA, conteneur.transposee);
+    unsigned char *Y = arene.allouer<unsigned char>(largeurY * (g.hauteurY / echelle));
+    unsigned char *Cb = arene.allouer<unsigned char>(largeurC * (g.hauteurC / echelle));
+    unsigned char *Cr = arene.allouer<unsigned char>(largeurC * (g.hauteurC / echelle));
+
+    // Coefficients of a group of MCU rows, blocks in coding order.
+    const size_t blocsParMcu = static_cast<size_t>(g.facteurH) * g.facteurV + 2;
+    const size_t blocsLigne = static_cast<size_t>(g.nbMcuX) * blocsParMcu;
+    const unsigned int nbGroupe = pool ? pool->getNbThreads() * 2 : 1;
+    int16_t *coefs = arene.allouer<int16_t>(blocsLigne * nbGroupe * 64);
+    uint64_t *masques = arene.allouer<uint64_t>(blocsLigne * nbGroupe);
+    // Per task: the pixels of a row of blocks, and its dequantized coefficients for the fixed-point IDCT.
+    int16_t *pixels = arene.allouer<int16_t>(blocsLigne * nbGroupe * 64);
+    int32_t *dequant = arene.allouer<int32_t>((pipeline == PIPELINE_ENTIER) ? blocsLigne * nbGroupe * 64 : 0);
+    const unsigned int nbBandes = pool ? std::min(hauteur, pool->getNbThreads() * 4) : 1;
+    sStatistiques *parTache = stats ? arene.allouer<sStatistiques>(std::max(nbGroupe, nbBandes)) : nullptr;
+
+    // A row of MCUs: dequantization and inverse DCT of its blocks, then the clamped pixels into the planes.
+    auto reconstruire_ligne = [&](unsigned int my, const int16_t *c, const uint64_t *m, int16_t *p, int32_t *d, sStatistiques *s) {
+        if (cote < 8) {
+            // Reduced scale: only the low frequencies are transformed, and the blocks are cote x cote.
+            cChronoEtape chrono(s, ETAPE_DCT);
+            for (size_t b = 0; b < blocsLigne; ++b) {
+                const float *Q = ((b % blocsParMcu < blocsParMcu - 2) ? ctxY : ctxC).getTableF();
+                Calcul_IDCT_Reduite(c + b * 64, Q, cote, p + b * 64);
+            }
+        } else {
+            // Full scale: the luma blocks of each MCU, then its two chroma blocks; DC-only blocks skip the transform.
+            const size_t nbY = blocsParMcu - 2;
+            for (unsigned int mx = 0; mx < g.nbMcuX; ++mx) {
+                const size_t b = mx * blocsParMcu;
+                reconstruire_composante(c + b * 64, m + b, nbY, ctxY, pipeline, d ? d + b * 64 : nullptr, p + b * 64, s);
+                reconstruire_composante(c + (b + nbY) * 64, m + b + nbY, 2, ctxC, pipeline, d ? d + (b + nbY) * 64 : nullptr,
+                                        p + (b + nbY) * 64, s);
+            }
+        }
+
+        cChronoEtape chrono(s, ETAPE_DCT);
+        auto ecrire = [&](const int16_t *bloc, unsigned char *dst, size_t pasPlan) {
+            if (cote == 8) {
+                ecrire_bloc(bloc, dst, pasPlan);
+            } else {
+                ecrire_bloc_reduit(bloc, cote, dst, pasPlan);
+            }
+        };
+        for (unsigned int mx = 0; mx < g.nbMcuX; ++mx) {
+            for (unsigned int v = 0; v < g.facteurV; ++v) {
+                for (unsigned int u = 0; u < g.facteurH; ++u) {
+                    const size_t y0 = (static_cast<size_t>(my) * g.facteurV + v) * cote;
+                    const size_t x0 = (static_cast<size_t>(mx) * g.facteurH + u) * cote;
+                    ecrire(p, Y + y0 * largeurY + x0, largeurY);
+                    p += 64;
+                }
+            }
+            const size_t off = static_cast<size_t>(my) * cote * largeurC + static_cast<size_t>(mx) * cote;
+            ecrire(p, Cb + off, largeurC);
+            ecrire(p + 64, Cr + off, largeurC);
+            p += 128;
+        }
+    };
+
+    // Blocks missing at the end of a short stream stay flat (all-zero coefficients).
+    cLecteurHuffman lecteur(*tables[0], conteneur.payload, conteneur.octets, 0, conteneur.bits);
+    int DC[3] = { 0, 0, 0 };
+    bool fin = false;
+    for (unsigned int my0 = 0; my0 < g.nbMcuY; my0 += nbGroupe) {
+        const unsigned int nbMcu = (g.nbMcuY - my0 < nbGroupe) ? g.nbMcuY - my0 : nbGroupe;
+        {
+            cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+            int16_t *c = coefs;
+            for (size_t b = 0; b < nbMcu * blocsLigne; ++b, c += 64) {
+                const size_t k = b % blocsParMcu;
+                const int composante = (k < blocsParMcu - 2) ? 0 : static_cast<int>(k - (blocsParMcu - 2)) + 1;
+                lecteur.setTable(*tables[composante == 0 ? 0 : 1]);
+                if (fin || !cCompression::RLE_Decoder_Bloc(lecteur, DC[composante], c, masques[b])) {
+                    fin = true;
+                    std::memset(c, 0, 64 * sizeof(int16_t));
+                    masques[b] = 1;
+                } else if (masques[b] <= 1 && cote < 8) {
+                    // Only the DC of a DC-only block is written; the reduced transform reads the low frequencies.
+                    std::memset(c + 1, 0, 63 * sizeof(int16_t));
+                }
+            }
+        }
+        if (lecteur.erreur()) return false;
+
+        auto reconstruire = [&](size_t i) {
+            sStatistiques *s = stats ? &(parTache[i] = sStatistiques()) : nullptr;
+            reconstruire_ligne(my0 + static_cast<unsigned int>(i), coefs + i * blocsLigne * 64, masques + i * blocsLigne,
+                               pixels + i * blocsLigne * 64, dequant ? dequant + i * blocsLigne * 64 : nullptr, s);
+        };
+        if (pool && nbMcu > 1) {
+            pool->paralleliser(nbMcu, reconstruire);
+        } else {
+            for (unsigned int i = 0; i < nbMcu; ++i) reconstruire(i);
+        }
+        if (stats) for (unsigned int i = 0; i < nbMcu; ++i) stats->ajouter(parTache[i]);
+    }
+
+    // Upsample and convert, one band of rows per task; the padding is skipped on the fly.
+    auto convertir_bande = [&](size_t i) {
+        sStatistiques *s = stats ? &(parTache[i] = sStatistiques()) : nullptr;
+        cChronoEtape chrono(s, ETAPE_COULEUR);
+        const unsigned int j0 = static_cast<unsigned int>(hauteur * i / nbBandes);
+        const unsigned int j1 = static_cast<unsigned int>(hauteur * (i + 1) / nbBandes);
+        ycbcr_vers_rgb_lignes(Y, largeurY, Cb, Cr, largeurC, largeur, hauteur,
+                              g.facteurH, g.facteurV, surechantillonnage, j0, j1, rgb, pas);
+    };
+    if (pool && nbBandes > 1) {
+        pool->paralleliser(nbBandes, convertir_bande);
+    } else {
+        convertir_bande(0);
+    }
+    if (stats) {
+        for (unsigned int i = 0; i < ((pool && nbBandes > 1) ? nbBandes : 1); ++i) stats->ajouter(parTache[i]);
+        stats->blocs += static_cast<uint64_t>(g.nbMcuY) * blocsLigne;
+        stats->symboles += lecteur.getNbSymboles();
+        stats->octetsSortie += static_cast<uint64_t>(largeur) * hauteur * 3;
+    }
+    return true;
+}
+
+} // namespace
+
 
 // --- cCompressionCouleur Method Implementations ---
 
-cCompressionCouleur::cCompressionCouleur() : cCompression(), mSubsamplingH(1), mSubsamplingV(1) {}
+cCompressionCouleur::cCompressionCouleur() : cCompression(), mSubsamplingH(1), mSubsamplingV(1), mSurechantillonnage(SURECHANTILLONNAGE_TRIANGLE) {}
 
 cCompressionCouleur::cCompressionCouleur(unsigned int largeur, unsigned int hauteur, unsigned int qualite, unsigned int subsamplingH, unsigned int subsamplingV, unsigned char **buffer)
-    : cCompression(largeur, hauteur, qualite, buffer), mSubsamplingH(subsamplingH), mSubsamplingV(subsamplingV) {}
+    : cCompression(largeur, hauteur, qualite, buffer), mSubsamplingH(subsamplingH), mSubsamplingV(subsamplingV), mSurechantillonnage(SURECHANTILLONNAGE_TRIANGLE) {}
 
 cCompressionCouleur::~cCompressionCouleur() {}
 
@@ -239,74 +793,360 @@ void cCompressionCouleur::setSubsamplingH(unsigned int subsamplingH) { mSubsampl
 void cCompressionCouleur::setSubsamplingV(unsigned int subsamplingV) { mSubsamplingV = subsamplingV; }
 unsigned int cCompressionCouleur::getSubsamplingH() const { return mSubsamplingH; }
 unsigned int cCompressionCouleur::getSubsamplingV() const { return mSubsamplingV; }
+void cCompressionCouleur::setSurechantillonnage(eModeSurechantillonnage mode) { mSurechantillonnage = mode; }
+eModeSurechantillonnage cCompressionCouleur::getSurechantillonnage() const { return mSurechantillonnage; }
 
-bool cCompressionCouleur::CompressPPM(const char *ppmPath, const char *basename, unsigned int qual, unsigned int subsamplingMode)
+bool cCompressionCouleur::CompressPPM(const char *ppmPath, const char *outPath, unsigned int qual, unsigned int subsamplingMode)
 {
-    // 1. Read PPM file
-    unsigned int w=0, h=0;
-    std::vector<unsigned char> rgb;
-    if (!readPPM(ppmPath, w, h, rgb)) return false;
-
-    // 2. Convert RGB to YCbCr color space
-    std::vector<unsigned char> Y(w*h), Cb_full(w*h), Cr_full(w*h);
-    for (unsigned int i = 0; i < h; ++i) {
-        for (unsigned int j = 0; j < w; ++j) {
-            size_t idx = (static_cast<size_t>(i) * w + j) * 3;
-            rgb_to_ycbcr(rgb[idx], rgb[idx+1], rgb[idx+2], Y[i*w+j], Cb_full[i*w+j], Cr_full[i*w+j]);
-        }
+    if (!ppmPath || !outPath) return false;
+    return encoder_ppm(ppmPath, outPath, qual, subsamplingMode, getModePipeline(), true, getPoolActif(), arene(), getStatistiques());
+}
+
+bool cCompressionCouleur::CompressPPMFlux(const char *ppmPath, const char *outPath, unsigned int qual, unsigned int subsamplingMode)
+{
+    if (!ppmPath || !outPath) return false;
+    return encoder_ppm(ppmPath, outPath, qual, subsamplingMode, getModePipeline(), false, getPoolActif(), arene(), getStatistiques());
+}
+
+bool cCompressionCouleur::CompressRGB(const unsigned char *rgb, unsigned int largeur, unsigned int hauteur, size_t pas,
+                                      unsigned int qual, unsigned int subsamplingMode, std::vector<unsigned char> &sortie)
+{
+    sGeometrieMCU g;
+    if (!rgb || pas < static_cast<size_t>(largeur) * 3 || !calculer_geometrie(largeur, hauteur, subsamplingMode, g)) return false;
+    sortie.clear();
+    sSortieMemoire out{ sortie };
+    auto lire = [&](unsigned int y0, unsigned int) { return rgb + static_cast<size_t>(y0) * pas; };
+    return encoder_conteneur(lire, pas, g, out, qual, getModePipeline(), true, getPoolActif(), arene(), getStatistiques());
+}
+
+bool cCompressionCouleur::CompressRGBCible(const unsigned char *rgb, unsigned int largeur, unsigned int hauteur, size_t pas,
+                                           unsigned int subsamplingMode, eCible cible, double valeur,
+                                           std::vector<unsigned char> &sortie, sResultatCible *resultat)
+{
+    sGeometrieMCU g;
+    if (!rgb || pas < static_cast<size_t>(largeur) * 3 || !calculer_geometrie(largeur, hauteur, subsamplingMode, g)) return false;
+    sortie.clear();
+    const eModePipeline pipeline = getModePipeline();
+    const bool entier = (pipeline == PIPELINE_ENTIER);
+    const size_t blocsParMcu = static_cast<size_t>(g.facteurH) * g.facteurV + 2;
+    const size_t blocsParLigne = static_cast<size_t>(g.nbMcuX) * blocsParMcu;
+    const size_t nbBlocs = blocsParLigne * g.nbMcuY;
+    cThreadPool *pool = getPoolActif();
+    cArene &a = arene();
+    sStatistiques *stats = getStatistiques();
+
+    // 1. Conversion, subsampling and DCT of every MCU row, once, straight into the coefficients kept for the search.
+    cPorteeArene portee(a);
+    float *dct = a.allouer<float>(entier ? 0 : nbBlocs * 64);
+    int32_t *dct8 = a.allouer<int32_t>(entier ? nbBlocs * 64 : 0);
+    const unsigned int hauteurBande = 8 * g.facteurV;
+    const unsigned int nbGroupe = pool ? pool->getNbThreads() * 2 : 1;
+    sLigneMCU *lignes = a.allouer<sLigneMCU>(nbGroupe);
+    for (unsigned int i = 0; i < nbGroupe; ++i) preparer_ligne_mcu(g, pipeline, stats != nullptr, a, lignes[i]);
+    for (unsigned int my0 = 0; my0 < g.nbMcuY; my0 += nbGroupe) {
+        const unsigned int nbMcu = (g.nbMcuY - my0 < nbGroupe) ? g.nbMcuY - my0 : nbGroupe;
+        const unsigned int y0 = my0 * hauteurBande;
+        auto transformer_ligne = [&](size_t i) {
+            sLigneMCU &ligne = lignes[i];
+            const size_t premier = (my0 + i) * blocsParLigne * 64;
+            if (entier) ligne.dct8 = dct8 + premier;
+            else ligne.dct = dct + premier;
+            const unsigned int debut = y0 + static_cast<unsigned int>(i) * hauteurBande;
+            const unsigned int nbLignes = (g.hauteur - debut < hauteurBande) ? g.hauteur - debut : hauteurBande;
+            transformer_ligne_mcu(rgb + pas * debut, pas, nbLignes, g, pipeline, ligne);
+        };
+        if (pool && nbMcu > 1) pool->paralleliser(nbMcu, transformer_ligne);
+        else for (unsigned int i = 0; i < nbMcu; ++i) transformer_ligne(i);
+        if (stats) for (unsigned int i = 0; i < nbMcu; ++i) stats->ajouter(*lignes[i].stats);
     }
 
-    // 3. Perform chroma subsampling
-    std::vector<unsigned char> Cb_sub, Cr_sub;
-    unsigned int cw=w, ch=h;
-    if (subsamplingMode == 420) {
-        subsample420(Cb_full, w, h, Cb_sub, cw, ch);
-        subsample420(Cr_full, w, h, Cr_sub, cw, ch);
-    } else if (subsamplingMode == 422) {
-        subsample422(Cb_full, w, h, Cb_sub, cw, ch);
-        subsample422(Cr_full, w, h, Cr_sub, cw, ch);
-    } else { // 444
-        Cb_sub = Cb_full; Cr_sub = Cr_full;
-    }
-
-    // 4. Pad each color plane to be a multiple of 8x8
-    std::vector<unsigned char> Y_pad, Cb_pad, Cr_pad;
-    unsigned int Ypw, Yph, Cbpw, Cbph, Crpw, Crph;
-    padToMultipleOf8(Y, w, h, Y_pad, Ypw, Yph);
-    padToMultipleOf8(Cb_sub, cw, ch, Cb_pad, Cbpw, Cbph);
-    padToMultipleOf8(Cr_sub, cw, ch, Cr_pad, Crpw, Crph);
-
-    // 5. Compress each plane individually
-    cCompression::setQualiteGlobale(qual);
-    auto compress_plane = [&](std::vector<unsigned char>& data, unsigned int pw, unsigned int ph, const char* suffix) {
-        unsigned char **rows = makeRowPointers(data, pw, ph);
-        cCompression comp(pw, ph, qual, rows);
-        std::vector<int> trame(1 + (pw/8)*(ph/8)*128);
-        comp.RLE(trame.data());
-        std::string filename = std::string(basename) + suffix;
-        comp.Compression_JPEG(trame.data(), filename.c_str());
-        delete[] rows;
+    // 2. Each quality tried: quantization, RLE in coding order, then the container size from the symbol counts.
+    int16_t *zigzag = a.allouer<int16_t>(nbBlocs * 64);
+    uint64_t *masques = a.allouer<uint64_t>(nbBlocs);
+    std::vector<unsigned char> &rle = a.tampon(TAMPON_RLE);
+    std::vector<unsigned char> &tailles = a.tampon(TAMPON_TAILLES);
+    rle.resize(nbBlocs * 128);
+    tailles.resize(nbBlocs);
+    uint32_t Comptes[2][256];
+    uint8_t Longueurs[2][256];
+    size_t longueur = 0;
+    auto essayer = [&](unsigned int q, uint64_t &taille, double &psnr) {
+        const cContexteQuant ctxY(q, COMPOSANTE_LUMA);
+        const cContexteQuant ctxC(q, COMPOSANTE_CHROMA);
+        double erreur = 0.0;
+        {
+            cChronoEtape chrono(stats, ETAPE_QUANT);
+            for (size_t b = 0; b < nbBlocs; ++b) {
+                const bool luma = (b % blocsParMcu < blocsParMcu - 2);
+                const cContexteQuant &ctx = luma ? ctxY : ctxC;
+                int16_t *zz = zigzag + b * 64;
+                masques[b] = entier ? ctx.quantifier_zigzag_entier(dct8 + b * 64, zz) : ctx.quantifier_zigzag(dct + b * 64, zz);
+                if (!luma) continue;
+                const int *Q = ctx.getTable();
+                for (int k = 0; k < 64; ++k) {
+                    const int i = ZIGZAG[k];
+                    const double c = entier ? dct8[b * 64 + i] / 8.0 : static_cast<double>(dct[b * 64 + i]);
+                    const double d = c - static_cast<double>(zz[k]) * Q[i];
+                    erreur += d * d;
+                }
+            }
+        }
+        cChronoEtape chrono(stats, ETAPE_RLE);
+        std::memset(Comptes, 0, sizeof(Comptes));
+        int DC[3] = { 0, 0, 0 };
+        size_t p = 0;
+        for (size_t b = 0; b < nbBlocs; ++b) {
+            const size_t k = b % blocsParMcu;
+            const int composante = (k < blocsParMcu - 2) ? 0 : static_cast<int>(k - (blocsParMcu - 2)) + 1;
+            const int16_t *zz = zigzag + b * 64;
+            const int n = cCompression::RLE_Block(zz, masques[b], DC[composante], reinterpret_cast<signed char*>(rle.data() + p));
+            DC[composante] = zz[0];
+            tailles[b] = static_cast<unsigned char>(n);
+            for (int i = 0; i < n; ++i) ++Comptes[composante != 0][rle[p + i]];
+            p += static_cast<size_t>(n);
+        }
+        longueur = p;
+
+        // Header, both tables, payload sizes and the payload.
+        uint64_t bits = 0;
+        taille = sizeof(kMagicConteneur) + 1 + 4 + 4 + 2 + 1 + 1 + 8;
+        for (int classe = 0; classe < 2; ++classe) {
+            cHuffman::CalculerLongueurs(Comptes[classe], Longueurs[classe]);
+            taille += 1 + cHuffman::kLongueurMax;
+            for (int c = 0; c < 256; ++c) {
+                bits += static_cast<uint64_t>(Comptes[classe][c]) * Longueurs[classe][c];
+                taille += (Longueurs[classe][c] != 0);
+            }
+        }
+        taille += (bits + 7) / 8;
+
+        const double nbY = static_cast<double>(g.nbMcuX) * g.nbMcuY * g.facteurH * g.facteurV;
+        const double eqm = erreur / (nbY * 64.0);
+        psnr = (eqm > 0.0) ? 10.0 * std::log10(255.0 * 255.0 / eqm) : std::numeric_limits<double>::infinity();
     };
-    compress_plane(Y_pad, Ypw, Yph, "_Y.huff");
-    compress_plane(Cb_pad, Cbpw, Cbph, "_Cb.huff");
-    compress_plane(Cr_pad, Crpw, Crph, "_Cr.huff");
+    sResultatCible r;
+    chercher_qualite(cible, valeur, essayer, r);
+    if (resultat) *resultat = r;
 
-    // 6. Write metadata file
-    std::string meta_path = std::string(basename) + ".meta";
-    std::ofstream m(meta_path, std::ios::binary);
-    if (m) {
-        uint32_t val;
-        val = w; m.write(reinterpret_cast<const char*>(&val), sizeof(val));
-        val = h; m.write(reinterpret_cast<const char*>(&val), sizeof(val));
-        val = cw; m.write(reinterpret_cast<const char*>(&val), sizeof(val));
-        val = ch; m.write(reinterpret_cast<const char*>(&val), sizeof(val));
-        val = subsamplingMode; m.write(reinterpret_cast<const char*>(&val), sizeof(val));
-        val = qual; m.write(reinterpret_cast<const char*>(&val), sizeof(val));
+    // 3. The chosen encoding, from the RLE bytes of the last quality tried, as the two-pass encoder writes it.
+    cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+    sSortieMemoire out{ sortie };
+    uint32_t Codes[2][256];
+    for (int classe = 0; classe < 2; ++classe) cHuffman::CodesCanoniques(Longueurs[classe], Codes[classe]);
+    const size_t posTaille = ecrire_entete_conteneur(out, g, r.qualite, Longueurs[0], Longueurs[1]);
+    std::vector<unsigned char> &octets = a.tampon(TAMPON_BITS);
+    octets.clear();
+    cEcrivainBits ecrivain(octets);
+    coder_blocs_huffman(ecrivain, reinterpret_cast<const signed char*>(rle.data()), tailles.data(), nbBlocs, blocsParMcu,
+                        Longueurs, Codes);
+    ecrivain.aligner();
+    out.ecrire(octets.data(), octets.size());
+    const uint32_t tailles_payload[2] = { static_cast<uint32_t>(octets.size()), static_cast<uint32_t>(ecrivain.getNbBits()) };
+    out.reecrire(posTaille, tailles_payload, sizeof(tailles_payload));
+    if (stats) {
+        stats->octetsEntree += static_cast<uint64_t>(g.largeur) * g.hauteur * 3;
+        stats->octetsSortie += sortie.size();
+        stats->blocs += nbBlocs;
+        stats->symboles += longueur;
+    }
+    return true;
+}
+
+bool cCompressionCouleur::DecompressToPPM(const char *inPath, const char *outppm)
+{
+    if (!inPath || !outppm) return false;
+    cFichierMappe fichier;
+    if (fichier.ouvrir(inPath) && est_conteneur(fichier.getDonnees(), fichier.getTaille())) {
+        sConteneur conteneur;
+        if (!lire_conteneur(fichier.getDonnees(), fichier.getTaille(), conteneur)) return false;
+        // The pixels are decoded straight into the output file.
+        const sGeometrieMCU &g = conteneur.g;
+        cEcrivainImage sortie;
+        if (!sortie.ouvrir(outppm, TailleReduite(g.largeur, getEchelle()), TailleReduite(g.hauteur, getEchelle()), 3)) return false;
+        sStatistiques *stats = getStatistiques();
+        if (!decoder_conteneur(conteneur, sortie.getPixels(), sortie.getPas(), getModePipeline(), 8 / getEchelle(),
+                               mSurechantillonnage, getPoolActif(), arene(), stats)) {
+            sortie.abandonner();
+            return false;
+        }
+        if (stats) stats->octetsEntree += fichier.getTaille();
+        return sortie.fermer();
+    }
+    return DecompressMultiFichiers(inPath, outppm);
+}
+
+bool cCompressionCouleur::DecompressToRGB(const uint8_t *Donnees, size_t Taille, unsigned char *rgb, size_t pas,
+                                          unsigned int largeurMax, unsigned int hauteurMax)
+{
+    sConteneur conteneur;
+    if (!rgb || !lire_conteneur(Donnees, Taille, conteneur)) return false;
+    const sGeometrieMCU &g = conteneur.g;
+    const unsigned int largeur = TailleReduite(g.largeur, getEchelle());
+    const unsigned int hauteur = TailleReduite(g.hauteur, getEchelle());
+    if (largeur > largeurMax || hauteur > hauteurMax || pas < static_cast<size_t>(largeur) * 3) return false;
+    sStatistiques *stats = getStatistiques();
+    if (!decoder_conteneur(conteneur, rgb, pas, getModePipeline(), 8 / getEchelle(), mSurechantillonnage, getPoolActif(),
+                           arene(), stats)) return false;
+    if (stats) stats->octetsEntree += Taille;
+    setLargeur(g.largeur);
+    setHauteur(g.hauteur);
+    return true;
+}
+
+bool cCompressionCouleur::LireDimensions(const uint8_t *Donnees, size_t Taille, unsigned int &largeur, unsigned int &hauteur)
+{
+    if (!est_conteneur(Donnees, Taille)) return cCompression::LireDimensions(Donnees, Taille, largeur, hauteur);
+    sConteneur conteneur;
+    if (!lire_conteneur(Donnees, Taille, conteneur)) return false;
+    largeur = conteneur.g.largeur;
+    hauteur = conteneur.g.hauteur;
+    return true;
+}
+
+bool cCompressionCouleur::TransformConteneur(const uint8_t *Donnees, size_t Taille, eTransformation t,
+                                             std::vector<unsigned char> &Fichier, const sRecadrage *recadrage)
+{
+    if (!est_conteneur(Donnees, Taille)) return Transformation_JPEG(Donnees, Taille, t, Fichier, recadrage);
+    Fichier.clear();
+    sConteneur conteneur;
+    if (!lire_conteneur(Donnees, Taille, conteneur)) return false;
+    const sGeometrieMCU &g = conteneur.g;
+    bool transposee, miroirX, miroirY;
+    decomposer_transformation(t, transposee, miroirX, miroirY);
+    // A 4:2:2 MCU is twice as wide as it is high: it cannot be turned on its side.
+    if (transposee && g.facteurH != g.facteurV) return false;
+
+    // 1. The crop, on MCU boundaries; its right and bottom edges may be those of the image.
+    const unsigned int largeurMcu = 8 * g.facteurH, hauteurMcu = 8 * g.facteurV;
+    sRecadrage r;
+    if (recadrage) r = *recadrage;
+    if (r.x % largeurMcu != 0 || r.y % hauteurMcu != 0 || r.x >= g.largeur || r.y >= g.hauteur) return false;
+    if (r.largeur == 0) r.largeur = g.largeur - r.x;
+    if (r.hauteur == 0) r.hauteur = g.hauteur - r.y;
+    if (r.largeur > g.largeur - r.x || r.hauteur > g.hauteur - r.y
+        || (r.largeur % largeurMcu != 0 && r.x + r.largeur != g.largeur)
+        || (r.hauteur % hauteurMcu != 0 && r.y + r.hauteur != g.hauteur)) return false;
+    const unsigned int mx0 = r.x / largeurMcu, my0 = r.y / hauteurMcu;
+    const unsigned int nbMcuX = (r.largeur + largeurMcu - 1) / largeurMcu;
+    const unsigned int nbMcuY = (r.hauteur + hauteurMcu - 1) / hauteurMcu;
+
+    // 2. The size of the result. A mirror brings the padding of the last
+    // MCUs to the left (or the top), where it is part of the image: that
+    // axis keeps its padded size.
+    const unsigned int largeurT = transposee ? r.hauteur : r.largeur, hauteurT = transposee ? r.largeur : r.hauteur;
+    const unsigned int largeurPad = (transposee ? nbMcuY * hauteurMcu : nbMcuX * largeurMcu);
+    const unsigned int hauteurPad = (transposee ? nbMcuX * largeurMcu : nbMcuY * hauteurMcu);
+    sGeometrieMCU gs;
+    if (!calculer_geometrie(miroirX ? largeurPad : largeurT, miroirY ? hauteurPad : hauteurT, g.mode, gs)) return false;
+
+    // 3. The quantized blocks of the cropped MCUs, in coding order. The
+    // stream is read up to the last MCU row of the crop; a block that does
+    // not decode fails the call.
+    sStatistiques *stats = getStatistiques();
+    cHuffman *tables[2] = { &arene().huffman(0), &arene().huffman(1) };
+    {
+        cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+        for (int classe = 0; classe < 2; ++classe) {
+            if (!tables[classe]->ConstruireDepuisLongueurs(conteneur.Longueurs[classe])) return false;
+        }
+    }
+    cPorteeArene portee(arene());
+    const size_t nbY = static_cast<size_t>(g.facteurH) * g.facteurV;
+    const size_t blocsParMcu = nbY + 2;
+    const size_t nbBlocs = static_cast<size_t>(nbMcuX) * nbMcuY * blocsParMcu;
+    int16_t *coefs = arene().allouer<int16_t>(nbBlocs * 64);
+    {
+        cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+        cLecteurHuffman lecteur(*tables[0], conteneur.payload, conteneur.octets, 0, conteneur.bits);
+        int16_t ignore[64];
+        int DC[3] = { 0, 0, 0 };
+        for (unsigned int my = 0; my < my0 + nbMcuY; ++my) {
+            for (unsigned int mx = 0; mx < g.nbMcuX; ++mx) {
+                const bool dedans = my >= my0 && mx >= mx0 && mx < mx0 + nbMcuX;
+                int16_t *mcu = dedans ? coefs + ((my - my0) * static_cast<size_t>(nbMcuX) + (mx - mx0)) * blocsParMcu * 64 : nullptr;
+                for (size_t k = 0; k < blocsParMcu; ++k) {
+                    const int composante = (k < nbY) ? 0 : static_cast<int>(k - nbY) + 1;
+                    lecteur.setTable(*tables[composante == 0 ? 0 : 1]);
+                    if (!RLE_Decoder_Bloc(lecteur, DC[composante], dedans ? mcu + k * 64 : ignore)) return false;
+                }
+            }
+        }
+        if (lecteur.erreur()) return false;
+    }
+
+    // 4. The MCUs of the transformed grid, RLE coded again. Each plane is
+    // moved on its own block grid; the DC differences of the new order,
+    // or an AC value of -128 once negated, may not fit the 8-bit format.
+    const unsigned int blocsYX = nbMcuX * g.facteurH, blocsYY = nbMcuY * g.facteurV;
+    signed char *rle = arene().allouer<signed char>(nbBlocs * 130);
+    unsigned char *tailles = arene().allouer<unsigned char>(nbBlocs);
+    uint32_t Comptes[2][256] = {{0}};
+    size_t longueur = 0;
+    {
+        cChronoEtape chrono(stats, ETAPE_RLE);
+        int16_t zz[64];
+        int DC[3] = { 0, 0, 0 };
+        size_t b = 0;
+        for (unsigned int my = 0; my < gs.nbMcuY; ++my) {
+            for (unsigned int mx = 0; mx < gs.nbMcuX; ++mx) {
+                for (size_t k = 0; k < blocsParMcu; ++k, ++b) {
+                    unsigned int sx = 0, sy = 0;
+                    size_t source = 0;
+                    int composante = 0;
+                    if (k < nbY) {
+                        bloc_source(t, blocsYX, blocsYY, mx * g.facteurH + static_cast<unsigned int>(k % g.facteurH),
+                                    my * g.facteurV + static_cast<unsigned int>(k / g.facteurH), sx, sy);
+                        source = ((sy / g.facteurV) * static_cast<size_t>(nbMcuX) + sx / g.facteurH) * blocsParMcu
+                                 + (sy % g.facteurV) * g.facteurH + sx % g.facteurH;
+                    } else {
+                        composante = static_cast<int>(k - nbY) + 1;
+                        bloc_source(t, nbMcuX, nbMcuY, mx, my, sx, sy);
+                        source = (sy * static_cast<size_t>(nbMcuX) + sx) * blocsParMcu + k;
+                    }
+                    TransformerBloc(coefs + source * 64, t, zz);
+                    bool code = zz[0] - DC[composante] >= -128 && zz[0] - DC[composante] <= 127;
+                    for (int i = 1; i < 64 && code; ++i) code = zz[i] <= 127;
+                    if (!code) return false;
+                    const int n = RLE_Block(zz, MasqueNonNuls(zz), DC[composante], rle + longueur);
+                    DC[composante] = zz[0];
+                    const int classe = (composante == 0) ? 0 : 1;
+                    for (int i = 0; i < n; ++i) ++Comptes[classe][static_cast<unsigned char>(rle[longueur + i])];
+                    tailles[b] = static_cast<unsigned char>(n);
+                    longueur += static_cast<size_t>(n);
+                }
+            }
+        }
+    }
+
+    // 5. Optimal tables and the bits, as the two-pass encoder writes them.
+    cChronoEtape chrono(stats, ETAPE_HUFFMAN);
+    uint8_t Longueurs[2][256];
+    uint32_t Codes[2][256];
+    for (int classe = 0; classe < 2; ++classe) {
+        cHuffman::CalculerLongueurs(Comptes[classe], Longueurs[classe]);
+        cHuffman::CodesCanoniques(Longueurs[classe], Codes[classe]);
+    }
+    sSortieMemoire out{ Fichier };
+    const size_t posTaille = ecrire_entete_conteneur(out, gs, conteneur.qualite, Longueurs[0], Longueurs[1],
+                                                     conteneur.transposee != transposee);
+    std::vector<unsigned char> &octets = arene().tampon(TAMPON_BITS);
+    octets.clear();
+    cEcrivainBits ecrivain(octets);
+    coder_blocs_huffman(ecrivain, rle, tailles, nbBlocs, blocsParMcu, Longueurs, Codes);
+    ecrivain.aligner();
+    out.ecrire(octets.data(), octets.size());
+    const uint32_t tailles_payload[2] = { static_cast<uint32_t>(octets.size()), static_cast<uint32_t>(ecrivain.getNbBits()) };
+    out.reecrire(posTaille, tailles_payload, sizeof(tailles_payload));
+    if (stats) {
+        stats->octetsEntree += Taille;
+        stats->octetsSortie += Fichier.size();
+        stats->blocs += nbBlocs;
+        stats->symboles += longueur;
     }
     return true;
 }
 
-bool cCompressionCouleur::DecompressToPPM(const char *basename, const char *outppm)
+bool cCompressionCouleur::DecompressMultiFichiers(const char *basename, const char *outppm)
 {
     // 1. Read metadata
     std::string meta_path = std::string(basename) + ".meta";
@@ -318,61 +1158,55 @@ bool cCompressionCouleur::DecompressToPPM(const char *basename, const char *outp
     m.read(reinterpret_cast<char*>(&sm), sizeof(sm)); m.read(reinterpret_cast<char*>(&q), sizeof(q));
     m.close();
 
-    cCompression::setQualiteGlobale(q);
+    // Files of this layout carry no quality of their own: decode with the one from the metadata.
+    auto codec = std::make_shared<cContexteCodec>(q);
 
-    // 2. Decompress each color plane
-    auto decompress_plane = [&](const char* suffix, unsigned int& pw, unsigned int& ph) -> std::vector<unsigned char> {
+    // 2. Decompress each color plane; the decoded rows are one contiguous buffer, used in place.
+    struct sPlan {
+        std::unique_ptr<unsigned char[]> donnees;
+        unsigned int largeur = 0, hauteur = 0;
+    };
+    auto decompress_plane = [&](const char* suffix, sPlan &plan) {
         std::string filename = std::string(basename) + suffix;
         cCompression comp;
+        comp.setContexte(codec);
         unsigned char** rows = comp.Decompression_JPEG(filename.c_str());
-        if (!rows) return {};
-        pw = comp.getLargeur();
-        ph = comp.getHauteur();
-        std::vector<unsigned char> data(pw * ph);
-        for(unsigned int y=0; y<ph; ++y) std::memcpy(data.data() + y*pw, rows[y], pw);
-        delete[] rows[0]; // Free buffer
+        if (!rows) return;
+        plan.donnees.reset(rows[0]);
+        plan.largeur = comp.getLargeur();
+        plan.hauteur = comp.getHauteur();
         delete[] rows;    // Free row pointers
-        return data;
     };
-    unsigned int Ypw, Yph, Cbpw, Cbph, Crpw, Crph;
-    std::vector<unsigned char> Y_pad = decompress_plane("_Y.huff", Ypw, Yph);
-    std::vector<unsigned char> Cb_pad = decompress_plane("_Cb.huff", Cbpw, Cbph);
-    std::vector<unsigned char> Cr_pad = decompress_plane("_Cr.huff", Crpw, Crph);
-    if (Y_pad.empty()) return false;
-    // If chroma planes are empty (very small files), fallback to neutral chroma (128)
-    if (Cb_pad.empty()) {
-        std::cerr << "[DecompressToPPM] Cb plane empty, using neutral 128 values\n";
-        Cbpw = cw; Cbph = ch;
-        Cb_pad.assign(static_cast<size_t>(Cbpw) * Cbph, 128);
-    }
-    if (Cr_pad.empty()) {
-        std::cerr << "[DecompressToPPM] Cr plane empty, using neutral 128 values\n";
-        Crpw = cw; Crph = ch;
-        Cr_pad.assign(static_cast<size_t>(Crpw) * Crph, 128);
-    }
-
-    // 3. Upsample chroma planes if they were subsampled
-    std::vector<unsigned char> Cb_full, Cr_full;
-    if (cw != w || ch != h) {
-        upsample_bilinear(Cb_pad, Cbpw, Cbph, Cb_full, w, h);
-        upsample_bilinear(Cr_pad, Crpw, Crph, Cr_full, w, h);
+    // The three files are independent: decode them concurrently on the pool.
+    const char *suffixes[3] = { "_Y.huff", "_Cb.huff", "_Cr.huff" };
+    sPlan plans[3];
+    auto decompress_index = [&](size_t i) { decompress_plane(suffixes[i], plans[i]); };
+    if (cThreadPool *pool = getPoolActif()) {
+        pool->paralleliser(3, decompress_index);
     } else {
-        Cb_full = Cb_pad;
-        Cr_full = Cr_pad;
-    }
-
-    // 4. Convert YCbCr back to RGB, cropping any padding
-    std::vector<unsigned char> rgb(static_cast<size_t>(w) * h * 3);
-    for (unsigned int y=0; y<h; ++y) {
-        for (unsigned int x=0; x<w; ++x) {
-            unsigned char Yv = Y_pad[y*Ypw + x];
-            unsigned char Cbv = Cb_full[y*w + x];
-            unsigned char Crv = Cr_full[y*w + x];
-            size_t idx = (static_cast<size_t>(y) * w + x) * 3;
-            ycbcr_to_rgb(Yv, Cbv, Crv, rgb[idx], rgb[idx+1], rgb[idx+2]);
-        }
+        for (size_t i = 0; i < 3; ++i) decompress_index(i);
+    }
+    if (!plans[0].donnees || plans[0].largeur < w || plans[0].hauteur < h) return false;
+    if (cw == 0 || ch == 0 || cw > w || ch > h) return false;
+    const unsigned int facteurH = (cw < w) ? 2 : 1, facteurV = (ch < h) ? 2 : 1;
+    if ((w + facteurH - 1) / facteurH != cw || (h + facteurV - 1) / facteurV != ch) return false;
+    // If a chroma plane is missing or too small (very small files), fall back to neutral chroma (128).
+    for (int p = 1; p < 3; ++p) {
+        if (plans[p].donnees && plans[p].largeur >= cw && plans[p].hauteur >= ch) continue;
+        tracer_codec(getTrace(), "[DecompressToPPM] %s plane empty, using neutral 128 values", (p == 1) ? "Cb" : "Cr");
+        plans[p].donnees.reset(new unsigned char[static_cast<size_t>(cw) * ch]);
+        std::memset(plans[p].donnees.get(), 128, static_cast<size_t>(cw) * ch);
+        plans[p].largeur = cw;
+        plans[p].hauteur = ch;
     }
+    // Both chroma planes must share a stride for the back end.
+    if (plans[1].largeur != plans[2].largeur) return false;
 
-    // 5. Write the final PPM file
-    return writePPM(outppm, w, h, rgb);
+    // 3. Upsample the chroma and convert back to RGB, cropping any padding, straight into the PPM file
+    cEcrivainImage sortie;
+    if (!sortie.ouvrir(outppm, w, h, 3)) return false;
+    ycbcr_vers_rgb_lignes(plans[0].donnees.get(), plans[0].largeur, plans[1].donnees.get(), plans[2].donnees.get(),
+                          plans[1].largeur, w, h, facteurH, facteurV, mSurechantillonnage, 0, h,
+                          sortie.getPixels(), sortie.getPas());
+    return sortie.fermer();
 }
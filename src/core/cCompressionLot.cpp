@@ -0,0 +1,288 @@
+/**
+ * @file cCompressionLot.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements cCompressionLot.
+ */
+
+#include "core/cCompressionLot.h"
+#include "core/cCompression.h"
+#include "core/cCompressionCouleur.h"
+#include "core/cContexteCodec.h"
+#include "core/cFichierMappe.h"
+#include "core/cImage.h"
+#include "core/cThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+/**
+ * @brief Reads the dimensions in the header of a PGM or PPM file, without touching its pixels.
+ * @return True if the file has a valid header.
+ */
+bool lire_dimensions_pnm(const std::string &chemin, unsigned int &w, unsigned int &h)
+{
+    cFichierMappe fichier;
+    sEntetePNM entete;
+    if (!fichier.ouvrir(chemin.c_str()) || !cLecteurImage::LireEntetePNM(fichier.getDonnees(), fichier.getTaille(), entete)) return false;
+    w = entete.largeur;
+    h = entete.hauteur;
+    return true;
+}
+
+/** @brief Returns the size of a file in bytes, 0 if it cannot be opened. */
+uint64_t taille_fichier(const std::string &chemin)
+{
+    std::ifstream f(chemin, std::ios::binary | std::ios::ate);
+    return f ? static_cast<uint64_t>(f.tellg()) : 0;
+}
+
+/** @brief Brings the quality of a job into 1..100, as both encoders expect it. */
+unsigned int borner_qualite(unsigned int qualite)
+{
+    return (qualite < 1) ? 1 : (qualite > 100) ? 100 : qualite;
+}
+
+/** @brief Writes a compressed file; false if it cannot be created or written. */
+bool ecrire_fichier(const std::string &chemin, const std::vector<unsigned char> &octets)
+{
+    std::ofstream out(chemin, std::ios::binary);
+    return out && out.write(reinterpret_cast<const char*>(octets.data()), static_cast<std::streamsize>(octets.size()));
+}
+
+/**
+ * @struct sPosteTravail
+ * @brief The codec instances and buffers of one worker, reused from job to job.
+ */
+struct sPosteTravail {
+    std::shared_ptr<cContexteCodec> contexte = std::make_shared<cContexteCodec>();
+    cCompression gris;
+    cCompressionCouleur couleur;
+    std::vector<unsigned char> pixels;
+    std::vector<unsigned char*> lignes;
+    std::vector<signed char> trame;
+    std::vector<unsigned char> fichier;
+
+    sPosteTravail() { gris.setContexte(contexte); }
+};
+
+/**
+ * @brief Compresses a grayscale image into a HUF2 file.
+ *
+ * When the size is a multiple of 8, the rows are encoded in place from the
+ * view. Otherwise they are copied and padded by replicating the last column
+ * and row, as cEncodeurFlux does; the trailer keeps the size of the image.
+ */
+bool compresser_gris(const sVueImage &vue, const sTacheLot &tache, sPosteTravail &poste, std::string &erreur)
+{
+    const unsigned int w = vue.largeur, h = vue.hauteur;
+    const unsigned int lb = (w + 7) / 8 * 8, hb = (h + 7) / 8 * 8;
+    poste.lignes.resize(hb);
+    if (lb == w && hb == h) {
+        // RLE() only reads the rows.
+        for (unsigned int y = 0; y < h; ++y) poste.lignes[y] = const_cast<unsigned char*>(vue.ligne(y));
+    } else {
+        poste.pixels.resize(static_cast<size_t>(lb) * hb);
+        for (unsigned int y = 0; y < hb; ++y) {
+            unsigned char *ligne = poste.pixels.data() + static_cast<size_t>(y) * lb;
+            poste.lignes[y] = ligne;
+            if (y >= h) {
+                std::copy(ligne - lb, ligne, ligne);
+                continue;
+            }
+            std::copy(vue.ligne(y), vue.ligne(y) + w, ligne);
+            std::fill(ligne + w, ligne + lb, ligne[w - 1]);
+        }
+    }
+
+    poste.contexte->setQualite(borner_qualite(tache.qualite));
+    poste.gris.setLargeur(lb);
+    poste.gris.setHauteur(hb);
+    poste.gris.setBuffer(poste.lignes.data());
+    poste.gris.RLE(poste.trame);
+    poste.gris.setBuffer(nullptr);
+
+    // The blocks cover the padded image; the decoder crops it back to the size in the trailer.
+    poste.gris.setLargeur(w);
+    poste.gris.setHauteur(h);
+    poste.gris.Compression_JPEG(poste.trame, poste.fichier);
+    if (!ecrire_fichier(tache.sortie, poste.fichier)) {
+        erreur = "cannot write output";
+        return false;
+    }
+    return true;
+}
+
+/** @brief Runs one job on the given worker, with the given pool (nullptr = single-threaded). */
+void executer_tache(const sTacheLot &tache, sPosteTravail &poste, cThreadPool *pool, sResultatLot &r)
+{
+    const auto debut = std::chrono::steady_clock::now();
+    r.paralleleBlocs = (pool != nullptr);
+    std::shared_ptr<cThreadPool> partage(pool, [](cThreadPool*) {}); // borrowed for the duration of the job
+    if (pool) {
+        poste.gris.setPool(partage);
+        poste.couleur.setPool(partage);
+    }
+
+    // The pixels are read in place from the mapped file and handed to the encoders as they are.
+    cLecteurImage image;
+    const sVueImage &vue = image.getVue();
+    if (!image.ouvrir(tache.entree.c_str())) {
+        r.erreur = image.getErreur();
+    } else if (image.getFormat() != IMAGE_PPM) {
+        r.reussi = compresser_gris(vue, tache, poste, r.erreur);
+    } else if (!poste.couleur.CompressRGB(vue.pixels, vue.largeur, vue.hauteur, vue.pas, borner_qualite(tache.qualite),
+                                          tache.sousEchantillonnage, poste.fichier)) {
+        r.erreur = "color compression failed";
+    } else {
+        r.reussi = ecrire_fichier(tache.sortie, poste.fichier);
+        if (!r.reussi) r.erreur = "cannot write output";
+    }
+    r.largeur = vue.largeur;
+    r.hauteur = vue.hauteur;
+    r.octetsEntree = taille_fichier(tache.entree);
+    r.octetsSortie = r.reussi ? taille_fichier(tache.sortie) : 0;
+
+    if (pool) {
+        poste.gris.setNbThreads(1);
+        poste.couleur.setNbThreads(1);
+    }
+    r.secondes = std::chrono::duration<double>(std::chrono::steady_clock::now() - debut).count();
+}
+
+} // namespace
+
+double sBilanLot::imagesParSeconde() const
+{
+    return (secondes > 0.0) ? static_cast<double>(nbReussis) / secondes : 0.0;
+}
+
+double sBilanLot::megapixelsParSeconde() const
+{
+    return (secondes > 0.0) ? static_cast<double>(pixels) / 1e6 / secondes : 0.0;
+}
+
+cCompressionLot::cCompressionLot(unsigned int nbThreads)
+    : mNbThreads(nbThreads), mSeuilPixels(kSeuilPixelsDefaut)
+{
+}
+
+cCompressionLot::~cCompressionLot() {}
+
+void cCompressionLot::setNbThreads(unsigned int nbThreads)
+{
+    this->mNbThreads = nbThreads;
+    if (this->mPool && this->mPool->getNbThreads() != ((nbThreads == 0) ? cThreadPool::nbThreadsMateriel() : nbThreads)) {
+        this->mPool.reset();
+    }
+}
+
+void cCompressionLot::setPool(const std::shared_ptr<cThreadPool> &pool)
+{
+    this->mPool = pool;
+    if (pool) this->mNbThreads = pool->getNbThreads();
+}
+
+void cCompressionLot::setSeuilPixels(uint64_t pixels)
+{
+    this->mSeuilPixels = pixels;
+}
+
+uint64_t cCompressionLot::getSeuilPixels() const
+{
+    return this->mSeuilPixels;
+}
+
+bool cCompressionLot::Executer(const std::vector<sTacheLot> &taches, std::vector<sResultatLot> &resultats, sBilanLot &bilan)
+{
+    const auto debut = std::chrono::steady_clock::now();
+    resultats.assign(taches.size(), sResultatLot());
+    bilan = sBilanLot();
+
+    const unsigned int nbThreads = (mNbThreads == 0) ? cThreadPool::nbThreadsMateriel() : mNbThreads;
+    if (nbThreads > 1 && !mPool) mPool = std::make_shared<cThreadPool>(nbThreads);
+    cThreadPool *pool = (nbThreads > 1) ? mPool.get() : nullptr;
+
+    // Sort the jobs by the size announced in their header.
+    std::vector<size_t> petites, grandes;
+    for (size_t i = 0; i < taches.size(); ++i) {
+        unsigned int w = 0, h = 0;
+        const bool grande = pool && lire_dimensions_pnm(taches[i].entree, w, h) &&
+                            static_cast<uint64_t>(w) * h >= mSeuilPixels;
+        (grande ? grandes : petites).push_back(i);
+    }
+
+    // Large images one after the other, each over the whole pool.
+    std::vector<sPosteTravail> postes(pool ? nbThreads : 1);
+    for (size_t i : grandes) executer_tache(taches[i], postes[0], pool, resultats[i]);
+
+    // Small images as independent jobs: each worker pulls the next one.
+    std::atomic<size_t> suivante(0);
+    auto travailler = [&](size_t p) {
+        for (size_t k = suivante++; k < petites.size(); k = suivante++) {
+            executer_tache(taches[petites[k]], postes[p], nullptr, resultats[petites[k]]);
+        }
+    };
+    if (pool && petites.size() > 1) {
+        pool->paralleliser(postes.size(), travailler);
+    } else {
+        travailler(0);
+    }
+
+    for (const sResultatLot &r : resultats) {
+        if (!r.reussi) {
+            ++bilan.nbEchecs;
+            continue;
+        }
+        ++bilan.nbReussis;
+        bilan.pixels += static_cast<uint64_t>(r.largeur) * r.hauteur;
+        bilan.octetsEntree += r.octetsEntree;
+        bilan.octetsSortie += r.octetsSortie;
+    }
+    bilan.secondes = std::chrono::duration<double>(std::chrono::steady_clock::now() - debut).count();
+    return bilan.nbEchecs == 0;
+}
+
+bool cCompressionLot::LireManifeste(const char *chemin, std::vector<sTacheLot> &taches, unsigned int &ligneErreur)
+{
+    taches.clear();
+    ligneErreur = 0;
+    if (!chemin) return false;
+    std::ifstream in(chemin);
+    if (!in) return false;
+
+    std::string ligne;
+    for (unsigned int numero = 1; std::getline(in, ligne); ++numero) {
+        std::istringstream iss(ligne);
+        sTacheLot tache;
+        if (!(iss >> tache.entree) || tache.entree[0] == '#') continue;
+        if (!(iss >> tache.sortie)) {
+            ligneErreur = numero;
+            return false;
+        }
+        if (iss >> std::ws && !iss.eof()) {
+            if (!(iss >> tache.qualite) || tache.qualite < 1 || tache.qualite > 100) {
+                ligneErreur = numero;
+                return false;
+            }
+        }
+        if (iss >> std::ws && !iss.eof()) {
+            if (!(iss >> tache.sousEchantillonnage) ||
+                (tache.sousEchantillonnage != 444 && tache.sousEchantillonnage != 422 && tache.sousEchantillonnage != 420)) {
+                ligneErreur = numero;
+                return false;
+            }
+        }
+        if (iss >> std::ws && !iss.eof()) {
+            ligneErreur = numero;
+            return false;
+        }
+        taches.push_back(tache);
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file cContexteCodec.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements cContexteCodec.
+ */
+
+#include "core/cContexteCodec.h"
+
+#include <cstring>
+
+cContexteCodec::cContexteCodec(unsigned int qualite)
+    : mQuant(qualite, COMPOSANTE_LUMA)
+{
+    this->mHuffNb = 0;
+}
+
+void cContexteCodec::setQualite(unsigned int qualite)
+{
+    this->mQuant.setQualite(qualite);
+}
+
+unsigned int cContexteCodec::getQualite() const
+{
+    return this->mQuant.getQualite();
+}
+
+const cContexteQuant &cContexteCodec::getQuant() const
+{
+    return this->mQuant;
+}
+
+void cContexteCodec::storeHuffmanTable(const char *symbols, const double *frequencies, unsigned int count)
+{
+    if (!symbols || !frequencies || count == 0) {
+        this->mHuffNb = 0;
+        return;
+    }
+    this->mHuffNb = (count > 256) ? 256 : count;
+    std::memcpy(this->mHuffSymboles, symbols, this->mHuffNb);
+    std::memcpy(this->mHuffFrequences, frequencies, this->mHuffNb * sizeof(double));
+}
+
+bool cContexteCodec::loadHuffmanTable(char *symbols, double *frequencies, unsigned int &count) const
+{
+    if (!symbols || !frequencies || this->mHuffNb == 0) {
+        count = 0;
+        return false;
+    }
+    std::memcpy(symbols, this->mHuffSymboles, this->mHuffNb);
+    std::memcpy(frequencies, this->mHuffFrequences, this->mHuffNb * sizeof(double));
+    count = this->mHuffNb;
+    return true;
+}
+
+bool cContexteCodec::hasStoredHuffmanTable() const
+{
+    return this->mHuffNb != 0;
+}
+
+cContexteCodec &cContexteCodec::global()
+{
+    static cContexteCodec contexte;
+    return contexte;
+}
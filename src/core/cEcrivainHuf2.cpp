@@ -0,0 +1,227 @@
+/**
+ * @file cEcrivainHuf2.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements the incremental HUF2 file writer.
+ */
+
+#include "core/cEcrivainHuf2.h"
+
+#include "core/cArene.h"
+#include "core/cFormatHuf2.h"
+#include "core/cTablesHuffman.h"
+
+#include <cstring>
+
+namespace {
+
+/** @brief Appends n raw bytes to a file. */
+void ajouter_octets(std::vector<unsigned char> &Fichier, const void *v, size_t n)
+{
+    const unsigned char *o = static_cast<const unsigned char*>(v);
+    Fichier.insert(Fichier.end(), o, o + n);
+}
+
+} // namespace
+
+cEcrivainHuf2::cEcrivainHuf2(std::vector<unsigned char> &Fichier, cArene &arene, size_t maxBlocs,
+                             unsigned int intervalleRestart, unsigned int intervalleIndex)
+    : mFichier(Fichier),
+      mEcrivain(Fichier),
+      mPosTaille(0),
+      mDebutPayload(0),
+      mOctetsVides(0),
+      mFlux(nullptr),
+      mDebutFlux(0),
+      mIntervalleRestart(intervalleRestart),
+      mIntervalleIndex(intervalleIndex),
+      mNbSeg(0),
+      mNbIndex(0),
+      mMaxBlocs(maxBlocs),
+      mBitsDebut(0),
+      mBloc(0),
+      mDC(0),
+      mNbSymboles(0)
+{
+    std::memset(mLongueurs, 0, sizeof(mLongueurs));
+    std::memset(mCodes, 0, sizeof(mCodes));
+    const size_t maxSeg = (intervalleRestart == 0) ? 0 : maxBlocs / intervalleRestart + 1;
+    mSegOffsets = arene.allouer<uint32_t>(maxSeg);
+    mSegBits = arene.allouer<uint32_t>(maxSeg);
+    const size_t maxIndex = (intervalleIndex == 0) ? 0 : maxBlocs / intervalleIndex + 1;
+    mIndexBits = arene.allouer<uint32_t>(maxIndex);
+    mIndexDC = arene.allouer<int32_t>(maxIndex);
+}
+
+void cEcrivainHuf2::commencer(const uint8_t Longueurs[256])
+{
+    mFichier.assign(kMagiqueHuf2, kMagiqueHuf2 + sizeof(kMagiqueHuf2));
+    std::memcpy(mLongueurs, Longueurs, sizeof(mLongueurs));
+    cHuffman::CodesCanoniques(mLongueurs, mCodes);
+
+    // The table is stored as code lengths (number of codes of each length
+    // 1..16, then the symbols in canonical order), as in a JPEG DHT segment.
+    mFichier.push_back(kTableIntegree); // Table mode
+    unsigned char nbParLongueur[cHuffman::kLongueurMax] = {0};
+    for (int c = 0; c < 256; ++c) {
+        if (mLongueurs[c] != 0) ++nbParLongueur[mLongueurs[c] - 1];
+    }
+    ajouter_octets(mFichier, nbParLongueur, sizeof(nbParLongueur));
+    for (int l = 1; l <= cHuffman::kLongueurMax; ++l) {
+        for (int c = 0; c < 256; ++c) {
+            if (mLongueurs[c] == l) mFichier.push_back(static_cast<unsigned char>(c));
+        }
+    }
+    ouvrirPayload();
+}
+
+void cEcrivainHuf2::commencer(const sTableHuffman &table)
+{
+    mFichier.assign(kMagiqueHuf2, kMagiqueHuf2 + sizeof(kMagiqueHuf2));
+    std::memcpy(mLongueurs, table.Longueurs, sizeof(mLongueurs));
+    std::memcpy(mCodes, table.Codes, sizeof(mCodes));
+
+    // A static table: the header only references it.
+    mFichier.push_back(kTableStatique); // Table mode
+    ajouter_octets(mFichier, &table.id, sizeof(table.id));
+    ajouter_octets(mFichier, &table.version, sizeof(table.version));
+    ouvrirPayload();
+}
+
+void cEcrivainHuf2::ouvrirPayload()
+{
+    mPosTaille = mFichier.size();
+    mFichier.resize(mPosTaille + sizeof(uint32_t) * 2); // payload bytes and bits, patched by terminer()
+    mDebutPayload = mFichier.size();
+}
+
+void cEcrivainHuf2::ajouter(const signed char *Trame, size_t Longueur)
+{
+    const char *trame = reinterpret_cast<const char*>(Trame);
+    mNbSymboles += Longueur;
+    auto emettre = [&](char sym) {
+        const unsigned char c = static_cast<unsigned char>(sym);
+        mEcrivain.ecrire(mCodes[c], mLongueurs[c]);
+    };
+
+    if (mIntervalleRestart == 0 && mIntervalleIndex == 0) {
+        for (size_t i = 0; i < Longueur; ++i) emettre(trame[i]);
+        return;
+    }
+
+    // With restart intervals, the stream is byte-aligned every N blocks and
+    // the offset and bit count of each segment are recorded.
+    size_t p = 0;
+    for (; p < Longueur && mBloc < mMaxBlocs; ++mBloc) {
+        if (mIntervalleRestart != 0 && mBloc % mIntervalleRestart == 0) {
+            if (mNbSeg != 0) mSegBits[mNbSeg - 1] = static_cast<uint32_t>(mEcrivain.getNbBits() - mBitsDebut);
+            mEcrivain.aligner();
+            mSegOffsets[mNbSeg++] = static_cast<uint32_t>(mOctetsVides + mFichier.size() - mDebutPayload);
+            mBitsDebut = mEcrivain.getNbBits();
+            mDC = 0;
+        }
+        if (mIntervalleIndex != 0 && mBloc % mIntervalleIndex == 0) {
+            // Padding is not counted by getNbBits(): positions are taken from the current segment.
+            const uint64_t position = (mNbSeg != 0) ? static_cast<uint64_t>(mSegOffsets[mNbSeg - 1]) * 8 + (mEcrivain.getNbBits() - mBitsDebut)
+                                                    : mEcrivain.getNbBits();
+            mIndexBits[mNbIndex] = static_cast<uint32_t>(position);
+            mIndexDC[mNbIndex++] = mDC;
+        }
+        const size_t n = LongueurBloc(trame, Longueur, p);
+        mDC += static_cast<signed char>(trame[p]);
+        for (size_t k = 0; k < n; ++k) emettre(trame[p + k]);
+        p += n;
+    }
+}
+
+void cEcrivainHuf2::terminer(uint32_t largeur, uint32_t hauteur, uint32_t qualite, bool transposee)
+{
+    if (mNbSeg != 0) mSegBits[mNbSeg - 1] = static_cast<uint32_t>(mEcrivain.getNbBits() - mBitsDebut);
+    mEcrivain.aligner(); // Push the last partially filled byte
+    const uint32_t payload_bytes = static_cast<uint32_t>(mOctetsVides + mFichier.size() - mDebutPayload);
+    const uint32_t payload_bits = static_cast<uint32_t>(mEcrivain.getNbBits());
+    if (mOctetsVides == 0) {
+        std::memcpy(mFichier.data() + mPosTaille, &payload_bytes, sizeof(payload_bytes));
+        std::memcpy(mFichier.data() + mPosTaille + sizeof(uint32_t), &payload_bits, sizeof(payload_bits));
+    } else {
+        // The header is already in the stream: patch it there, then come back to its end.
+        const std::streampos fin = mFlux->tellp();
+        mFlux->seekp(mDebutFlux + static_cast<std::streamoff>(mPosTaille));
+        mFlux->write(reinterpret_cast<const char*>(&payload_bytes), sizeof(payload_bytes));
+        mFlux->write(reinterpret_cast<const char*>(&payload_bits), sizeof(payload_bits));
+        mFlux->seekp(fin);
+    }
+
+    // Width/height trailer to avoid guessing during decompression (zero when
+    // unknown). Old files do not include this, so the reader treats it as optional.
+    ajouter_octets(mFichier, &largeur, sizeof(largeur));
+    ajouter_octets(mFichier, &hauteur, sizeof(hauteur));
+
+    // Optional restart-interval extension: tag, N, segment count, then (offset, bits) per segment.
+    if (mNbSeg != 0) {
+        uint32_t intervalle = mIntervalleRestart;
+        ajouter_octets(mFichier, kTagRestart, sizeof(kTagRestart));
+        ajouter_octets(mFichier, &intervalle, sizeof(intervalle));
+        ajouter_octets(mFichier, &mNbSeg, sizeof(mNbSeg));
+        for (uint32_t i = 0; i < mNbSeg; ++i) {
+            ajouter_octets(mFichier, &mSegOffsets[i], sizeof(uint32_t));
+            ajouter_octets(mFichier, &mSegBits[i], sizeof(uint32_t));
+        }
+    }
+
+    // Quality extension: tag, quality. The decoder no longer depends on
+    // being configured with the encoder's quality.
+    ajouter_octets(mFichier, kTagQualite, sizeof(kTagQualite));
+    ajouter_octets(mFichier, &qualite, sizeof(qualite));
+
+    // Optional seek index: tag, N, entry count, then (bit position, DC predictor) per entry.
+    if (mNbIndex != 0) {
+        uint32_t intervalle = mIntervalleIndex;
+        ajouter_octets(mFichier, kTagIndex, sizeof(kTagIndex));
+        ajouter_octets(mFichier, &intervalle, sizeof(intervalle));
+        ajouter_octets(mFichier, &mNbIndex, sizeof(mNbIndex));
+        for (uint32_t i = 0; i < mNbIndex; ++i) {
+            ajouter_octets(mFichier, &mIndexBits[i], sizeof(uint32_t));
+            ajouter_octets(mFichier, &mIndexDC[i], sizeof(int32_t));
+        }
+    }
+
+    // Optional transposed quantization: the tag alone. Only a transform that
+    // swaps rows and columns writes it, so that the coefficients still meet
+    // the quantization step they were rounded with.
+    if (transposee) ajouter_octets(mFichier, kTagTransposee, sizeof(kTagTransposee));
+}
+
+bool cEcrivainHuf2::vider(std::ostream &sortie)
+{
+    if (!mFlux) {
+        mFlux = &sortie;
+        mDebutFlux = sortie.tellp();
+        if (mDebutFlux == std::streampos(-1)) sortie.setstate(std::ios::failbit);
+    }
+    sortie.write(reinterpret_cast<const char*>(mFichier.data()), static_cast<std::streamsize>(mFichier.size()));
+    mOctetsVides += mFichier.size();
+    mFichier.clear();
+    return static_cast<bool>(sortie);
+}
+
+uint64_t cEcrivainHuf2::getNbSymboles() const
+{
+    return mNbSymboles;
+}
+
+size_t cEcrivainHuf2::LongueurBloc(const char *Trame, size_t Longueur, size_t pos)
+{
+    size_t p = pos;
+    if (p >= Longueur) return 0;
+    ++p; // DC difference
+    int idx = 1;
+    while ((p + 1) < Longueur && idx < 64) {
+        unsigned char run = static_cast<unsigned char>(Trame[p]);
+        unsigned char val = static_cast<unsigned char>(Trame[p + 1]);
+        p += 2;
+        if (run == 0 && val == 0) break; // EOB
+        idx += run + 1;
+    }
+    return p - pos;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file cEncodeurFlux.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements the stripe-based streaming encoder.
+ */
+
+#include "core/cEncodeurFlux.h"
+
+#include "dct/dct.h"
+#include "dct/dct_kernels.h"
+#include "core/cTablesHuffman.h"
+
+#include <cstring>
+
+cEncodeurFlux::cEncodeurFlux(std::ostream &sortie, unsigned int largeur, unsigned int hauteur, unsigned int qualite)
+    : mSortie(sortie),
+      mLargeur(largeur),
+      mHauteur(hauteur),
+      mLargeurBlocs(((largeur + 7) / 8) * 8),
+      mContexte(qualite, COMPOSANTE_LUMA),
+      mModePipeline(PIPELINE_FLOTTANT),
+      mIntervalleRestart(0),
+      mIntervalleIndex(0),
+      mBande(static_cast<size_t>(mLargeurBlocs) * 8),
+      mLignesBande(0),
+      mLignesRecues(0),
+      mBlocCourant(0),
+      mDC_precedent(0),
+      mTable(cTablesHuffman::global().trouver(cTablesHuffman::kIdDefaut, 1)),
+      mReference(false),
+      mCommence(false),
+      mTermine(false),
+      mOk(true)
+{
+}
+
+void cEncodeurFlux::setModePipeline(eModePipeline mode)
+{
+    if (!mCommence) this->mModePipeline = mode;
+}
+
+void cEncodeurFlux::setIntervalleRestart(unsigned int nbBlocs)
+{
+    if (!mCommence) this->mIntervalleRestart = nbBlocs;
+}
+
+void cEncodeurFlux::setIntervalleIndex(unsigned int nbBlocs)
+{
+    if (!mCommence) this->mIntervalleIndex = nbBlocs;
+}
+
+bool cEncodeurFlux::setTableStatique(uint16_t id, uint16_t version)
+{
+    if (mCommence) return false;
+    const sTableHuffman *table = cTablesHuffman::global().trouver(id, version);
+    if (!table) return false;
+    this->mTable = table;
+    this->mReference = true;
+    return true;
+}
+
+unsigned int cEncodeurFlux::getLargeur() const
+{
+    return this->mLargeur;
+}
+
+unsigned int cEncodeurFlux::getHauteur() const
+{
+    return this->mHauteur;
+}
+
+const uint8_t *cEncodeurFlux::getLongueursFixes()
+{
+    return cTablesHuffman::global().trouver(cTablesHuffman::kIdDefaut, 1)->Longueurs;
+}
+
+void cEncodeurFlux::commencer()
+{
+    mCommence = true;
+
+    // Same 'HUF2' header as cCompression::Compression_JPEG(): the reference
+    // of the table, or its code lengths.
+    const size_t nbBlocs = static_cast<size_t>(mLargeurBlocs / 8) * ((mHauteur + 7) / 8);
+    mEcrivain.reset(new cEcrivainHuf2(mOctets, mArene, nbBlocs, mIntervalleRestart, mIntervalleIndex));
+    if (mReference) {
+        mEcrivain->commencer(*mTable);
+    } else {
+        mEcrivain->commencer(mTable->Longueurs);
+    }
+    if (!mEcrivain->vider(mSortie)) mOk = false;
+}
+
+bool cEncodeurFlux::ajouterLignes(const unsigned char *pixels, size_t pas, unsigned int nbLignes)
+{
+    if (mTermine || !mOk || !pixels || mLargeur == 0 || mHauteur == 0) return false;
+    if (nbLignes > mHauteur - mLignesRecues) return false;
+    if (!mCommence) commencer();
+
+    for (unsigned int i = 0; i < nbLignes; ++i) {
+        // Copy the row, replicating its last pixel up to a multiple of 8.
+        unsigned char *ligne = mBande.data() + static_cast<size_t>(mLignesBande) * mLargeurBlocs;
+        std::memcpy(ligne, pixels + i * pas, mLargeur);
+        std::memset(ligne + mLargeur, ligne[mLargeur - 1], mLargeurBlocs - mLargeur);
+        ++mLignesRecues;
+        if (++mLignesBande == 8) encoderBande();
+    }
+    return mOk;
+}
+
+void cEncodeurFlux::encoderBande()
+{
+    const unsigned int blocks_w = mLargeurBlocs / 8;
+    int16_t blocs[8 * 64];
+    float dct[8 * 64];
+    int16_t zigzag[64];
+    signed char trame[8 * 128];
+
+    // The row of blocks is processed 8 blocks at a time to stay in small stack buffers.
+    for (unsigned int b0 = 0; b0 < blocks_w; b0 += 8) {
+        const unsigned int nb = (blocks_w - b0 < 8) ? blocks_w - b0 : 8;
+        for (unsigned int b = 0; b < nb; ++b) {
+            int16_t *block = blocs + b * 64;
+            for (int r = 0; r < 8; ++r) {
+                const unsigned char *ligne = mBande.data() + static_cast<size_t>(r) * mLargeurBlocs + (b0 + b) * 8;
+                for (int c = 0; c < 8; ++c) block[r * 8 + c] = static_cast<int16_t>(static_cast<int>(ligne[c]) - 128);
+            }
+        }
+        if (mModePipeline == PIPELINE_FLOTTANT) dct_kernels().dct(blocs, dct, nb);
+
+        size_t len = 0;
+        for (unsigned int b = 0; b < nb; ++b) {
+            uint64_t masque = 0;
+            if (mModePipeline == PIPELINE_ENTIER) {
+                int32_t dct8[64];
+                Calcul_DCT_Block_Entier(blocs + b * 64, dct8);
+                masque = mContexte.quantifier_zigzag_entier(dct8, zigzag);
+            } else {
+                masque = mContexte.quantifier_zigzag(dct + b * 64, zigzag);
+            }
+
+            // A restart segment starts with no DC prediction; the writer aligns it.
+            if (mIntervalleRestart != 0 && mBlocCourant % mIntervalleRestart == 0) mDC_precedent = 0;
+            len += static_cast<size_t>(cCompression::RLE_Block(zigzag, masque, mDC_precedent, trame + len));
+            mDC_precedent = zigzag[0];
+            ++mBlocCourant;
+        }
+        mEcrivain->ajouter(trame, len);
+    }
+
+    // Only complete bytes are in mOctets; the pending bits stay in the writer.
+    mLignesBande = 0;
+    if (!mEcrivain->vider(mSortie)) mOk = false;
+}
+
+bool cEncodeurFlux::terminer()
+{
+    if (mTermine) return false;
+    mTermine = true;
+    if (!mOk || !mCommence || mLignesRecues != mHauteur) return false;
+
+    // Pad the last stripe by replicating its last row.
+    if (mLignesBande > 0) {
+        const unsigned char *derniere = mBande.data() + static_cast<size_t>(mLignesBande - 1) * mLargeurBlocs;
+        for (unsigned int r = mLignesBande; r < 8; ++r) {
+            std::memcpy(mBande.data() + static_cast<size_t>(r) * mLargeurBlocs, derniere, mLargeurBlocs);
+        }
+        encoderBande();
+    }
+
+    // The trailer keeps the size of the image; the decoder crops the padding away.
+    mEcrivain->terminer(mLargeur, mHauteur, mContexte.getQualite());
+    const bool ok = mEcrivain->vider(mSortie);
+    mSortie.flush();
+    return ok && static_cast<bool>(mSortie);
+}
+
+bool cEncodeurFlux::Encoder(const std::function<bool(unsigned char *lignes, size_t pas, unsigned int nbLignes)> &source)
+{
+    if (!source) return false;
+    std::vector<unsigned char> bande(static_cast<size_t>(mLargeur) * 8);
+    while (mLignesRecues < mHauteur) {
+        const unsigned int nb = (mHauteur - mLignesRecues < 8) ? mHauteur - mLignesRecues : 8;
+        if (!source(bande.data(), mLargeur, nb) || !ajouterLignes(bande.data(), mLargeur, nb)) {
+            mTermine = true;
+            return false;
+        }
+    }
+    return terminer();
+}
+
+bool cEncodeurFlux::Encoder(std::istream &entree)
+{
+    return Encoder([&entree](unsigned char *lignes, size_t pas, unsigned int nbLignes) {
+        const std::streamsize n = static_cast<std::streamsize>(pas * nbLignes);
+        entree.read(reinterpret_cast<char*>(lignes), n);
+        return entree.gcount() == n;
+    });
+}
@@ -0,0 +1,373 @@
+/**
+ * @file cEncodeurPipeline.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements cEncodeurPipeline.
+ */
+
+#include "core/cEncodeurPipeline.h"
+#include "core/cEcrivainHuf2.h"
+#include "core/cThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using tHorloge = std::chrono::steady_clock;
+
+/** @brief Returns the seconds elapsed between two instants. */
+double secondes_entre(tHorloge::time_point debut, tHorloge::time_point fin)
+{
+    return std::chrono::duration<double>(fin - debut).count();
+}
+
+/**
+ * @struct sJauge
+ * @brief The depth of a queue, integrated over time for its mean.
+ */
+struct sJauge {
+    unsigned int profondeur = 0;
+    unsigned int max = 0;
+    double integrale = 0.0;
+    tHorloge::time_point dernier;
+
+    /** @brief Adds delta stripes to the queue at the given instant. */
+    void changer(int delta, tHorloge::time_point maintenant)
+    {
+        integrale += profondeur * secondes_entre(dernier, maintenant);
+        dernier = maintenant;
+        profondeur = static_cast<unsigned int>(static_cast<int>(profondeur) + delta);
+        max = std::max(max, profondeur);
+    }
+};
+
+/** @brief Where a stripe buffer is in the pipeline. */
+enum eEtatBande { BANDE_LIBRE, BANDE_LUE, BANDE_TRANSFORMEE };
+
+/**
+ * @struct sBande
+ * @brief One stripe buffer: the padded rows, then the RLE bytes of their blocks.
+ */
+struct sBande {
+    std::vector<unsigned char> pixels;
+    std::vector<signed char> trame;
+    int DC_premier = 0;
+    int DC_dernier = 0;
+    unsigned int ligne = 0;
+    unsigned int nbLignes = 0;
+    eEtatBande etat = BANDE_LIBRE;
+};
+
+} // namespace
+
+double sMetriquesEtape::occupation(double secondes) const
+{
+    return (secondes > 0.0 && nbThreads != 0) ? secondesActives / (secondes * nbThreads) : 0.0;
+}
+
+const sMetriquesEtape &sMetriquesPipeline::goulot() const
+{
+    const sMetriquesEtape *g = &lecture;
+    if (transformation.occupation(secondes) > g->occupation(secondes)) g = &transformation;
+    if (entropie.occupation(secondes) > g->occupation(secondes)) g = &entropie;
+    return *g;
+}
+
+cEncodeurPipeline::cEncodeurPipeline(unsigned int largeur, unsigned int hauteur, unsigned int qualite)
+    : mLargeur(largeur),
+      mHauteur(hauteur),
+      mContexte(std::make_shared<cContexteCodec>(qualite)),
+      mModePipeline(PIPELINE_FLOTTANT),
+      mIntervalleRestart(0),
+      mIntervalleIndex(0),
+      mTableStatique(nullptr),
+      mNbThreads(0),
+      mLignesParBande(kLignesParBandeDefaut),
+      mProfondeur(0),
+      mArene(std::make_shared<cArene>())
+{
+}
+
+void cEncodeurPipeline::setModePipeline(eModePipeline mode)
+{
+    this->mModePipeline = mode;
+}
+
+void cEncodeurPipeline::setIntervalleRestart(unsigned int nbBlocs)
+{
+    this->mIntervalleRestart = nbBlocs;
+}
+
+void cEncodeurPipeline::setIntervalleIndex(unsigned int nbBlocs)
+{
+    this->mIntervalleIndex = nbBlocs;
+}
+
+bool cEncodeurPipeline::setTableStatique(uint16_t id, uint16_t version)
+{
+    const sTableHuffman *table = cTablesHuffman::global().trouver(id, version);
+    if (!table) return false;
+    this->mTableStatique = table;
+    return true;
+}
+
+void cEncodeurPipeline::setNbThreads(unsigned int nbThreads)
+{
+    this->mNbThreads = nbThreads;
+}
+
+void cEncodeurPipeline::setLignesParBande(unsigned int nbLignes)
+{
+    this->mLignesParBande = (nbLignes == 0) ? 8 : (nbLignes + 7) / 8 * 8;
+}
+
+void cEncodeurPipeline::setProfondeur(unsigned int nbBandes)
+{
+    this->mProfondeur = nbBandes;
+}
+
+unsigned int cEncodeurPipeline::getLargeur() const
+{
+    return this->mLargeur;
+}
+
+unsigned int cEncodeurPipeline::getHauteur() const
+{
+    return this->mHauteur;
+}
+
+const sMetriquesPipeline &cEncodeurPipeline::getMetriques() const
+{
+    return this->mMetriques;
+}
+
+bool cEncodeurPipeline::Encoder(const std::function<bool(unsigned char *lignes, size_t pas, unsigned int nbLignes)> &source,
+                                std::vector<unsigned char> &Fichier)
+{
+    const tHorloge::time_point debut = tHorloge::now();
+    Fichier.clear();
+    mMetriques = sMetriquesPipeline();
+    if (!source || mLargeur == 0 || mHauteur == 0) return false;
+
+    const unsigned int lb = (mLargeur + 7) / 8 * 8, hb = (mHauteur + 7) / 8 * 8;
+    const unsigned int lignesParBande = std::min(mLignesParBande, hb);
+    const unsigned int nbBandes = (hb + lignesParBande - 1) / lignesParBande;
+    unsigned int nbTransformeurs = (mNbThreads == 0) ? cThreadPool::nbThreadsMateriel() : mNbThreads;
+    nbTransformeurs = std::min(nbTransformeurs, nbBandes);
+    unsigned int profondeur = (mProfondeur == 0) ? 2 * nbTransformeurs + 2 : std::max(mProfondeur, 2u);
+    profondeur = std::min(profondeur, nbBandes);
+
+    mMetriques.lignesParBande = lignesParBande;
+    mMetriques.lecture.nom = "lecture";
+    mMetriques.transformation.nom = "transformation";
+    mMetriques.transformation.nbThreads = nbTransformeurs;
+    mMetriques.entropie.nom = "entropie";
+    mMetriques.fileTransformation.capacite = profondeur;
+    mMetriques.fileEntropie.capacite = profondeur;
+
+    // The stripe buffers: stripe n always goes through buffer n % profondeur,
+    // so the reader gets it back only once stripe n - profondeur is coded.
+    std::vector<sBande> bandes(profondeur);
+    for (sBande &b : bandes) b.pixels.resize(static_cast<size_t>(lb) * lignesParBande);
+
+    std::mutex mutex;
+    std::condition_variable condLibre, condLue, condTransformee;
+    std::deque<unsigned int> lues; // stripes read, in order
+    bool lectureFinie = false, erreur = false;
+    sJauge jaugeTransformation, jaugeEntropie;
+    jaugeTransformation.dernier = jaugeEntropie.dernier = debut;
+    auto arreter = [&] {
+        {
+            std::lock_guard<std::mutex> verrou(mutex);
+            erreur = true;
+        }
+        condLibre.notify_all();
+        condLue.notify_all();
+        condTransformee.notify_all();
+    };
+
+    // 1. Reader: pull the rows of each stripe into a free buffer and pad them.
+    std::thread lecteur([&] {
+        sMetriquesEtape &m = mMetriques.lecture;
+        for (unsigned int n = 0; n < nbBandes; ++n) {
+            sBande &b = bandes[n % profondeur];
+            const tHorloge::time_point t0 = tHorloge::now();
+            {
+                std::unique_lock<std::mutex> verrou(mutex);
+                condLibre.wait(verrou, [&] { return b.etat == BANDE_LIBRE || erreur; });
+                if (erreur) break;
+            }
+            const tHorloge::time_point t1 = tHorloge::now();
+            m.secondesAttenteSortie += secondes_entre(t0, t1);
+
+            b.ligne = n * lignesParBande;
+            b.nbLignes = std::min(lignesParBande, hb - b.ligne);
+            const unsigned int reelles = std::min(b.nbLignes, mHauteur - b.ligne);
+            if (!source(b.pixels.data(), lb, reelles)) {
+                arreter();
+                break;
+            }
+            for (unsigned int y = 0; y < b.nbLignes; ++y) {
+                unsigned char *ligne = b.pixels.data() + static_cast<size_t>(y) * lb;
+                if (y >= reelles) std::copy(ligne - lb, ligne, ligne);
+                else std::fill(ligne + mLargeur, ligne + lb, ligne[mLargeur - 1]);
+            }
+            const tHorloge::time_point t2 = tHorloge::now();
+            m.secondesActives += secondes_entre(t1, t2);
+            ++m.bandes;
+            {
+                std::lock_guard<std::mutex> verrou(mutex);
+                b.etat = BANDE_LUE;
+                lues.push_back(n);
+                jaugeTransformation.changer(+1, tHorloge::now());
+            }
+            condLue.notify_one();
+        }
+        {
+            std::lock_guard<std::mutex> verrou(mutex);
+            lectureFinie = true;
+        }
+        condLue.notify_all();
+    });
+
+    // 2. Transform workers: each has its own codec instance (and arena) over
+    // the shared context; its row table points at one stripe at a time.
+    std::vector<sMetriquesEtape> parTransformeur(nbTransformeurs);
+    std::vector<std::thread> transformeurs;
+    transformeurs.reserve(nbTransformeurs);
+    for (unsigned int k = 0; k < nbTransformeurs; ++k) {
+        transformeurs.emplace_back([&, k] {
+            sMetriquesEtape &m = parTransformeur[k];
+            std::vector<unsigned char*> lignes(hb, nullptr);
+            cCompression codec(lb, hb, mContexte->getQualite(), lignes.data());
+            codec.setContexte(mContexte);
+            codec.setModePipeline(mModePipeline);
+            codec.setIntervalleRestart(mIntervalleRestart);
+            for (;;) {
+                const tHorloge::time_point t0 = tHorloge::now();
+                unsigned int n;
+                {
+                    std::unique_lock<std::mutex> verrou(mutex);
+                    condLue.wait(verrou, [&] { return !lues.empty() || lectureFinie || erreur; });
+                    if (erreur || lues.empty()) break;
+                    n = lues.front();
+                    lues.pop_front();
+                    jaugeTransformation.changer(-1, tHorloge::now());
+                }
+                const tHorloge::time_point t1 = tHorloge::now();
+                m.secondesAttenteEntree += secondes_entre(t0, t1);
+
+                sBande &b = bandes[n % profondeur];
+                for (unsigned int y = 0; y < b.nbLignes; ++y) lignes[b.ligne + y] = b.pixels.data() + static_cast<size_t>(y) * lb;
+                codec.RLE(b.ligne, b.ligne + b.nbLignes, b.trame, b.DC_premier, b.DC_dernier);
+                std::fill(lignes.begin() + b.ligne, lignes.begin() + b.ligne + b.nbLignes, nullptr);
+                const tHorloge::time_point t2 = tHorloge::now();
+                m.secondesActives += secondes_entre(t1, t2);
+                ++m.bandes;
+                {
+                    std::lock_guard<std::mutex> verrou(mutex);
+                    b.etat = BANDE_TRANSFORMEE;
+                    jaugeEntropie.changer(+1, tHorloge::now());
+                }
+                condTransformee.notify_one();
+            }
+        });
+    }
+
+    // 3. Entropy coder, on the calling thread: the stripes in raster order.
+    // The first DC of a stripe was coded against 0; it is re-coded against
+    // the last DC of the previous stripe unless a restart interval starts there.
+    sMetriquesEtape &e = mMetriques.entropie;
+    cPorteeArene portee(*mArene);
+    const size_t nbBlocs = static_cast<size_t>(lb / 8) * (hb / 8);
+    cEcrivainHuf2 ecrivain(Fichier, *mArene, mTableStatique ? nbBlocs : 0, mIntervalleRestart, mIntervalleIndex);
+    if (mTableStatique) ecrivain.commencer(*mTableStatique);
+    mTrame.clear();
+    bool ok = true;
+    int DC_precedent = 0;
+    for (unsigned int n = 0; n < nbBandes; ++n) {
+        sBande &b = bandes[n % profondeur];
+        const tHorloge::time_point t0 = tHorloge::now();
+        {
+            std::unique_lock<std::mutex> verrou(mutex);
+            condTransformee.wait(verrou, [&] { return b.etat == BANDE_TRANSFORMEE || erreur; });
+            if (erreur) {
+                ok = false;
+                break;
+            }
+            jaugeEntropie.changer(-1, tHorloge::now());
+        }
+        const tHorloge::time_point t1 = tHorloge::now();
+        e.secondesAttenteEntree += secondes_entre(t0, t1);
+
+        const size_t premier_bloc = static_cast<size_t>(b.ligne / 8) * (lb / 8);
+        const bool restart = (mIntervalleRestart != 0 && premier_bloc % mIntervalleRestart == 0);
+        if (n > 0 && !restart && !b.trame.empty()) b.trame[0] = static_cast<signed char>(b.DC_premier - DC_precedent);
+        DC_precedent = b.DC_dernier;
+        if (mTableStatique) ecrivain.ajouter(b.trame.data(), b.trame.size());
+        else mTrame.insert(mTrame.end(), b.trame.begin(), b.trame.end());
+        e.secondesActives += secondes_entre(t1, tHorloge::now());
+        ++e.bandes;
+        {
+            std::lock_guard<std::mutex> verrou(mutex);
+            b.etat = BANDE_LIBRE;
+        }
+        condLibre.notify_one();
+    }
+    if (!ok) arreter();
+    lecteur.join();
+    for (std::thread &t : transformeurs) t.join();
+    if (!ok) {
+        Fichier.clear();
+        return false;
+    }
+
+    // 4. Adaptive codes: the histogram is complete, code the whole trame.
+    const tHorloge::time_point t0 = tHorloge::now();
+    // The trailer keeps the size of the image; the decoder crops the padding away.
+    if (mTableStatique) {
+        ecrivain.terminer(mLargeur, mHauteur, mContexte->getQualite());
+    } else {
+        cCompression codec(mLargeur, mHauteur, mContexte->getQualite());
+        codec.setContexte(mContexte);
+        codec.setArene(mArene);
+        codec.setIntervalleRestart(mIntervalleRestart);
+        codec.setIntervalleIndex(mIntervalleIndex);
+        codec.Compression_JPEG(mTrame, Fichier);
+    }
+    const tHorloge::time_point fin = tHorloge::now();
+    e.secondesActives += secondes_entre(t0, fin);
+
+    for (const sMetriquesEtape &m : parTransformeur) {
+        mMetriques.transformation.bandes += m.bandes;
+        mMetriques.transformation.secondesActives += m.secondesActives;
+        mMetriques.transformation.secondesAttenteEntree += m.secondesAttenteEntree;
+    }
+    mMetriques.secondes = secondes_entre(debut, fin);
+    jaugeTransformation.changer(0, fin);
+    jaugeEntropie.changer(0, fin);
+    mMetriques.fileTransformation.profondeurMax = jaugeTransformation.max;
+    mMetriques.fileEntropie.profondeurMax = jaugeEntropie.max;
+    if (mMetriques.secondes > 0.0) {
+        mMetriques.fileTransformation.profondeurMoyenne = jaugeTransformation.integrale / mMetriques.secondes;
+        mMetriques.fileEntropie.profondeurMoyenne = jaugeEntropie.integrale / mMetriques.secondes;
+    }
+    return true;
+}
+
+bool cEncodeurPipeline::Encoder(std::istream &entree, std::vector<unsigned char> &Fichier)
+{
+    const unsigned int largeur = mLargeur;
+    return Encoder([&entree, largeur](unsigned char *lignes, size_t pas, unsigned int nbLignes) {
+        for (unsigned int y = 0; y < nbLignes; ++y) {
+            entree.read(reinterpret_cast<char*>(lignes + y * pas), static_cast<std::streamsize>(largeur));
+            if (entree.gcount() != static_cast<std::streamsize>(largeur)) return false;
+        }
+        return true;
+    }, Fichier);
+}
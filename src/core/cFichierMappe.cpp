@@ -0,0 +1,100 @@
+/**
+ * @file cFichierMappe.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements cFichierMappe with mmap and a buffered-read fallback.
+ */
+
+#include "core/cFichierMappe.h"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define JPEG_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+cFichierMappe::cFichierMappe()
+{
+    this->mDonnees = nullptr;
+    this->mTaille = 0;
+    this->mMappe = false;
+}
+
+cFichierMappe::~cFichierMappe()
+{
+    fermer();
+}
+
+void cFichierMappe::fermer()
+{
+#if defined(JPEG_HAVE_MMAP)
+    if (this->mMappe) munmap(const_cast<unsigned char*>(this->mDonnees), this->mTaille);
+#endif
+    this->mDonnees = nullptr;
+    this->mTaille = 0;
+    this->mMappe = false;
+    this->mCopie.clear();
+    this->mCopie.shrink_to_fit();
+}
+
+bool cFichierMappe::ouvrir(const char *chemin)
+{
+    fermer();
+    if (!chemin) return false;
+
+#if defined(JPEG_HAVE_MMAP)
+    int fd = open(chemin, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            close(fd);
+            return true;
+        }
+        void *p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            close(fd); // the mapping stays valid
+            madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+            this->mDonnees = static_cast<const unsigned char*>(p);
+            this->mTaille = static_cast<size_t>(st.st_size);
+            this->mMappe = true;
+            return true;
+        }
+    }
+    close(fd);
+#endif
+
+    // Fallback: one bulk read into an owned buffer.
+    std::ifstream in(chemin, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    const std::streamoff taille = in.tellg();
+    if (taille < 0) return false;
+    this->mCopie.resize(static_cast<size_t>(taille));
+    in.seekg(0);
+    if (taille > 0 && !in.read(reinterpret_cast<char*>(this->mCopie.data()), taille)) {
+        this->mCopie.clear();
+        return false;
+    }
+    this->mDonnees = this->mCopie.empty() ? nullptr : this->mCopie.data();
+    this->mTaille = this->mCopie.size();
+    return true;
+}
+
+const unsigned char *cFichierMappe::getDonnees() const
+{
+    return this->mDonnees;
+}
+
+size_t cFichierMappe::getTaille() const
+{
+    return this->mTaille;
+}
+
+bool cFichierMappe::estMappe() const
+{
+    return this->mMappe;
+}
@@ -10,6 +10,8 @@
 #include <queue>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <cstring>
 
 // --- Anonymous Namespace for Local Helper Functions ---
 
@@ -69,6 +71,34 @@ void printCodesRec(sNoeud *node, const std::string &prefix)
     printCodesRec(node->mdroit, prefix + "1");
 }
 
+/**
+ * @brief Recursively fills the decoding table below a node.
+ * @param[in] node The current node.
+ * @param[in] code The bits leading to node, right-aligned.
+ * @param[in] longueur The number of bits leading to node.
+ * @param[out] table The table of 2^kBitsTable entries.
+ */
+void remplirTableRec(sNoeud *node, uint32_t code, int longueur, std::vector<sEntreeDecodage> &table)
+{
+    if (!node) return;
+    const int K = cHuffman::kBitsTable;
+    const bool feuille = !node->mgauche && !node->mdroit;
+
+    if (feuille || longueur == K) {
+        // Every index whose first `longueur` bits equal `code` maps to this node.
+        const uint32_t premier = code << (K - longueur);
+        const uint32_t nombre = 1u << (K - longueur);
+        sEntreeDecodage e;
+        e.msymbole = node->mdonnee;
+        e.mlongueur = feuille ? static_cast<uint8_t>(longueur) : 0;
+        e.mnoeud = node;
+        for (uint32_t i = 0; i < nombre; ++i) table[premier + i] = e;
+        return;
+    }
+    remplirTableRec(node->mgauche, code << 1, longueur + 1, table);
+    remplirTableRec(node->mdroit, (code << 1) | 1u, longueur + 1, table);
+}
+
 } // namespace
 
 
@@ -77,14 +107,16 @@ void printCodesRec(sNoeud *node, const std::string &prefix)
 cHuffman::cHuffman()
     : mtrame(nullptr),
       mLongueur(0),
-      mRacine(nullptr)
+      mRacine(nullptr),
+      mRacineReservee(false)
 {
 }
 
 cHuffman::cHuffman(char *trame, unsigned int longueur)
     : mtrame(trame),
       mLongueur(longueur),
-      mRacine(nullptr)
+      mRacine(nullptr),
+      mRacineReservee(false)
 {
 }
 
@@ -92,8 +124,14 @@ cHuffman::~cHuffman()
 {
     // The trame pointer is not owned by this class, so it is not deleted here.
     // The tree, however, is owned and must be freed.
-    deleteTree(mRacine);
+    LibererArbre();
+}
+
+void cHuffman::LibererArbre()
+{
+    if (!mRacineReservee) deleteTree(mRacine);
     mRacine = nullptr;
+    mRacineReservee = false;
 }
 
 
@@ -123,9 +161,10 @@ void cHuffman::setTrame(char *trame, unsigned int longueur)
 void cHuffman::setRacine(sNoeud *racine)
 {
     if (mRacine != racine) {
-        deleteTree(mRacine); // Free the previous tree if it's different.
+        LibererArbre(); // Free the previous tree if it's different.
     }
     mRacine = racine;
+    ConstruireTableDecodage();
 }
 
 
@@ -134,8 +173,8 @@ void cHuffman::setRacine(sNoeud *racine)
 void cHuffman::HuffmanCodes(char *Donnee, double *Frequence, unsigned int Taille)
 {
     if (!Donnee || !Frequence || Taille == 0) {
-        deleteTree(mRacine);
-        mRacine = nullptr;
+        LibererArbre();
+        mTableDecodage.clear();
         return;
     }
 
@@ -164,8 +203,29 @@ void cHuffman::HuffmanCodes(char *Donnee, double *Frequence, unsigned int Taille
     }
 
     // 3. The last remaining node is the root of the Huffman tree.
-    deleteTree(mRacine); // Free any pre-existing tree.
+    LibererArbre(); // Free any pre-existing tree.
     mRacine = minHeap.top();
+    ConstruireTableDecodage();
+}
+
+void cHuffman::ConstruireTableDecodage()
+{
+    mTableDecodage.clear();
+    if (!mRacine || (!mRacine->mgauche && !mRacine->mdroit)) return;
+    mTableDecodage.assign(size_t(1) << kBitsTable, sEntreeDecodage{ '\0', 0, nullptr });
+    remplirTableRec(mRacine, 0, 0, mTableDecodage);
+}
+
+bool cHuffman::Decoder(const unsigned char *payload, size_t taille, uint64_t debut, uint64_t nbBits, std::vector<char> &sortie) const
+{
+    if (mTableDecodage.empty() || !payload) return false;
+    if (debut + nbBits > static_cast<uint64_t>(taille) * 8ULL) return false;
+
+    cLecteurHuffman lecteur(*this, payload, taille, debut, nbBits);
+    for (int sym = lecteur.lire(); sym >= 0; sym = lecteur.lire()) {
+        sortie.push_back(static_cast<char>(sym));
+    }
+    return !lecteur.erreur();
 }
 
 void cHuffman::BuildTableCodes(std::map<char, std::string> &table)
@@ -183,3 +243,206 @@ void cHuffman::AfficherHuffman(sNoeud *Racine)
     printCodesRec(Racine, "");
 }
 
+
+
+// --- Canonical Codes ---
+
+void cHuffman::CalculerLongueurs(const uint32_t Comptes[256], uint8_t Longueurs[256], int LongueurMax)
+{
+    std::memset(Longueurs, 0, 256);
+
+    int presents[256];
+    size_t n = 0;
+    for (int s = 0; s < 256; ++s) if (Comptes[s] > 0) presents[n++] = s;
+    if (n == 0) return;
+    if (n == 1) {
+        Longueurs[presents[0]] = 1;
+        return;
+    }
+
+    // 1. Huffman merge on integer weights; parent[] links every node to its parent.
+    uint64_t poids[2 * 256 - 1];
+    int parent[2 * 256 - 1];
+    typedef std::pair<uint64_t, int> tNoeud; // (weight, node index), smallest first
+    tNoeud tas[256];
+    size_t nbTas = 0;
+    const std::greater<tNoeud> plusGrand;
+    for (size_t i = 0; i < n; ++i) {
+        poids[i] = Comptes[presents[i]];
+        parent[i] = -1;
+        tas[nbTas++] = tNoeud(poids[i], static_cast<int>(i));
+        std::push_heap(tas, tas + nbTas, plusGrand);
+    }
+    int suivant = static_cast<int>(n);
+    while (nbTas > 1) {
+        std::pop_heap(tas, tas + nbTas--, plusGrand);
+        const tNoeud a = tas[nbTas];
+        std::pop_heap(tas, tas + nbTas--, plusGrand);
+        const tNoeud b = tas[nbTas];
+        poids[suivant] = a.first + b.first;
+        parent[suivant] = -1;
+        parent[a.second] = suivant;
+        parent[b.second] = suivant;
+        tas[nbTas++] = tNoeud(poids[suivant], suivant);
+        std::push_heap(tas, tas + nbTas, plusGrand);
+        ++suivant;
+    }
+
+    // 2. Depth of every leaf, and the number of codes of each length.
+    int profondeur[256];
+    int nbParLongueur[257] = {0};
+    for (size_t i = 0; i < n; ++i) {
+        int d = 0;
+        for (int k = parent[i]; k != -1; k = parent[k]) ++d;
+        profondeur[i] = d;
+        ++nbParLongueur[d];
+    }
+
+    // 3. Limit the lengths (JPEG Annex K.3): move pairs of over-long codes up the tree.
+    for (int i = static_cast<int>(n); i > LongueurMax; --i) {
+        while (nbParLongueur[i] > 0) {
+            int j = i - 2;
+            while (nbParLongueur[j] == 0) --j;
+            nbParLongueur[i] -= 2;
+            nbParLongueur[i - 1] += 1;
+            nbParLongueur[j + 1] += 2;
+            nbParLongueur[j] -= 1;
+        }
+    }
+
+    // 4. Hand the lengths out again, shortest to the most frequent symbols.
+    // The keys (depth, symbol) are distinct, so a plain sort is stable enough.
+    size_t ordre[256];
+    for (size_t i = 0; i < n; ++i) ordre[i] = i;
+    std::sort(ordre, ordre + n, [&](size_t a, size_t b) {
+        return (profondeur[a] != profondeur[b]) ? profondeur[a] < profondeur[b] : presents[a] < presents[b];
+    });
+    size_t k = 0;
+    for (int l = 1; l <= LongueurMax && l <= static_cast<int>(n); ++l) {
+        for (int c = 0; c < nbParLongueur[l]; ++c) Longueurs[presents[ordre[k++]]] = static_cast<uint8_t>(l);
+    }
+}
+
+void cHuffman::CodesCanoniques(const uint8_t Longueurs[256], uint32_t Codes[256])
+{
+    std::memset(Codes, 0, 256 * sizeof(uint32_t));
+    uint32_t code = 0;
+    for (int l = 1; l <= 32; ++l) {
+        for (int s = 0; s < 256; ++s) {
+            if (Longueurs[s] == l) Codes[s] = code++;
+        }
+        code <<= 1;
+    }
+}
+
+bool cHuffman::ConstruireDepuisLongueurs(const uint8_t Longueurs[256])
+{
+    uint32_t Codes[256];
+    CodesCanoniques(Longueurs, Codes);
+
+    // Kraft inequality: the lengths must fit in a binary tree.
+    uint64_t kraft = 0;
+    bool vide = true;
+    for (int s = 0; s < 256; ++s) {
+        if (Longueurs[s] == 0) continue;
+        if (Longueurs[s] > 32) return false;
+        kraft += uint64_t(1) << (32 - Longueurs[s]);
+        vide = false;
+    }
+    if (vide || kraft > (uint64_t(1) << 32)) return false;
+
+    // The nodes live in mNoeuds: reserved up front (one per code bit at most)
+    // so that the pointers stay valid, and kept for the next table.
+    size_t maxNoeuds = 1;
+    for (int s = 0; s < 256; ++s) maxNoeuds += Longueurs[s];
+    LibererArbre();
+    mNoeuds.clear();
+    mNoeuds.reserve(maxNoeuds);
+    mNoeuds.emplace_back('\0', 0.0);
+    sNoeud *racine = &mNoeuds.back();
+    for (int s = 0; s < 256; ++s) {
+        const int l = Longueurs[s];
+        if (l == 0) continue;
+        sNoeud *noeud = racine;
+        for (int b = l - 1; b >= 0; --b) {
+            sNoeud *&fils = ((Codes[s] >> b) & 1u) ? noeud->mdroit : noeud->mgauche;
+            if (!fils) {
+                mNoeuds.emplace_back((b == 0) ? static_cast<char>(s) : '\0', 0.0);
+                fils = &mNoeuds.back();
+            }
+            noeud = fils;
+        }
+    }
+    mRacine = racine;
+    mRacineReservee = true;
+    ConstruireTableDecodage();
+    return true;
+}
+
+
+// --- Bit Writer ---
+
+cEcrivainBits::cEcrivainBits(std::vector<unsigned char> &sortie)
+    : mSortie(sortie),
+      mAccumulateur(0),
+      mNbBits(0),
+      mTotal(0)
+{
+}
+
+void cEcrivainBits::aligner()
+{
+    if (mNbBits > 0) {
+        mSortie.push_back(static_cast<unsigned char>(mAccumulateur << (8 - mNbBits)));
+        mAccumulateur = 0;
+        mNbBits = 0;
+    }
+}
+
+uint64_t cEcrivainBits::getNbBits() const
+{
+    return mTotal;
+}
+
+
+// --- Symbol-by-symbol reader ---
+
+cLecteurHuffman::cLecteurHuffman(const cHuffman &huffman, const unsigned char *payload, size_t taille, uint64_t debut, uint64_t nbBits)
+    : mHuffman(&huffman),
+      mPayload(payload),
+      mTaille(taille),
+      mOctet(static_cast<size_t>(debut / 8ULL)),
+      mTampon(0),
+      mNbDispo(0),
+      mRestants(nbBits),
+      mErreur(false),
+      mNbSymboles(0)
+{
+    if (huffman.mTableDecodage.empty() || !payload || debut + nbBits > static_cast<uint64_t>(taille) * 8ULL) {
+        mErreur = true;
+        mRestants = 0;
+        return;
+    }
+    remplir();
+    consommer(static_cast<int>(debut % 8ULL));
+}
+
+int cLecteurHuffman::lireLong(const sEntreeDecodage &e)
+{
+    // Slow path: a code longer than kBitsTable bits.
+    if (!e.mnoeud) { mErreur = true; return -1; } // bits that do not start any code
+    if (static_cast<uint64_t>(cHuffman::kBitsTable) >= mRestants) { mRestants = 0; return -1; }
+    consommer(cHuffman::kBitsTable);
+    mRestants -= cHuffman::kBitsTable;
+    sNoeud *cursor = e.mnoeud;
+    while (cursor->mgauche || cursor->mdroit) {
+        if (mRestants == 0) return -1; // incomplete trailing code
+        if (mNbDispo == 0) remplir();
+        cursor = (mTampon >> 63) ? cursor->mdroit : cursor->mgauche;
+        consommer(1);
+        --mRestants;
+        if (!cursor) { mErreur = true; return -1; }
+    }
+    if (kStatistiques) ++mNbSymboles;
+    return static_cast<unsigned char>(cursor->mdonnee);
+}
@@ -0,0 +1,347 @@
+/**
+ * @file cImage.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements cLecteurImage and cEcrivainImage.
+ */
+
+#include "core/cImage.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define JPEG_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/** @brief Tells whether c separates the tokens of a PNM header or of a text image. */
+inline bool est_espace(unsigned char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/** @brief Skips whitespace and '#' comments, then reads an unsigned decimal number. */
+bool lire_nombre(const unsigned char *d, size_t n, size_t &pos, unsigned int &v)
+{
+    for (;;) {
+        while (pos < n && est_espace(d[pos])) ++pos;
+        if (pos < n && d[pos] == '#') {
+            while (pos < n && d[pos] != '\n') ++pos;
+            continue;
+        }
+        break;
+    }
+    const char *debut = reinterpret_cast<const char*>(d) + pos;
+    const std::from_chars_result r = std::from_chars(debut, reinterpret_cast<const char*>(d) + n, v);
+    if (r.ec != std::errc()) return false;
+    pos += static_cast<size_t>(r.ptr - debut);
+    return true;
+}
+
+/** @brief Rescales samples of maxval to 0..255; two-byte samples are big-endian. */
+void convertir_8_bits(const unsigned char *src, size_t nb, unsigned int maxval, unsigned char *dst)
+{
+    const uint32_t arrondi = maxval / 2;
+    if (maxval > 255) {
+        for (size_t i = 0; i < nb; ++i) {
+            const uint32_t s = (static_cast<uint32_t>(src[2 * i]) << 8) | src[2 * i + 1];
+            dst[i] = (s >= maxval) ? 255 : static_cast<unsigned char>((s * 255 + arrondi) / maxval);
+        }
+    } else {
+        for (size_t i = 0; i < nb; ++i) {
+            const uint32_t s = src[i];
+            dst[i] = (s >= maxval) ? 255 : static_cast<unsigned char>((s * 255 + arrondi) / maxval);
+        }
+    }
+}
+
+} // namespace
+
+
+// --- cLecteurImage ---
+
+cLecteurImage::cLecteurImage()
+{
+    this->mFormat = IMAGE_INCONNUE;
+    this->mMaxval = 0;
+    this->mErreur = "";
+}
+
+void cLecteurImage::fermer()
+{
+    this->mFichier.fermer();
+    this->mPixels.clear();
+    this->mVue = sVueImage();
+    this->mFormat = IMAGE_INCONNUE;
+    this->mMaxval = 0;
+}
+
+bool cLecteurImage::ouvrir(const char *chemin, bool accepterAutresProfondeurs)
+{
+    fermer();
+    this->mErreur = "";
+    if (!chemin || !this->mFichier.ouvrir(chemin)) {
+        this->mErreur = "cannot open input";
+        return false;
+    }
+    const unsigned char *d = this->mFichier.getDonnees();
+    const size_t n = this->mFichier.getTaille();
+
+    if (n >= 2 && d[0] == 'P' && d[1] >= '1' && d[1] <= '7') {
+        sEntetePNM e;
+        if (d[1] != '5' && d[1] != '6') {
+            this->mErreur = "only binary PGM (P5) and PPM (P6) are supported";
+        } else if (!LireEntetePNM(d, n, e)) {
+            this->mErreur = "invalid or truncated PGM/PPM";
+        } else if (e.maxval != 255 && !accepterAutresProfondeurs) {
+            this->mErreur = "not an 8-bit PGM/PPM";
+        } else {
+            this->mFormat = e.format;
+            this->mMaxval = e.maxval;
+            this->mVue.largeur = e.largeur;
+            this->mVue.hauteur = e.hauteur;
+            this->mVue.canaux = (e.format == IMAGE_PPM) ? 3 : 1;
+            this->mVue.pas = static_cast<size_t>(e.largeur) * this->mVue.canaux;
+            if (e.maxval == 255) {
+                this->mVue.pixels = d + e.debutPixels; // read in place from the mapping
+            } else {
+                this->mPixels.resize(this->mVue.pas * e.hauteur);
+                convertir_8_bits(d + e.debutPixels, this->mPixels.size(), e.maxval, this->mPixels.data());
+                this->mVue.pixels = this->mPixels.data();
+                this->mFichier.fermer();
+            }
+            return true;
+        }
+        fermer();
+        return false;
+    }
+
+    unsigned int largeur = 0, hauteur = 0;
+    if (!ParserTexte(reinterpret_cast<const char*>(d), n, this->mPixels, largeur, hauteur)) {
+        fermer();
+        this->mErreur = "not a PGM, PPM or text image";
+        return false;
+    }
+    this->mFichier.fermer();
+    this->mFormat = IMAGE_TEXTE;
+    this->mMaxval = 255;
+    this->mVue.pixels = this->mPixels.data();
+    this->mVue.largeur = largeur;
+    this->mVue.hauteur = hauteur;
+    this->mVue.canaux = 1;
+    this->mVue.pas = largeur;
+    return true;
+}
+
+const sVueImage &cLecteurImage::getVue() const
+{
+    return this->mVue;
+}
+
+eFormatImage cLecteurImage::getFormat() const
+{
+    return this->mFormat;
+}
+
+unsigned int cLecteurImage::getMaxval() const
+{
+    return this->mMaxval;
+}
+
+bool cLecteurImage::estEnPlace() const
+{
+    return this->mVue.pixels && this->mPixels.empty();
+}
+
+const char *cLecteurImage::getErreur() const
+{
+    return this->mErreur;
+}
+
+bool cLecteurImage::LireEntetePNM(const unsigned char *Donnees, size_t Taille, sEntetePNM &entete)
+{
+    if (!Donnees || Taille < 3 || Donnees[0] != 'P' || (Donnees[1] != '5' && Donnees[1] != '6')) return false;
+    if (!est_espace(Donnees[2]) && Donnees[2] != '#') return false;
+    size_t pos = 2;
+    unsigned int w = 0, h = 0, maxval = 0;
+    if (!lire_nombre(Donnees, Taille, pos, w) || !lire_nombre(Donnees, Taille, pos, h) || !lire_nombre(Donnees, Taille, pos, maxval)) return false;
+    if (pos >= Taille || !est_espace(Donnees[pos])) return false;
+    ++pos; // single whitespace before the samples
+    if (w == 0 || h == 0 || maxval == 0 || maxval > 65535) return false;
+
+    const uint64_t canaux = (Donnees[1] == '6') ? 3 : 1;
+    const uint64_t octets = static_cast<uint64_t>(w) * h * canaux * ((maxval > 255) ? 2 : 1);
+    if (octets > Taille - pos) return false;
+
+    entete.format = (Donnees[1] == '6') ? IMAGE_PPM : IMAGE_PGM;
+    entete.largeur = w;
+    entete.hauteur = h;
+    entete.maxval = maxval;
+    entete.debutPixels = pos;
+    return true;
+}
+
+bool cLecteurImage::ParserTexte(const char *Donnees, size_t Taille, std::vector<unsigned char> &pixels,
+                                unsigned int &largeur, unsigned int &hauteur)
+{
+    pixels.clear();
+    largeur = 0;
+    hauteur = 0;
+    if (!Donnees) return false;
+
+    // A value takes at least two bytes with its separator.
+    pixels.reserve(Taille / 2 + 1);
+    const char *p = Donnees;
+    const char *const fin = Donnees + Taille;
+    size_t nbPremiereLigne = 0;
+    bool premiereLigne = true;
+    while (p < fin) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '\n') {
+            if (premiereLigne) {
+                nbPremiereLigne = pixels.size();
+                if (nbPremiereLigne == 0) return false;
+                premiereLigne = false;
+            }
+            ++p;
+            continue;
+        }
+        if (est_espace(c)) {
+            ++p;
+            continue;
+        }
+        int v = 0;
+        const std::from_chars_result r = std::from_chars(p, fin, v);
+        if (r.ec != std::errc() || (r.ptr < fin && !est_espace(static_cast<unsigned char>(*r.ptr)))) return false;
+        p = r.ptr;
+        pixels.push_back(static_cast<unsigned char>((v < 0) ? 0 : (v > 255) ? 255 : v));
+    }
+    if (premiereLigne) nbPremiereLigne = pixels.size();
+    if (nbPremiereLigne == 0 || pixels.size() % nbPremiereLigne != 0 || nbPremiereLigne > 0xFFFFFFFFu) return false;
+    largeur = static_cast<unsigned int>(nbPremiereLigne);
+    hauteur = static_cast<unsigned int>(pixels.size() / nbPremiereLigne);
+    return true;
+}
+
+
+// --- cEcrivainImage ---
+
+cEcrivainImage::cEcrivainImage()
+{
+    this->mChemin = nullptr;
+    this->mCarte = nullptr;
+    this->mTaille = 0;
+    this->mEntete = 0;
+    this->mLargeur = 0;
+    this->mHauteur = 0;
+    this->mCanaux = 0;
+}
+
+cEcrivainImage::~cEcrivainImage()
+{
+    fermer();
+}
+
+bool cEcrivainImage::ouvrir(const char *chemin, unsigned int largeur, unsigned int hauteur, unsigned int canaux)
+{
+    fermer();
+    if (!chemin || largeur == 0 || hauteur == 0 || (canaux != 1 && canaux != 3)) return false;
+    char entete[48];
+    const int nbEntete = std::snprintf(entete, sizeof(entete), "P%c\n%u %u\n255\n", (canaux == 3) ? '6' : '5', largeur, hauteur);
+    if (nbEntete <= 0) return false;
+    this->mEntete = static_cast<size_t>(nbEntete);
+    this->mTaille = this->mEntete + static_cast<size_t>(largeur) * hauteur * canaux;
+    this->mChemin = chemin;
+    this->mLargeur = largeur;
+    this->mHauteur = hauteur;
+    this->mCanaux = canaux;
+
+#if defined(JPEG_HAVE_MMAP)
+    const int fd = open(chemin, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        this->mChemin = nullptr;
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(this->mTaille)) == 0) {
+        void *p = mmap(nullptr, this->mTaille, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            close(fd); // the mapping stays valid
+            this->mCarte = static_cast<unsigned char*>(p);
+            std::memcpy(this->mCarte, entete, this->mEntete);
+            return true;
+        }
+    }
+    close(fd);
+#endif
+
+    // Fallback: the whole file in memory, written by fermer().
+    this->mTampon.assign(this->mTaille, 0);
+    std::memcpy(this->mTampon.data(), entete, this->mEntete);
+    return true;
+}
+
+unsigned char *cEcrivainImage::getPixels()
+{
+    if (this->mCarte) return this->mCarte + this->mEntete;
+    return this->mTampon.empty() ? nullptr : this->mTampon.data() + this->mEntete;
+}
+
+size_t cEcrivainImage::getPas() const
+{
+    return static_cast<size_t>(this->mLargeur) * this->mCanaux;
+}
+
+bool cEcrivainImage::fermer()
+{
+    if (!this->mChemin) return false;
+    bool ok = true;
+#if defined(JPEG_HAVE_MMAP)
+    if (this->mCarte) ok = (munmap(this->mCarte, this->mTaille) == 0);
+#endif
+    if (!this->mCarte) {
+        std::ofstream out(this->mChemin, std::ios::binary);
+        ok = out && out.write(reinterpret_cast<const char*>(this->mTampon.data()), static_cast<std::streamsize>(this->mTampon.size()));
+    }
+    this->mChemin = nullptr;
+    this->mCarte = nullptr;
+    this->mTampon.clear();
+    this->mTampon.shrink_to_fit();
+    return ok;
+}
+
+void cEcrivainImage::abandonner()
+{
+    if (!this->mChemin) return;
+    const char *chemin = this->mChemin;
+#if defined(JPEG_HAVE_MMAP)
+    if (this->mCarte) munmap(this->mCarte, this->mTaille);
+#endif
+    this->mChemin = nullptr;
+    this->mCarte = nullptr;
+    this->mTampon.clear();
+    this->mTampon.shrink_to_fit();
+    std::remove(chemin);
+}
+
+bool cEcrivainImage::Ecrire(const char *chemin, const sVueImage &vue)
+{
+    if (!vue.pixels || (vue.canaux != 1 && vue.canaux != 3) || vue.pas < static_cast<size_t>(vue.largeur) * vue.canaux) return false;
+    cEcrivainImage sortie;
+    if (!sortie.ouvrir(chemin, vue.largeur, vue.hauteur, vue.canaux)) return false;
+    unsigned char *dst = sortie.getPixels();
+    const size_t octetsLigne = sortie.getPas();
+    if (vue.pas == octetsLigne) {
+        std::memcpy(dst, vue.pixels, octetsLigne * vue.hauteur);
+    } else {
+        for (unsigned int y = 0; y < vue.hauteur; ++y) std::memcpy(dst + y * octetsLigne, vue.ligne(y), octetsLigne);
+    }
+    return sortie.fermer();
+}
@@ -0,0 +1,50 @@
+/**
+ * @file cStatistiques.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements sStatistiques and tracer_codec().
+ */
+
+#include "core/cStatistiques.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+void sStatistiques::reinitialiser()
+{
+    *this = sStatistiques();
+}
+
+void sStatistiques::ajouter(const sStatistiques &autre)
+{
+    octetsEntree += autre.octetsEntree;
+    octetsSortie += autre.octetsSortie;
+    blocs += autre.blocs;
+    symboles += autre.symboles;
+    segmentsCorrompus += autre.segmentsCorrompus;
+    for (int e = 0; e < NB_ETAPES_CODEC; ++e) secondes[e] += autre.secondes[e];
+}
+
+double sStatistiques::secondesTotal() const
+{
+    double total = 0.0;
+    for (int e = 0; e < NB_ETAPES_CODEC; ++e) total += secondes[e];
+    return total;
+}
+
+const char *sStatistiques::nomEtape(eEtapeCodec etape)
+{
+    static const char *const noms[NB_ETAPES_CODEC] = { "color", "dct", "quant", "rle", "huffman" };
+    return (etape >= 0 && etape < NB_ETAPES_CODEC) ? noms[etape] : "?";
+}
+
+void tracer_codec(const fTraceCodec &trace, const char *format, ...)
+{
+    if (!kStatistiques || !trace) return;
+    char message[256];
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    trace(message);
+}
@@ -0,0 +1,155 @@
+/**
+ * @file cTablesHuffman.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements the registry of static Huffman tables.
+ */
+
+#include "core/cTablesHuffman.h"
+
+#include "core/cFichierMappe.h"
+#include "core/cHuffman.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+/** @brief Magic number of the table files. */
+const char kMagicTable[4] = { 'H', 'T', 'B', '1' };
+
+/**
+ * @brief Code lengths of the built-in table, indexed by byte value.
+ *
+ * Derived from the RLE bytes of the reference image at qualities 25 to 90,
+ * with the counts made non-increasing in magnitude on each side of zero and
+ * every byte value given a code, so that any image can be encoded.
+ */
+const uint8_t kLongueursDefaut[256] = {
+     1,  3,  5,  5,  6,  6,  7,  7,  8,  8,  8,  8,  9,  9,  9, 10,
+    10, 10, 10, 11, 11, 11, 11, 11, 11, 11, 11, 11, 12, 12, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 16, 16, 16, 16, 16, 16,
+    16, 16, 15, 15, 15, 15, 15, 15, 15, 15, 15, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 12, 12, 12,
+    12, 12, 12, 12, 12, 11, 11, 11, 11, 11, 11, 11, 11, 11, 10, 10,
+    10, 10, 10, 10, 10,  9,  9,  9,  8,  8,  8,  7,  7,  6,  5,  3,
+};
+
+/** @brief Tells whether every byte value has a code of at most kLongueurMax bits, and the codes form a prefix code. */
+bool longueurs_valides(const uint8_t Longueurs[256])
+{
+    uint64_t kraft = 0;
+    for (int c = 0; c < 256; ++c) {
+        if (Longueurs[c] == 0 || Longueurs[c] > cHuffman::kLongueurMax) return false;
+        kraft += uint64_t(1) << (cHuffman::kLongueurMax - Longueurs[c]);
+    }
+    return kraft <= (uint64_t(1) << cHuffman::kLongueurMax);
+}
+
+} // namespace
+
+cTablesHuffman::cTablesHuffman()
+{
+    enregistrer(kIdDefaut, 1, "defaut", kLongueursDefaut);
+}
+
+bool cTablesHuffman::enregistrer(uint16_t id, uint16_t version, const char *nom, const uint8_t Longueurs[256])
+{
+    if (id == 0 || version == 0 || !Longueurs || !longueurs_valides(Longueurs)) return false;
+    std::lock_guard<std::mutex> verrou(mVerrou);
+    for (const sTableHuffman &t : mTables) {
+        if (t.id == id && t.version == version) return std::memcmp(t.Longueurs, Longueurs, 256) == 0;
+    }
+    mTables.emplace_back();
+    sTableHuffman &t = mTables.back();
+    t.id = id;
+    t.version = version;
+    t.nom = nom ? nom : "";
+    std::memcpy(t.Longueurs, Longueurs, 256);
+    cHuffman::CodesCanoniques(t.Longueurs, t.Codes);
+    return true;
+}
+
+const sTableHuffman *cTablesHuffman::trouver(uint16_t id, uint16_t version) const
+{
+    std::lock_guard<std::mutex> verrou(mVerrou);
+    const sTableHuffman *trouvee = nullptr;
+    for (const sTableHuffman &t : mTables) {
+        if (t.id != id) continue;
+        if (t.version == version) return &t;
+        if (version == 0 && (!trouvee || t.version > trouvee->version)) trouvee = &t;
+    }
+    return trouvee;
+}
+
+bool cTablesHuffman::charger(const char *chemin, const sTableHuffman **table)
+{
+    cFichierMappe fichier;
+    if (!chemin || !fichier.ouvrir(chemin)) return false;
+    const unsigned char *d = fichier.getDonnees();
+    const size_t taille = fichier.getTaille();
+    if (taille < sizeof(kMagicTable) + 5 || std::memcmp(d, kMagicTable, sizeof(kMagicTable)) != 0) return false;
+    size_t pos = sizeof(kMagicTable);
+    uint16_t id = 0, version = 0;
+    std::memcpy(&id, d + pos, sizeof(id)); pos += sizeof(id);
+    std::memcpy(&version, d + pos, sizeof(version)); pos += sizeof(version);
+    const size_t longueurNom = d[pos++];
+    if (pos + longueurNom + 256 != taille) return false;
+    const std::string nom(reinterpret_cast<const char*>(d + pos), longueurNom);
+    if (!enregistrer(id, version, nom.c_str(), d + pos + longueurNom)) return false;
+    if (table) *table = trouver(id, version);
+    return true;
+}
+
+size_t cTablesHuffman::getNombre() const
+{
+    std::lock_guard<std::mutex> verrou(mVerrou);
+    return mTables.size();
+}
+
+const sTableHuffman &cTablesHuffman::getTable(size_t i) const
+{
+    std::lock_guard<std::mutex> verrou(mVerrou);
+    return mTables[i];
+}
+
+bool cTablesHuffman::Ecrire(const char *chemin, const sTableHuffman &table)
+{
+    if (!chemin) return false;
+    std::ofstream out(chemin, std::ios::binary);
+    if (!out) return false;
+    const unsigned char longueurNom = static_cast<unsigned char>(table.nom.size() > 255 ? 255 : table.nom.size());
+    out.write(kMagicTable, sizeof(kMagicTable));
+    out.write(reinterpret_cast<const char*>(&table.id), sizeof(table.id));
+    out.write(reinterpret_cast<const char*>(&table.version), sizeof(table.version));
+    out.put(static_cast<char>(longueurNom));
+    out.write(table.nom.data(), longueurNom);
+    out.write(reinterpret_cast<const char*>(table.Longueurs), 256);
+    return static_cast<bool>(out);
+}
+
+void cTablesHuffman::Entrainer(const uint64_t Comptes[256], uint8_t Longueurs[256])
+{
+    uint64_t max = 0;
+    for (int c = 0; c < 256; ++c) if (Comptes[c] > max) max = Comptes[c];
+    int decalage = 0;
+    while ((max >> decalage) >= UINT32_MAX) ++decalage;
+    uint32_t reduits[256];
+    for (int c = 0; c < 256; ++c) reduits[c] = static_cast<uint32_t>(Comptes[c] >> decalage) + 1;
+    cHuffman::CalculerLongueurs(reduits, Longueurs);
+}
+
+cTablesHuffman &cTablesHuffman::global()
+{
+    static cTablesHuffman registre;
+    return registre;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file cThreadPool.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements the cThreadPool worker pool.
+ */
+
+#include "core/cThreadPool.h"
+
+#include <atomic>
+#include <memory>
+
+cThreadPool::cThreadPool(unsigned int nbThreads)
+{
+    this->mArret = false;
+    if (nbThreads == 0) nbThreads = nbThreadsMateriel();
+    this->mThreads.reserve(nbThreads);
+    for (unsigned int i = 0; i < nbThreads; ++i) {
+        this->mThreads.emplace_back(&cThreadPool::boucle, this);
+    }
+}
+
+cThreadPool::~cThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> verrou(this->mMutex);
+        this->mArret = true;
+    }
+    this->mCond.notify_all();
+    for (std::thread &t : this->mThreads) t.join();
+}
+
+unsigned int cThreadPool::getNbThreads() const
+{
+    return static_cast<unsigned int>(this->mThreads.size());
+}
+
+unsigned int cThreadPool::nbThreadsMateriel()
+{
+    unsigned int n = std::thread::hardware_concurrency();
+    return (n == 0) ? 1 : n;
+}
+
+void cThreadPool::boucle()
+{
+    for (;;) {
+        std::function<void()> tache;
+        {
+            std::unique_lock<std::mutex> verrou(this->mMutex);
+            this->mCond.wait(verrou, [this] { return this->mArret || !this->mFile.empty(); });
+            if (this->mFile.empty()) return; // stopping and nothing left to do
+            tache = std::move(this->mFile.front());
+            this->mFile.pop_front();
+        }
+        tache();
+    }
+}
+
+void cThreadPool::soumettre(std::function<void()> tache)
+{
+    {
+        std::lock_guard<std::mutex> verrou(this->mMutex);
+        this->mFile.push_back(std::move(tache));
+    }
+    this->mCond.notify_one();
+}
+
+void cThreadPool::paralleliser(size_t nbTaches, const std::function<void(size_t)> &tache)
+{
+    if (nbTaches == 0) return;
+    if (nbTaches == 1 || this->mThreads.empty()) {
+        for (size_t i = 0; i < nbTaches; ++i) tache(i);
+        return;
+    }
+
+    // Shared by the caller and the helpers; helpers may still hold it after we return.
+    struct sEtat {
+        std::atomic<size_t> prochain{0};
+        size_t restants = 0;
+        std::mutex mutex;
+        std::condition_variable fini;
+    };
+    auto etat = std::make_shared<sEtat>();
+    etat->restants = nbTaches;
+
+    auto travailler = [etat, nbTaches, &tache]() {
+        size_t faits = 0;
+        for (size_t i = etat->prochain.fetch_add(1); i < nbTaches; i = etat->prochain.fetch_add(1)) {
+            tache(i);
+            ++faits;
+        }
+        if (faits == 0) return;
+        std::lock_guard<std::mutex> verrou(etat->mutex);
+        etat->restants -= faits;
+        if (etat->restants == 0) etat->fini.notify_all();
+    };
+
+    // One helper per worker at most; each keeps pulling indices until none are left.
+    size_t nbAides = this->mThreads.size();
+    if (nbAides > nbTaches - 1) nbAides = nbTaches - 1;
+    for (size_t i = 0; i < nbAides; ++i) soumettre(travailler);
+
+    travailler();
+    std::unique_lock<std::mutex> verrou(etat->mutex);
+    etat->fini.wait(verrou, [&etat] { return etat->restants == 0; });
+}
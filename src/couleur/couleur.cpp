@@ -0,0 +1,236 @@
+/**
+ * @file couleur.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements the scalar color kernels, their runtime selection and the fused front and back ends.
+ */
+
+#include "couleur/couleur.h"
+#include "couleur_kernels_impl.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+void rgb_ycbcr_scalar(const uint8_t *RGB, size_t n, uint8_t *Y, int32_t *Cb, int32_t *Cr)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const int32_t R = RGB[3 * i], G = RGB[3 * i + 1], B = RGB[3 * i + 2];
+        Y[i] = static_cast<uint8_t>((kY_R * R + kY_G * G + kY_B * B + kDemi) >> 16);
+        Cb[i] = kCb_R * R + kCb_G * G + kCb_B * B;
+        Cr[i] = kCr_R * R + kCr_G * G + kCr_B * B;
+    }
+}
+
+void ycbcr_rgb_scalar(const uint8_t *Y, const uint8_t *Cb, const uint8_t *Cr, size_t n, uint8_t *RGB)
+{
+    for (size_t i = 0; i < n; ++i) ycbcr_rgb_pixel(Y[i], Cb[i], Cr[i], RGB + 3 * i);
+}
+
+const sCouleurKernels kScalar = { "scalar", rgb_ycbcr_scalar, ycbcr_rgb_scalar };
+#if defined(JPEG_HAVE_SSE41)
+const sCouleurKernels kSse41 = { "sse4.1", rgb_ycbcr_sse41, ycbcr_rgb_sse41 };
+#endif
+
+/** @brief Checks whether the running CPU can execute the named instruction set. */
+bool cpu_supporte(const char *nom)
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (std::strcmp(nom, "sse4.1") == 0) return __builtin_cpu_supports("sse4.1");
+#endif
+    return std::strcmp(nom, "scalar") == 0;
+}
+
+const sCouleurKernels *choisir_kernels()
+{
+    if (const char *force = std::getenv("JPEG_COULEUR_KERNELS")) {
+        if (const sCouleurKernels *k = couleur_kernels_by_name(force)) return k;
+    }
+    if (const sCouleurKernels *k = couleur_kernels_by_name("sse4.1")) return k;
+    return &kScalar;
+}
+
+/** @brief Rounds a sum of 2^decalage chroma values (scaled by 2^16) to an 8-bit sample. */
+inline uint8_t arrondir_chroma(int32_t somme, unsigned int decalage)
+{
+    return saturer((somme + (128 << (16 + decalage)) + (1 << (15 + decalage))) >> (16 + decalage));
+}
+
+/**
+ * @brief Upsamples one chroma row horizontally by 2 with the triangle filter.
+ * @param[in] c cw column values, scaled by 4^echelle (1 for a plain row, 4 for a vertical sum).
+ * @param[in] cw The number of chroma columns.
+ * @param[in] echelle 0 for a plain row, 1 for a 3:1 vertical sum.
+ * @param[out] dst largeur samples.
+ * @param[in] largeur The output width (2 cw - 1 or 2 cw).
+ */
+void triangle_horizontal(const int32_t *c, unsigned int cw, unsigned int echelle, uint8_t *dst, unsigned int largeur)
+{
+    // libjpeg rounding: the biases alternate so that the errors do not accumulate.
+    const unsigned int decalage = 2 + 2 * echelle;
+    const int32_t biaisPair = echelle ? 8 : 1, biaisImpair = echelle ? 7 : 2;
+    for (unsigned int i = 0; i < cw; ++i) {
+        const int32_t gauche = c[(i > 0) ? i - 1 : 0];
+        const int32_t droite = c[(i + 1 < cw) ? i + 1 : i];
+        dst[2 * i] = static_cast<uint8_t>((3 * c[i] + gauche + biaisPair) >> decalage);
+        if (2 * i + 1 < largeur) dst[2 * i + 1] = static_cast<uint8_t>((3 * c[i] + droite + biaisImpair) >> decalage);
+    }
+}
+
+} // namespace
+
+const sCouleurKernels &couleur_kernels()
+{
+    static const sCouleurKernels *const choix = choisir_kernels();
+    return *choix;
+}
+
+const sCouleurKernels &couleur_kernels_scalar()
+{
+    return kScalar;
+}
+
+const sCouleurKernels *couleur_kernels_by_name(const char *nom)
+{
+    if (!nom || !cpu_supporte(nom)) return nullptr;
+    if (std::strcmp(nom, "scalar") == 0) return &kScalar;
+#if defined(JPEG_HAVE_SSE41)
+    if (std::strcmp(nom, "sse4.1") == 0) return &kSse41;
+#endif
+    return nullptr;
+}
+
+void rgb_vers_ycbcr_mcu(const uint8_t *RGB, size_t pasRGB, unsigned int largeur, unsigned int nbLignes,
+                        unsigned int facteurH, unsigned int facteurV, unsigned int largeurY,
+                        uint8_t *Y, uint8_t *Cb, uint8_t *Cr)
+{
+    const sCouleurKernels &k = couleur_kernels();
+    const unsigned int hauteur = 8 * facteurV;
+    const unsigned int largeurC = largeurY / facteurH;
+    const unsigned int decalage = (facteurH == 2) + (facteurV == 2); // log2 of the pixels per chroma sample
+
+    // Unrounded chroma of the current row, and its sum with the previous row for 4:2:0.
+    // The scratch is kept by the thread, so that a warm encoder does not allocate.
+    static thread_local std::vector<int32_t> tampon;
+    if (tampon.size() < static_cast<size_t>(largeurY) * 4) tampon.resize(static_cast<size_t>(largeurY) * 4);
+    int32_t *cb = tampon.data(), *cr = cb + largeurY;
+    int32_t *cbSomme = cr + largeurY, *crSomme = cbSomme + largeurY;
+
+    for (unsigned int r = 0; r < hauteur; ++r) {
+        // Rows past the bottom edge repeat the last one (cb and cr still hold its chroma).
+        uint8_t *y = Y + static_cast<size_t>(r) * largeurY;
+        if (r < nbLignes) {
+            k.rgb_ycbcr(RGB + static_cast<size_t>(r) * pasRGB, largeur, y, cb, cr);
+            std::memset(y + largeur, y[largeur - 1], largeurY - largeur);
+            for (unsigned int x = largeur; x < largeurY; ++x) {
+                cb[x] = cb[largeur - 1];
+                cr[x] = cr[largeur - 1];
+            }
+        } else {
+            std::memcpy(y, y - largeurY, largeurY);
+        }
+
+        if (facteurV == 2 && (r & 1) == 0) {
+            std::memcpy(cbSomme, cb, largeurY * sizeof(int32_t));
+            std::memcpy(crSomme, cr, largeurY * sizeof(int32_t));
+            continue;
+        }
+        const int32_t *sCb = cb, *sCr = cr;
+        if (facteurV == 2) {
+            for (unsigned int x = 0; x < largeurY; ++x) {
+                cbSomme[x] += cb[x];
+                crSomme[x] += cr[x];
+            }
+            sCb = cbSomme;
+            sCr = crSomme;
+        }
+        uint8_t *lb = Cb + static_cast<size_t>(r / facteurV) * largeurC;
+        uint8_t *lr = Cr + static_cast<size_t>(r / facteurV) * largeurC;
+        if (facteurH == 2) {
+            for (unsigned int x = 0; x < largeurC; ++x) {
+                lb[x] = arrondir_chroma(sCb[2 * x] + sCb[2 * x + 1], decalage);
+                lr[x] = arrondir_chroma(sCr[2 * x] + sCr[2 * x + 1], decalage);
+            }
+        } else {
+            for (unsigned int x = 0; x < largeurC; ++x) {
+                lb[x] = arrondir_chroma(sCb[x], decalage);
+                lr[x] = arrondir_chroma(sCr[x], decalage);
+            }
+        }
+    }
+}
+
+void ycbcr_vers_rgb_lignes(const uint8_t *Y, size_t pasY, const uint8_t *Cb, const uint8_t *Cr, size_t pasC,
+                           unsigned int largeur, unsigned int hauteur, unsigned int facteurH, unsigned int facteurV,
+                           eModeSurechantillonnage mode, unsigned int j_debut, unsigned int j_fin,
+                           uint8_t *RGB, size_t pasRGB)
+{
+    const sCouleurKernels &k = couleur_kernels();
+    if (j_fin > hauteur) j_fin = hauteur;
+    if (largeur == 0 || j_debut >= j_fin) return;
+    const unsigned int cw = (largeur + facteurH - 1) / facteurH;
+    const unsigned int ch = (hauteur + facteurV - 1) / facteurV;
+
+    // Full-resolution chroma of the current row, and the 3:1 vertical sums of the triangle filter.
+    // Kept by the thread like the front end's scratch.
+    static thread_local std::vector<uint8_t> lignes;
+    static thread_local std::vector<int32_t> sommes;
+    if (lignes.size() < static_cast<size_t>(largeur) * 2) lignes.resize(static_cast<size_t>(largeur) * 2);
+    if (sommes.size() < static_cast<size_t>(cw) * 2) sommes.resize(static_cast<size_t>(cw) * 2);
+    uint8_t *cbLigne = lignes.data(), *crLigne = cbLigne + largeur;
+    int32_t *cbSomme = sommes.data(), *crSomme = cbSomme + cw;
+
+    for (unsigned int j = j_debut; j < j_fin; ++j) {
+        const unsigned int cy = j / facteurV;
+        const uint8_t *cb = Cb + static_cast<size_t>(cy) * pasC;
+        const uint8_t *cr = Cr + static_cast<size_t>(cy) * pasC;
+        const uint8_t *cbSortie = cb, *crSortie = cr;
+
+        if (facteurH == 1 && facteurV == 1) {
+            // 4:4:4: the chroma rows are used in place.
+        } else if (mode == SURECHANTILLONNAGE_PROCHE) {
+            if (facteurH == 2) {
+                for (unsigned int x = 0; x < largeur; ++x) {
+                    cbLigne[x] = cb[x >> 1];
+                    crLigne[x] = cr[x >> 1];
+                }
+                cbSortie = cbLigne;
+                crSortie = crLigne;
+            }
+        } else if (facteurV == 2) {
+            // The nearer chroma row weighs 3, the other one (above for an even row) 1.
+            const unsigned int cyLoin = (j & 1) ? ((cy + 1 < ch) ? cy + 1 : cy) : ((cy > 0) ? cy - 1 : 0);
+            const uint8_t *cbLoin = Cb + static_cast<size_t>(cyLoin) * pasC;
+            const uint8_t *crLoin = Cr + static_cast<size_t>(cyLoin) * pasC;
+            for (unsigned int i = 0; i < cw; ++i) {
+                cbSomme[i] = 3 * cb[i] + cbLoin[i];
+                crSomme[i] = 3 * cr[i] + crLoin[i];
+            }
+            if (facteurH == 2) {
+                triangle_horizontal(cbSomme, cw, 1, cbLigne, largeur);
+                triangle_horizontal(crSomme, cw, 1, crLigne, largeur);
+            } else {
+                const int32_t biais = (j & 1) ? 2 : 1;
+                for (unsigned int x = 0; x < largeur; ++x) {
+                    cbLigne[x] = static_cast<uint8_t>((cbSomme[x] + biais) >> 2);
+                    crLigne[x] = static_cast<uint8_t>((crSomme[x] + biais) >> 2);
+                }
+            }
+            cbSortie = cbLigne;
+            crSortie = crLigne;
+        } else {
+            for (unsigned int i = 0; i < cw; ++i) {
+                cbSomme[i] = cb[i];
+                crSomme[i] = cr[i];
+            }
+            triangle_horizontal(cbSomme, cw, 0, cbLigne, largeur);
+            triangle_horizontal(crSomme, cw, 0, crLigne, largeur);
+            cbSortie = cbLigne;
+            crSortie = crLigne;
+        }
+        k.ycbcr_rgb(Y + static_cast<size_t>(j) * pasY, cbSortie, crSortie, largeur, RGB + static_cast<size_t>(j) * pasRGB);
+    }
+}
@@ -0,0 +1,47 @@
+/**
+ * @file couleur_kernels_impl.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Internal constants and declarations shared by the color conversion kernels.
+ */
+
+#ifndef JPEG_COMPRESSOR_COULEUR_KERNELS_IMPL_H
+#define JPEG_COMPRESSOR_COULEUR_KERNELS_IMPL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/** @brief JFIF coefficients scaled by 2^16 (each row sums to 65536 for Y and to 0 for Cb, Cr). */
+constexpr int32_t kY_R = 19595, kY_G = 38470, kY_B = 7471;
+constexpr int32_t kCb_R = -11059, kCb_G = -21709, kCb_B = 32768;
+constexpr int32_t kCr_R = 32768, kCr_G = -27439, kCr_B = -5329;
+
+/** @brief Inverse JFIF coefficients scaled by 2^16, applied to Cb - 128 and Cr - 128. */
+constexpr int32_t kR_Cr = 91881;
+constexpr int32_t kG_Cb = -22554, kG_Cr = -46802;
+constexpr int32_t kB_Cb = 116130;
+
+/** @brief Rounding constant of the 16-bit fixed point. */
+constexpr int32_t kDemi = 1 << 15;
+
+/** @brief Clamps a sample to [0, 255]. */
+inline uint8_t saturer(int32_t v)
+{
+    return static_cast<uint8_t>((v < 0) ? 0 : (v > 255) ? 255 : v);
+}
+
+/** @brief Converts one pixel back to RGB; shared by the scalar kernel and the vector tails. */
+inline void ycbcr_rgb_pixel(int32_t y, int32_t Cb, int32_t Cr, uint8_t *rgb)
+{
+    const int32_t cb = Cb - 128, cr = Cr - 128;
+    rgb[0] = saturer(y + ((kR_Cr * cr + kDemi) >> 16));
+    rgb[1] = saturer(y + ((kG_Cb * cb + kG_Cr * cr + kDemi) >> 16));
+    rgb[2] = saturer(y + ((kB_Cb * cb + kDemi) >> 16));
+}
+
+#if defined(JPEG_HAVE_SSE41)
+void rgb_ycbcr_sse41(const uint8_t *RGB, size_t n, uint8_t *Y, int32_t *Cb, int32_t *Cr);
+void ycbcr_rgb_sse41(const uint8_t *Y, const uint8_t *Cb, const uint8_t *Cr, size_t n, uint8_t *RGB);
+#endif
+
+#endif // JPEG_COMPRESSOR_COULEUR_KERNELS_IMPL_H
@@ -0,0 +1,91 @@
+/**
+ * @file couleur_sse41.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief SSE4.1 color conversion kernels (4 pixels per iteration).
+ *
+ * This file is compiled with -msse4.1 and only called after a CPUID check.
+ */
+
+#include "couleur_kernels_impl.h"
+
+#if defined(JPEG_HAVE_SSE41)
+
+#include <cstring>
+#include <smmintrin.h>
+
+void rgb_ycbcr_sse41(const uint8_t *RGB, size_t n, uint8_t *Y, int32_t *Cb, int32_t *Cr)
+{
+    // Gather R, G and B of 4 packed pixels into 32-bit lanes.
+    const __m128i masqueR = _mm_setr_epi8(0, -1, -1, -1, 3, -1, -1, -1, 6, -1, -1, -1, 9, -1, -1, -1);
+    const __m128i masqueG = _mm_setr_epi8(1, -1, -1, -1, 4, -1, -1, -1, 7, -1, -1, -1, 10, -1, -1, -1);
+    const __m128i masqueB = _mm_setr_epi8(2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1);
+    const __m128i yR = _mm_set1_epi32(kY_R), yG = _mm_set1_epi32(kY_G), yB = _mm_set1_epi32(kY_B);
+    const __m128i bR = _mm_set1_epi32(kCb_R), bG = _mm_set1_epi32(kCb_G), bB = _mm_set1_epi32(kCb_B);
+    const __m128i rR = _mm_set1_epi32(kCr_R), rG = _mm_set1_epi32(kCr_G), rB = _mm_set1_epi32(kCr_B);
+    const __m128i demi = _mm_set1_epi32(kDemi);
+
+    size_t i = 0;
+    // Each load reads 16 bytes for 12 used: stop while 2 pixels of margin remain.
+    for (; i + 6 <= n; i += 4) {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(RGB + 3 * i));
+        const __m128i R = _mm_shuffle_epi8(px, masqueR);
+        const __m128i G = _mm_shuffle_epi8(px, masqueG);
+        const __m128i B = _mm_shuffle_epi8(px, masqueB);
+
+        __m128i y = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(R, yR), _mm_mullo_epi32(G, yG)),
+                                  _mm_add_epi32(_mm_mullo_epi32(B, yB), demi));
+        y = _mm_srli_epi32(y, 16);
+        y = _mm_packus_epi16(_mm_packus_epi32(y, y), _mm_setzero_si128());
+        const int32_t y4 = _mm_cvtsi128_si32(y);
+        std::memcpy(Y + i, &y4, sizeof(y4));
+
+        const __m128i cb = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(R, bR), _mm_mullo_epi32(G, bG)), _mm_mullo_epi32(B, bB));
+        const __m128i cr = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(R, rR), _mm_mullo_epi32(G, rG)), _mm_mullo_epi32(B, rB));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Cb + i), cb);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Cr + i), cr);
+    }
+    for (; i < n; ++i) {
+        const int32_t R = RGB[3 * i], G = RGB[3 * i + 1], B = RGB[3 * i + 2];
+        Y[i] = static_cast<uint8_t>((kY_R * R + kY_G * G + kY_B * B + kDemi) >> 16);
+        Cb[i] = kCb_R * R + kCb_G * G + kCb_B * B;
+        Cr[i] = kCr_R * R + kCr_G * G + kCr_B * B;
+    }
+}
+
+void ycbcr_rgb_sse41(const uint8_t *Y, const uint8_t *Cb, const uint8_t *Cr, size_t n, uint8_t *RGB)
+{
+    // Interleaves the bytes R0-3 G0-3 B0-3 into R0 G0 B0 R1 ...
+    const __m128i entrelacer = _mm_setr_epi8(0, 4, 8, 1, 5, 9, 2, 6, 10, 3, 7, 11, -1, -1, -1, -1);
+    const __m128i rCr = _mm_set1_epi32(kR_Cr), gCb = _mm_set1_epi32(kG_Cb), gCr = _mm_set1_epi32(kG_Cr);
+    const __m128i bCb = _mm_set1_epi32(kB_Cb);
+    const __m128i demi = _mm_set1_epi32(kDemi), centre = _mm_set1_epi32(128);
+
+    auto charger4 = [](const uint8_t *p) {
+        int32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(v));
+    };
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i y = charger4(Y + i);
+        const __m128i cb = _mm_sub_epi32(charger4(Cb + i), centre);
+        const __m128i cr = _mm_sub_epi32(charger4(Cr + i), centre);
+
+        const __m128i R = _mm_add_epi32(y, _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(cr, rCr), demi), 16));
+        const __m128i G = _mm_add_epi32(y, _mm_srai_epi32(
+            _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(cb, gCb), _mm_mullo_epi32(cr, gCr)), demi), 16));
+        const __m128i B = _mm_add_epi32(y, _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(cb, bCb), demi), 16));
+
+        // Both packs saturate, which clamps to [0, 255] as the scalar kernel does.
+        const __m128i octets = _mm_packus_epi16(_mm_packus_epi32(R, G), _mm_packus_epi32(B, B));
+        const __m128i px = _mm_shuffle_epi8(octets, entrelacer);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(RGB + 3 * i), px);
+        const int32_t fin = _mm_extract_epi32(px, 2);
+        std::memcpy(RGB + 3 * i + 8, &fin, sizeof(fin));
+    }
+    for (; i < n; ++i) ycbcr_rgb_pixel(Y[i], Cb[i], Cr[i], RGB + 3 * i);
+}
+
+#endif // JPEG_HAVE_SSE41
@@ -3,65 +3,233 @@
  * @author Khanh-Phuong NGUYEN
  * @date 2025-12-08
  * @brief Implements the 2D Discrete Cosine Transform (DCT) functions.
+ *
+ * The 2D-DCT is separable: it is computed as a 1D-DCT over the columns of the
+ * block followed by a 1D-DCT over the rows, using a basis table computed at
+ * compile time. This replaces the direct O(N^4) double sum, which called
+ * cos() twice per term.
  */
 
 #include "dct/dct.h"
+#include "dct_kernels_impl.h"
 #include <cmath>
 #include <iostream>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+namespace {
 
-void Calcul_DCT_Block(int **Bloc8x8, double **DCT_Img) {
-    const int N = 8;
-    // For each frequency coefficient (u,v) in the output DCT matrix...
+/** @brief cos(k*pi/16) for k = 0..8. */
+constexpr double kCosPi16[9] = {
+    1.00000000000000000000, 0.98078528040323044913, 0.92387953251128675613,
+    0.83146961230254523708, 0.70710678118654752440, 0.55557023301960222474,
+    0.38268343236508977173, 0.19509032201612826785, 0.00000000000000000000
+};
+
+/** @brief Evaluates cos(m*pi/16) for any integer m >= 0 from kCosPi16 using the symmetries of cos. */
+constexpr double cos_pi16(int m)
+{
+    m %= 32;
+    if (m > 16) m = 32 - m;
+    return (m <= 8) ? kCosPi16[m] : -kCosPi16[16 - m];
+}
+
+/**
+ * @brief The orthonormal 8-point DCT basis, C[u][x] = c(u)/2 * cos((2x+1)u*pi/16).
+ *
+ * c(0) = 1/sqrt(2) and c(u) = 1 otherwise, so that the 2D transform
+ * C * B * C^T equals the textbook 0.25 * Cu * Cv * sum(...) formula.
+ */
+struct sBaseDCT {
+    double d[8][8];
+    float f[8][8];
+    float ft[8][8];
+};
+
+constexpr sBaseDCT construire_base()
+{
+    sBaseDCT base{};
+    for (int u = 0; u < 8; ++u) {
+        const double echelle = (u == 0) ? 0.35355339059327376220 : 0.5; // c(u)/2
+        for (int x = 0; x < 8; ++x) {
+            base.d[u][x] = echelle * cos_pi16((2 * x + 1) * u);
+            base.f[u][x] = static_cast<float>(base.d[u][x]);
+            base.ft[x][u] = base.f[u][x];
+        }
+    }
+    return base;
+}
+
+constexpr sBaseDCT kBase = construire_base();
+
+/** @brief Rounds half away from zero and saturates to the int16_t range. */
+inline int16_t arrondir_int16(float v)
+{
+    int r = static_cast<int>(v < 0.0f ? v - 0.5f : v + 0.5f);
+    r = (r < -32768) ? -32768 : (r > 32767) ? 32767 : r;
+    return static_cast<int16_t>(r);
+}
+
+/**
+ * @brief The reduced bases R[u][x] = c(u)/2 * cos((2x+1)u*pi/(2N)) for N = 2 and 4.
+ *
+ * With the weights of the 8-point basis, the N-point inverse transform of
+ * the lowest N coefficients gives the mean of each run of 8/N samples.
+ */
+struct sBaseReduite {
+    float n2[2][2];
+    float n4[4][4];
+};
+
+constexpr sBaseReduite construire_base_reduite()
+{
+    sBaseReduite base{};
+    for (int u = 0; u < 4; ++u) {
+        const double echelle = (u == 0) ? 0.35355339059327376220 : 0.5;
+        for (int x = 0; x < 4; ++x) {
+            base.n4[u][x] = static_cast<float>(echelle * cos_pi16(2 * (2 * x + 1) * u));
+            if (u < 2 && x < 2) base.n2[u][x] = static_cast<float>(echelle * cos_pi16(4 * (2 * x + 1) * u));
+        }
+    }
+    return base;
+}
+
+constexpr sBaseReduite kBaseReduite = construire_base_reduite();
+
+/** @brief The N x N reduced inverse transform of the low frequencies of a block (see Calcul_IDCT_Reduite()). */
+template <int N>
+void idct_reduite(const int16_t *Coefs, const float *Q, const float (&C)[N][N], int16_t *Bloc)
+{
+    float F[N][N], tmp[N][N];
     for (int u = 0; u < N; ++u) {
+        for (int v = 0; v < N; ++v) F[u][v] = static_cast<float>(Coefs[u * 8 + v]) * Q[u * 8 + v];
+    }
+    for (int x = 0; x < N; ++x) {
         for (int v = 0; v < N; ++v) {
+            float sum = 0.0f;
+            for (int u = 0; u < N; ++u) sum += C[u][x] * F[u][v];
+            tmp[x][v] = sum;
+        }
+    }
+    for (int x = 0; x < N; ++x) {
+        for (int y = 0; y < N; ++y) {
+            float sum = 0.0f;
+            for (int v = 0; v < N; ++v) sum += tmp[x][v] * C[v][y];
+            Bloc[x * N + y] = arrondir_int16(sum);
+        }
+    }
+}
+
+} // namespace
+
+const float *dct_base() {
+    return &kBase.f[0][0];
+}
+
+const float *dct_base_transposed() {
+    return &kBase.ft[0][0];
+}
+
+void Calcul_DCT_Block(int **Bloc8x8, double **DCT_Img) {
+    const auto &C = kBase.d;
+    double tmp[8][8];
+
+    // 1D-DCT along the columns: tmp[u][y] = sum_x C[u][x] * B[x][y].
+    for (int u = 0; u < 8; ++u) {
+        for (int y = 0; y < 8; ++y) {
             double sum = 0.0;
-            // ...sum over all spatial coordinates (x,y) in the input block.
-            for (int x = 0; x < N; ++x) {
-                for (int y = 0; y < N; ++y) {
-                    sum += Bloc8x8[x][y] *
-                           cos((2 * x + 1) * u * M_PI / (2.0 * N)) *
-                           cos((2 * y + 1) * v * M_PI / (2.0 * N));
-                }
-            }
-
-            // Define the normalization coefficients Cu and Cv.
-            double Cu = (u == 0) ? (1.0 / sqrt(2.0)) : 1.0;
-            double Cv = (v == 0) ? (1.0 / sqrt(2.0)) : 1.0;
-            
-            // Apply the normalization factors to get the final DCT coefficient.
-            DCT_Img[u][v] = 0.25 * Cu * Cv * sum;
+            for (int x = 0; x < 8; ++x) sum += C[u][x] * Bloc8x8[x][y];
+            tmp[u][y] = sum;
+        }
+    }
+
+    // 1D-DCT along the rows: DCT[u][v] = sum_y tmp[u][y] * C[v][y].
+    for (int u = 0; u < 8; ++u) {
+        for (int v = 0; v < 8; ++v) {
+            double sum = 0.0;
+            for (int y = 0; y < 8; ++y) sum += tmp[u][y] * C[v][y];
+            DCT_Img[u][v] = sum;
         }
     }
 }
 
 void Calcul_IDCT_Block(double **DCT_Img, int **Bloc8x8) {
-    const int N = 8;
-    // For each spatial coordinate (x,y) in the output block...
-    for (int x = 0; x < N; ++x) {
-        for (int y = 0; y < N; ++y) {
+    const auto &C = kBase.d;
+    double tmp[8][8];
+
+    // 1D-IDCT along the columns: tmp[x][v] = sum_u C[u][x] * F[u][v].
+    for (int x = 0; x < 8; ++x) {
+        for (int v = 0; v < 8; ++v) {
             double sum = 0.0;
-            // ...sum over all frequency coefficients (u,v) in the input DCT block.
-            for (int u = 0; u < N; ++u) {
-                for (int v = 0; v < N; ++v) {
-                    // Define the normalization coefficients Cu and Cv.
-                    double Cu = (u == 0) ? (1.0 / sqrt(2.0)) : 1.0;
-                    double Cv = (v == 0) ? (1.0 / sqrt(2.0)) : 1.0;
-
-                    sum += Cu * Cv * DCT_Img[u][v] *
-                           cos((2 * x + 1) * u * M_PI / (2.0 * N)) *
-                           cos((2 * y + 1) * v * M_PI / (2.0 * N));
-                }
-            }
-            // Apply the normalization factor, round the result, and cast to an integer type.
-            Bloc8x8[x][y] = static_cast<int>(round(0.25 * sum));
+            for (int u = 0; u < 8; ++u) sum += C[u][x] * DCT_Img[u][v];
+            tmp[x][v] = sum;
+        }
+    }
+
+    // 1D-IDCT along the rows, then round to the nearest integer.
+    for (int x = 0; x < 8; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            double sum = 0.0;
+            for (int v = 0; v < 8; ++v) sum += tmp[x][v] * C[v][y];
+            Bloc8x8[x][y] = static_cast<int>(round(sum));
+        }
+    }
+}
+
+void Calcul_DCT_Block(const int16_t *Bloc, float *DCT) {
+    const auto &C = kBase.f;
+    float tmp[64];
+
+    for (int u = 0; u < 8; ++u) {
+        for (int y = 0; y < 8; ++y) {
+            float sum = 0.0f;
+            for (int x = 0; x < 8; ++x) sum += C[u][x] * static_cast<float>(Bloc[x * 8 + y]);
+            tmp[u * 8 + y] = sum;
+        }
+    }
+    for (int u = 0; u < 8; ++u) {
+        for (int v = 0; v < 8; ++v) {
+            float sum = 0.0f;
+            for (int y = 0; y < 8; ++y) sum += tmp[u * 8 + y] * C[v][y];
+            DCT[u * 8 + v] = sum;
+        }
+    }
+}
+
+void Calcul_IDCT_Block(const float *DCT, int16_t *Bloc) {
+    const auto &C = kBase.f;
+    float tmp[64];
+
+    for (int x = 0; x < 8; ++x) {
+        for (int v = 0; v < 8; ++v) {
+            float sum = 0.0f;
+            for (int u = 0; u < 8; ++u) sum += C[u][x] * DCT[u * 8 + v];
+            tmp[x * 8 + v] = sum;
+        }
+    }
+    for (int x = 0; x < 8; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            float sum = 0.0f;
+            for (int v = 0; v < 8; ++v) sum += tmp[x * 8 + v] * C[v][y];
+            Bloc[x * 8 + y] = arrondir_int16(sum);
         }
     }
 }
 
+int16_t Calcul_IDCT_DC(int16_t Coef, float Q) {
+    // Both passes of the transform reduce to one product by C[0][.]; the other terms are exact zeros.
+    const float c0 = kBase.f[0][0];
+    return arrondir_int16((c0 * (static_cast<float>(Coef) * Q)) * c0);
+}
+
+void Calcul_IDCT_Reduite(const int16_t *Coefs, const float *Q, unsigned int N, int16_t *Bloc) {
+    if (N == 1) {
+        Bloc[0] = arrondir_int16(static_cast<float>(Coefs[0]) * Q[0] * 0.125f);
+    } else if (N == 2) {
+        idct_reduite<2>(Coefs, Q, kBaseReduite.n2, Bloc);
+    } else {
+        idct_reduite<4>(Coefs, Q, kBaseReduite.n4, Bloc);
+    }
+}
+
 void Show_DCT_Block(double **DCT_Img) {
     const int N = 8;
     std::cout << "--- DCT Block Coefficients ---" << std::endl;
@@ -72,4 +240,3 @@ void Show_DCT_Block(double **DCT_Img) {
         std::cout << std::endl;
     }
 }
-
@@ -0,0 +1,115 @@
+/**
+ * @file dct_avx2.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief AVX2 block kernels (8 lanes, one register per block row).
+ *
+ * This file is compiled with -mavx2 (without -mfma, so that products and sums
+ * stay separately rounded) and only called after a CPUID check.
+ */
+
+#include "dct_kernels_impl.h"
+
+#if defined(JPEG_HAVE_AVX2)
+
+#include <immintrin.h>
+
+namespace {
+
+/** @brief Rounds half away from zero and stores 8 lanes as saturated int16. */
+inline void arrondir_stocker(__m256 a, int16_t *out)
+{
+    const __m256 demi = _mm256_set1_ps(0.5f);
+    const __m256 signe = _mm256_set1_ps(-0.0f);
+    a = _mm256_add_ps(a, _mm256_or_ps(demi, _mm256_and_ps(a, signe)));
+    __m256i i = _mm256_cvttps_epi32(a);
+    __m128i p = _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), p);
+}
+
+/** @brief Loads 8 int16 values and widens them to one float vector. */
+inline __m256 charger_ligne(const int16_t *p)
+{
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v));
+}
+
+/** @brief Forward DCT of one block; row u of the result is left in out[u]. */
+inline void dct_bloc(const int16_t *in, const float *C, const float *CT, float *tmp, __m256 out[8])
+{
+    __m256 lig[8];
+    for (int x = 0; x < 8; ++x) lig[x] = charger_ligne(in + 8 * x);
+
+    for (int u = 0; u < 8; ++u) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int x = 0; x < 8; ++x) {
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(C[u * 8 + x]), lig[x]));
+        }
+        _mm256_store_ps(tmp + u * 8, acc);
+    }
+
+    for (int u = 0; u < 8; ++u) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int y = 0; y < 8; ++y) {
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(tmp[u * 8 + y]), _mm256_loadu_ps(CT + y * 8)));
+        }
+        out[u] = acc;
+    }
+}
+
+} // namespace
+
+void dct_avx2(const int16_t *Blocs, float *DCT, size_t nbBlocs)
+{
+    alignas(32) float tmp[64];
+    __m256 lignes[8];
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        dct_bloc(Blocs + 64 * b, dct_base(), dct_base_transposed(), tmp, lignes);
+        for (int u = 0; u < 8; ++u) _mm256_storeu_ps(DCT + 64 * b + u * 8, lignes[u]);
+    }
+}
+
+void dct_quant_avx2(const int16_t *Blocs, const float *Q_inv, int16_t *Coefs, size_t nbBlocs)
+{
+    alignas(32) float tmp[64];
+    __m256 lignes[8];
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        dct_bloc(Blocs + 64 * b, dct_base(), dct_base_transposed(), tmp, lignes);
+        int16_t *out = Coefs + 64 * b;
+        for (int u = 0; u < 8; ++u) {
+            arrondir_stocker(_mm256_mul_ps(lignes[u], _mm256_loadu_ps(Q_inv + u * 8)), out + u * 8);
+        }
+    }
+}
+
+void dequant_idct_avx2(const int16_t *Coefs, const float *Q, int16_t *Blocs, size_t nbBlocs)
+{
+    const float *C = dct_base();
+    alignas(32) float tmp[64];
+
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        const int16_t *in = Coefs + 64 * b;
+        int16_t *out = Blocs + 64 * b;
+
+        __m256 F[8];
+        for (int u = 0; u < 8; ++u) F[u] = _mm256_mul_ps(charger_ligne(in + 8 * u), _mm256_loadu_ps(Q + u * 8));
+
+        for (int x = 0; x < 8; ++x) {
+            __m256 acc = _mm256_setzero_ps();
+            for (int u = 0; u < 8; ++u) {
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(C[u * 8 + x]), F[u]));
+            }
+            _mm256_store_ps(tmp + x * 8, acc);
+        }
+
+        for (int x = 0; x < 8; ++x) {
+            __m256 acc = _mm256_setzero_ps();
+            for (int v = 0; v < 8; ++v) {
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(tmp[x * 8 + v]), _mm256_loadu_ps(C + v * 8)));
+            }
+            arrondir_stocker(acc, out + x * 8);
+        }
+    }
+}
+
+#endif // JPEG_HAVE_AVX2
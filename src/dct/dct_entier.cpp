@@ -0,0 +1,214 @@
+/**
+ * @file dct_entier.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements the fixed-point (integer-only) forward and inverse DCT.
+ *
+ * Both transforms follow the Loeffler-Ligtenberg-Moschytz factorization used
+ * by the "islow" DCT of the IJG libjpeg: 12 multiplications and 32 additions
+ * per 1D pass, with constants scaled by 2^CONST_BITS and PASS1_BITS extra
+ * bits of precision kept between the two passes. Only integer additions,
+ * multiplications and arithmetic shifts are used, so the results are the same
+ * on every compiler and CPU.
+ */
+
+#include "dct/dct.h"
+
+namespace {
+
+constexpr int CONST_BITS = 13;
+constexpr int PASS1_BITS = 2;
+
+/** @brief Rounds a constant to fixed point with CONST_BITS fractional bits. */
+constexpr int32_t FIX(double x)
+{
+    return static_cast<int32_t>(x * (1 << CONST_BITS) + 0.5);
+}
+
+constexpr int32_t FIX_0_298631336 = FIX(0.298631336);
+constexpr int32_t FIX_0_390180644 = FIX(0.390180644);
+constexpr int32_t FIX_0_541196100 = FIX(0.541196100);
+constexpr int32_t FIX_0_765366865 = FIX(0.765366865);
+constexpr int32_t FIX_0_899976223 = FIX(0.899976223);
+constexpr int32_t FIX_1_175875602 = FIX(1.175875602);
+constexpr int32_t FIX_1_501321110 = FIX(1.501321110);
+constexpr int32_t FIX_1_847759065 = FIX(1.847759065);
+constexpr int32_t FIX_1_961570560 = FIX(1.961570560);
+constexpr int32_t FIX_2_053119869 = FIX(2.053119869);
+constexpr int32_t FIX_2_562915447 = FIX(2.562915447);
+constexpr int32_t FIX_3_072711026 = FIX(3.072711026);
+
+/** @brief Divides by 2^n, rounding to nearest (arithmetic shift). */
+constexpr int32_t descale(int32_t x, int n)
+{
+    return (x + (1 << (n - 1))) >> n;
+}
+
+/**
+ * @brief One forward 1D pass over 8 elements spaced by `pas`.
+ * @param d The 8 values, transformed in place.
+ * @param pas The distance between consecutive elements (1 for rows, 8 for columns).
+ * @param premier_passage True for the first (row) pass, which keeps PASS1_BITS extra bits.
+ */
+void fdct_1d(int32_t *d, int pas, bool premier_passage)
+{
+    const int dec_pair = premier_passage ? 0 : PASS1_BITS;
+    const int dec_impair = premier_passage ? CONST_BITS - PASS1_BITS : CONST_BITS + PASS1_BITS;
+
+    int32_t tmp0 = d[0 * pas] + d[7 * pas];
+    int32_t tmp7 = d[0 * pas] - d[7 * pas];
+    int32_t tmp1 = d[1 * pas] + d[6 * pas];
+    int32_t tmp6 = d[1 * pas] - d[6 * pas];
+    int32_t tmp2 = d[2 * pas] + d[5 * pas];
+    int32_t tmp5 = d[2 * pas] - d[5 * pas];
+    int32_t tmp3 = d[3 * pas] + d[4 * pas];
+    int32_t tmp4 = d[3 * pas] - d[4 * pas];
+
+    // Even part
+    int32_t tmp10 = tmp0 + tmp3;
+    int32_t tmp13 = tmp0 - tmp3;
+    int32_t tmp11 = tmp1 + tmp2;
+    int32_t tmp12 = tmp1 - tmp2;
+
+    if (premier_passage) {
+        d[0 * pas] = (tmp10 + tmp11) * (1 << PASS1_BITS);
+        d[4 * pas] = (tmp10 - tmp11) * (1 << PASS1_BITS);
+    } else {
+        d[0 * pas] = descale(tmp10 + tmp11, dec_pair);
+        d[4 * pas] = descale(tmp10 - tmp11, dec_pair);
+    }
+
+    int32_t z1 = (tmp12 + tmp13) * FIX_0_541196100;
+    d[2 * pas] = descale(z1 + tmp13 * FIX_0_765366865, dec_impair);
+    d[6 * pas] = descale(z1 - tmp12 * FIX_1_847759065, dec_impair);
+
+    // Odd part
+    z1 = tmp4 + tmp7;
+    int32_t z2 = tmp5 + tmp6;
+    int32_t z3 = tmp4 + tmp6;
+    int32_t z4 = tmp5 + tmp7;
+    int32_t z5 = (z3 + z4) * FIX_1_175875602;
+
+    tmp4 *= FIX_0_298631336;
+    tmp5 *= FIX_2_053119869;
+    tmp6 *= FIX_3_072711026;
+    tmp7 *= FIX_1_501321110;
+    z1 *= -FIX_0_899976223;
+    z2 *= -FIX_2_562915447;
+    z3 = z3 * -FIX_1_961570560 + z5;
+    z4 = z4 * -FIX_0_390180644 + z5;
+
+    d[7 * pas] = descale(tmp4 + z1 + z3, dec_impair);
+    d[5 * pas] = descale(tmp5 + z2 + z4, dec_impair);
+    d[3 * pas] = descale(tmp6 + z2 + z3, dec_impair);
+    d[1 * pas] = descale(tmp7 + z1 + z4, dec_impair);
+}
+
+/**
+ * @brief One inverse 1D pass: reads 8 elements spaced by `pas` and writes 8 contiguous results.
+ * @param in The 8 input coefficients.
+ * @param pas_in The distance between consecutive input elements.
+ * @param out The 8 outputs, spaced by pas_out.
+ * @param pas_out The distance between consecutive output elements.
+ * @param dec The final descaling shift of this pass.
+ */
+void idct_1d(const int32_t *in, int pas_in, int32_t *out, int pas_out, int dec)
+{
+    // Even part
+    int32_t z2 = in[2 * pas_in];
+    int32_t z3 = in[6 * pas_in];
+    int32_t z1 = (z2 + z3) * FIX_0_541196100;
+    int32_t tmp2 = z1 - z3 * FIX_1_847759065;
+    int32_t tmp3 = z1 + z2 * FIX_0_765366865;
+
+    z2 = in[0 * pas_in];
+    z3 = in[4 * pas_in];
+    int32_t tmp0 = (z2 + z3) * (1 << CONST_BITS);
+    int32_t tmp1 = (z2 - z3) * (1 << CONST_BITS);
+
+    int32_t tmp10 = tmp0 + tmp3;
+    int32_t tmp13 = tmp0 - tmp3;
+    int32_t tmp11 = tmp1 + tmp2;
+    int32_t tmp12 = tmp1 - tmp2;
+
+    // Odd part
+    tmp0 = in[7 * pas_in];
+    tmp1 = in[5 * pas_in];
+    tmp2 = in[3 * pas_in];
+    tmp3 = in[1 * pas_in];
+
+    z1 = tmp0 + tmp3;
+    z2 = tmp1 + tmp2;
+    z3 = tmp0 + tmp2;
+    int32_t z4 = tmp1 + tmp3;
+    int32_t z5 = (z3 + z4) * FIX_1_175875602;
+
+    tmp0 *= FIX_0_298631336;
+    tmp1 *= FIX_2_053119869;
+    tmp2 *= FIX_3_072711026;
+    tmp3 *= FIX_1_501321110;
+    z1 *= -FIX_0_899976223;
+    z2 *= -FIX_2_562915447;
+    z3 = z3 * -FIX_1_961570560 + z5;
+    z4 = z4 * -FIX_0_390180644 + z5;
+
+    tmp0 += z1 + z3;
+    tmp1 += z2 + z4;
+    tmp2 += z2 + z3;
+    tmp3 += z1 + z4;
+
+    out[0 * pas_out] = descale(tmp10 + tmp3, dec);
+    out[7 * pas_out] = descale(tmp10 - tmp3, dec);
+    out[1 * pas_out] = descale(tmp11 + tmp2, dec);
+    out[6 * pas_out] = descale(tmp11 - tmp2, dec);
+    out[2 * pas_out] = descale(tmp12 + tmp1, dec);
+    out[5 * pas_out] = descale(tmp12 - tmp1, dec);
+    out[3 * pas_out] = descale(tmp13 + tmp0, dec);
+    out[4 * pas_out] = descale(tmp13 - tmp0, dec);
+}
+
+} // namespace
+
+void Calcul_DCT_Block_Entier(const int16_t *Bloc, int32_t *DCT)
+{
+    for (int k = 0; k < 64; ++k) DCT[k] = Bloc[k];
+    for (int r = 0; r < 8; ++r) fdct_1d(DCT + 8 * r, 1, true);
+    for (int c = 0; c < 8; ++c) fdct_1d(DCT + c, 8, false);
+}
+
+void Calcul_IDCT_Block_Entier(const int32_t *DCT, int16_t *Bloc)
+{
+    int32_t ws[64];
+
+    // Pass 1: columns, keeping PASS1_BITS extra bits. Columns without AC terms are common.
+    for (int c = 0; c < 8; ++c) {
+        const int32_t *col = DCT + c;
+        if (col[8] == 0 && col[16] == 0 && col[24] == 0 && col[32] == 0 &&
+            col[40] == 0 && col[48] == 0 && col[56] == 0) {
+            const int32_t dc = col[0] * (1 << PASS1_BITS);
+            for (int r = 0; r < 8; ++r) ws[r * 8 + c] = dc;
+            continue;
+        }
+        idct_1d(col, 8, ws + c, 8, CONST_BITS - PASS1_BITS);
+    }
+
+    // Pass 2: rows, removing PASS1_BITS and the factor 8 of the 2D transform.
+    int32_t ligne[8];
+    for (int r = 0; r < 8; ++r) {
+        idct_1d(ws + 8 * r, 1, ligne, 1, CONST_BITS + PASS1_BITS + 3);
+        for (int c = 0; c < 8; ++c) {
+            int32_t v = ligne[c];
+            v = (v < -32768) ? -32768 : (v > 32767) ? 32767 : v;
+            Bloc[r * 8 + c] = static_cast<int16_t>(v);
+        }
+    }
+}
+
+int16_t Calcul_IDCT_DC_Entier(int32_t DC)
+{
+    // Pass 1 keeps dc << PASS1_BITS in every column; pass 2 multiplies by 2^CONST_BITS
+    // and descales by CONST_BITS + PASS1_BITS + 3: a rounded division by 8.
+    int32_t v = descale(DC, 3);
+    v = (v < -32768) ? -32768 : (v > 32767) ? 32767 : v;
+    return static_cast<int16_t>(v);
+}
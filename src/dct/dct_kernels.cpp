@@ -0,0 +1,115 @@
+/**
+ * @file dct_kernels.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Implements the scalar block kernels and the runtime selection of the vectorized ones.
+ */
+
+#include "dct/dct_kernels.h"
+#include "dct/dct.h"
+#include "dct_kernels_impl.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+/** @brief Quantizes one coefficient: t = x / Q, rounded half away from zero, saturated to int16_t. */
+inline int16_t quantifier(float x, float q_inv)
+{
+    float t = x * q_inv;
+    int r = static_cast<int>(t < 0.0f ? t - 0.5f : t + 0.5f);
+    r = (r < -32768) ? -32768 : (r > 32767) ? 32767 : r;
+    return static_cast<int16_t>(r);
+}
+
+void dct_scalar(const int16_t *Blocs, float *DCT, size_t nbBlocs)
+{
+    for (size_t b = 0; b < nbBlocs; ++b) Calcul_DCT_Block(Blocs + 64 * b, DCT + 64 * b);
+}
+
+void dct_quant_scalar(const int16_t *Blocs, const float *Q_inv, int16_t *Coefs, size_t nbBlocs)
+{
+    float dct[64];
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        Calcul_DCT_Block(Blocs + 64 * b, dct);
+        int16_t *out = Coefs + 64 * b;
+        for (int k = 0; k < 64; ++k) out[k] = quantifier(dct[k], Q_inv[k]);
+    }
+}
+
+void dequant_idct_scalar(const int16_t *Coefs, const float *Q, int16_t *Blocs, size_t nbBlocs)
+{
+    float dct[64];
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        const int16_t *in = Coefs + 64 * b;
+        for (int k = 0; k < 64; ++k) dct[k] = static_cast<float>(in[k]) * Q[k];
+        Calcul_IDCT_Block(dct, Blocs + 64 * b);
+    }
+}
+
+const sDctKernels kScalar = { "scalar", dct_scalar, dct_quant_scalar, dequant_idct_scalar };
+#if defined(JPEG_HAVE_SSE41)
+const sDctKernels kSse41 = { "sse4.1", dct_sse41, dct_quant_sse41, dequant_idct_sse41 };
+#endif
+#if defined(JPEG_HAVE_AVX2)
+const sDctKernels kAvx2 = { "avx2", dct_avx2, dct_quant_avx2, dequant_idct_avx2 };
+#endif
+#if defined(JPEG_HAVE_NEON)
+const sDctKernels kNeon = { "neon", dct_neon, dct_quant_neon, dequant_idct_neon };
+#endif
+
+/** @brief Checks whether the running CPU can execute the named instruction set. */
+bool cpu_supporte(const char *nom)
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (std::strcmp(nom, "sse4.1") == 0) return __builtin_cpu_supports("sse4.1");
+    if (std::strcmp(nom, "avx2") == 0) return __builtin_cpu_supports("avx2");
+#endif
+#if defined(JPEG_HAVE_NEON)
+    if (std::strcmp(nom, "neon") == 0) return true; // NEON is part of the AArch64 baseline.
+#endif
+    return std::strcmp(nom, "scalar") == 0;
+}
+
+const sDctKernels *choisir_kernels()
+{
+    if (const char *force = std::getenv("JPEG_DCT_KERNELS")) {
+        if (const sDctKernels *k = dct_kernels_by_name(force)) return k;
+    }
+    static const char *const preference[] = { "avx2", "sse4.1", "neon" };
+    for (const char *nom : preference) {
+        if (const sDctKernels *k = dct_kernels_by_name(nom)) return k;
+    }
+    return &kScalar;
+}
+
+} // namespace
+
+const sDctKernels &dct_kernels()
+{
+    static const sDctKernels *const choix = choisir_kernels();
+    return *choix;
+}
+
+const sDctKernels &dct_kernels_scalar()
+{
+    return kScalar;
+}
+
+const sDctKernels *dct_kernels_by_name(const char *nom)
+{
+    if (!nom || !cpu_supporte(nom)) return nullptr;
+    if (std::strcmp(nom, "scalar") == 0) return &kScalar;
+#if defined(JPEG_HAVE_SSE41)
+    if (std::strcmp(nom, "sse4.1") == 0) return &kSse41;
+#endif
+#if defined(JPEG_HAVE_AVX2)
+    if (std::strcmp(nom, "avx2") == 0) return &kAvx2;
+#endif
+#if defined(JPEG_HAVE_NEON)
+    if (std::strcmp(nom, "neon") == 0) return &kNeon;
+#endif
+    return nullptr;
+}
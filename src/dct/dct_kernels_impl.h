@@ -0,0 +1,44 @@
+/**
+ * @file dct_kernels_impl.h
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief Internal declarations shared by the scalar and vectorized block kernels.
+ *
+ * To stay bit-identical with the scalar reference, every implementation must
+ * evaluate the two separable passes in the same order (column pass, then row
+ * pass, accumulating k = 0..7 from zero), multiply and add separately (no
+ * fused multiply-add), and round with round_half_away() semantics.
+ */
+
+#ifndef JPEG_COMPRESSOR_DCT_KERNELS_IMPL_H
+#define JPEG_COMPRESSOR_DCT_KERNELS_IMPL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/** @brief The single-precision DCT basis C[u][x], 64 floats, row-major (defined in dct.cpp). */
+const float *dct_base();
+
+/** @brief The transposed basis, CT[x][u] = C[u][x] (defined in dct.cpp). */
+const float *dct_base_transposed();
+
+#if defined(JPEG_HAVE_SSE41)
+void dct_sse41(const int16_t *Blocs, float *DCT, size_t nbBlocs);
+void dct_quant_sse41(const int16_t *Blocs, const float *Q_inv, int16_t *Coefs, size_t nbBlocs);
+void dequant_idct_sse41(const int16_t *Coefs, const float *Q, int16_t *Blocs, size_t nbBlocs);
+#endif
+
+#if defined(JPEG_HAVE_AVX2)
+void dct_avx2(const int16_t *Blocs, float *DCT, size_t nbBlocs);
+void dct_quant_avx2(const int16_t *Blocs, const float *Q_inv, int16_t *Coefs, size_t nbBlocs);
+void dequant_idct_avx2(const int16_t *Coefs, const float *Q, int16_t *Blocs, size_t nbBlocs);
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define JPEG_HAVE_NEON 1
+void dct_neon(const int16_t *Blocs, float *DCT, size_t nbBlocs);
+void dct_quant_neon(const int16_t *Blocs, const float *Q_inv, int16_t *Coefs, size_t nbBlocs);
+void dequant_idct_neon(const int16_t *Coefs, const float *Q, int16_t *Blocs, size_t nbBlocs);
+#endif
+
+#endif // JPEG_COMPRESSOR_DCT_KERNELS_IMPL_H
@@ -0,0 +1,136 @@
+/**
+ * @file dct_neon.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief NEON block kernels (4 lanes, two registers per block row).
+ *
+ * Built only for targets where NEON is available at compile time (AArch64, or
+ * 32-bit ARM compiled with NEON enabled). Products and sums use separate
+ * vmulq/vaddq so that results match the scalar reference.
+ */
+
+#include "dct_kernels_impl.h"
+
+#if defined(JPEG_HAVE_NEON)
+
+#include <arm_neon.h>
+
+namespace {
+
+/** @brief Rounds half away from zero, converts to int32 and narrows 8 lanes to int16 with saturation. */
+inline int16x8_t arrondir_paquet(float32x4_t a, float32x4_t b)
+{
+    const uint32x4_t signe = vdupq_n_u32(0x80000000u);
+    const uint32x4_t demi = vreinterpretq_u32_f32(vdupq_n_f32(0.5f));
+    a = vaddq_f32(a, vreinterpretq_f32_u32(vorrq_u32(demi, vandq_u32(vreinterpretq_u32_f32(a), signe))));
+    b = vaddq_f32(b, vreinterpretq_f32_u32(vorrq_u32(demi, vandq_u32(vreinterpretq_u32_f32(b), signe))));
+    return vcombine_s16(vqmovn_s32(vcvtq_s32_f32(a)), vqmovn_s32(vcvtq_s32_f32(b)));
+}
+
+/** @brief Loads 8 int16 values and widens them to two float vectors. */
+inline void charger_ligne(const int16_t *p, float32x4_t &lo, float32x4_t &hi)
+{
+    int16x8_t v = vld1q_s16(p);
+    lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+    hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+}
+
+/** @brief Forward DCT of one block; row u of the result is left in out[u][0..1]. */
+inline void dct_bloc(const int16_t *in, const float *C, const float *CT, float *tmp, float32x4_t out[8][2])
+{
+    float32x4_t lig[8][2];
+    for (int x = 0; x < 8; ++x) charger_ligne(in + 8 * x, lig[x][0], lig[x][1]);
+
+    for (int u = 0; u < 8; ++u) {
+        float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+        for (int x = 0; x < 8; ++x) {
+            float32x4_t c = vdupq_n_f32(C[u * 8 + x]);
+            acc0 = vaddq_f32(acc0, vmulq_f32(c, lig[x][0]));
+            acc1 = vaddq_f32(acc1, vmulq_f32(c, lig[x][1]));
+        }
+        vst1q_f32(tmp + u * 8, acc0);
+        vst1q_f32(tmp + u * 8 + 4, acc1);
+    }
+
+    for (int u = 0; u < 8; ++u) {
+        float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+        for (int y = 0; y < 8; ++y) {
+            float32x4_t t = vdupq_n_f32(tmp[u * 8 + y]);
+            acc0 = vaddq_f32(acc0, vmulq_f32(t, vld1q_f32(CT + y * 8)));
+            acc1 = vaddq_f32(acc1, vmulq_f32(t, vld1q_f32(CT + y * 8 + 4)));
+        }
+        out[u][0] = acc0;
+        out[u][1] = acc1;
+    }
+}
+
+} // namespace
+
+void dct_neon(const int16_t *Blocs, float *DCT, size_t nbBlocs)
+{
+    float tmp[64];
+    float32x4_t lignes[8][2];
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        dct_bloc(Blocs + 64 * b, dct_base(), dct_base_transposed(), tmp, lignes);
+        for (int u = 0; u < 8; ++u) {
+            vst1q_f32(DCT + 64 * b + u * 8, lignes[u][0]);
+            vst1q_f32(DCT + 64 * b + u * 8 + 4, lignes[u][1]);
+        }
+    }
+}
+
+void dct_quant_neon(const int16_t *Blocs, const float *Q_inv, int16_t *Coefs, size_t nbBlocs)
+{
+    float tmp[64];
+    float32x4_t lignes[8][2];
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        dct_bloc(Blocs + 64 * b, dct_base(), dct_base_transposed(), tmp, lignes);
+        int16_t *out = Coefs + 64 * b;
+        for (int u = 0; u < 8; ++u) {
+            float32x4_t q0 = vmulq_f32(lignes[u][0], vld1q_f32(Q_inv + u * 8));
+            float32x4_t q1 = vmulq_f32(lignes[u][1], vld1q_f32(Q_inv + u * 8 + 4));
+            vst1q_s16(out + u * 8, arrondir_paquet(q0, q1));
+        }
+    }
+}
+
+void dequant_idct_neon(const int16_t *Coefs, const float *Q, int16_t *Blocs, size_t nbBlocs)
+{
+    const float *C = dct_base();
+    float tmp[64];
+
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        const int16_t *in = Coefs + 64 * b;
+        int16_t *out = Blocs + 64 * b;
+
+        float32x4_t F[8][2];
+        for (int u = 0; u < 8; ++u) {
+            charger_ligne(in + 8 * u, F[u][0], F[u][1]);
+            F[u][0] = vmulq_f32(F[u][0], vld1q_f32(Q + u * 8));
+            F[u][1] = vmulq_f32(F[u][1], vld1q_f32(Q + u * 8 + 4));
+        }
+
+        for (int x = 0; x < 8; ++x) {
+            float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+            for (int u = 0; u < 8; ++u) {
+                float32x4_t c = vdupq_n_f32(C[u * 8 + x]);
+                acc0 = vaddq_f32(acc0, vmulq_f32(c, F[u][0]));
+                acc1 = vaddq_f32(acc1, vmulq_f32(c, F[u][1]));
+            }
+            vst1q_f32(tmp + x * 8, acc0);
+            vst1q_f32(tmp + x * 8 + 4, acc1);
+        }
+
+        for (int x = 0; x < 8; ++x) {
+            float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+            for (int v = 0; v < 8; ++v) {
+                float32x4_t t = vdupq_n_f32(tmp[x * 8 + v]);
+                acc0 = vaddq_f32(acc0, vmulq_f32(t, vld1q_f32(C + v * 8)));
+                acc1 = vaddq_f32(acc1, vmulq_f32(t, vld1q_f32(C + v * 8 + 4)));
+            }
+            vst1q_s16(out + x * 8, arrondir_paquet(acc0, acc1));
+        }
+    }
+}
+
+#endif // JPEG_HAVE_NEON
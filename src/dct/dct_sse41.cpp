@@ -0,0 +1,138 @@
+/**
+ * @file dct_sse41.cpp
+ * @author Khanh-Phuong NGUYEN
+ * @date 2025-12-08
+ * @brief SSE4.1 block kernels (4 lanes, two registers per block row).
+ *
+ * This file is compiled with -msse4.1 and only called after a CPUID check.
+ */
+
+#include "dct_kernels_impl.h"
+
+#if defined(JPEG_HAVE_SSE41)
+
+#include <smmintrin.h>
+
+namespace {
+
+/** @brief Rounds half away from zero, converts to int32 and packs 8 lanes to int16 with saturation. */
+inline __m128i arrondir_paquet(__m128 a, __m128 b)
+{
+    const __m128 demi = _mm_set1_ps(0.5f);
+    const __m128 signe = _mm_set1_ps(-0.0f);
+    a = _mm_add_ps(a, _mm_or_ps(demi, _mm_and_ps(a, signe)));
+    b = _mm_add_ps(b, _mm_or_ps(demi, _mm_and_ps(b, signe)));
+    return _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b));
+}
+
+/** @brief Loads 8 int16 values and widens them to two float vectors. */
+inline void charger_ligne(const int16_t *p, __m128 &lo, __m128 &hi)
+{
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    lo = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(v));
+    hi = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_srli_si128(v, 8)));
+}
+
+/** @brief Forward DCT of one block; row u of the result is left in out[u][0..1]. */
+inline void dct_bloc(const int16_t *in, const float *C, const float *CT, float *tmp, __m128 out[8][2])
+{
+    __m128 lig[8][2];
+    for (int x = 0; x < 8; ++x) charger_ligne(in + 8 * x, lig[x][0], lig[x][1]);
+
+    // Column pass: tmp[u][.] = sum_x C[u][x] * B[x][.]
+    for (int u = 0; u < 8; ++u) {
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+        for (int x = 0; x < 8; ++x) {
+            __m128 c = _mm_set1_ps(C[u * 8 + x]);
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(c, lig[x][0]));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(c, lig[x][1]));
+        }
+        _mm_store_ps(tmp + u * 8, acc0);
+        _mm_store_ps(tmp + u * 8 + 4, acc1);
+    }
+
+    // Row pass: DCT[u][.] = sum_y tmp[u][y] * C[.][y]
+    for (int u = 0; u < 8; ++u) {
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+        for (int y = 0; y < 8; ++y) {
+            __m128 t = _mm_set1_ps(tmp[u * 8 + y]);
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(t, _mm_loadu_ps(CT + y * 8)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(t, _mm_loadu_ps(CT + y * 8 + 4)));
+        }
+        out[u][0] = acc0;
+        out[u][1] = acc1;
+    }
+}
+
+} // namespace
+
+void dct_sse41(const int16_t *Blocs, float *DCT, size_t nbBlocs)
+{
+    alignas(16) float tmp[64];
+    __m128 lignes[8][2];
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        dct_bloc(Blocs + 64 * b, dct_base(), dct_base_transposed(), tmp, lignes);
+        for (int u = 0; u < 8; ++u) {
+            _mm_storeu_ps(DCT + 64 * b + u * 8, lignes[u][0]);
+            _mm_storeu_ps(DCT + 64 * b + u * 8 + 4, lignes[u][1]);
+        }
+    }
+}
+
+void dct_quant_sse41(const int16_t *Blocs, const float *Q_inv, int16_t *Coefs, size_t nbBlocs)
+{
+    alignas(16) float tmp[64];
+    __m128 lignes[8][2];
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        dct_bloc(Blocs + 64 * b, dct_base(), dct_base_transposed(), tmp, lignes);
+        int16_t *out = Coefs + 64 * b;
+        for (int u = 0; u < 8; ++u) {
+            __m128 q0 = _mm_mul_ps(lignes[u][0], _mm_loadu_ps(Q_inv + u * 8));
+            __m128 q1 = _mm_mul_ps(lignes[u][1], _mm_loadu_ps(Q_inv + u * 8 + 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + u * 8), arrondir_paquet(q0, q1));
+        }
+    }
+}
+
+void dequant_idct_sse41(const int16_t *Coefs, const float *Q, int16_t *Blocs, size_t nbBlocs)
+{
+    const float *C = dct_base();
+    alignas(16) float tmp[64];
+
+    for (size_t b = 0; b < nbBlocs; ++b) {
+        const int16_t *in = Coefs + 64 * b;
+        int16_t *out = Blocs + 64 * b;
+
+        __m128 F[8][2];
+        for (int u = 0; u < 8; ++u) {
+            charger_ligne(in + 8 * u, F[u][0], F[u][1]);
+            F[u][0] = _mm_mul_ps(F[u][0], _mm_loadu_ps(Q + u * 8));
+            F[u][1] = _mm_mul_ps(F[u][1], _mm_loadu_ps(Q + u * 8 + 4));
+        }
+
+        // Column pass: tmp[x][.] = sum_u C[u][x] * F[u][.]
+        for (int x = 0; x < 8; ++x) {
+            __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+            for (int u = 0; u < 8; ++u) {
+                __m128 c = _mm_set1_ps(C[u * 8 + x]);
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(c, F[u][0]));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(c, F[u][1]));
+            }
+            _mm_store_ps(tmp + x * 8, acc0);
+            _mm_store_ps(tmp + x * 8 + 4, acc1);
+        }
+
+        // Row pass: B[x][.] = sum_v tmp[x][v] * C[v][.]
+        for (int x = 0; x < 8; ++x) {
+            __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+            for (int v = 0; v < 8; ++v) {
+                __m128 t = _mm_set1_ps(tmp[x * 8 + v]);
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(t, _mm_loadu_ps(C + v * 8)));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(t, _mm_loadu_ps(C + v * 8 + 4)));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 8), arrondir_paquet(acc0, acc1));
+        }
+    }
+}
+
+#endif // JPEG_HAVE_SSE41
@@ -28,18 +28,41 @@ static const int Q_LUMINANCE[8][8] = {
     {72, 92, 95, 98,112,100,103, 99}
 };
 
+/**
+ * @brief The standard JPEG chrominance quantization table (ISO/ITU recommendation, table K.2).
+ */
+static const int Q_CHROMINANCE[8][8] = {
+    {17, 18, 24, 47, 99, 99, 99, 99},
+    {18, 21, 26, 66, 99, 99, 99, 99},
+    {24, 26, 56, 99, 99, 99, 99, 99},
+    {47, 66, 99, 99, 99, 99, 99, 99},
+    {99, 99, 99, 99, 99, 99, 99, 99},
+    {99, 99, 99, 99, 99, 99, 99, 99},
+    {99, 99, 99, 99, 99, 99, 99, 99},
+    {99, 99, 99, 99, 99, 99, 99, 99}
+};
+
+const int ZIGZAG[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
 /**
  * @brief (Helper) Calculates a scaled 8x8 quantization table from a quality value.
  * @note "calculer" is French for "calculate".
  *
  * This function applies the standard JPEG formula to map a quality value (1-100)
  * to a scaling factor (`lambda`). This factor is then used to scale the baseline
- * `Q_LUMINANCE` table. The final table values are clamped to the range [1, 255].
+ * baseline table. The final table values are clamped to the range [1, 255].
  *
  * @param[out] Q_tab The 8x8 output table to be filled with scaled quantization values.
  * @param[in] qualite The quality setting, from 1 to 100.
+ * @param[in] base The baseline table to scale (Q_LUMINANCE or Q_CHROMINANCE).
  */
-static void calculer_q_table(int Q_tab[8][8], unsigned int qualite) {
+static void calculer_q_table(int Q_tab[8][8], unsigned int qualite, const int base[8][8]) {
+    qualite = (qualite < 1) ? 1 : (qualite > 100) ? 100 : qualite;
     double lambda;
     if (qualite < 50) {
         lambda = 5000.0 / qualite;
@@ -49,44 +72,162 @@ static void calculer_q_table(int Q_tab[8][8], unsigned int qualite) {
 
     for (int i = 0; i < 8; ++i) {
         for (int j = 0; j < 8; ++j) {
-            double val = std::floor((Q_LUMINANCE[i][j] * lambda + 50.0) / 100.0);
+            double val = std::floor((base[i][j] * lambda + 50.0) / 100.0);
             Q_tab[i][j] = static_cast<int>(std::max(1.0, std::min(255.0, val)));
         }
     }
 }
 
-void build_Q_table(int Qtab[8][8]) {
-    // Fetches the global quality setting to build the table.
+/**
+ * @brief (Helper) Rounds half away from zero and saturates to int16_t, like the block kernels.
+ */
+static inline int16_t arrondir_int16(float t) {
+    int r = static_cast<int>(t < 0.0f ? t - 0.5f : t + 0.5f);
+    r = (r < -32768) ? -32768 : (r > 32767) ? 32767 : r;
+    return static_cast<int16_t>(r);
+}
+
+/**
+ * @brief (Helper) Returns this thread's context for the global quality, rebuilding it only when the quality changed.
+ */
+static const cContexteQuant &contexte_global() {
+    thread_local cContexteQuant ctx(cCompression::getQualiteGlobale());
     unsigned int qualite = cCompression::getQualiteGlobale();
-    calculer_q_table(Qtab, qualite);
+    if (ctx.getQualite() != qualite) ctx.setQualite(qualite);
+    return ctx;
 }
 
-void quant_JPEG(double** img_DCT, int** Img_Quant) {
-    // 1. Build the appropriate quantization table for the current global quality.
+cContexteQuant::cContexteQuant(unsigned int qualite, eComposante composante, bool transposee)
+{
+    this->mComposante = composante;
+    this->mTransposee = transposee;
+    setQualite(qualite);
+}
+
+void cContexteQuant::setQualite(unsigned int qualite)
+{
+    this->mQualite = (qualite < 1) ? 1 : (qualite > 100) ? 100 : qualite;
+
     int Q_tab[8][8];
-    build_Q_table(Q_tab);
+    build_Q_table(Q_tab, this->mQualite, this->mComposante);
+    for (int k = 0; k < 64; ++k) {
+        this->mQ[k] = this->mTransposee ? Q_tab[k % 8][k / 8] : Q_tab[k / 8][k % 8];
+        this->mQf[k] = static_cast<float>(this->mQ[k]);
+        this->mQinv[k] = 1.0f / this->mQf[k];
+        this->mQinvD[k] = 1.0 / static_cast<double>(this->mQ[k]);
+    }
+    for (int k = 0; k < 64; ++k) {
+        this->mQinvZigzag[k] = this->mQinv[ZIGZAG[k]];
+
+        // Divisor of the fixed-point path: the integer DCT output is scaled by 8.
+        const uint32_t d = 8u * static_cast<uint32_t>(this->mQ[ZIGZAG[k]]);
+        unsigned int log2_d = 0;
+        while ((1u << log2_d) < d) ++log2_d;
+        const unsigned int s = 16 + log2_d;
+        this->mDecalageZigzag[k] = static_cast<uint8_t>(s);
+        this->mRecipZigzag[k] = static_cast<uint32_t>(((uint64_t(1) << s) + d - 1) / d);
+    }
+}
+
+unsigned int cContexteQuant::getQualite() const
+{
+    return this->mQualite;
+}
+
+eComposante cContexteQuant::getComposante() const
+{
+    return this->mComposante;
+}
+
+bool cContexteQuant::getTransposee() const
+{
+    return this->mTransposee;
+}
+
+const int *cContexteQuant::getTable() const
+{
+    return this->mQ;
+}
 
-    // 2. Perform element-wise division and round to the nearest integer.
+const float *cContexteQuant::getTableF() const
+{
+    return this->mQf;
+}
+
+const float *cContexteQuant::getInverses() const
+{
+    return this->mQinv;
+}
+
+uint64_t cContexteQuant::quantifier_zigzag(const float *DCT, int16_t *Zigzag) const
+{
+    uint64_t masque = 0;
+    for (int k = 0; k < 64; ++k) {
+        Zigzag[k] = arrondir_int16(DCT[ZIGZAG[k]] * this->mQinvZigzag[k]);
+        masque |= static_cast<uint64_t>(Zigzag[k] != 0) << k;
+    }
+    return masque;
+}
+
+uint64_t cContexteQuant::quantifier_zigzag_entier(const int32_t *DCT8, int16_t *Zigzag) const
+{
+    uint64_t masque = 0;
+    for (int k = 0; k < 64; ++k) {
+        const int32_t x = DCT8[ZIGZAG[k]];
+        // (|x| + d/2) / d with d = 8Q, where d/2 = 4Q.
+        uint32_t n = static_cast<uint32_t>(x < 0 ? -x : x) + 4u * static_cast<uint32_t>(this->mQ[ZIGZAG[k]]);
+        uint32_t q = static_cast<uint32_t>((static_cast<uint64_t>(n) * this->mRecipZigzag[k]) >> this->mDecalageZigzag[k]);
+        if (q > 32767u) q = 32767u;
+        Zigzag[k] = static_cast<int16_t>(x < 0 ? -static_cast<int32_t>(q) : static_cast<int32_t>(q));
+        masque |= static_cast<uint64_t>(q != 0) << k;
+    }
+    return masque;
+}
+
+void cContexteQuant::quantifier(double **img_DCT, int **Img_Quant) const
+{
     for (int i = 0; i < 8; ++i) {
         for (int j = 0; j < 8; ++j) {
-            Img_Quant[i][j] = static_cast<int>(std::round(img_DCT[i][j] / Q_tab[i][j]));
+            Img_Quant[i][j] = static_cast<int>(std::round(img_DCT[i][j] * this->mQinvD[i * 8 + j]));
         }
     }
 }
 
-void dequant_JPEG(int** Img_Quant, double** img_DCT) {
-    // 1. Build the same quantization table used for compression.
-    int Q_tab[8][8];
-    build_Q_table(Q_tab);
-
-    // 2. Perform element-wise multiplication.
+void cContexteQuant::dequantifier(int **Img_Quant, double **img_DCT) const
+{
     for (int i = 0; i < 8; ++i) {
         for (int j = 0; j < 8; ++j) {
-            img_DCT[i][j] = Img_Quant[i][j] * Q_tab[i][j];
+            img_DCT[i][j] = Img_Quant[i][j] * this->mQ[i * 8 + j];
         }
     }
 }
 
+void build_Q_table(int Qtab[8][8]) {
+    // Fetches the global quality setting to build the table.
+    unsigned int qualite = cCompression::getQualiteGlobale();
+    calculer_q_table(Qtab, qualite, Q_LUMINANCE);
+}
+
+void build_Q_table(int Qtab[8][8], unsigned int qualite, eComposante composante) {
+    calculer_q_table(Qtab, qualite, (composante == COMPOSANTE_CHROMA) ? Q_CHROMINANCE : Q_LUMINANCE);
+}
+
+void quant_JPEG(double** img_DCT, int** Img_Quant) {
+    contexte_global().quantifier(img_DCT, Img_Quant);
+}
+
+void dequant_JPEG(int** Img_Quant, double** img_DCT) {
+    contexte_global().dequantifier(Img_Quant, img_DCT);
+}
+
+void quant_JPEG(double** img_DCT, int** Img_Quant, const cContexteQuant &ctx) {
+    ctx.quantifier(img_DCT, Img_Quant);
+}
+
+void dequant_JPEG(int** Img_Quant, double** img_DCT, const cContexteQuant &ctx) {
+    ctx.dequantifier(Img_Quant, img_DCT);
+}
+
 double EQM(int **Bloc8x8) {
     // Note: This implementation calculates the mean square value of the input block,
     // not the mean squared error between two blocks.
@@ -0,0 +1,13 @@
+#ifndef JPEG_COMPRESSOR_TESTS_MOTIF_H
+#define JPEG_COMPRESSOR_TESTS_MOTIF_H
+
+#include <cmath>
+
+// The test image: a wave across the image, different for each color channel
+// c (c = 0 is the grayscale image). With frequence below 1 the wave is
+// smoother, for tests that compare against a downscaled image.
+inline unsigned char motif(unsigned int x, unsigned int y, unsigned int c = 0, double frequence = 1.0) {
+    return static_cast<unsigned char>(128 + 60 * std::sin(x * 0.1 * frequence * (c + 1)) * std::cos(y * 0.07 * frequence) + c * 20);
+}
+
+#endif // JPEG_COMPRESSOR_TESTS_MOTIF_H
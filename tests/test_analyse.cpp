@@ -0,0 +1,105 @@
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "core/cCompression.h"
+#include "core/cContexteCodec.h"
+#include "motif.h"
+
+int main() {
+    bool ok = true;
+    const unsigned int w = 72, h = 56;
+    std::vector<unsigned char> pixels(static_cast<size_t>(w) * h);
+    std::vector<unsigned char*> lignes(h);
+    for (unsigned int y = 0; y < h; ++y) {
+        lignes[y] = pixels.data() + static_cast<size_t>(y) * w;
+        for (unsigned int x = 0; x < w; ++x) lignes[y][x] = motif(x, y);
+    }
+
+    const eModePipeline modes[] = { PIPELINE_FLOTTANT, PIPELINE_ENTIER };
+    const unsigned int threads[] = { 1, 3 };
+    for (eModePipeline mode : modes) {
+        for (unsigned int n : threads) {
+            cCompression codec(w, h, 50, lignes.data());
+            codec.setContexte(std::make_shared<cContexteCodec>(50));
+            codec.setModePipeline(mode);
+            codec.setNbThreads(n);
+            codec.setIntervalleRestart(5);
+
+            // The trame coded from the analysis is the one RLE() codes from the pixels.
+            sAnalyseImage analyse;
+            std::vector<signed char> direct, partage;
+            if (!codec.Analyse_Image(analyse)) {
+                std::cerr << "analysis failed\n";
+                return 1;
+            }
+            codec.RLE(direct);
+            codec.RLE(analyse, partage);
+            if (direct != partage) {
+                std::cerr << "mode " << mode << ", " << n << " threads: RLE from the analysis differs\n";
+                ok = false;
+            }
+
+            // The reconstruction is what the decoder produces.
+            std::vector<unsigned char> fichier, decode(pixels.size());
+            codec.Compression_JPEG(direct, fichier);
+            cCompression lecteur;
+            lecteur.setModePipeline(mode);
+            if (!lecteur.Decompression_JPEG(fichier.data(), fichier.size(), decode.data(), w, w, h)
+                || decode != analyse.reconstruction) {
+                std::cerr << "mode " << mode << ", " << n << " threads: reconstruction differs from the decoder\n";
+                ok = false;
+            }
+
+            // Image totals against a direct computation, and the block entry point on every block.
+            uint64_t somme = 0;
+            for (size_t i = 0; i < pixels.size(); ++i) {
+                const int d = static_cast<int>(pixels[i]) - decode[i];
+                somme += static_cast<uint64_t>(d * d);
+            }
+            double eqmBlocs = 0.0, tauxBlocs = 0.0;
+            for (unsigned int by = 0; by < h / 8; ++by) {
+                for (unsigned int bx = 0; bx < w / 8; ++bx) {
+                    int bloc[8][8]; int *ptrs[8];
+                    for (int r = 0; r < 8; ++r) {
+                        ptrs[r] = bloc[r];
+                        for (int c = 0; c < 8; ++c) bloc[r][c] = lignes[by * 8 + r][bx * 8 + c];
+                    }
+                    sAnalyseBloc a;
+                    codec.Analyse_Bloc(ptrs, a);
+                    eqmBlocs += a.eqm;
+                    tauxBlocs += a.tauxZeros;
+                    const int16_t *zz = analyse.coefficients.data() + (static_cast<size_t>(by) * (w / 8) + bx) * 64;
+                    for (int k = 0; k < 64; ++k) if (a.zigzag[k] != zz[k]) ok = false;
+                    for (int r = 0; r < 8; ++r)
+                        for (int c = 0; c < 8; ++c)
+                            if (a.reconstruit[r * 8 + c] != decode[(by * 8 + r) * w + bx * 8 + c]) ok = false;
+                    if (codec.EQM(ptrs) != a.eqm || codec.Taux_Compression(ptrs) != a.tauxZeros) ok = false;
+                }
+            }
+            const double nb = static_cast<double>(analyse.nbBlocs());
+            if (analyse.sommeErreurs != somme || std::fabs(eqmBlocs / nb - analyse.eqm()) > 1e-9
+                || std::fabs(tauxBlocs / nb - analyse.tauxZeros()) > 1e-9) {
+                std::cerr << "mode " << mode << ": image totals disagree with the blocks\n";
+                ok = false;
+            }
+            if (!(analyse.psnr() > 20.0 && analyse.psnr() < 60.0)) {
+                std::cerr << "implausible PSNR " << analyse.psnr() << "\n";
+                ok = false;
+            }
+        }
+    }
+    if (!ok) std::cerr << "the block and image analyses disagree\n";
+
+    // Sizes that are not a multiple of 8 are refused.
+    cCompression impair(w - 1, h, 50, lignes.data());
+    sAnalyseImage vide;
+    if (impair.Analyse_Image(vide) || vide.nbBlocs() != 0 || vide.psnr() != 0.0) {
+        std::cerr << "a size that is not a multiple of 8 must be refused\n";
+        ok = false;
+    }
+
+    if (!ok) return 1;
+    std::cout << "test_analyse passed\n";
+    return 0;
+}
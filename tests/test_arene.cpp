@@ -0,0 +1,128 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include "core/cArene.h"
+#include "core/cCompression.h"
+#include "core/cCompressionCouleur.h"
+#include "motif.h"
+
+// Every heap allocation of the process goes through these, so the steady state can be checked.
+static size_t g_allocations = 0;
+
+void *operator new(size_t n) {
+    ++g_allocations;
+    if (void *p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+int main() {
+    bool ok = true;
+
+    // Bump allocator: alignment, marks, and one chunk after a call that needed several.
+    {
+        cArene arene;
+        cPorteeArene portee(arene);
+        char *a = arene.allouer<char>(3);
+        double *d = arene.allouer<double>(5);
+        if (!a || reinterpret_cast<uintptr_t>(d) % alignof(double) != 0) {
+            std::cerr << "misaligned arena allocation\n";
+            ok = false;
+        }
+        const cArene::sMarque m = arene.marquer();
+        arene.allouer(3 * cArene::kTailleBlocMin);
+        arene.revenir(m);
+        if (arene.allouer<char>(1) != reinterpret_cast<char*>(d + 5)) {
+            std::cerr << "revenir() did not release the later allocations\n";
+            ok = false;
+        }
+        arene.revenir(cArene::sMarque{ 0, 0 });
+        const size_t avant = arene.getNbAllocations();
+        arene.allouer(3 * cArene::kTailleBlocMin);
+        if (arene.getNbAllocations() != avant) {
+            std::cerr << "the merged chunk should hold the same request\n";
+            ok = false;
+        }
+    }
+
+    // Grayscale: RLE + in-memory Compression_JPEG, then decode into a caller buffer.
+    const unsigned int w = 48, h = 40;
+    std::vector<unsigned char> pixels(static_cast<size_t>(w) * h);
+    std::vector<unsigned char*> lignes(h);
+    for (unsigned int y = 0; y < h; ++y) {
+        lignes[y] = pixels.data() + static_cast<size_t>(y) * w;
+        for (unsigned int x = 0; x < w; ++x) lignes[y][x] = motif(x, y, 0);
+    }
+    cCompression gris(w, h, 60, lignes.data());
+    gris.setIntervalleRestart(6);
+    std::vector<signed char> trame;
+    std::vector<unsigned char> fichier;
+    const size_t pas = w + 5;
+    std::vector<unsigned char> image(pas * h);
+    cCompression lecteur;
+
+    // Color: in-memory container with a padded stride, in and out.
+    const unsigned int cw = 45, ch = 29;
+    const size_t pasRGB = cw * 3 + 4;
+    std::vector<unsigned char> rgb(pasRGB * ch);
+    for (unsigned int y = 0; y < ch; ++y)
+        for (unsigned int x = 0; x < cw * 3; ++x) rgb[y * pasRGB + x] = motif(x / 3, y, x % 3);
+    cCompressionCouleur couleur;
+    std::vector<unsigned char> conteneur;
+    std::vector<unsigned char> sortieRGB(pasRGB * ch);
+
+    auto passe = [&](unsigned int mode) {
+        gris.RLE(trame);
+        gris.Compression_JPEG(trame, fichier);
+        bool r = lecteur.Decompression_JPEG(fichier.data(), fichier.size(), image.data(), pas, w, h);
+        r = couleur.CompressRGB(rgb.data(), cw, ch, pasRGB, 75, mode, conteneur) && r;
+        return couleur.DecompressToRGB(conteneur.data(), conteneur.size(), sortieRGB.data(), pasRGB, cw, ch) && r;
+    };
+
+    const unsigned int modes[3] = { 444, 420, 422 };
+    for (unsigned int m : modes) ok = passe(m) && ok; // warm-up: the arenas grow to the largest mode
+    for (unsigned int m : modes) {
+        const size_t avant = g_allocations;
+        if (!passe(m)) {
+            std::cerr << "in-memory round trip failed for mode " << m << "\n";
+            ok = false;
+        }
+        if (g_allocations != avant) {
+            std::cerr << (g_allocations - avant) << " heap allocations in a warm call (mode " << m << ")\n";
+            ok = false;
+        }
+    }
+
+    // Same bytes and pixels as the file and row-pointer APIs.
+    gris.Compression_JPEG(trame, "tmp_arene.huff");
+    unsigned char **rows = lecteur.Decompression_JPEG("tmp_arene.huff");
+    unsigned int lw = 0, lh = 0;
+    if (!rows || !cCompression::LireDimensions(fichier.data(), fichier.size(), lw, lh) || lw != w || lh != h) {
+        std::cerr << "grayscale file API or LireDimensions() mismatch\n";
+        ok = false;
+    } else {
+        for (unsigned int y = 0; y < h; ++y)
+            for (unsigned int x = 0; x < w; ++x)
+                if (rows[y][x] != image[y * pas + x]) ok = false;
+        if (!ok) std::cerr << "decode into buffer differs from Decompression_JPEG(file)\n";
+    }
+    if (rows) { delete[] rows[0]; delete[] rows; }
+    if (lecteur.Decompression_JPEG(fichier.data(), fichier.size(), image.data(), pas, w - 1, h)) {
+        std::cerr << "a buffer too small must be refused\n";
+        ok = false;
+    }
+    if (!cCompressionCouleur::LireDimensions(conteneur.data(), conteneur.size(), lw, lh) || lw != cw || lh != ch) {
+        std::cerr << "container LireDimensions() mismatch\n";
+        ok = false;
+    }
+
+    if (!ok) return 1;
+    std::cout << "test_arene passed\n";
+    return 0;
+}
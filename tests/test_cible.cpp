@@ -0,0 +1,134 @@
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "core/cCompression.h"
+#include "core/cCompressionCouleur.h"
+#include "core/cContexteCodec.h"
+#include "motif.h"
+
+int main() {
+    bool ok = true;
+
+    // Grayscale: the file is the plain encoding at the chosen quality, and the next quality does not fit.
+    const unsigned int w = 96, h = 64;
+    std::vector<unsigned char> pixels(static_cast<size_t>(w) * h);
+    std::vector<unsigned char*> lignes(h);
+    for (unsigned int y = 0; y < h; ++y) {
+        lignes[y] = pixels.data() + static_cast<size_t>(y) * w;
+        for (unsigned int x = 0; x < w; ++x) lignes[y][x] = motif(x, y, 0);
+    }
+    const eModePipeline modes[] = { PIPELINE_FLOTTANT, PIPELINE_ENTIER };
+    const unsigned int intervalles[] = { 0, 7 };
+    for (eModePipeline mode : modes) {
+        for (unsigned int intervalle : intervalles) {
+            cCompression codec(w, h, 50, lignes.data());
+            codec.setContexte(std::make_shared<cContexteCodec>(50));
+            codec.setModePipeline(mode);
+            codec.setIntervalleRestart(intervalle);
+            codec.setNbThreads(2);
+
+            auto encoder = [&](unsigned int q, std::vector<unsigned char> &fichier) {
+                cCompression direct(w, h, q, lignes.data());
+                direct.setContexte(std::make_shared<cContexteCodec>(q));
+                direct.setModePipeline(mode);
+                direct.setIntervalleRestart(intervalle);
+                std::vector<signed char> trame;
+                direct.RLE(trame);
+                direct.Compression_JPEG(trame, fichier);
+            };
+
+            std::vector<unsigned char> fichier, attendu, suivant;
+            sResultatCible r;
+            const double budget = 2500;
+            if (!codec.Compression_Cible(CIBLE_TAILLE, budget, fichier, &r) || !r.atteinte) {
+                std::cerr << "size target failed\n";
+                return 1;
+            }
+            encoder(r.qualite, attendu);
+            encoder(r.qualite + 1, suivant);
+            if (fichier != attendu || r.taille != fichier.size() || fichier.size() > budget
+                || (r.qualite < 100 && suivant.size() <= budget) || codec.getContexte().getQualite() != 50) {
+                std::cerr << "mode " << mode << ", interval " << intervalle << ": size target gave q=" << r.qualite
+                          << " (" << fichier.size() << " bytes, estimated " << r.taille << ")\n";
+                ok = false;
+            }
+
+            // PSNR: the estimate is close to the PSNR of the reconstruction.
+            if (!codec.Compression_Cible(CIBLE_PSNR, 36.0, fichier, &r) || !r.atteinte || r.psnr < 36.0) {
+                std::cerr << "PSNR target failed\n";
+                ok = false;
+            }
+            cCompression mesure(w, h, r.qualite, lignes.data());
+            mesure.setContexte(std::make_shared<cContexteCodec>(r.qualite));
+            mesure.setModePipeline(mode);
+            sAnalyseImage analyse;
+            mesure.Analyse_Image(analyse);
+            encoder(r.qualite, attendu);
+            if (std::fabs(analyse.psnr() - r.psnr) > 0.1 || fichier != attendu) {
+                std::cerr << "mode " << mode << ": q=" << r.qualite << ", PSNR estimated " << r.psnr << ", measured " << analyse.psnr() << "\n";
+                ok = false;
+            }
+        }
+    }
+
+    // Unreachable targets fall back to the closest quality.
+    {
+        cCompression codec(w, h, 50, lignes.data());
+        codec.setContexte(std::make_shared<cContexteCodec>(50));
+        std::vector<unsigned char> fichier;
+        sResultatCible r;
+        codec.Compression_Cible(CIBLE_TAILLE, 10, fichier, &r);
+        if (r.atteinte || r.qualite != 1 || fichier.size() != r.taille) {
+            std::cerr << "an impossible size must encode at quality 1\n";
+            ok = false;
+        }
+        codec.Compression_Cible(CIBLE_PSNR, 200.0, fichier, &r);
+        if (r.atteinte || r.qualite != 100 || r.essais > 8) {
+            std::cerr << "an impossible PSNR must encode at quality 100\n";
+            ok = false;
+        }
+    }
+
+    // Color: the container is CompressRGB() at the chosen quality, on every subsampling and thread count.
+    const unsigned int cw = 75, ch = 53;
+    std::vector<unsigned char> rgb(static_cast<size_t>(cw) * ch * 3);
+    for (unsigned int y = 0; y < ch; ++y)
+        for (unsigned int x = 0; x < cw * 3; ++x) rgb[y * cw * 3 + x] = motif(x / 3, y, x % 3);
+    const unsigned int sousEch[] = { 444, 422, 420 };
+    const unsigned int threads[] = { 1, 3 };
+    for (eModePipeline mode : modes) {
+        for (unsigned int m : sousEch) {
+            for (unsigned int n : threads) {
+                cCompressionCouleur couleur;
+                couleur.setModePipeline(mode);
+                couleur.setNbThreads(n);
+                std::vector<unsigned char> conteneur, attendu, suivant;
+                sResultatCible r;
+                const double budget = 3000;
+                if (!couleur.CompressRGBCible(rgb.data(), cw, ch, cw * 3, m, CIBLE_TAILLE, budget, conteneur, &r)) {
+                    std::cerr << "color size target failed\n";
+                    return 1;
+                }
+                couleur.CompressRGB(rgb.data(), cw, ch, cw * 3, r.qualite, m, attendu);
+                couleur.CompressRGB(rgb.data(), cw, ch, cw * 3, r.qualite + 1, m, suivant);
+                if (!r.atteinte || conteneur != attendu || r.taille != conteneur.size() || conteneur.size() > budget
+                    || (r.qualite < 100 && suivant.size() <= budget)) {
+                    std::cerr << "color " << m << ", mode " << mode << ", " << n << " threads: q=" << r.qualite << " ("
+                              << conteneur.size() << " bytes, estimated " << r.taille << ")\n";
+                    ok = false;
+                }
+                couleur.CompressRGBCible(rgb.data(), cw, ch, cw * 3, m, CIBLE_PSNR, 38.0, conteneur, &r);
+                couleur.CompressRGB(rgb.data(), cw, ch, cw * 3, r.qualite, m, attendu);
+                if (!r.atteinte || r.psnr < 38.0 || conteneur != attendu) {
+                    std::cerr << "color PSNR target failed\n";
+                    ok = false;
+                }
+            }
+        }
+    }
+
+    if (!ok) return 1;
+    std::cout << "test_cible passed\n";
+    return 0;
+}
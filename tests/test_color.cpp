@@ -4,16 +4,81 @@
 #include <string>
 #include <sys/stat.h>
 #include <cstdio>
+#include <iterator>
+#include <vector>
+#include <cstdint>
+#include <memory>
 #include "core/cCompressionCouleur.h"
+#include "core/cThreadPool.h"
 
 static bool file_exists(const std::string &path) {
     struct stat buf;
     return (stat(path.c_str(), &buf) == 0);
 }
 
+// Reads a whole file (empty if missing).
+static std::string read_file(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+// Reads a P6 file into w, h and rgb (false on failure).
+static bool read_ppm(const std::string &path, unsigned int &w, unsigned int &h, std::vector<unsigned char> &rgb) {
+    std::ifstream in(path, std::ios::binary);
+    std::string magic;
+    unsigned int maxv = 0;
+    if (!(in >> magic >> w >> h >> maxv) || magic != "P6") return false;
+    in.get();
+    rgb.resize(static_cast<size_t>(w) * h * 3);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(rgb.data()), static_cast<std::streamsize>(rgb.size())));
+}
+
+// Mean squared error between two PPM files of the same size (-1 on failure).
+static double ppm_mse(const std::string &a, const std::string &b) {
+    unsigned int wa = 0, ha = 0, wb = 0, hb = 0;
+    std::vector<unsigned char> da, db;
+    if (!read_ppm(a, wa, ha, da) || !read_ppm(b, wb, hb, db) || wa != wb || ha != hb) return -1.0;
+    double mse = 0.0;
+    for (size_t i = 0; i < da.size(); ++i) {
+        double d = static_cast<double>(da[i]) - db[i];
+        mse += d * d;
+    }
+    return mse / static_cast<double>(da.size());
+}
+
+// Writes a 16x16 image in the former layout, one plane per file, and decodes it.
+static bool legacy_round_trip(cCompressionCouleur &cc) {
+    const unsigned int W = 16, H = 16;
+    const char *plans[3] = { "tmp_legacy_Y.huff", "tmp_legacy_Cb.huff", "tmp_legacy_Cr.huff" };
+    const unsigned char valeurs[3] = { 150, 90, 200 };
+    for (int p = 0; p < 3; ++p) {
+        std::vector<unsigned char> pixels(W * H);
+        for (unsigned int i = 0; i < W * H; ++i) pixels[i] = static_cast<unsigned char>(valeurs[p] + (p == 0 ? i % 16 : 0));
+        std::vector<unsigned char*> rows(H);
+        for (unsigned int y = 0; y < H; ++y) rows[y] = pixels.data() + y * W;
+        cCompression enc(W, H, 50, rows.data());
+        std::vector<signed char> trame;
+        enc.RLE(trame);
+        enc.Compression_JPEG(trame, plans[p]);
+    }
+    {
+        std::ofstream m("tmp_legacy.meta", std::ios::binary);
+        const uint32_t meta[6] = { W, H, W, H, 444, 50 };
+        m.write(reinterpret_cast<const char*>(meta), sizeof(meta));
+    }
+    bool ok = cc.DecompressToPPM("tmp_legacy", "tmp_legacy.ppm");
+    unsigned int w = 0, h = 0;
+    std::vector<unsigned char> rgb;
+    ok = ok && read_ppm("tmp_legacy.ppm", w, h, rgb) && w == W && h == H;
+    for (int p = 0; p < 3; ++p) std::remove(plans[p]);
+    std::remove("tmp_legacy.meta");
+    std::remove("tmp_legacy.ppm");
+    return ok;
+}
+
 int main() {
     const char *input_ppm = "lenna_color.ppm";
-    const std::string basename = "tmp_test_color";
+    const std::string outfile = "tmp_test_color.hufc";
     const std::string outppm = "tmp_decomp_color.ppm";
 
     if (!file_exists(input_ppm)) {
@@ -25,33 +90,27 @@ int main() {
     unsigned int quality = 50;
     unsigned int subsampling = 444; // 4:4:4
 
-    bool ok = cc.CompressPPM(input_ppm, basename.c_str(), quality, subsampling);
+    bool ok = cc.CompressPPM(input_ppm, outfile.c_str(), quality, subsampling);
     if (!ok) {
         std::cerr << "CompressPPM failed" << std::endl;
         return 1;
     }
 
-    const std::string yfile = basename + "_Y.huff";
-    const std::string cbfile = basename + "_Cb.huff";
-    const std::string crfile = basename + "_Cr.huff";
-    const std::string metafile = basename + ".meta";
-
-    if (!file_exists(yfile) || !file_exists(cbfile) || !file_exists(crfile) || !file_exists(metafile)) {
-        std::cerr << "Missing output files after compression" << std::endl;
+    if (!file_exists(outfile)) {
+        std::cerr << "Missing output file after compression" << std::endl;
         return 1;
     }
 
-    bool ok2 = cc.DecompressToPPM(basename.c_str(), outppm.c_str());
+    bool ok2 = cc.DecompressToPPM(outfile.c_str(), outppm.c_str());
     if (!ok2) {
         std::cerr << "DecompressToPPM failed" << std::endl;
-        // try to cleanup what we can
-        std::remove(yfile.c_str()); std::remove(cbfile.c_str()); std::remove(crfile.c_str()); std::remove(metafile.c_str());
+        std::remove(outfile.c_str());
         return 1;
     }
 
     if (!file_exists(outppm)) {
         std::cerr << "Decompressed PPM not produced" << std::endl;
-        std::remove(yfile.c_str()); std::remove(cbfile.c_str()); std::remove(crfile.c_str()); std::remove(metafile.c_str());
+        std::remove(outfile.c_str());
         return 1;
     }
 
@@ -74,12 +133,67 @@ int main() {
         return 1;
     }
 
-    // Cleanup generated files
-    std::remove(yfile.c_str());
-    std::remove(cbfile.c_str());
-    std::remove(crfile.c_str());
-    std::remove(metafile.c_str());
+    // The reconstruction must stay close to the original.
+    double mse = ppm_mse(input_ppm, outppm);
+    std::cout << "Container 4:4:4 q50: MSE=" << mse << std::endl;
+    std::remove(outfile.c_str());
     std::remove(outppm.c_str());
+    if (mse < 0.0 || mse > 60.0) {
+        std::cerr << "Decoded image is too far from the original" << std::endl;
+        return 1;
+    }
+
+    // The single-pass path only changes the Huffman tables, so it must
+    // decode to exactly the same image.
+    for (unsigned int mode : {444u, 422u, 420u}) {
+        const std::string outRef = "tmp_decomp_color_ref.ppm";
+        const std::string outFlux = "tmp_decomp_color_flux.ppm";
+        bool okMode = cc.CompressPPM(input_ppm, outfile.c_str(), quality, mode) &&
+                      cc.DecompressToPPM(outfile.c_str(), outRef.c_str()) &&
+                      cc.CompressPPMFlux(input_ppm, outfile.c_str(), quality, mode) &&
+                      cc.DecompressToPPM(outfile.c_str(), outFlux.c_str());
+        if (okMode) {
+            std::ifstream fa(outRef, std::ios::binary), fb(outFlux, std::ios::binary);
+            std::string da((std::istreambuf_iterator<char>(fa)), std::istreambuf_iterator<char>());
+            std::string db((std::istreambuf_iterator<char>(fb)), std::istreambuf_iterator<char>());
+            okMode = !da.empty() && da == db;
+        }
+        if (okMode) {
+            double m = ppm_mse(input_ppm, outRef);
+            std::cout << "Container " << mode << " q50: MSE=" << m << std::endl;
+            okMode = m >= 0.0 && m < 80.0;
+        }
+        std::remove(outfile.c_str());
+        std::remove(outRef.c_str()); std::remove(outFlux.c_str());
+        if (!okMode) {
+            std::cerr << "CompressPPMFlux (" << mode << ") does not decode like CompressPPM" << std::endl;
+            return 1;
+        }
+    }
+
+    // Several threads (on an external pool) write the same file and decode to the same image.
+    {
+        const std::string outMt = "tmp_test_color_mt.hufc";
+        const std::string ppmRef = "tmp_decomp_color_ref.ppm", ppmMt = "tmp_decomp_color_mt.ppm";
+        cCompressionCouleur mt;
+        mt.setPool(std::make_shared<cThreadPool>(4));
+        bool okMt = cc.CompressPPM(input_ppm, outfile.c_str(), quality, 420) &&
+                    mt.CompressPPM(input_ppm, outMt.c_str(), quality, 420) &&
+                    cc.DecompressToPPM(outfile.c_str(), ppmRef.c_str()) &&
+                    mt.DecompressToPPM(outfile.c_str(), ppmMt.c_str());
+        okMt = okMt && read_file(outfile) == read_file(outMt) && read_file(ppmRef) == read_file(ppmMt);
+        for (const std::string &f : {outfile, outMt, ppmRef, ppmMt}) std::remove(f.c_str());
+        if (!okMt) {
+            std::cerr << "Parallel color encoding or decoding differs from the serial one" << std::endl;
+            return 1;
+        }
+    }
+
+    // The former layout (basename.meta + one .huff file per component) is still read.
+    if (!legacy_round_trip(cc)) {
+        std::cerr << "Legacy four-file layout is no longer readable" << std::endl;
+        return 1;
+    }
 
     std::cout << "testcolor: OK" << std::endl;
     return 0;
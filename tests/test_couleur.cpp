@@ -0,0 +1,168 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include "couleur/couleur.h"
+
+// Straightforward reference: per-pixel double JFIF, edge replication, then box averaging.
+static void reference_mcu(const std::vector<uint8_t> &rgb, unsigned w, unsigned n,
+                          unsigned H, unsigned V, unsigned wy,
+                          std::vector<int> &Y, std::vector<double> &Cb, std::vector<double> &Cr)
+{
+    const unsigned h = 8 * V, wc = wy / H;
+    std::vector<double> cb(static_cast<size_t>(wy) * h), cr(cb.size());
+    Y.assign(cb.size(), 0);
+    for (unsigned r = 0; r < h; ++r) {
+        const unsigned sr = (r < n) ? r : n - 1;
+        for (unsigned x = 0; x < wy; ++x) {
+            const unsigned sx = (x < w) ? x : w - 1;
+            const double R = rgb[(sr * w + sx) * 3], G = rgb[(sr * w + sx) * 3 + 1], B = rgb[(sr * w + sx) * 3 + 2];
+            Y[r * wy + x] = static_cast<int>(std::lround(0.299 * R + 0.587 * G + 0.114 * B));
+            cb[r * wy + x] = -0.168736 * R - 0.331264 * G + 0.5 * B + 128.0;
+            cr[r * wy + x] = 0.5 * R - 0.418688 * G - 0.081312 * B + 128.0;
+        }
+    }
+    Cb.assign(static_cast<size_t>(wc) * 8, 0.0);
+    Cr.assign(Cb.size(), 0.0);
+    for (unsigned r = 0; r < 8; ++r)
+        for (unsigned x = 0; x < wc; ++x) {
+            double sb = 0.0, sc = 0.0;
+            for (unsigned v = 0; v < V; ++v)
+                for (unsigned u = 0; u < H; ++u) {
+                    sb += cb[(r * V + v) * wy + x * H + u];
+                    sc += cr[(r * V + v) * wy + x * H + u];
+                }
+            Cb[r * wc + x] = sb / (H * V);
+            Cr[r * wc + x] = sc / (H * V);
+        }
+}
+
+int main() {
+    std::srand(1234);
+    bool ok = true;
+
+    // 1) Every available kernel matches the scalar one exactly, including the tails.
+    const sCouleurKernels &ref = couleur_kernels_scalar();
+    const char *noms[] = { "sse4.1" };
+    for (const char *nom : noms) {
+        const sCouleurKernels *k = couleur_kernels_by_name(nom);
+        if (!k) { std::cout << nom << ": not available, skipped\n"; continue; }
+        for (size_t n = 1; n <= 67; ++n) {
+            std::vector<uint8_t> rgb(3 * n);
+            for (auto &v : rgb) v = static_cast<uint8_t>(std::rand() & 255);
+            std::vector<uint8_t> y0(n), y1(n);
+            std::vector<int32_t> b0(n), b1(n), r0(n), r1(n);
+            ref.rgb_ycbcr(rgb.data(), n, y0.data(), b0.data(), r0.data());
+            k->rgb_ycbcr(rgb.data(), n, y1.data(), b1.data(), r1.data());
+            if (y0 != y1 || b0 != b1 || r0 != r1) {
+                std::cerr << nom << " differs from scalar for n=" << n << "\n";
+                ok = false;
+            }
+            std::vector<uint8_t> c0(3 * n), c1(3 * n);
+            ref.ycbcr_rgb(rgb.data(), rgb.data() + n, rgb.data() + 2 * n, n, c0.data());
+            k->ycbcr_rgb(rgb.data(), rgb.data() + n, rgb.data() + 2 * n, n, c1.data());
+            if (c0 != c1) {
+                std::cerr << nom << " back end differs from scalar for n=" << n << "\n";
+                ok = false;
+            }
+        }
+        std::cout << nom << " kernel matches scalar\n";
+    }
+
+    // 2) The fused front end stays within one level of the double-precision formula.
+    struct { unsigned w, n, H, V; } cas[] = {
+        { 16, 8, 1, 1 }, { 13, 5, 1, 1 }, { 21, 8, 2, 1 }, { 7, 3, 2, 1 },
+        { 33, 16, 2, 2 }, { 19, 11, 2, 2 }, { 1, 1, 2, 2 }
+    };
+    for (const auto &c : cas) {
+        const unsigned bloc = 8 * c.H, wy = (c.w + bloc - 1) / bloc * bloc, wc = wy / c.H;
+        std::vector<uint8_t> rgb(static_cast<size_t>(c.w) * c.n * 3);
+        for (auto &v : rgb) v = static_cast<uint8_t>(std::rand() & 255);
+        std::vector<uint8_t> Y(static_cast<size_t>(wy) * 8 * c.V), Cb(static_cast<size_t>(wc) * 8), Cr(Cb.size());
+        rgb_vers_ycbcr_mcu(rgb.data(), static_cast<size_t>(c.w) * 3, c.w, c.n, c.H, c.V, wy, Y.data(), Cb.data(), Cr.data());
+
+        std::vector<int> rY;
+        std::vector<double> rCb, rCr;
+        reference_mcu(rgb, c.w, c.n, c.H, c.V, wy, rY, rCb, rCr);
+        int ecartY = 0;
+        double ecartC = 0.0;
+        for (size_t i = 0; i < Y.size(); ++i) ecartY = std::max(ecartY, std::abs(Y[i] - rY[i]));
+        for (size_t i = 0; i < Cb.size(); ++i) {
+            ecartC = std::max(ecartC, std::fabs(Cb[i] - std::min(255.0, rCb[i])));
+            ecartC = std::max(ecartC, std::fabs(Cr[i] - std::min(255.0, rCr[i])));
+        }
+        std::cout << c.w << "x" << c.n << " " << c.H << "x" << c.V
+                  << ": max luma error " << ecartY << ", max chroma error " << ecartC << "\n";
+        if (ecartY > 1 || ecartC > 1.0) ok = false;
+    }
+
+    // 3) The back end stays within one level of the double-precision inverse.
+    {
+        int ecart = 0;
+        const unsigned n = 256;
+        std::vector<uint8_t> ycc(3 * n), rgb(3 * n);
+        for (auto &v : ycc) v = static_cast<uint8_t>(std::rand() & 255);
+        couleur_kernels().ycbcr_rgb(ycc.data(), ycc.data() + n, ycc.data() + 2 * n, n, rgb.data());
+        for (unsigned i = 0; i < n; ++i) {
+            const double y = ycc[i], cb = ycc[n + i] - 128.0, cr = ycc[2 * n + i] - 128.0;
+            const double ref[3] = { y + 1.402 * cr, y - 0.344136 * cb - 0.714136 * cr, y + 1.772 * cb };
+            for (int c = 0; c < 3; ++c) {
+                const int attendu = static_cast<int>(std::lround(std::max(0.0, std::min(255.0, ref[c]))));
+                ecart = std::max(ecart, std::abs(rgb[3 * i + c] - attendu));
+            }
+        }
+        std::cout << "back end: max error " << ecart << "\n";
+        if (ecart > 1) ok = false;
+    }
+
+    // 4) Upsampling: nearest replicates, the triangle filter keeps a flat color flat,
+    //    and the padding of the planes is never written to the output.
+    for (unsigned H = 1; H <= 2; ++H) {
+        for (unsigned V = 1; V <= 2; ++V) {
+            const unsigned w = 13, h = 7, pas = 24, cw = (w + H - 1) / H, ch = (h + V - 1) / V;
+            std::vector<uint8_t> Y(pas * 8, 100), Cb(pas * 8, 0), Cr(pas * 8, 0), plat(pas * 8, 170);
+            for (unsigned j = 0; j < ch; ++j)
+                for (unsigned i = 0; i < cw; ++i) {
+                    Cb[j * pas + i] = static_cast<uint8_t>(std::rand() & 255);
+                    Cr[j * pas + i] = static_cast<uint8_t>(std::rand() & 255);
+                }
+            std::vector<uint8_t> proche(w * h * 3), triangle(w * h * 3), attendu(3 * w);
+            ycbcr_vers_rgb_lignes(Y.data(), pas, Cb.data(), Cr.data(), pas, w, h, H, V,
+                                  SURECHANTILLONNAGE_PROCHE, 0, h, proche.data(), w * 3);
+            for (unsigned j = 0; j < h; ++j) {
+                std::vector<uint8_t> cb(w), cr(w);
+                for (unsigned x = 0; x < w; ++x) {
+                    cb[x] = Cb[(j / V) * pas + x / H];
+                    cr[x] = Cr[(j / V) * pas + x / H];
+                }
+                couleur_kernels_scalar().ycbcr_rgb(Y.data() + j * pas, cb.data(), cr.data(), w, attendu.data());
+                if (!std::equal(attendu.begin(), attendu.end(), proche.begin() + j * w * 3)) {
+                    std::cerr << "nearest upsampling " << H << "x" << V << " differs at row " << j << "\n";
+                    ok = false;
+                }
+            }
+            // Two bands, as the parallel decoder does.
+            ycbcr_vers_rgb_lignes(Y.data(), pas, plat.data(), plat.data(), pas, w, h, H, V,
+                                  SURECHANTILLONNAGE_TRIANGLE, 0, 3, triangle.data(), w * 3);
+            ycbcr_vers_rgb_lignes(Y.data(), pas, plat.data(), plat.data(), pas, w, h, H, V,
+                                  SURECHANTILLONNAGE_TRIANGLE, 3, h, triangle.data(), w * 3);
+            couleur_kernels_scalar().ycbcr_rgb(Y.data(), plat.data(), plat.data(), w, attendu.data());
+            for (unsigned j = 0; j < h; ++j) {
+                if (!std::equal(attendu.begin(), attendu.end(), triangle.begin() + j * w * 3)) {
+                    std::cerr << "triangle upsampling " << H << "x" << V << " alters a flat color at row " << j << "\n";
+                    ok = false;
+                }
+            }
+        }
+    }
+    std::cout << "upsampling checks done\n";
+
+    if (!ok) {
+        std::cerr << "Color conversion test failed\n";
+        return 1;
+    }
+    std::cout << "Color conversion test passed\n";
+    return 0;
+}
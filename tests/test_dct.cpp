@@ -1,7 +1,10 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <vector>
+#include <cstdint>
 #include "dct/dct.h"
+#include "dct/dct_kernels.h"
 
 int main() {
     // Original 8x8 block values (Lena example)
@@ -128,6 +131,118 @@ int main() {
         }
     }
 
+    // Flat (contiguous) API: same coefficients, single precision
+    int16_t flatIn[64]; float flatDct[64]; int16_t flatOut[64];
+    for (int i = 0; i < 64; ++i) flatIn[i] = static_cast<int16_t>(blockVals[i / 8][i % 8] - 128);
+    Calcul_DCT_Block(flatIn, flatDct);
+    for (int k = 0; k < 64 && ok; ++k) {
+        if (std::fabs(flatDct[k] - expected[k / 8][k % 8]) > coeffTol) {
+            std::cerr << "Flat DCT mismatch at " << k << ": got " << flatDct[k]
+                      << " expected " << expected[k / 8][k % 8] << "\n";
+            ok = false;
+        }
+    }
+    Calcul_IDCT_Block(flatDct, flatOut);
+    for (int k = 0; k < 64 && ok; ++k) {
+        int diff = std::abs(flatOut[k] + 128 - blockVals[k / 8][k % 8]);
+        if (diff > tolerance) {
+            std::cerr << "Flat IDCT mismatch at " << k << ": got " << (flatOut[k] + 128)
+                      << " expected " << blockVals[k / 8][k % 8] << "\n";
+            ok = false;
+        }
+    }
+
+    // Fixed-point transforms: coefficients are scaled by 8 and stay close to the float ones.
+    int32_t intDct[64]; int16_t intOut[64];
+    Calcul_DCT_Block_Entier(flatIn, intDct);
+    for (int k = 0; k < 64 && ok; ++k) {
+        if (std::fabs(intDct[k] / 8.0 - expected[k / 8][k % 8]) > 0.25) {
+            std::cerr << "Integer DCT mismatch at " << k << ": got " << intDct[k] / 8.0
+                      << " expected " << expected[k / 8][k % 8] << "\n";
+            ok = false;
+        }
+    }
+    int32_t intUnscaled[64];
+    for (int k = 0; k < 64; ++k) intUnscaled[k] = (intDct[k] + 4) >> 3;
+    Calcul_IDCT_Block_Entier(intUnscaled, intOut);
+    for (int k = 0; k < 64 && ok; ++k) {
+        int diff = std::abs(intOut[k] + 128 - blockVals[k / 8][k % 8]);
+        if (diff > tolerance) {
+            std::cerr << "Integer IDCT mismatch at " << k << ": got " << (intOut[k] + 128)
+                      << " expected " << blockVals[k / 8][k % 8] << "\n";
+            ok = false;
+        }
+    }
+
+    // Every SIMD kernel available on this CPU must match the scalar one bit for bit.
+    const size_t nbBlocs = 257;
+    std::vector<int16_t> blocs(nbBlocs * 64);
+    uint32_t graine = 12345;
+    for (size_t i = 0; i < blocs.size(); ++i) {
+        graine = graine * 1103515245u + 12345u;
+        blocs[i] = static_cast<int16_t>(static_cast<int>((graine >> 16) % 256) - 128);
+    }
+    for (int k = 0; k < 64; ++k) blocs[k] = flatIn[k]; // include the reference block
+    float Q[64], Q_inv[64];
+    for (int k = 0; k < 64; ++k) { Q[k] = static_cast<float>(1 + (k * 7) % 60); Q_inv[k] = 1.0f / Q[k]; }
+
+    const sDctKernels &ref = dct_kernels_scalar();
+    std::vector<int16_t> refCoefs(blocs.size()), refPix(blocs.size());
+    std::vector<float> refDct(blocs.size());
+    ref.dct(blocs.data(), refDct.data(), nbBlocs);
+    ref.dct_quant(blocs.data(), Q_inv, refCoefs.data(), nbBlocs);
+    ref.dequant_idct(refCoefs.data(), Q, refPix.data(), nbBlocs);
+    std::cout << "Selected DCT kernels: " << dct_kernels().nom << "\n";
+
+    const char *noms[] = { "sse4.1", "avx2", "neon" };
+    for (const char *nom : noms) {
+        const sDctKernels *k = dct_kernels_by_name(nom);
+        if (!k) continue;
+        std::vector<int16_t> coefs(blocs.size()), pix(blocs.size());
+        std::vector<float> dct(blocs.size());
+        k->dct(blocs.data(), dct.data(), nbBlocs);
+        k->dct_quant(blocs.data(), Q_inv, coefs.data(), nbBlocs);
+        k->dequant_idct(refCoefs.data(), Q, pix.data(), nbBlocs);
+        bool same = (dct == refDct) && (coefs == refCoefs) && (pix == refPix);
+        std::cout << "Kernel " << nom << " vs scalar: " << (same ? "bit-identical" : "MISMATCH") << "\n";
+        if (!same) ok = false;
+    }
+
+    // Blocks without AC coefficients: the shortcut gives what every transform gives.
+    const sDctKernels *kernels[] = { &ref, dct_kernels_by_name("sse4.1"), dct_kernels_by_name("avx2"),
+                                     dct_kernels_by_name("neon") };
+    int16_t dcBloc[64] = { 0 }, dcPix[64];
+    int32_t dcEntier[64] = { 0 };
+    for (int q = 1; q <= 255 && ok; q += 2) {
+        float dcQ[64];
+        for (int k = 0; k < 64; ++k) dcQ[k] = static_cast<float>(q);
+        for (int c = -2048 / q - 1; c <= 2048 / q + 1 && ok; ++c) {
+            dcBloc[0] = static_cast<int16_t>(c);
+            const int16_t attendu = Calcul_IDCT_DC(dcBloc[0], dcQ[0]);
+            for (const sDctKernels *k : kernels) {
+                if (!k) continue;
+                k->dequant_idct(dcBloc, dcQ, dcPix, 1);
+                for (int i = 0; i < 64; ++i) {
+                    if (dcPix[i] != attendu) {
+                        std::cerr << "DC-only block " << c << " x " << q << ", " << k->nom << ": got " << dcPix[i]
+                                  << " expected " << attendu << "\n";
+                        ok = false;
+                        break;
+                    }
+                }
+            }
+            dcEntier[0] = c * q;
+            Calcul_IDCT_Block_Entier(dcEntier, dcPix);
+            for (int i = 0; i < 64 && ok; ++i) {
+                if (dcPix[i] != Calcul_IDCT_DC_Entier(dcEntier[0])) {
+                    std::cerr << "Integer DC-only block " << c << " x " << q << ": got " << dcPix[i] << " expected "
+                              << Calcul_IDCT_DC_Entier(dcEntier[0]) << "\n";
+                    ok = false;
+                }
+            }
+        }
+    }
+
     // cleanup
     for (int i = 0; i < 8; ++i) {
         delete[] shiftedIn[i];
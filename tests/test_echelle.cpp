@@ -0,0 +1,161 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "core/cCompression.h"
+#include "core/cCompressionCouleur.h"
+#include "core/cContexteCodec.h"
+#include "quantification/quantification.h"
+#include "motif.h"
+
+// Largest and mean difference between a reduced image and the box average of the full one.
+static void comparer(const std::vector<unsigned char> &complet, unsigned int w, unsigned int h, unsigned int canaux,
+                     const std::vector<unsigned char> &reduit, unsigned int d, int &ecartMax, double &ecartMoyen) {
+    const unsigned int rw = cCompression::TailleReduite(w, d), rh = cCompression::TailleReduite(h, d);
+    ecartMax = 0;
+    double somme = 0.0;
+    for (unsigned int y = 0; y < rh; ++y) {
+        for (unsigned int x = 0; x < rw; ++x) {
+            for (unsigned int c = 0; c < canaux; ++c) {
+                int total = 0, n = 0;
+                for (unsigned int j = y * d; j < y * d + d && j < h; ++j)
+                    for (unsigned int i = x * d; i < x * d + d && i < w; ++i, ++n) total += complet[(j * w + i) * canaux + c];
+                const int ecart = std::abs(reduit[(y * rw + x) * canaux + c] - (total + n / 2) / n);
+                if (ecart > ecartMax) ecartMax = ecart;
+                somme += ecart;
+            }
+        }
+    }
+    ecartMoyen = somme / (static_cast<double>(rw) * rh * canaux);
+}
+
+int main() {
+    bool ok = true;
+    const unsigned int echelles[] = { 2, 4, 8 };
+
+    // Grayscale: every scale against the box-downscaled full decode, with and without restart segments.
+    const unsigned int w = 96, h = 64;
+    std::vector<unsigned char> pixels(static_cast<size_t>(w) * h);
+    std::vector<unsigned char*> lignes(h);
+    for (unsigned int y = 0; y < h; ++y) {
+        lignes[y] = pixels.data() + static_cast<size_t>(y) * w;
+        for (unsigned int x = 0; x < w; ++x) lignes[y][x] = motif(x, y, 0, 0.25);
+    }
+    const unsigned int intervalles[] = { 0, 5 };
+    for (unsigned int intervalle : intervalles) {
+        cCompression codec(w, h, 75, lignes.data());
+        codec.setContexte(std::make_shared<cContexteCodec>(75));
+        codec.setIntervalleRestart(intervalle);
+        std::vector<signed char> trame;
+        std::vector<unsigned char> fichier, complet(pixels.size());
+        codec.RLE(trame);
+        codec.Compression_JPEG(trame, fichier);
+
+        cCompression lecteur;
+        lecteur.setNbThreads(2);
+        if (!lecteur.Decompression_JPEG(fichier.data(), fichier.size(), complet.data(), w, w, h)) {
+            std::cerr << "full decode failed\n";
+            return 1;
+        }
+        for (unsigned int d : echelles) {
+            lecteur.setEchelle(d);
+            const unsigned int rw = w / d, rh = h / d;
+            std::vector<unsigned char> reduit(static_cast<size_t>(rw) * rh);
+            if (lecteur.Decompression_JPEG(fichier.data(), fichier.size(), reduit.data(), rw, rw - 1, rh)
+                || !lecteur.Decompression_JPEG(fichier.data(), fichier.size(), reduit.data(), rw, rw, rh)
+                || lecteur.getLargeur() != w || lecteur.getHauteur() != h) {
+                std::cerr << "1/" << d << ": the reduced buffer is not sized as expected\n";
+                ok = false;
+                continue;
+            }
+            int ecartMax = 0;
+            double ecartMoyen = 0.0;
+            comparer(complet, w, h, 1, reduit, d, ecartMax, ecartMoyen);
+            if (ecartMax > 4 || ecartMoyen > 1.0) {
+                std::cerr << "1/" << d << ", interval " << intervalle << ": differs from the downscaled image by up to "
+                          << ecartMax << " (mean " << ecartMoyen << ")\n";
+                ok = false;
+            }
+
+            // The allocating decoder gives the same pixels.
+            unsigned char **rows = lecteur.Decompression_JPEG(fichier.data(), fichier.size());
+            if (!rows) {
+                ok = false;
+                continue;
+            }
+            for (unsigned int y = 0; y < rh; ++y)
+                for (unsigned int x = 0; x < rw; ++x)
+                    if (rows[y][x] != reduit[y * rw + x]) ok = false;
+            delete[] rows[0];
+            delete[] rows;
+        }
+    }
+    if (!ok) std::cerr << "the reduced grayscale decodes are wrong\n";
+
+    // 1/8 is the DC coefficient of each block, exactly.
+    {
+        cCompression codec(w, h, 50, lignes.data());
+        codec.setContexte(std::make_shared<cContexteCodec>(50));
+        sAnalyseImage analyse;
+        std::vector<signed char> trame;
+        std::vector<unsigned char> fichier;
+        codec.Analyse_Image(analyse);
+        codec.RLE(analyse, trame);
+        codec.Compression_JPEG(trame, fichier);
+        cCompression lecteur;
+        lecteur.setEchelle(8);
+        std::vector<unsigned char> dc((w / 8) * (h / 8));
+        const cContexteQuant ctx(50, COMPOSANTE_LUMA);
+        if (!lecteur.Decompression_JPEG(fichier.data(), fichier.size(), dc.data(), w / 8, w / 8, h / 8)) ok = false;
+        for (size_t b = 0; b < dc.size(); ++b) {
+            const double v = analyse.coefficients[b * 64] * ctx.getTableF()[0] / 8.0;
+            const int attendu = static_cast<int>(v < 0 ? v - 0.5 : v + 0.5) + 128;
+            if (dc[b] != ((attendu < 0) ? 0 : (attendu > 255) ? 255 : attendu)) {
+                std::cerr << "block " << b << ": 1/8 pixel " << int(dc[b]) << ", DC gives " << attendu << "\n";
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    // Color: the output is rounded up on odd sizes, on every subsampling. The chroma is upsampled
+    // from the reduced planes, hence a looser bound than for the luma.
+    const unsigned int cw = 75, ch = 53;
+    std::vector<unsigned char> rgb(static_cast<size_t>(cw) * ch * 3);
+    for (unsigned int y = 0; y < ch; ++y)
+        for (unsigned int x = 0; x < cw * 3; ++x) rgb[y * cw * 3 + x] = motif(x / 3, y, x % 3, 0.25);
+    const unsigned int sousEch[] = { 444, 422, 420 };
+    for (unsigned int m : sousEch) {
+        cCompressionCouleur couleur;
+        couleur.setNbThreads(3);
+        std::vector<unsigned char> conteneur, complet(rgb.size());
+        couleur.CompressRGB(rgb.data(), cw, ch, cw * 3, 75, m, conteneur);
+        if (!couleur.DecompressToRGB(conteneur.data(), conteneur.size(), complet.data(), cw * 3, cw, ch)) {
+            std::cerr << "full color decode failed\n";
+            return 1;
+        }
+        for (unsigned int d : echelles) {
+            couleur.setEchelle(d);
+            const unsigned int rw = cCompression::TailleReduite(cw, d), rh = cCompression::TailleReduite(ch, d);
+            std::vector<unsigned char> reduit(static_cast<size_t>(rw) * rh * 3);
+            if (!couleur.DecompressToRGB(conteneur.data(), conteneur.size(), reduit.data(), rw * 3, rw, rh)) {
+                std::cerr << m << ", 1/" << d << ": reduced color decode failed\n";
+                ok = false;
+                continue;
+            }
+            int ecartMax = 0;
+            double ecartMoyen = 0.0;
+            comparer(complet, cw, ch, 3, reduit, d, ecartMax, ecartMoyen);
+            if (ecartMax > 16 || ecartMoyen > 3.0) {
+                std::cerr << m << ", 1/" << d << ": differs from the downscaled image by up to " << ecartMax
+                          << " (mean " << ecartMoyen << ")\n";
+                ok = false;
+            }
+        }
+    }
+
+    if (!ok) return 1;
+    std::cout << "test_echelle passed\n";
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include <iostream>
+#include <iterator>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include "core/cCompression.h"
+#include "core/cEncodeurFlux.h"
+
+// Decodes a file and returns its pixels (empty on failure).
+static std::vector<unsigned char> decoder(const char *fichier, eModePipeline mode, unsigned int &w, unsigned int &h)
+{
+    cCompression dec;
+    dec.setModePipeline(mode);
+    unsigned char **rows = dec.Decompression_JPEG(fichier);
+    if (!rows) return {};
+    w = dec.getLargeur();
+    h = dec.getHauteur();
+    std::vector<unsigned char> px(static_cast<size_t>(w) * h);
+    for (unsigned int y = 0; y < h; ++y) std::memcpy(px.data() + static_cast<size_t>(y) * w, rows[y], w);
+    delete[] rows[0];
+    delete[] rows;
+    return px;
+}
+
+// Encodes with the two-pass encoder (optimal tables), for comparison.
+static void encoder_deux_passes(std::vector<unsigned char> &pixels, unsigned int W, unsigned int H,
+                                eModePipeline mode, unsigned int restart, const char *fichier)
+{
+    std::vector<unsigned char*> rows(H);
+    for (unsigned int y = 0; y < H; ++y) rows[y] = pixels.data() + static_cast<size_t>(y) * W;
+    cCompression enc(W, H, 50, rows.data());
+    enc.setModePipeline(mode);
+    enc.setIntervalleRestart(restart);
+    std::vector<int> trame(1 + (W / 8) * (H / 8) * 128, 0);
+    enc.RLE(trame.data());
+    enc.Compression_JPEG(trame.data(), fichier);
+}
+
+int main() {
+    bool ok = true;
+    cCompression::setQualiteGlobale(50);
+
+    const unsigned int W = 40, H = 32;
+    std::vector<unsigned char> pixels(W * H);
+    for (unsigned int y = 0; y < H; ++y) {
+        for (unsigned int x = 0; x < W; ++x) {
+            int v = (x < 16 && y < 8) ? 100 : static_cast<int>(50 + 3 * x + 4 * y + ((x * 7 + y * 13) % 5));
+            pixels[y * W + x] = static_cast<unsigned char>(v);
+        }
+    }
+
+    // The built-in table must be a complete prefix code over all 256 byte values.
+    const uint8_t *L = cEncodeurFlux::getLongueursFixes();
+    uint64_t kraft = 0;
+    for (int c = 0; c < 256; ++c) {
+        if (L[c] == 0 || L[c] > cHuffman::kLongueurMax) { ok = false; break; }
+        kraft += 1ULL << (cHuffman::kLongueurMax - L[c]);
+    }
+    if (!ok || kraft != (1ULL << cHuffman::kLongueurMax)) {
+        std::cerr << "Built-in table is not a complete prefix code\n";
+        ok = false;
+    }
+
+    // Rows pushed a few at a time: the stripes are cut internally, and the
+    // decoded image must match the two-pass encoder (same quantized blocks).
+    std::string flux;
+    {
+        std::ostringstream out(std::ios::binary);
+        cEncodeurFlux enc(out, W, H, 50);
+        for (unsigned int y = 0; ok && y < H; y += 3) {
+            unsigned int nb = (H - y < 3) ? H - y : 3;
+            ok = enc.ajouterLignes(pixels.data() + y * W, W, nb);
+        }
+        ok = ok && enc.terminer();
+        flux = out.str();
+        std::ofstream f("test_flux.huff", std::ios::binary);
+        f.write(flux.data(), static_cast<std::streamsize>(flux.size()));
+    }
+    encoder_deux_passes(pixels, W, H, PIPELINE_FLOTTANT, 0, "test_flux_ref.huff");
+    unsigned int w1 = 0, h1 = 0, w2 = 0, h2 = 0;
+    std::vector<unsigned char> a = decoder("test_flux.huff", PIPELINE_FLOTTANT, w1, h1);
+    std::vector<unsigned char> b = decoder("test_flux_ref.huff", PIPELINE_FLOTTANT, w2, h2);
+    if (!ok || a.empty() || a != b || w1 != W || h1 != H) {
+        std::cerr << "Streamed file does not decode like the two-pass one\n";
+        ok = false;
+    }
+    std::cout << "Streamed file: " << flux.size() << " bytes\n";
+
+    // Reading from an istream gives the same bytes.
+    {
+        std::istringstream in(std::string(pixels.begin(), pixels.end()), std::ios::binary);
+        std::ostringstream out(std::ios::binary);
+        cEncodeurFlux enc(out, W, H, 50);
+        if (!enc.Encoder(in) || out.str() != flux) {
+            std::cerr << "istream encoding differs from row-by-row encoding\n";
+            ok = false;
+        }
+    }
+
+    // Truncated input: fails, and terminer() reports the missing rows.
+    {
+        std::istringstream in(std::string(pixels.begin(), pixels.begin() + W * 20), std::ios::binary);
+        std::ostringstream out(std::ios::binary);
+        cEncodeurFlux enc(out, W, H, 50);
+        if (enc.Encoder(in)) {
+            std::cerr << "Truncated input was accepted\n";
+            ok = false;
+        }
+    }
+
+    // Fixed-point pipeline with restart intervals.
+    {
+        std::ofstream f("test_flux_rst.huff", std::ios::binary);
+        cEncodeurFlux enc(f, W, H, 50);
+        enc.setModePipeline(PIPELINE_ENTIER);
+        enc.setIntervalleRestart(3);
+        ok = enc.ajouterLignes(pixels.data(), W, H) && enc.terminer() && ok;
+    }
+    encoder_deux_passes(pixels, W, H, PIPELINE_ENTIER, 3, "test_flux_rst_ref.huff");
+    a = decoder("test_flux_rst.huff", PIPELINE_ENTIER, w1, h1);
+    b = decoder("test_flux_rst_ref.huff", PIPELINE_ENTIER, w2, h2);
+    if (a.empty() || a != b) {
+        std::cerr << "Streamed restart/fixed-point file does not decode like the two-pass one\n";
+        ok = false;
+    }
+
+    // A seek index on top of the restart intervals: same image, and a region read through it.
+    {
+        std::string idx;
+        {
+            std::ofstream f("test_flux_idx.huff", std::ios::binary);
+            cEncodeurFlux enc(f, W, H, 50);
+            enc.setModePipeline(PIPELINE_ENTIER);
+            enc.setIntervalleRestart(3);
+            enc.setIntervalleIndex(2);
+            ok = enc.ajouterLignes(pixels.data(), W, H) && enc.terminer() && ok;
+        }
+        {
+            std::ifstream f("test_flux_idx.huff", std::ios::binary);
+            idx.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        }
+        b = decoder("test_flux_idx.huff", PIPELINE_ENTIER, w2, h2);
+        cCompression dec;
+        dec.setModePipeline(PIPELINE_ENTIER);
+        std::vector<unsigned char> region(20 * 12);
+        bool pareil = dec.DecodeRegion(reinterpret_cast<const uint8_t*>(idx.data()), idx.size(), 12, 10, 20, 12,
+                                       region.data(), 20);
+        for (unsigned int y = 0; y < 12 && pareil; ++y)
+            pareil = std::memcmp(region.data() + y * 20, a.data() + (y + 10) * W + 12, 20) == 0;
+        if (a.empty() || a != b || !pareil || idx.find("IDX1") == std::string::npos) {
+            std::cerr << "Streamed file with a seek index does not decode like the one without\n";
+            ok = false;
+        }
+    }
+
+    // Sizes that are not multiples of 8 are padded by replication, and cropped on decode.
+    {
+        const unsigned int w = 37, h = 21;
+        std::vector<unsigned char> petit(w * h);
+        for (unsigned int y = 0; y < h; ++y) std::memcpy(petit.data() + y * w, pixels.data() + y * W, w);
+        std::ofstream f("test_flux_pad.huff", std::ios::binary);
+        cEncodeurFlux enc(f, w, h, 50);
+        ok = enc.ajouterLignes(petit.data(), w, h) && enc.terminer() && ok;
+        f.close();
+        a = decoder("test_flux_pad.huff", PIPELINE_FLOTTANT, w1, h1);
+        double mse = 0.0;
+        if (a.empty() || w1 != w || h1 != h) {
+            ok = false;
+        } else {
+            for (unsigned int y = 0; y < h; ++y) for (unsigned int x = 0; x < w; ++x) {
+                double d = static_cast<double>(a[y * w1 + x]) - petit[y * w + x];
+                mse += d * d;
+            }
+            mse /= static_cast<double>(w * h);
+        }
+        std::cout << "Padded 37x21 image: MSE=" << mse << "\n";
+        if (!ok || mse > 30.0) {
+            std::cerr << "Padded image round trip failed\n";
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        std::cerr << "test_flux: FAIL\n";
+        return 1;
+    }
+    std::cout << "test_flux: PASS\n";
+    return 0;
+}
@@ -1,5 +1,10 @@
 #include <iostream>
 #include <iomanip>
+#include <cstdint>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
 #include "core/cHuffman.h"   // adjust path if needed
 
 int main() {
@@ -23,6 +28,101 @@ int main() {
     // Print codes starting from the root
     h.AfficherHuffman(h.getRacine());
 
+    // Table-driven decoder: a Fibonacci-like distribution gives codes well
+    // beyond kBitsTable bits, so both the fast and the slow path are exercised.
+    std::vector<char> symboles;
+    std::vector<double> freqs;
+    double a = 1.0, b = 1.0;
+    for (int i = 0; i < 20; ++i) {
+        symboles.push_back(static_cast<char>('a' + i));
+        freqs.push_back(a);
+        double c = a + b; a = b; b = c;
+    }
+    cHuffman hl;
+    hl.HuffmanCodes(symboles.data(), freqs.data(), static_cast<unsigned int>(symboles.size()));
+    std::map<char, std::string> codes;
+    hl.BuildTableCodes(codes);
+
+    std::vector<char> message;
+    uint32_t graine = 7;
+    for (int i = 0; i < 5000; ++i) {
+        graine = graine * 1103515245u + 12345u;
+        message.push_back(symboles[(graine >> 16) % symboles.size()]);
+    }
+    std::vector<unsigned char> octets;
+    uint64_t nbBits = 0;
+    for (char c : message) {
+        for (char bit : codes[c]) {
+            if (nbBits % 8 == 0) octets.push_back(0);
+            if (bit == '1') octets.back() |= static_cast<unsigned char>(0x80u >> (nbBits % 8));
+            ++nbBits;
+        }
+    }
+
+    bool ok = true;
+    std::vector<char> decode;
+    if (!hl.Decoder(octets.data(), octets.size(), 0, nbBits, decode) || decode != message) {
+        std::cerr << "Table-driven decode mismatch (" << decode.size() << " of " << message.size() << " symbols)\n";
+        ok = false;
+    }
+
+    // Decoding from an unaligned start bit (skip the first symbol).
+    const size_t premier = codes[message[0]].size();
+    decode.clear();
+    if (!hl.Decoder(octets.data(), octets.size(), premier, nbBits - premier, decode) ||
+        decode != std::vector<char>(message.begin() + 1, message.end())) {
+        std::cerr << "Unaligned table-driven decode mismatch\n";
+        ok = false;
+    }
+
+    // Canonical, length-limited codes: the Fibonacci counts would need 19 bits.
+    uint32_t comptes[256] = {0};
+    for (size_t i = 0; i < symboles.size(); ++i) comptes[static_cast<unsigned char>(symboles[i])] = static_cast<uint32_t>(freqs[i]);
+    uint8_t longueurs[256];
+    uint32_t codesCanon[256];
+    cHuffman::CalculerLongueurs(comptes, longueurs);
+    cHuffman::CodesCanoniques(longueurs, codesCanon);
+    double kraft = 0.0;
+    int maxLong = 0;
+    for (int c = 0; c < 256; ++c) {
+        if (longueurs[c] == 0) continue;
+        kraft += std::ldexp(1.0, -longueurs[c]);
+        if (longueurs[c] > maxLong) maxLong = longueurs[c];
+    }
+    std::cout << "Canonical codes: max length " << maxLong << ", Kraft sum " << kraft << "\n";
+    if (maxLong > cHuffman::kLongueurMax || std::fabs(kraft - 1.0) > 1e-12) {
+        std::cerr << "Length-limited code is not complete or too long\n";
+        ok = false;
+    }
+
+    std::vector<unsigned char> octetsCanon;
+    cEcrivainBits ecrivain(octetsCanon);
+    for (char c : message) {
+        unsigned char u = static_cast<unsigned char>(c);
+        ecrivain.ecrire(codesCanon[u], longueurs[u]);
+    }
+    ecrivain.aligner();
+    cHuffman hc;
+    decode.clear();
+    if (!hc.ConstruireDepuisLongueurs(longueurs) ||
+        !hc.Decoder(octetsCanon.data(), octetsCanon.size(), 0, ecrivain.getNbBits(), decode) || decode != message) {
+        std::cerr << "Canonical code round trip mismatch\n";
+        ok = false;
+    }
+
+    // A lone symbol still gets a 1-bit code.
+    uint32_t seul[256] = {0};
+    seul[0] = 42;
+    cHuffman::CalculerLongueurs(seul, longueurs);
+    if (longueurs[0] != 1) {
+        std::cerr << "Single-symbol alphabet should get a 1-bit code\n";
+        ok = false;
+    }
+
+    if (!ok) {
+        std::cerr << "test_huffman: FAIL\n";
+        return 1;
+    }
     std::cout << "\nDone.\n";
     return 0;
 }
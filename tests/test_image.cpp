@@ -0,0 +1,126 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "core/cCompressionCouleur.h"
+#include "core/cFichierMappe.h"
+#include "core/cImage.h"
+
+// Writes raw bytes to a file.
+static void ecrire_fichier(const char *chemin, const std::string &octets) {
+    std::ofstream out(chemin, std::ios::binary);
+    out.write(octets.data(), static_cast<std::streamsize>(octets.size()));
+}
+
+int main() {
+    bool ok = true;
+
+    // 8-bit PGM with a comment: read in place.
+    {
+        std::string pgm = "P5\n# made by hand\n5 3\n255\n";
+        for (int i = 0; i < 15; ++i) pgm += static_cast<char>(i * 17);
+        ecrire_fichier("tmp_image_a.pgm", pgm);
+        cLecteurImage image;
+        const sVueImage &v = image.getVue();
+        if (!image.ouvrir("tmp_image_a.pgm") || image.getFormat() != IMAGE_PGM || !image.estEnPlace()
+            || v.largeur != 5 || v.hauteur != 3 || v.canaux != 1 || v.pas != 5 || v.ligne(2)[4] != 14 * 17) {
+            std::cerr << "8-bit PGM not read in place: " << image.getErreur() << "\n";
+            ok = false;
+        }
+    }
+
+    // 16-bit samples are big-endian and rescaled, or refused on request.
+    {
+        std::string pgm = "P5 3 1 65535\n";
+        const unsigned char samples[6] = { 0x00, 0x00, 0xFF, 0xFF, 0x80, 0x00 };
+        pgm.append(reinterpret_cast<const char*>(samples), sizeof(samples));
+        ecrire_fichier("tmp_image_b.pgm", pgm);
+        cLecteurImage image;
+        const sVueImage &v = image.getVue();
+        if (!image.ouvrir("tmp_image_b.pgm") || image.getMaxval() != 65535 || image.estEnPlace()
+            || v.pixels[0] != 0 || v.pixels[1] != 255 || v.pixels[2] != 128) {
+            std::cerr << "16-bit PGM not rescaled\n";
+            ok = false;
+        }
+        if (image.ouvrir("tmp_image_b.pgm", false) || std::strlen(image.getErreur()) == 0) {
+            std::cerr << "16-bit PGM must be refused when asked\n";
+            ok = false;
+        }
+    }
+
+    // Truncated pixel data and unsupported formats are refused.
+    {
+        ecrire_fichier("tmp_image_c.pgm", "P5\n5 3\n255\n0123456789");
+        ecrire_fichier("tmp_image_d.pgm", "P2\n2 1\n255\n0 255\n");
+        cLecteurImage image;
+        if (image.ouvrir("tmp_image_c.pgm") || image.ouvrir("tmp_image_d.pgm") || image.ouvrir("tmp_image_absent.pgm")) {
+            std::cerr << "invalid files must be refused\n";
+            ok = false;
+        }
+    }
+
+    // Text images: width from the first line, clamping, CRLF, malformed input.
+    {
+        std::vector<unsigned char> px;
+        unsigned int w = 0, h = 0;
+        const char texte[] = "1 2 300\r\n-4 5 6";
+        if (!cLecteurImage::ParserTexte(texte, sizeof(texte) - 1, px, w, h) || w != 3 || h != 2
+            || px != std::vector<unsigned char>({ 1, 2, 255, 0, 5, 6 })) {
+            std::cerr << "text image parsed wrongly\n";
+            ok = false;
+        }
+        const char *mauvais[] = { "1 2 x\n", "1 2 3\n4 5\n", "\n1 2\n", "" };
+        for (const char *m : mauvais) {
+            if (cLecteurImage::ParserTexte(m, std::strlen(m), px, w, h)) {
+                std::cerr << "malformed text image accepted: \"" << m << "\"\n";
+                ok = false;
+            }
+        }
+        ecrire_fichier("tmp_image_e.img", "10 20\n30 40\n");
+        cLecteurImage image;
+        if (!image.ouvrir("tmp_image_e.img") || image.getFormat() != IMAGE_TEXTE || image.getVue().ligne(1)[1] != 40) {
+            std::cerr << "text image not opened\n";
+            ok = false;
+        }
+    }
+
+    // A strided PPM view is written, read back in place and encoded as is.
+    {
+        const unsigned int w = 21, h = 13;
+        const size_t pas = w * 3 + 5;
+        std::vector<unsigned char> rgb(pas * h);
+        for (size_t i = 0; i < rgb.size(); ++i) rgb[i] = static_cast<unsigned char>((i * 7) ^ (i >> 4));
+        sVueImage vue;
+        vue.pixels = rgb.data(); vue.largeur = w; vue.hauteur = h; vue.canaux = 3; vue.pas = pas;
+        if (!cEcrivainImage::Ecrire("tmp_image_f.ppm", vue)) {
+            std::cerr << "cannot write PPM\n";
+            ok = false;
+        }
+        cLecteurImage image;
+        const sVueImage &lue = image.getVue();
+        if (!image.ouvrir("tmp_image_f.ppm") || image.getFormat() != IMAGE_PPM || lue.largeur != w || lue.hauteur != h) {
+            std::cerr << "written PPM not read back\n";
+            ok = false;
+        } else {
+            for (unsigned int y = 0; y < h; ++y)
+                if (std::memcmp(lue.ligne(y), vue.ligne(y), w * 3) != 0) ok = false;
+            if (!ok) std::cerr << "PPM round trip differs\n";
+        }
+
+        cCompressionCouleur couleur;
+        std::vector<unsigned char> enMemoire;
+        couleur.CompressRGB(lue.pixels, lue.largeur, lue.hauteur, lue.pas, 70, 420, enMemoire);
+        couleur.CompressPPM("tmp_image_f.ppm", "tmp_image_f.hufc", 70, 420);
+        cFichierMappe fichier;
+        if (!fichier.ouvrir("tmp_image_f.hufc") || fichier.getTaille() != enMemoire.size()
+            || std::memcmp(fichier.getDonnees(), enMemoire.data(), enMemoire.size()) != 0) {
+            std::cerr << "CompressPPM and CompressRGB on the mapped view differ\n";
+            ok = false;
+        }
+    }
+
+    if (!ok) return 1;
+    std::cout << "test_image passed\n";
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include "core/cCompression.h"
+#include "core/cCompressionLot.h"
+#include "core/cCompressionCouleur.h"
+
+static std::vector<unsigned char> read_file(const std::string &path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::vector<unsigned char>((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+static void write_pnm(const std::string &path, const char *magic, unsigned int w, unsigned int h, unsigned int nbComp) {
+    std::ofstream f(path, std::ios::binary);
+    f << magic << "\n" << w << " " << h << "\n255\n";
+    for (unsigned int y = 0; y < h; ++y)
+        for (unsigned int x = 0; x < w * nbComp; ++x)
+            f.put(static_cast<char>((x * 7 + y * 13 + (x * y) % 17) & 255));
+}
+
+int main() {
+    write_pnm("tmp_lot_a.pgm", "P5", 61, 37, 1);
+    write_pnm("tmp_lot_b.ppm", "P6", 45, 29, 3);
+    write_pnm("tmp_lot_c.ppm", "P6", 16, 16, 3);
+
+    std::vector<sTacheLot> taches(4);
+    taches[0].entree = "tmp_lot_a.pgm"; taches[0].sortie = "tmp_lot_a.huff"; taches[0].qualite = 60;
+    taches[1].entree = "tmp_lot_b.ppm"; taches[1].sortie = "tmp_lot_b.hufc"; taches[1].qualite = 75; taches[1].sousEchantillonnage = 420;
+    taches[2].entree = "tmp_lot_missing.ppm"; taches[2].sortie = "tmp_lot_m.hufc";
+    taches[3].entree = "tmp_lot_c.ppm"; taches[3].sortie = "tmp_lot_c.hufc"; taches[3].sousEchantillonnage = 422;
+
+    // Reference: one thread, then compare with job-level and block-level runs.
+    std::vector<std::vector<unsigned char>> reference;
+    bool ok = true;
+    struct { unsigned int threads; uint64_t seuil; } configs[] = { { 1, cCompressionLot::kSeuilPixelsDefaut }, { 3, cCompressionLot::kSeuilPixelsDefaut }, { 3, 0 } };
+    for (const auto &c : configs) {
+        cCompressionLot lot(c.threads);
+        lot.setSeuilPixels(c.seuil);
+        std::vector<sResultatLot> resultats;
+        sBilanLot bilan;
+        if (lot.Executer(taches, resultats, bilan)) {
+            std::cerr << "a missing input should fail the batch\n";
+            ok = false;
+        }
+        if (resultats.size() != taches.size() || bilan.nbReussis != 3 || bilan.nbEchecs != 1 || resultats[2].reussi) {
+            std::cerr << "wrong results with " << c.threads << " threads\n";
+            ok = false;
+            continue;
+        }
+        if (resultats[1].largeur != 45 || resultats[1].hauteur != 29 || resultats[1].octetsSortie == 0 ||
+            resultats[1].paralleleBlocs != (c.threads > 1 && c.seuil == 0)) {
+            std::cerr << "wrong job report with " << c.threads << " threads\n";
+            ok = false;
+        }
+        std::vector<std::vector<unsigned char>> sorties;
+        for (const sTacheLot &t : taches) sorties.push_back(read_file(t.sortie));
+        if (reference.empty()) {
+            reference = sorties;
+        } else if (sorties != reference) {
+            std::cerr << "outputs depend on the parallelism (" << c.threads << " threads, threshold " << c.seuil << ")\n";
+            ok = false;
+        }
+        std::cout << c.threads << " threads, threshold " << c.seuil << ": " << bilan.nbReussis << " OK, "
+                  << bilan.octetsEntree << " -> " << bilan.octetsSortie << " bytes\n";
+    }
+
+    // The batch writes the same file as a direct call.
+    cCompressionCouleur cc;
+    cc.CompressPPM("tmp_lot_b.ppm", "tmp_lot_direct.hufc", 75, 420);
+    if (read_file("tmp_lot_direct.hufc") != reference[1]) {
+        std::cerr << "batch output differs from CompressPPM()\n";
+        ok = false;
+    }
+
+    // The padded grayscale file keeps the size of the image.
+    unsigned int w = 0, h = 0;
+    if (!cCompression::LireDimensions(reference[0].data(), reference[0].size(), w, h) || w != 61 || h != 37) {
+        std::cerr << "the grayscale output does not keep the image size\n";
+        ok = false;
+    }
+
+    // An output that cannot be written fails the job, for both encoders; out-of-range qualities are clamped.
+    {
+        std::vector<sTacheLot> mauvaises(3);
+        mauvaises[0].entree = "tmp_lot_a.pgm"; mauvaises[0].sortie = "tmp_lot_absent/a.huff";
+        mauvaises[1].entree = "tmp_lot_b.ppm"; mauvaises[1].sortie = "tmp_lot_absent/b.hufc";
+        mauvaises[2].entree = "tmp_lot_c.ppm"; mauvaises[2].sortie = "tmp_lot_c.hufc"; mauvaises[2].qualite = 250;
+        cCompressionLot lot(1);
+        std::vector<sResultatLot> resultats;
+        sBilanLot bilan;
+        lot.Executer(mauvaises, resultats, bilan);
+        if (resultats.size() != 3 || resultats[0].reussi || resultats[1].reussi || resultats[0].erreur != "cannot write output"
+            || resultats[1].erreur != "cannot write output" || !resultats[2].reussi) {
+            std::cerr << "unwritable outputs or an out-of-range quality not handled\n";
+            ok = false;
+        }
+    }
+
+    // Manifest parsing.
+    {
+        std::ofstream m("tmp_lot_manifest.txt");
+        m << "# comment\n\ntmp_lot_a.pgm out.huff 40\n  tmp_lot_b.ppm out.hufc 80 420\n";
+    }
+    std::vector<sTacheLot> lues;
+    unsigned int ligne = 0;
+    if (!cCompressionLot::LireManifeste("tmp_lot_manifest.txt", lues, ligne) || lues.size() != 2 ||
+        lues[0].qualite != 40 || lues[0].sousEchantillonnage != 444 || lues[1].sousEchantillonnage != 420) {
+        std::cerr << "manifest not read correctly\n";
+        ok = false;
+    }
+    {
+        std::ofstream m("tmp_lot_manifest.txt");
+        m << "a.pgm a.huff\nb.ppm b.hufc 75 411\n";
+    }
+    if (cCompressionLot::LireManifeste("tmp_lot_manifest.txt", lues, ligne) || ligne != 2) {
+        std::cerr << "malformed manifest line not reported\n";
+        ok = false;
+    }
+
+    const char *fichiers[] = { "tmp_lot_a.pgm", "tmp_lot_b.ppm", "tmp_lot_c.ppm", "tmp_lot_a.huff", "tmp_lot_b.hufc",
+                               "tmp_lot_c.hufc", "tmp_lot_direct.hufc", "tmp_lot_manifest.txt" };
+    for (const char *f : fichiers) std::remove(f);
+
+    if (!ok) {
+        std::cerr << "Batch test failed\n";
+        return 1;
+    }
+    std::cout << "Batch test passed\n";
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "core/cCompression.h"
+#include "core/cContexteCodec.h"
+#include "core/cEncodeurPipeline.h"
+#include "core/cTablesHuffman.h"
+#include "motif.h"
+
+struct sReglages {
+    unsigned int restart, index;
+    bool statique;
+    eModePipeline mode;
+};
+
+// The reference: the whole image through RLE() and Compression_JPEG().
+static std::vector<unsigned char> reference(std::vector<unsigned char> &pixels, unsigned int w, unsigned int h,
+                                            const sReglages &r)
+{
+    std::vector<unsigned char*> lignes(h);
+    for (unsigned int y = 0; y < h; ++y) lignes[y] = pixels.data() + static_cast<size_t>(y) * w;
+    cCompression codec(w, h, 60, lignes.data());
+    codec.setContexte(std::make_shared<cContexteCodec>(60));
+    codec.setModePipeline(r.mode);
+    codec.setIntervalleRestart(r.restart);
+    codec.setIntervalleIndex(r.index);
+    if (r.statique) codec.setTableStatique(cTablesHuffman::kIdDefaut, 1);
+    std::vector<signed char> trame;
+    std::vector<unsigned char> fichier;
+    codec.RLE(trame);
+    codec.Compression_JPEG(trame, fichier);
+    return fichier;
+}
+
+static bool encoder(const std::vector<unsigned char> &pixels, unsigned int w, unsigned int h, const sReglages &r,
+                    unsigned int threads, unsigned int lignes, unsigned int profondeur,
+                    std::vector<unsigned char> &fichier, sMetriquesPipeline &m)
+{
+    cEncodeurPipeline enc(w, h, 60);
+    enc.setModePipeline(r.mode);
+    enc.setIntervalleRestart(r.restart);
+    enc.setIntervalleIndex(r.index);
+    if (r.statique) enc.setTableStatique(cTablesHuffman::kIdDefaut, 1);
+    enc.setNbThreads(threads);
+    enc.setLignesParBande(lignes);
+    enc.setProfondeur(profondeur);
+    std::string brut(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+    std::istringstream entree(brut);
+    const bool ok = enc.Encoder(entree, fichier);
+    m = enc.getMetriques();
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    const unsigned int w = 200, h = 120;
+    std::vector<unsigned char> pixels(static_cast<size_t>(w) * h);
+    for (unsigned int y = 0; y < h; ++y)
+        for (unsigned int x = 0; x < w; ++x) pixels[y * w + x] = motif(x, y);
+
+    // Every setting gives the file of the one-shot encoder, whatever the stripes and threads.
+    const sReglages reglages[] = { { 0, 0, false, PIPELINE_FLOTTANT }, { 0, 0, true, PIPELINE_FLOTTANT },
+                                   { 11, 0, false, PIPELINE_FLOTTANT }, { 11, 7, true, PIPELINE_FLOTTANT },
+                                   { 25, 25, false, PIPELINE_ENTIER }, { 0, 0, true, PIPELINE_ENTIER } };
+    struct sForme { unsigned int threads, lignes, profondeur; };
+    const sForme formes[] = { { 1, 8, 2 }, { 1, 64, 0 }, { 3, 8, 0 }, { 3, 24, 2 }, { 4, 200, 0 } };
+    for (const sReglages &r : reglages) {
+        const std::vector<unsigned char> attendu = reference(pixels, w, h, r);
+        for (const sForme &f : formes) {
+            std::vector<unsigned char> fichier;
+            sMetriquesPipeline m;
+            if (!encoder(pixels, w, h, r, f.threads, f.lignes, f.profondeur, fichier, m) || fichier != attendu) {
+                std::cerr << "restart " << r.restart << ", index " << r.index << (r.statique ? ", static" : "")
+                          << ", " << f.threads << " threads, " << f.lignes << " rows, depth " << f.profondeur
+                          << ": the file differs from RLE() + Compression_JPEG()\n";
+                ok = false;
+                continue;
+            }
+            const unsigned int nbBandes = (h + m.lignesParBande - 1) / m.lignesParBande;
+            if (m.lecture.bandes != nbBandes || m.transformation.bandes != nbBandes || m.entropie.bandes != nbBandes
+                || m.fileTransformation.profondeurMax > m.fileTransformation.capacite
+                || m.fileEntropie.profondeurMax > m.fileEntropie.capacite || m.fileEntropie.capacite < 1) {
+                std::cerr << f.threads << " threads, " << f.lignes << " rows: inconsistent metrics\n";
+                ok = false;
+            }
+        }
+    }
+
+    // Sizes that are not multiples of 8 are padded by replicating the last column and row.
+    {
+        const unsigned int W = 203, H = 117, lb = 208, hb = 120;
+        std::vector<unsigned char> petit(static_cast<size_t>(W) * H), complet(static_cast<size_t>(lb) * hb);
+        for (unsigned int y = 0; y < H; ++y)
+            for (unsigned int x = 0; x < W; ++x) petit[y * W + x] = motif(x, y);
+        for (unsigned int y = 0; y < hb; ++y)
+            for (unsigned int x = 0; x < lb; ++x) complet[y * lb + x] = petit[std::min(y, H - 1) * W + std::min(x, W - 1)];
+        const sReglages r = { 0, 0, true, PIPELINE_FLOTTANT };
+        std::vector<unsigned char> fichier;
+        sMetriquesPipeline m;
+        // The reference codes the padded image; the trailer holds the size, followed by the quality extension.
+        std::vector<unsigned char> attendu = reference(complet, lb, hb, r);
+        const uint32_t taille[2] = { W, H };
+        std::memcpy(attendu.data() + attendu.size() - 16, taille, sizeof(taille));
+        if (!encoder(petit, W, H, r, 2, 16, 0, fichier, m) || fichier != attendu) {
+            std::cerr << W << "x" << H << ": the padded file differs\n";
+            ok = false;
+        }
+    }
+
+    // A source that fails stops every stage and reports the error.
+    {
+        cEncodeurPipeline enc(w, h, 60);
+        enc.setNbThreads(2);
+        enc.setLignesParBande(8);
+        enc.setProfondeur(2);
+        unsigned int appels = 0;
+        std::vector<unsigned char> fichier;
+        const bool reussi = enc.Encoder([&appels](unsigned char *lignes, size_t pas, unsigned int nbLignes) {
+            std::memset(lignes, 0, pas * nbLignes);
+            return ++appels < 5;
+        }, fichier);
+        if (reussi || !fichier.empty()) {
+            std::cerr << "a failing source must fail the encode\n";
+            ok = false;
+        }
+    }
+
+    if (!ok) return 1;
+    std::cout << "test_pipeline passed\n";
+    return 0;
+}
@@ -1,7 +1,9 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <cstdlib>
 #include "dct/dct.h"
+#include "dct/dct_kernels.h"
 #include "quantification/quantification.h"
 #include "core/cCompression.h"
 
@@ -140,6 +142,80 @@ int main() {
         }
     }
 
+    // The quantization context must agree with quant_JPEG() and with the block kernels.
+    cContexteQuant ctx(50);
+    for (int k = 0; k < 64 && ok; ++k) {
+        if (ctx.getTable()[k] != Qtab[k / 8][k % 8]) {
+            std::cerr << "Context table mismatch at " << k << "\n";
+            ok = false;
+        }
+    }
+
+    int16_t flatIn[64];
+    float flatDct[64];
+    int16_t kernelQuant[64];
+    int16_t zigzag[64];
+    for (int k = 0; k < 64; ++k) flatIn[k] = static_cast<int16_t>(shiftedIn[k / 8][k % 8]);
+    Calcul_DCT_Block(flatIn, flatDct);
+    dct_kernels_scalar().dct_quant(flatIn, ctx.getInverses(), kernelQuant, 1);
+    ctx.quantifier_zigzag(flatDct, zigzag);
+    for (int k = 0; k < 64 && ok; ++k) {
+        if (zigzag[k] != kernelQuant[ZIGZAG[k]]) {
+            std::cerr << "quantifier_zigzag mismatch at scan position " << k << "\n";
+            ok = false;
+        }
+        if (std::abs(zigzag[k] - Img_Quant[ZIGZAG[k] / 8][ZIGZAG[k] % 8]) > 1) {
+            std::cerr << "quantifier_zigzag disagrees with quant_JPEG at scan position " << k << "\n";
+            ok = false;
+        }
+    }
+
+    // The integer reciprocal must reproduce an exact rounded division by 8*Q
+    // over the whole range produced by the fixed-point DCT of 8-bit samples.
+    for (unsigned int qual : {1u, 50u, 100u}) {
+        cContexteQuant ctxQ(qual);
+        int32_t dct8[64];
+        int16_t zz[64];
+        for (int32_t x = -16384; x <= 16384 && ok; ++x) {
+            for (int k = 0; k < 64; ++k) dct8[k] = x;
+            ctxQ.quantifier_zigzag_entier(dct8, zz);
+            for (int k = 0; k < 64; ++k) {
+                int32_t d = 8 * ctxQ.getTable()[ZIGZAG[k]];
+                int32_t attendu = (std::abs(x) + d / 2) / d;
+                if (x < 0) attendu = -attendu;
+                if (zz[k] != attendu) {
+                    std::cerr << "Integer quantization mismatch: x=" << x << " d=" << d << " got " << zz[k] << "\n";
+                    ok = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Chrominance uses its own base table (K.2); quality 50 leaves it unscaled.
+    cContexteQuant chroma(50, COMPOSANTE_CHROMA);
+    if (chroma.getTable()[0] != 17 || chroma.getTable()[63] != 99 || chroma.getComposante() != COMPOSANTE_CHROMA) {
+        std::cerr << "Chrominance table mismatch\n";
+        ok = false;
+    }
+
+    // Changing the global quality must be picked up by quant_JPEG().
+    cCompression::setQualiteGlobale(10);
+    int Qtab10[8][8];
+    build_Q_table(Qtab10);
+    for (int i = 0; i < 8; ++i) for (int j = 0; j < 8; ++j) {
+        dctBlock[i][j] = 3.0 * Qtab10[i][j];
+    }
+    quant_JPEG(dctBlock, Img_Quant);
+    for (int i = 0; i < 8 && ok; ++i) for (int j = 0; j < 8; ++j) {
+        if (Img_Quant[i][j] != 3) {
+            std::cerr << "quant_JPEG did not follow the quality change at (" << i << "," << j << ")\n";
+            ok = false;
+            break;
+        }
+    }
+    cCompression::setQualiteGlobale(50);
+
     // cleanup
     for (int i = 0; i < 8; ++i) {
         delete[] shiftedIn[i];
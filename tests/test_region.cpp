@@ -0,0 +1,106 @@
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "core/cCompression.h"
+#include "core/cContexteCodec.h"
+#include "motif.h"
+
+int main() {
+    bool ok = true;
+    const unsigned int w = 200, h = 120;
+    std::vector<unsigned char> pixels(static_cast<size_t>(w) * h);
+    std::vector<unsigned char*> lignes(h);
+    for (unsigned int y = 0; y < h; ++y) {
+        lignes[y] = pixels.data() + static_cast<size_t>(y) * w;
+        for (unsigned int x = 0; x < w; ++x) lignes[y][x] = motif(x, y);
+    }
+
+    // Without an index, the file is the plain one; the index only appends an extension.
+    std::vector<unsigned char> sansIndex;
+    {
+        cCompression codec(w, h, 60, lignes.data());
+        codec.setContexte(std::make_shared<cContexteCodec>(60));
+        std::vector<signed char> trame;
+        codec.RLE(trame);
+        codec.Compression_JPEG(trame, sansIndex);
+    }
+
+    struct sCas { unsigned int restart, index; };
+    const sCas cas[] = { { 0, 0 }, { 0, w / 8 }, { 0, 7 }, { 11, 0 }, { 11, 4 }, { 30, w / 8 } };
+    struct sRect { unsigned int x, y, w, h; };
+    const sRect rects[] = { { 0, 0, w, h }, { 0, 0, 1, 1 }, { w - 1, h - 1, 1, 1 }, { 37, 21, 50, 33 },
+                            { 64, 40, 8, 8 }, { 150, 3, 50, 117 }, { 5, 100, 190, 20 } };
+    for (const sCas &c : cas) {
+        cCompression codec(w, h, 60, lignes.data());
+        codec.setContexte(std::make_shared<cContexteCodec>(60));
+        codec.setIntervalleRestart(c.restart);
+        codec.setIntervalleIndex(c.index);
+        std::vector<signed char> trame;
+        std::vector<unsigned char> fichier, complet(pixels.size());
+        codec.RLE(trame);
+        codec.Compression_JPEG(trame, fichier);
+        if (c.restart == 0 && (fichier.size() < sansIndex.size()
+                               || std::memcmp(fichier.data(), sansIndex.data(), sansIndex.size()) != 0)) {
+            std::cerr << "index " << c.index << ": the file does not start with the plain file\n";
+            ok = false;
+        }
+
+        cCompression lecteur;
+        if (!lecteur.Decompression_JPEG(fichier.data(), fichier.size(), complet.data(), w, w, h)) {
+            std::cerr << "full decode failed\n";
+            return 1;
+        }
+        const unsigned int threads[] = { 1, 3 };
+        for (unsigned int n : threads) {
+            lecteur.setNbThreads(n);
+            for (const sRect &r : rects) {
+                std::vector<unsigned char> region(static_cast<size_t>(r.w + 3) * r.h, 0);
+                if (!lecteur.DecodeRegion(fichier.data(), fichier.size(), r.x, r.y, r.w, r.h, region.data(), r.w + 3)) {
+                    std::cerr << "restart " << c.restart << ", index " << c.index << ": region refused\n";
+                    ok = false;
+                    continue;
+                }
+                for (unsigned int j = 0; j < r.h; ++j) {
+                    if (std::memcmp(region.data() + j * (r.w + 3), complet.data() + (r.y + j) * w + r.x, r.w) != 0) {
+                        std::cerr << "restart " << c.restart << ", index " << c.index << ", " << n << " threads: region "
+                                  << r.x << "," << r.y << " " << r.w << "x" << r.h << " differs at row " << j << "\n";
+                        ok = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // A targeted encoding counts the index in the size.
+    {
+        cCompression codec(w, h, 60, lignes.data());
+        codec.setContexte(std::make_shared<cContexteCodec>(60));
+        codec.setIntervalleIndex(w / 8);
+        std::vector<unsigned char> fichier;
+        sResultatCible r;
+        if (!codec.Compression_Cible(CIBLE_TAILLE, 6000, fichier, &r) || r.taille != fichier.size()) {
+            std::cerr << "size target with an index: estimated " << r.taille << ", written " << fichier.size() << "\n";
+            ok = false;
+        }
+    }
+
+    // Rectangles outside the image are refused.
+    {
+        cCompression lecteur;
+        std::vector<unsigned char> tampon(static_cast<size_t>(w) * h);
+        const sRect mauvais[] = { { 0, 0, 0, 5 }, { w - 4, 0, 5, 1 }, { 0, h, 1, 1 }, { 0, 0, w + 1, 1 } };
+        for (const sRect &r : mauvais) {
+            if (lecteur.DecodeRegion(sansIndex.data(), sansIndex.size(), r.x, r.y, r.w, r.h, tampon.data(), w + 1)) {
+                std::cerr << "region " << r.x << "," << r.y << " " << r.w << "x" << r.h << " must be refused\n";
+                ok = false;
+            }
+        }
+    }
+
+    if (!ok) return 1;
+    std::cout << "test_region passed\n";
+    return 0;
+}
@@ -1,6 +1,18 @@
 #include <iostream>
 #include <iomanip>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <memory>
+#include <thread>
 #include "core/cCompression.h"
+#include "core/cContexteCodec.h"
+#include "core/cFichierMappe.h"
+#include "core/cFormatHuf2.h"
 
 int main() {
     // Example 8x8 block (same as other tests / Lena example)
@@ -44,6 +56,362 @@ int main() {
     // Cleanup
     for (int r = 0; r < 8; ++r) delete[] bufferRows[r];
 
+    // Multi-block round trip: every block's bytes must be appended exactly,
+    // otherwise the decoder sees extra blocks and the image comes back garbled.
+    const unsigned int W = 32, H = 24;
+    std::vector<unsigned char> pixels(W * H);
+    std::vector<unsigned char*> rows(H);
+    for (unsigned int y = 0; y < H; ++y) {
+        rows[y] = pixels.data() + y * W;
+        for (unsigned int x = 0; x < W; ++x) {
+            // Smooth gradient with a few flat blocks (dc_diff == 0) and busy ones.
+            int v = (x < 16 && y < 8) ? 100 : static_cast<int>(60 + 4 * x + 3 * y + ((x * 7 + y * 13) % 5));
+            rows[y][x] = static_cast<unsigned char>(v);
+        }
+    }
+    cCompression enc(W, H, 50, rows.data());
+    std::vector<int> trameImg(1 + (W / 8) * (H / 8) * 128, 0);
+    enc.RLE(trameImg.data());
+    enc.Compression_JPEG(trameImg.data(), "test_rle_roundtrip.huff");
+
+    cCompression dec;
+    unsigned char **out = dec.Decompression_JPEG("test_rle_roundtrip.huff");
+    bool ok = (out != nullptr && dec.getLargeur() == W && dec.getHauteur() == H);
+    double mse = 0.0;
+    if (ok) {
+        for (unsigned int y = 0; y < H; ++y) for (unsigned int x = 0; x < W; ++x) {
+            double d = static_cast<double>(out[y][x]) - rows[y][x];
+            mse += d * d;
+        }
+        mse /= static_cast<double>(W * H);
+        std::cout << "Round-trip MSE (" << W << "x" << H << "): " << mse << "\n";
+        ok = mse < 30.0;
+    }
+    if (out) {
+        delete[] out[0];
+        delete[] out;
+    }
+
+    // Decoding from a caller-supplied span, or from the mapped file, gives the same image.
+    if (ok) {
+        std::ifstream f("test_rle_roundtrip.huff", std::ios::binary);
+        std::vector<unsigned char> octets((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        cFichierMappe fichier;
+        ok = fichier.ouvrir("test_rle_roundtrip.huff") && fichier.getTaille() == octets.size() &&
+             std::memcmp(fichier.getDonnees(), octets.data(), octets.size()) == 0;
+        cCompression decSpan, decFichier;
+        unsigned char **viaSpan = decSpan.Decompression_JPEG(octets.data(), octets.size());
+        unsigned char **viaFichier = decFichier.Decompression_JPEG("test_rle_roundtrip.huff");
+        ok = ok && viaSpan && viaFichier && decSpan.getLargeur() == W && decSpan.getHauteur() == H;
+        for (unsigned int y = 0; ok && y < H; ++y) ok = (std::memcmp(viaSpan[y], viaFichier[y], W) == 0);
+        for (unsigned char **img : {viaSpan, viaFichier}) {
+            if (img) { delete[] img[0]; delete[] img; }
+        }
+
+        // A truncated buffer is rejected rather than read past its end.
+        cCompression decTronque;
+        unsigned char **tronque = decTronque.Decompression_JPEG(octets.data(), octets.size() / 2);
+        if (tronque) { ok = false; delete[] tronque[0]; delete[] tronque; }
+
+        // A bitstream that ends early decodes its blocks up to there; the rest is flat gray.
+        std::vector<unsigned char> court(octets);
+        size_t posBits = 4 + 1 + 16;
+        for (int l = 0; l < 16; ++l) posBits += court[5 + l];
+        posBits += 4;
+        uint32_t bits = 0;
+        std::memcpy(&bits, court.data() + posBits, sizeof(bits));
+        bits /= 2;
+        std::memcpy(court.data() + posBits, &bits, sizeof(bits));
+        cCompression decCourt;
+        unsigned char **partiel = decCourt.Decompression_JPEG(court.data(), court.size());
+        ok = ok && partiel && partiel[H - 1][W - 1] == 128 && partiel[0][0] != 128;
+        if (partiel) { delete[] partiel[0]; delete[] partiel; }
+
+        cFichierMappe absent;
+        ok = ok && !absent.ouvrir("test_rle_absent.huff") && absent.getDonnees() == nullptr;
+        if (!ok) std::cerr << "Span / mapped-file decoding mismatch\n";
+    }
+
+    // The byte-vector interface produces exactly the int trame, and the same file.
+    if (ok) {
+        std::vector<signed char> octets;
+        enc.RLE(octets);
+        ok = (octets.size() == static_cast<size_t>(trameImg[0]));
+        for (size_t i = 0; ok && i < octets.size(); ++i) ok = (octets[i] == trameImg[i + 1]);
+        enc.Compression_JPEG(octets, "test_rle_vector.huff");
+        std::ifstream fa("test_rle_roundtrip.huff", std::ios::binary), fb("test_rle_vector.huff", std::ios::binary);
+        std::string da((std::istreambuf_iterator<char>(fa)), std::istreambuf_iterator<char>());
+        std::string db((std::istreambuf_iterator<char>(fb)), std::istreambuf_iterator<char>());
+        ok = ok && !da.empty() && da == db;
+
+        cCompression par(W, H, 50, rows.data());
+        par.setNbThreads(3);
+        std::vector<signed char> octetsPar;
+        par.RLE(octetsPar);
+        ok = ok && (octetsPar == octets);
+        if (!ok) std::cerr << "Byte-vector RLE differs from the int trame\n";
+    }
+
+    // Files in the older HUF1 layout (symbol counts + frequency-built tree) remain readable.
+    if (ok) {
+        std::vector<char> octets(trameImg[0]);
+        for (int i = 0; i < trameImg[0]; ++i) octets[i] = static_cast<char>(trameImg[i + 1]);
+        char Donnee[256];
+        double Frequence[256];
+        unsigned int nbSym = enc.Histogramme(octets.data(), static_cast<unsigned int>(octets.size()), Donnee, Frequence);
+        cHuffman h;
+        h.HuffmanCodes(Donnee, Frequence, nbSym);
+        std::map<char, std::string> codes;
+        h.BuildTableCodes(codes);
+        std::vector<unsigned char> payload;
+        uint32_t bits = 0;
+        for (char c : octets) for (char bit : codes[c]) {
+            if (bits % 8 == 0) payload.push_back(0);
+            if (bit == '1') payload.back() |= static_cast<unsigned char>(0x80u >> (bits % 8));
+            ++bits;
+        }
+        std::ofstream f("test_rle_huf1.huff", std::ios::binary);
+        f.write("HUF1", 4);
+        uint16_t nb16 = static_cast<uint16_t>(nbSym);
+        f.write(reinterpret_cast<const char*>(&nb16), sizeof(nb16));
+        for (unsigned int i = 0; i < nbSym; ++i) {
+            uint32_t cnt = static_cast<uint32_t>(Frequence[i]);
+            f.put(Donnee[i]);
+            f.write(reinterpret_cast<const char*>(&cnt), sizeof(cnt));
+        }
+        uint32_t nbOctets = static_cast<uint32_t>(payload.size());
+        f.write(reinterpret_cast<const char*>(&nbOctets), sizeof(nbOctets));
+        f.write(reinterpret_cast<const char*>(&bits), sizeof(bits));
+        f.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        f.write(reinterpret_cast<const char*>(&W), sizeof(W));
+        f.write(reinterpret_cast<const char*>(&H), sizeof(H));
+        f.close();
+
+        cCompression decRef, decHuf1;
+        unsigned char **ref = decRef.Decompression_JPEG("test_rle_roundtrip.huff");
+        unsigned char **ancien = decHuf1.Decompression_JPEG("test_rle_huf1.huff");
+        ok = ref && ancien;
+        for (unsigned int y = 0; ok && y < H; ++y) {
+            if (std::memcmp(ref[y], ancien[y], W) != 0) {
+                std::cerr << "HUF1 decode differs from HUF2 at row " << y << "\n";
+                ok = false;
+            }
+        }
+        for (unsigned char **img : {ref, ancien}) {
+            if (img) { delete[] img[0]; delete[] img; }
+        }
+    }
+
+    // A flat image yields a single-symbol alphabet, which must still round-trip.
+    if (ok) {
+        std::vector<unsigned char> gris(16 * 16, 128);
+        std::vector<unsigned char*> lignesGris(16);
+        for (int y = 0; y < 16; ++y) lignesGris[y] = gris.data() + y * 16;
+        cCompression encGris(16, 16, 50, lignesGris.data());
+        std::vector<int> trameGris(1 + 4 * 128, 0);
+        encGris.RLE(trameGris.data());
+        encGris.Compression_JPEG(trameGris.data(), "test_rle_flat.huff");
+        cCompression decGris;
+        unsigned char **outGris = decGris.Decompression_JPEG("test_rle_flat.huff");
+        ok = (outGris != nullptr);
+        for (int y = 0; ok && y < 16; ++y) for (int x = 0; x < 16; ++x) {
+            if (outGris[y][x] != 128) { ok = false; break; }
+        }
+        if (!ok) std::cerr << "Flat image round trip failed\n";
+        if (outGris) { delete[] outGris[0]; delete[] outGris; }
+    }
+
+    // The parallel encoder must produce exactly the serial bytes, whatever the thread count.
+    for (unsigned int nbThreads : {2u, 3u, 0u}) {
+        if (!ok) break;
+        cCompression encPar(W, H, 50, rows.data());
+        encPar.setNbThreads(nbThreads);
+        std::vector<int> tramePar(trameImg.size(), 0);
+        encPar.RLE(tramePar.data());
+        if (tramePar != trameImg) {
+            std::cerr << "Parallel RLE (" << nbThreads << " threads) differs from the serial output\n";
+            ok = false;
+        }
+    }
+
+    // Restart intervals: same pixels as the monolithic stream, decoded segment by segment in parallel.
+    if (ok) {
+        const unsigned int N = 5; // 12 blocks -> segments of 5, 5 and 2 blocks
+        cCompression encRst(W, H, 50, rows.data());
+        encRst.setIntervalleRestart(N);
+        std::vector<int> trameRst(trameImg.size(), 0);
+        encRst.RLE(trameRst.data());
+        encRst.Compression_JPEG(trameRst.data(), "test_rle_restart.huff");
+
+        cCompression encRstPar(W, H, 50, rows.data());
+        encRstPar.setIntervalleRestart(N);
+        encRstPar.setNbThreads(3);
+        std::vector<int> trameRstPar(trameImg.size(), 0);
+        encRstPar.RLE(trameRstPar.data());
+        if (trameRstPar != trameRst) {
+            std::cerr << "Parallel RLE with restart intervals differs from the serial output\n";
+            ok = false;
+        }
+
+        cCompression decRef;
+        unsigned char **ref = decRef.Decompression_JPEG("test_rle_roundtrip.huff");
+        cCompression decRst;
+        decRst.setNbThreads(3);
+        unsigned char **rst = decRst.Decompression_JPEG("test_rle_restart.huff");
+        ok = (ref != nullptr && rst != nullptr);
+        for (unsigned int y = 0; ok && y < H; ++y) {
+            if (std::memcmp(ref[y], rst[y], W) != 0) {
+                std::cerr << "Restart-interval decode differs from the monolithic one at row " << y << "\n";
+                ok = false;
+            }
+        }
+
+        // Corrupt the second segment: the blocks of the other segments must be unaffected.
+        std::ifstream fin("test_rle_restart.huff", std::ios::binary);
+        std::vector<char> fichier((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        fin.close();
+        size_t tag = 0;
+        for (size_t i = fichier.size() - 4; ok && i > 0; --i) {
+            if (std::memcmp(fichier.data() + i, kTagRestart, sizeof(kTagRestart)) == 0) { tag = i; break; }
+        }
+        // HUF2 header: magic, table mode, the table, then the payload size in bytes and in bits.
+        size_t payload = 0;
+        if (fichier.size() > sizeof(kMagiqueHuf2) + 1 + cHuffman::kLongueurMax &&
+            std::memcmp(fichier.data(), kMagiqueHuf2, sizeof(kMagiqueHuf2)) == 0) {
+            size_t pos = sizeof(kMagiqueHuf2);
+            const unsigned char modeTable = static_cast<unsigned char>(fichier[pos++]);
+            if (modeTable == kTableStatique) {
+                pos += 2 * sizeof(uint16_t);
+            } else if (modeTable == kTableIntegree) {
+                size_t nbSym = 0;
+                for (int l = 0; l < cHuffman::kLongueurMax; ++l) nbSym += static_cast<unsigned char>(fichier[pos + l]);
+                pos += cHuffman::kLongueurMax + nbSym;
+            }
+            payload = pos + 2 * sizeof(uint32_t);
+        }
+        uint32_t off1 = 0, off2 = 0;
+        if (tag != 0 && tag + 12 + 16 + sizeof(off2) <= fichier.size()) {
+            std::memcpy(&off1, fichier.data() + tag + 12 + 8, sizeof(off1));
+            std::memcpy(&off2, fichier.data() + tag + 12 + 16, sizeof(off2));
+        }
+        if (ok && (payload == 0 || off1 >= off2 || payload + off2 > fichier.size())) {
+            std::cerr << "Restart segment 2 not found in the file\n";
+            ok = false;
+        }
+        for (uint32_t i = off1; ok && i < off2; ++i) fichier[payload + i] ^= 0x5A;
+        std::ofstream fout("test_rle_restart_corrupt.huff", std::ios::binary);
+        fout.write(fichier.data(), static_cast<std::streamsize>(fichier.size()));
+        fout.close();
+
+        cCompression decCor;
+        sStatistiques statsCor;
+        decCor.setStatistiques(&statsCor);
+        unsigned char **cor = ok ? decCor.Decompression_JPEG("test_rle_restart_corrupt.huff") : nullptr;
+        ok = ok && cor != nullptr;
+        bool endommage = false;
+        for (unsigned int bloc = 0; ok && bloc < (W / 8) * (H / 8); ++bloc) {
+            const bool corrompu = bloc >= N && bloc < 2 * N; // the corrupted segment
+            unsigned int bx = (bloc % (W / 8)) * 8, by = (bloc / (W / 8)) * 8;
+            for (unsigned int r = 0; r < 8; ++r) {
+                if (std::memcmp(ref[by + r] + bx, cor[by + r] + bx, 8) != 0) {
+                    if (corrompu) {
+                        endommage = true;
+                        continue;
+                    }
+                    std::cerr << "Corruption leaked into block " << bloc << "\n";
+                    ok = false;
+                    break;
+                }
+            }
+        }
+        if (ok && (!endommage || (kStatistiques && statsCor.segmentsCorrompus != 1))) {
+            std::cerr << "The corrupted restart segment was not detected\n";
+            ok = false;
+        }
+        for (unsigned char **img : {ref, rst, cor}) {
+            if (img) { delete[] img[0]; delete[] img; }
+        }
+    }
+
+    // Same round trip through the fixed-point pipeline.
+    if (ok) {
+        cCompression encEntier(W, H, 50, rows.data());
+        encEntier.setModePipeline(PIPELINE_ENTIER);
+        std::vector<int> trameEntier(trameImg.size(), 0);
+        encEntier.RLE(trameEntier.data());
+        encEntier.Compression_JPEG(trameEntier.data(), "test_rle_roundtrip_int.huff");
+
+        cCompression decEntier;
+        decEntier.setModePipeline(PIPELINE_ENTIER);
+        unsigned char **outEntier = decEntier.Decompression_JPEG("test_rle_roundtrip_int.huff");
+        ok = (outEntier != nullptr);
+        if (ok) {
+            double mseEntier = 0.0;
+            for (unsigned int y = 0; y < H; ++y) for (unsigned int x = 0; x < W; ++x) {
+                double d = static_cast<double>(outEntier[y][x]) - rows[y][x];
+                mseEntier += d * d;
+            }
+            mseEntier /= static_cast<double>(W * H);
+            std::cout << "Round-trip MSE, fixed-point pipeline: " << mseEntier << "\n";
+            ok = mseEntier < 30.0;
+            delete[] outEntier[0];
+            delete[] outEntier;
+        }
+    }
+
+    // Instances with their own contexts encode concurrently at different
+    // qualities, and the files decode without knowing the encoder's quality.
+    if (ok) {
+        const unsigned int qualites[2] = { 20, 80 };
+        const char *fichiers[2] = { "test_rle_ctx_20.huff", "test_rle_ctx_80.huff" };
+        auto encoder = [&](int i, const char *fichier) {
+            cCompression e(W, H, qualites[i], rows.data());
+            e.setContexte(std::make_shared<cContexteCodec>(qualites[i]));
+            std::vector<signed char> t;
+            e.RLE(t);
+            e.Compression_JPEG(t, fichier);
+        };
+        std::thread t0(encoder, 0, fichiers[0]), t1(encoder, 1, fichiers[1]);
+        t0.join();
+        t1.join();
+
+        cCompression::setQualiteGlobale(50);
+        for (int i = 0; ok && i < 2; ++i) {
+            // Serial reference through the global context at the same quality.
+            cCompression::setQualiteGlobale(qualites[i]);
+            encoder(i, "test_rle_ctx_ref.huff");
+            cCompression::setQualiteGlobale(50);
+            std::ifstream fa(fichiers[i], std::ios::binary), fb("test_rle_ctx_ref.huff", std::ios::binary);
+            std::string a((std::istreambuf_iterator<char>(fa)), std::istreambuf_iterator<char>());
+            std::string b((std::istreambuf_iterator<char>(fb)), std::istreambuf_iterator<char>());
+            ok = !a.empty() && a == b;
+
+            // Decoding with contexts at other qualities follows the file.
+            cCompression decA, decB;
+            decB.setContexte(std::make_shared<cContexteCodec>(75));
+            unsigned char **ia = decA.Decompression_JPEG(fichiers[i]);
+            unsigned char **ib = decB.Decompression_JPEG(fichiers[i]);
+            ok = ok && ia && ib;
+            double m = 0.0;
+            for (unsigned int y = 0; ok && y < H; ++y) {
+                ok = std::memcmp(ia[y], ib[y], W) == 0;
+                for (unsigned int x = 0; x < W; ++x) {
+                    double d = static_cast<double>(ia[y][x]) - rows[y][x];
+                    m += d * d;
+                }
+            }
+            std::cout << "Context quality " << qualites[i] << ": " << a.size() << " bytes, MSE=" << m / (W * H) << "\n";
+            for (unsigned char **img : {ia, ib}) {
+                if (img) { delete[] img[0]; delete[] img; }
+            }
+        }
+        if (!ok) std::cerr << "Per-instance contexts do not match the global-quality encoder\n";
+    }
+
+    if (!ok) {
+        std::cerr << "test_rle: FAIL (multi-block round trip)\n";
+        return 1;
+    }
     std::cout << "test_rle: DONE\n";
     return 0;
 }
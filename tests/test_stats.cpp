@@ -0,0 +1,126 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "core/cCompression.h"
+#include "core/cCompressionCouleur.h"
+#include "core/cStatistiques.h"
+#include "motif.h"
+
+int main() {
+    bool ok = true;
+
+    // Grayscale, on two threads with restart segments: the stripes and segments add up.
+    const unsigned int w = 64, h = 48;
+    std::vector<unsigned char> pixels(static_cast<size_t>(w) * h);
+    std::vector<unsigned char*> lignes(h);
+    for (unsigned int y = 0; y < h; ++y) {
+        lignes[y] = pixels.data() + static_cast<size_t>(y) * w;
+        for (unsigned int x = 0; x < w; ++x) lignes[y][x] = motif(x, y, 0);
+    }
+    cCompression gris(w, h, 60, lignes.data());
+    gris.setNbThreads(2);
+    gris.setIntervalleRestart(5);
+
+    std::vector<signed char> trameNue;
+    std::vector<unsigned char> fichierNu;
+    gris.RLE(trameNue);
+    gris.Compression_JPEG(trameNue, fichierNu);
+
+    sStatistiques stats;
+    std::vector<std::string> messages;
+    gris.setStatistiques(&stats);
+    gris.setTrace([&](const char *m) { messages.push_back(m); });
+    std::vector<signed char> trame;
+    std::vector<unsigned char> fichier;
+    gris.RLE(trame);
+    gris.Compression_JPEG(trame, fichier);
+    if (trame != trameNue || fichier != fichierNu) {
+        std::cerr << "measuring changed the encoder output\n";
+        ok = false;
+    }
+
+    cCompression lecteur;
+    lecteur.setNbThreads(2);
+    sStatistiques statsDec;
+    lecteur.setStatistiques(&statsDec);
+    lecteur.setTrace([&](const char *m) { messages.push_back(m); });
+    std::vector<unsigned char> image(pixels.size());
+    if (!lecteur.Decompression_JPEG(fichier.data(), fichier.size(), image.data(), w, w, h)) {
+        std::cerr << "grayscale decode failed\n";
+        ok = false;
+    }
+
+    if (kStatistiques) {
+        if (stats.blocs != w * h / 64 || stats.octetsEntree != w * h || stats.symboles != trame.size() || stats.octetsSortie != fichier.size()) {
+            std::cerr << "grayscale encoder counters: blocs=" << stats.blocs << " in=" << stats.octetsEntree
+                      << " symboles=" << stats.symboles << " out=" << stats.octetsSortie << "\n";
+            ok = false;
+        }
+        if (statsDec.blocs != w * h / 64 || statsDec.octetsEntree != fichier.size() || statsDec.symboles != trame.size()
+            || statsDec.octetsSortie != w * h || statsDec.segmentsCorrompus != 0) {
+            std::cerr << "grayscale decoder counters: blocs=" << statsDec.blocs << " in=" << statsDec.octetsEntree
+                      << " symboles=" << statsDec.symboles << " out=" << statsDec.octetsSortie << "\n";
+            ok = false;
+        }
+        if (stats.secondes[ETAPE_DCT] <= 0.0 || stats.secondes[ETAPE_HUFFMAN] <= 0.0 || statsDec.secondes[ETAPE_HUFFMAN] <= 0.0) {
+            std::cerr << "stage times were not measured\n";
+            ok = false;
+        }
+        if (messages.empty() || messages[0].find("Parsed HUF2 header") == std::string::npos) {
+            std::cerr << "the trace hook did not receive the header message\n";
+            ok = false;
+        }
+    } else if (stats.blocs != 0 || gris.getStatistiques() != nullptr || !messages.empty()) {
+        std::cerr << "JPEG_STATS=0 must measure nothing\n";
+        ok = false;
+    }
+
+    // Counters accumulate until the caller resets them.
+    stats.reinitialiser();
+    gris.setStatistiques(nullptr);
+    gris.RLE(trame);
+    if (stats.blocs != 0 || gris.getStatistiques() != nullptr) {
+        std::cerr << "a detached record must not be updated\n";
+        ok = false;
+    }
+
+    // Color: the blocks of every component, and the decoder reads back every symbol.
+    const unsigned int cw = 45, ch = 29;
+    std::vector<unsigned char> rgb(static_cast<size_t>(cw) * ch * 3);
+    for (unsigned int y = 0; y < ch; ++y)
+        for (unsigned int x = 0; x < cw * 3; ++x) rgb[y * cw * 3 + x] = motif(x / 3, y, x % 3);
+    cCompressionCouleur couleur;
+    std::vector<unsigned char> conteneurNu, conteneur;
+    couleur.CompressRGB(rgb.data(), cw, ch, cw * 3, 75, 420, conteneurNu);
+    sStatistiques statsCouleur;
+    couleur.setStatistiques(&statsCouleur);
+    couleur.CompressRGB(rgb.data(), cw, ch, cw * 3, 75, 420, conteneur);
+    const uint64_t symbolesCodes = statsCouleur.symboles;
+    const uint64_t blocsCouleur = static_cast<uint64_t>((cw + 15) / 16) * ((ch + 15) / 16) * 6;
+    if (conteneur != conteneurNu) {
+        std::cerr << "measuring changed the color encoder output\n";
+        ok = false;
+    }
+    if (kStatistiques && (statsCouleur.blocs != blocsCouleur || statsCouleur.octetsEntree != rgb.size()
+                          || statsCouleur.octetsSortie != conteneur.size() || statsCouleur.secondes[ETAPE_COULEUR] <= 0.0)) {
+        std::cerr << "color encoder counters: blocs=" << statsCouleur.blocs << " in=" << statsCouleur.octetsEntree
+                  << " out=" << statsCouleur.octetsSortie << "\n";
+        ok = false;
+    }
+    statsCouleur.reinitialiser();
+    std::vector<unsigned char> sortie(rgb.size());
+    if (!couleur.DecompressToRGB(conteneur.data(), conteneur.size(), sortie.data(), cw * 3, cw, ch)) {
+        std::cerr << "color decode failed\n";
+        ok = false;
+    }
+    if (kStatistiques && (statsCouleur.blocs != blocsCouleur || statsCouleur.symboles != symbolesCodes
+                          || statsCouleur.octetsEntree != conteneur.size() || statsCouleur.octetsSortie != rgb.size())) {
+        std::cerr << "color decoder counters: blocs=" << statsCouleur.blocs << " symboles=" << statsCouleur.symboles
+                  << " (" << symbolesCodes << " coded)\n";
+        ok = false;
+    }
+
+    if (!ok) return 1;
+    std::cout << "test_stats passed\n";
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include "core/cCompression.h"
+#include "core/cContexteCodec.h"
+#include "core/cEncodeurFlux.h"
+#include "core/cTablesHuffman.h"
+#include "motif.h"
+
+int main() {
+    bool ok = true;
+    cTablesHuffman &registre = cTablesHuffman::global();
+
+    // The built-in table is registered, and is the one of the streaming encoder.
+    const sTableHuffman *defaut = registre.trouver(cTablesHuffman::kIdDefaut);
+    if (!defaut || defaut->version != 1 || std::memcmp(defaut->Longueurs, cEncodeurFlux::getLongueursFixes(), 256) != 0) {
+        std::cerr << "the built-in table is not registered\n";
+        return 1;
+    }
+
+    const unsigned int w = 64, h = 48;
+    std::vector<unsigned char> pixels(static_cast<size_t>(w) * h);
+    std::vector<unsigned char*> lignes(h);
+    for (unsigned int y = 0; y < h; ++y) {
+        lignes[y] = pixels.data() + static_cast<size_t>(y) * w;
+        for (unsigned int x = 0; x < w; ++x) lignes[y][x] = motif(x, y);
+    }
+    cCompression codec(w, h, 60, lignes.data());
+    codec.setContexte(std::make_shared<cContexteCodec>(60));
+    std::vector<signed char> trame;
+    codec.RLE(trame);
+
+    // Training gives every byte value a code; the table survives a round trip through its file.
+    uint64_t Comptes[256] = {0};
+    for (signed char c : trame) ++Comptes[static_cast<unsigned char>(c)];
+    sTableHuffman entrainee;
+    entrainee.id = 42;
+    entrainee.version = 1;
+    entrainee.nom = "motif";
+    cTablesHuffman::Entrainer(Comptes, entrainee.Longueurs);
+    const sTableHuffman *chargee = nullptr;
+    if (!cTablesHuffman::Ecrire("tmp_tables_42.htb", entrainee) || !registre.charger("tmp_tables_42.htb", &chargee)
+        || !chargee || chargee->nom != "motif" || std::memcmp(chargee->Longueurs, entrainee.Longueurs, 256) != 0
+        || !registre.charger("tmp_tables_42.htb")) {
+        std::cerr << "trained table not registered from its file\n";
+        return 1;
+    }
+
+    // Conflicting or invalid tables are refused; version 0 finds the latest one.
+    uint8_t autres[256];
+    std::memcpy(autres, defaut->Longueurs, 256);
+    if (registre.enregistrer(42, 1, "conflit", autres) || !registre.enregistrer(42, 3, "v3", autres)
+        || registre.trouver(42)->version != 3 || registre.trouver(42, 1) != chargee || registre.trouver(42, 2)) {
+        std::cerr << "versions are not told apart\n";
+        ok = false;
+    }
+    autres[17] = 0;
+    if (registre.enregistrer(43, 1, "trou", autres)) ok = false;
+    autres[17] = 1;
+    if (registre.enregistrer(43, 1, "trop court", autres)) ok = false;
+    if (!ok) std::cerr << "an invalid table was accepted\n";
+
+    // A file on a static table references it and decodes like the file that embeds its own table.
+    std::vector<unsigned char> propre, statique, complet(pixels.size()), attendu(pixels.size());
+    codec.Compression_JPEG(trame, propre);
+    if (!codec.setTableStatique(42, 1) || codec.getTableStatique() != chargee || codec.setTableStatique(44)) {
+        std::cerr << "static table not selected\n";
+        return 1;
+    }
+    codec.Compression_JPEG(trame, statique);
+    cCompression lecteur;
+    uint16_t ref[2];
+    std::memcpy(ref, statique.data() + 5, sizeof(ref));
+    if (statique[4] != 1 || ref[0] != 42 || ref[1] != 1
+        || !lecteur.Decompression_JPEG(propre.data(), propre.size(), attendu.data(), w, w, h)
+        || !lecteur.Decompression_JPEG(statique.data(), statique.size(), complet.data(), w, w, h) || complet != attendu) {
+        std::cerr << "the file on the static table does not decode like the plain one\n";
+        ok = false;
+    }
+    std::cout << "Plain file: " << propre.size() << " bytes, on the trained table: " << statique.size() << " bytes\n";
+
+    // A reference to a table that is not registered is refused.
+    std::vector<unsigned char> inconnu = statique;
+    inconnu[7] = 2;
+    if (lecteur.Decompression_JPEG(inconnu.data(), inconnu.size(), complet.data(), w, w, h)) {
+        std::cerr << "a file on an unknown table must be refused\n";
+        ok = false;
+    }
+
+    // The size target counts the reference instead of the table.
+    sResultatCible r;
+    if (!codec.Compression_Cible(CIBLE_TAILLE, 1500, statique, &r) || r.taille != statique.size() || statique[4] != 1) {
+        std::cerr << "size target on a static table: estimated " << r.taille << ", written " << statique.size() << "\n";
+        ok = false;
+    }
+
+    // The streaming encoder can reference the table instead of embedding it.
+    std::ostringstream integre(std::ios::binary), reference(std::ios::binary);
+    {
+        cEncodeurFlux a(integre, w, h, 60), b(reference, w, h, 60);
+        if (!b.setTableStatique(cTablesHuffman::kIdDefaut) || !a.ajouterLignes(pixels.data(), w, h) || !a.terminer()
+            || !b.ajouterLignes(pixels.data(), w, h) || !b.terminer() || b.setTableStatique(42)) ok = false;
+    }
+    const std::string fa = integre.str(), fb = reference.str();
+    std::vector<unsigned char> da(pixels.size()), db(pixels.size());
+    if (!ok || fa.size() != fb.size() + 1 + cHuffman::kLongueurMax + 256 - 5
+        || !lecteur.Decompression_JPEG(reinterpret_cast<const uint8_t*>(fa.data()), fa.size(), da.data(), w, w, h)
+        || !lecteur.Decompression_JPEG(reinterpret_cast<const uint8_t*>(fb.data()), fb.size(), db.data(), w, w, h) || da != db) {
+        std::cerr << "the streamed file on a referenced table differs\n";
+        ok = false;
+    }
+
+    if (!ok) return 1;
+    std::cout << "test_tables passed\n";
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "core/cCompression.h"
+#include "core/cCompressionCouleur.h"
+#include "core/cContexteCodec.h"
+#include "core/cTablesHuffman.h"
+#include "motif.h"
+
+// Where pixel (x, y) of the transformed image comes from, in a w x h source.
+static void pixel_source(eTransformation t, unsigned int w, unsigned int h, unsigned int x, unsigned int y,
+                         unsigned int &sx, unsigned int &sy)
+{
+    switch (t) {
+    case TRANSFORMATION_MIROIR_H:      sx = w - 1 - x; sy = y; break;
+    case TRANSFORMATION_MIROIR_V:      sx = x; sy = h - 1 - y; break;
+    case TRANSFORMATION_ROTATION_90:   sx = y; sy = h - 1 - x; break;
+    case TRANSFORMATION_ROTATION_180:  sx = w - 1 - x; sy = h - 1 - y; break;
+    case TRANSFORMATION_ROTATION_270:  sx = w - 1 - y; sy = x; break;
+    case TRANSFORMATION_TRANSPOSITION: sx = y; sy = x; break;
+    case TRANSFORMATION_TRANSVERSE:    sx = w - 1 - y; sy = h - 1 - x; break;
+    default:                           sx = x; sy = y; break;
+    }
+}
+
+static bool transpose(eTransformation t) {
+    return t == TRANSFORMATION_ROTATION_90 || t == TRANSFORMATION_ROTATION_270
+           || t == TRANSFORMATION_TRANSPOSITION || t == TRANSFORMATION_TRANSVERSE;
+}
+
+static std::vector<unsigned char> decoder_gris(const std::vector<unsigned char> &fichier, unsigned int &w, unsigned int &h) {
+    cCompression d;
+    d.setContexte(std::make_shared<cContexteCodec>(50));
+    unsigned char **lignes = d.Decompression_JPEG(fichier.data(), fichier.size());
+    if (!lignes) return {};
+    w = d.getLargeur();
+    h = d.getHauteur();
+    std::vector<unsigned char> pixels(lignes[0], lignes[0] + static_cast<size_t>(w) * h);
+    delete[] lignes[0];
+    delete[] lignes;
+    return pixels;
+}
+
+int main() {
+    bool ok = true;
+    const eTransformation toutes[] = { TRANSFORMATION_MIROIR_H, TRANSFORMATION_MIROIR_V, TRANSFORMATION_ROTATION_90,
+                                       TRANSFORMATION_ROTATION_180, TRANSFORMATION_ROTATION_270,
+                                       TRANSFORMATION_TRANSPOSITION, TRANSFORMATION_TRANSVERSE };
+
+    // Grayscale, with restart intervals and a seek index re-emitted by the transforms.
+    {
+        const unsigned int w = 64, h = 40;
+        std::vector<unsigned char> pixels(static_cast<size_t>(w) * h);
+        std::vector<unsigned char*> lignes(h);
+        for (unsigned int y = 0; y < h; ++y) {
+            lignes[y] = pixels.data() + static_cast<size_t>(y) * w;
+            for (unsigned int x = 0; x < w; ++x) pixels[y * w + x] = motif(x, y, 0);
+        }
+        cCompression codec(w, h, 75, lignes.data());
+        codec.setContexte(std::make_shared<cContexteCodec>(75));
+        codec.setIntervalleRestart(5);
+        codec.setIntervalleIndex(8);
+        std::vector<signed char> trame;
+        std::vector<unsigned char> fichier, sortie;
+        codec.RLE(trame);
+        codec.Compression_JPEG(trame, fichier);
+
+        if (!codec.Transformation_JPEG(fichier.data(), fichier.size(), TRANSFORMATION_AUCUNE, sortie) || sortie != fichier) {
+            std::cerr << "the identity must give back the file\n";
+            ok = false;
+        }
+        std::vector<unsigned char> tour = fichier;
+        for (int i = 0; i < 4 && ok; ++i) {
+            ok = codec.Transformation_JPEG(tour.data(), tour.size(), TRANSFORMATION_ROTATION_90, sortie);
+            tour = sortie;
+        }
+        if (!ok || tour != fichier) {
+            std::cerr << "four quarter turns must give back the file\n";
+            ok = false;
+        }
+
+        unsigned int W = 0, H = 0;
+        const std::vector<unsigned char> reference = decoder_gris(fichier, W, H);
+        for (eTransformation t : toutes) {
+            unsigned int W2 = 0, H2 = 0;
+            std::vector<unsigned char> image;
+            if (codec.Transformation_JPEG(fichier.data(), fichier.size(), t, sortie)) image = decoder_gris(sortie, W2, H2);
+            if (image.empty() || W2 != (transpose(t) ? H : W) || H2 != (transpose(t) ? W : H)) {
+                std::cerr << "transform " << t << " failed\n";
+                ok = false;
+                continue;
+            }
+            for (unsigned int y = 0; y < H2; ++y) {
+                for (unsigned int x = 0; x < W2; ++x) {
+                    unsigned int sx = 0, sy = 0;
+                    pixel_source(t, W, H, x, y, sx, sy);
+                    if (std::abs(image[y * W2 + x] - reference[sy * W + sx]) > 1) {
+                        std::cerr << "transform " << t << ": pixel (" << x << ", " << y << ") differs\n";
+                        ok = false;
+                        y = H2;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // A crop, with a static table; then crops off block boundaries or outside the image.
+        codec.setTableStatique(cTablesHuffman::kIdDefaut, 1);
+        sRecadrage r;
+        r.x = 16; r.y = 8; r.largeur = 24; r.hauteur = 0;
+        unsigned int W2 = 0, H2 = 0;
+        std::vector<unsigned char> image;
+        if (codec.Transformation_JPEG(fichier.data(), fichier.size(), TRANSFORMATION_AUCUNE, sortie, &r))
+            image = decoder_gris(sortie, W2, H2);
+        bool pareil = !image.empty() && W2 == 24 && H2 == H - 8;
+        for (unsigned int y = 0; y < H2 && pareil; ++y)
+            for (unsigned int x = 0; x < W2 && pareil; ++x) pareil = image[y * W2 + x] == reference[(y + 8) * W + x + 16];
+        if (!pareil) {
+            std::cerr << "the crop must keep the pixels of its blocks\n";
+            ok = false;
+        }
+        const sRecadrage refuses[] = { { 4, 0, 8, 8 }, { 0, 0, 12, 8 }, { 56, 0, 16, 8 }, { 0, 40, 0, 0 } };
+        for (const sRecadrage &mauvais : refuses) {
+            if (codec.Transformation_JPEG(fichier.data(), fichier.size(), TRANSFORMATION_AUCUNE, sortie, &mauvais)) {
+                std::cerr << "a crop off block boundaries or outside the image must be refused\n";
+                ok = false;
+            }
+        }
+        std::vector<unsigned char> tronque(fichier.begin(), fichier.begin() + fichier.size() / 2);
+        if (codec.Transformation_JPEG(tronque.data(), tronque.size(), TRANSFORMATION_ROTATION_180, sortie)) {
+            std::cerr << "a truncated file must be refused\n";
+            ok = false;
+        }
+    }
+
+    // Color containers whose sizes are not whole MCUs: the mirrored axes keep the padding.
+    {
+        const unsigned int w = 77, h = 50;
+        std::vector<unsigned char> rgb(static_cast<size_t>(w) * h * 3);
+        for (unsigned int y = 0; y < h; ++y)
+            for (unsigned int x = 0; x < w; ++x)
+                for (int c = 0; c < 3; ++c) rgb[(y * w + x) * 3 + c] = motif(x, y, c);
+        for (unsigned int mode : { 444u, 420u, 422u }) {
+            cCompressionCouleur cc;
+            cc.setSurechantillonnage(SURECHANTILLONNAGE_PROCHE);
+            std::vector<unsigned char> fichier, sortie;
+            cc.CompressRGB(rgb.data(), w, h, w * 3, 80, mode, fichier);
+            if (!cc.TransformConteneur(fichier.data(), fichier.size(), TRANSFORMATION_AUCUNE, sortie) || sortie != fichier) {
+                std::cerr << mode << ": the identity must give back the container\n";
+                ok = false;
+            }
+            std::vector<unsigned char> reference(rgb.size());
+            cc.DecompressToRGB(fichier.data(), fichier.size(), reference.data(), w * 3, w, h);
+            for (eTransformation t : toutes) {
+                const bool refuse = (mode == 422 && transpose(t));
+                if (!cc.TransformConteneur(fichier.data(), fichier.size(), t, sortie)) {
+                    if (!refuse) {
+                        std::cerr << mode << ": transform " << t << " failed\n";
+                        ok = false;
+                    }
+                    continue;
+                }
+                if (refuse) {
+                    std::cerr << mode << ": a quarter turn of 4:2:2 must be refused\n";
+                    ok = false;
+                    continue;
+                }
+                unsigned int W2 = 0, H2 = 0;
+                cCompressionCouleur::LireDimensions(sortie.data(), sortie.size(), W2, H2);
+                std::vector<unsigned char> image(static_cast<size_t>(W2) * H2 * 3);
+                if (!cc.DecompressToRGB(sortie.data(), sortie.size(), image.data(), W2 * 3, W2, H2)) {
+                    std::cerr << mode << ": transform " << t << " does not decode\n";
+                    ok = false;
+                    continue;
+                }
+                // The source, padding included, is the result turned back.
+                const unsigned int ws = transpose(t) ? H2 : W2, hs = transpose(t) ? W2 : H2;
+                bool pareil = true;
+                for (unsigned int y = 0; y < H2 && pareil; ++y) {
+                    for (unsigned int x = 0; x < W2 && pareil; ++x) {
+                        unsigned int sx = 0, sy = 0;
+                        pixel_source(t, ws, hs, x, y, sx, sy);
+                        if (sx >= w || sy >= h) continue;
+                        for (int c = 0; c < 3; ++c)
+                            pareil = pareil && std::abs(image[(y * W2 + x) * 3 + c] - reference[(sy * w + sx) * 3 + c]) <= 1;
+                    }
+                }
+                if (!pareil) {
+                    std::cerr << mode << ": transform " << t << " does not decode to the transformed image\n";
+                    ok = false;
+                }
+            }
+            sRecadrage mauvais;
+            mauvais.x = 8;
+            if (mode != 444 && cc.TransformConteneur(fichier.data(), fichier.size(), TRANSFORMATION_AUCUNE, sortie, &mauvais)) {
+                std::cerr << mode << ": a crop off MCU boundaries must be refused\n";
+                ok = false;
+            }
+        }
+    }
+
+    if (!ok) return 1;
+    std::cout << "test_transformation passed\n";
+    return 0;
+}